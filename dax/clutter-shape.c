@@ -21,6 +21,9 @@
 
 #include <cogl/cogl.h>
 
+#include "dax-path.h"
+#include "dax-path-cache.h"
+#include "dax-utils.h"
 #include "clutter-shape.h"
 
 #ifndef CLUTTER_PARAM_READWRITE
@@ -48,46 +51,28 @@ struct _ClutterShapePrivate
 {
     ClutterColor *color;            /* NULL means no fill color */
     ClutterColor *border_color;     /* NULL means no stroke color */
-    ClutterPath2D *path;
-    CoglHandle cogl_path;
+    DaxPath *path;
+    DaxPathCacheEntry *geometry;    /* looked up when first painted */
+    ClutterActorBox bounds;         /* of path, computed when set */
+    gboolean has_bounds;
 };
 
-static void clutter_path_draw_cogl (const ClutterPath2DNode *node,
-                                    gpointer                 user_data)
+/* Sets the tessellated geometry of the path as the current cogl path,
+ * shapes with the same path data share it */
+static gboolean
+clutter_shape_set_cogl_path (ClutterShape *shape)
 {
-  switch (node->type)
-    {
-      case CLUTTER_PATH_MOVE_TO:
-        cogl_path_move_to (node->points[0].x, node->points[0].y);
-        break;
-      case CLUTTER_PATH_LINE_TO:
-        cogl_path_line_to
-          (node->points[0].x, node->points[0].y);
-        break;
-      case CLUTTER_PATH_CURVE_TO:
-        cogl_path_curve_to (node->points[0].x, node->points[0].y,
-                            node->points[1].x, node->points[1].y,
-                            node->points[2].x, node->points[2].y);
-        break;
-      case CLUTTER_PATH_REL_MOVE_TO:
-        cogl_path_rel_move_to
-          (node->points[0].x, node->points[0].y);
-        break;
-      case CLUTTER_PATH_REL_LINE_TO:
-        cogl_path_rel_line_to (node->points[0].x, node->points[0].y);
-        break;
-      case CLUTTER_PATH_REL_CURVE_TO:
-        cogl_path_rel_curve_to
-                           (node->points[0].x, node->points[0].y,
-                            node->points[1].x, node->points[1].y,
-                            node->points[2].x, node->points[2].y);
-        break;
-      case CLUTTER_PATH_CLOSE:
-        cogl_path_close ();
-        break;
-      default:
-        g_assert_not_reached ();
-    }
+    ClutterShapePrivate *priv = shape->priv;
+
+    if (priv->path == NULL)
+        return FALSE;
+
+    if (priv->geometry == NULL)
+        priv->geometry = _dax_path_cache_lookup (priv->path);
+
+    cogl_set_path (_dax_path_cache_entry_get_cogl_path (priv->geometry));
+
+    return TRUE;
 }
 
 static void
@@ -95,15 +80,18 @@ clutter_shape_pick (ClutterActor       *self,
                     const ClutterColor *color)
 {
   ClutterShape          *shape = CLUTTER_SHAPE(self);
-  ClutterShapePrivate *priv = shape->priv;
 
-  if (clutter_actor_should_pick_paint (self))
+  if (!shape->priv->has_bounds ||
+      !_dax_utils_box_is_visible (&shape->priv->bounds))
+      return;
+
+  if (clutter_actor_should_pick_paint (self) &&
+      clutter_shape_set_cogl_path (shape))
     {
       cogl_set_source_color4ub (color->red,
                                 color->green,
                                 color->blue,
                                 color->alpha);
-      clutter_path_2d_foreach (priv->path, clutter_path_draw_cogl, NULL);
       cogl_path_fill();
     }
 }
@@ -126,12 +114,12 @@ clutter_shape_paint (ClutterActor *self)
   ClutterShapePrivate *priv = shape->priv;
   ClutterColor         tmp_col;
 
-  if (priv->cogl_path == COGL_INVALID_HANDLE) {
-      clutter_path_2d_foreach (priv->path, clutter_path_draw_cogl, NULL);
-      priv->cogl_path = cogl_handle_ref (cogl_get_path ());
-  } else {
-      cogl_set_path (priv->cogl_path);
-  }
+  /* scrolled out of the stage */
+  if (!priv->has_bounds || !_dax_utils_box_is_visible (&priv->bounds))
+      return;
+
+  if (!clutter_shape_set_cogl_path (shape))
+      return;
 
   if (priv->color && priv->border_color) {
       _apply_opacity_to_color (self, priv->color, &tmp_col);
@@ -206,13 +194,19 @@ clutter_shape_set_property (GObject      *object,
         }
         break;
     case PROP_PATH:
-        if (priv->cogl_path) {
-            cogl_handle_unref (priv->cogl_path);
-            priv->cogl_path = COGL_INVALID_HANDLE;
-        }
+        /* the geometry stays in the cache, the same path data is likely
+         * to come back */
+        _dax_path_cache_entry_unref (priv->geometry);
+        priv->geometry = NULL;
         if (priv->path)
             g_object_unref (priv->path);
-        priv->path = g_value_get_object (value);
+        priv->path = g_value_dup_object (value);
+        priv->has_bounds = priv->path &&
+                           dax_path_get_bounds (priv->path,
+                                                &priv->bounds.x1,
+                                                &priv->bounds.y1,
+                                                &priv->bounds.x2,
+                                                &priv->bounds.y2);
         clutter_actor_queue_redraw (CLUTTER_ACTOR (object));
         break;
     default:
@@ -230,8 +224,7 @@ clutter_shape_finalize (GObject *object)
     if (priv->path)
         g_object_unref (priv->path);
 
-    if (priv->cogl_path)
-        cogl_handle_unref (priv->path);
+    _dax_path_cache_entry_unref (priv->geometry);
 
     G_OBJECT_CLASS (clutter_shape_parent_class)->finalize (object);
 }
@@ -276,7 +269,7 @@ clutter_shape_class_init (ClutterShapeClass *klass)
     pspec = g_param_spec_object ("path",
                                  "Path",
                                  "A path describing the shape",
-                                 CLUTTER_TYPE_PATH_2D,
+                                 DAX_TYPE_PATH,
                                  CLUTTER_PARAM_READWRITE);
     g_object_class_install_property (gobject_class, PROP_PATH, pspec);
 }
@@ -292,7 +285,7 @@ clutter_shape_init (ClutterShape *self)
 /**
  * clutter_shape_new:
  *
- * Creates a new #ClutterActor that draws a #ClutterPath2D
+ * Creates a new #ClutterActor that draws a #DaxPath
  *
  * Return value: a new #ClutterActor
  */
@@ -301,3 +294,74 @@ clutter_shape_new (void)
 {
     return g_object_new (CLUTTER_TYPE_SHAPE, NULL);
 }
+
+/**
+ * clutter_shape_get_bounds:
+ * @shape: a #ClutterShape
+ * @box: (out): return location for the bounds
+ *
+ * Retrieves the bounds of the path of @shape, in the coordinates of
+ * @shape. They are computed once, when the path is set.
+ *
+ * Return value: %FALSE if @shape has nothing to draw
+ */
+gboolean
+clutter_shape_get_bounds (ClutterShape    *shape,
+                          ClutterActorBox *box)
+{
+    g_return_val_if_fail (CLUTTER_IS_SHAPE (shape), FALSE);
+
+    if (!shape->priv->has_bounds)
+        return FALSE;
+
+    *box = shape->priv->bounds;
+
+    return TRUE;
+}
+
+/**
+ * clutter_shape_contains_point:
+ * @shape: a #ClutterShape
+ * @x: the x coordinate of the point, in the coordinates of @shape
+ * @y: the y coordinate of the point, in the coordinates of @shape
+ * @stroke_width: the width of the outline, in the coordinates of @shape
+ *
+ * Tests whether @shape paints the point (@x, @y), without drawing it. The
+ * fill uses the even-odd rule, as cogl does, and the outline is
+ * @stroke_width wide.
+ *
+ * Return value: %TRUE if @shape covers the point
+ */
+gboolean
+clutter_shape_contains_point (ClutterShape *shape,
+                              gfloat        x,
+                              gfloat        y,
+                              gfloat        stroke_width)
+{
+    ClutterShapePrivate *priv;
+    gfloat margin;
+
+    g_return_val_if_fail (CLUTTER_IS_SHAPE (shape), FALSE);
+
+    priv = shape->priv;
+    if (!priv->has_bounds)
+        return FALSE;
+
+    /* most of the shapes are far from the point */
+    margin = priv->border_color ? stroke_width / 2 : 0;
+    if (x < priv->bounds.x1 - margin || x > priv->bounds.x2 + margin ||
+        y < priv->bounds.y1 - margin || y > priv->bounds.y2 + margin)
+    {
+        return FALSE;
+    }
+
+    if (priv->color &&
+        dax_path_fill_contains_point (priv->path, DAX_FILL_RULE_EVEN_ODD,
+                                      x, y))
+    {
+        return TRUE;
+    }
+
+    return priv->border_color &&
+           dax_path_stroke_contains_point (priv->path, stroke_width, x, y);
+}
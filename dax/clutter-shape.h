@@ -66,6 +66,12 @@ struct _ClutterShapeClass
 GType clutter_shape_get_type (void) G_GNUC_CONST;
 
 ClutterActor *clutter_shape_new            (void);
+gboolean      clutter_shape_get_bounds     (ClutterShape    *shape,
+                                            ClutterActorBox *box);
+gboolean      clutter_shape_contains_point (ClutterShape    *shape,
+                                            gfloat           x,
+                                            gfloat           y,
+                                            gfloat           stroke_width);
 
 G_END_DECLS
 
@@ -16,8 +16,12 @@
  * along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
+
+#include "clutter-shape.h"
 #include "dax-affine.h"
 #include "dax-debug.h"
+#include "dax-display-list.h"
 #include "dax-parser.h"
 #include "dax-traverser-clutter.h"
 
@@ -35,6 +39,14 @@ struct _DaxActorPrivate
     DaxDomDocument *document;
     ClutterScore *score;
     GPtrArray *media;
+    DaxTraverser *traverser;
+    gboolean use_display_list;
+    DaxGroupCacheMode group_cache_mode;
+    gboolean geometric_picking;
+
+    /* progressive loading */
+    DaxParser *parser;
+    gboolean has_size;
 };
 
 static void
@@ -47,26 +59,329 @@ remove_actor (ClutterActor *child,
 }
 
 static void
-dax_actor_rebuild_scene_graph (DaxActor *self)
+dax_actor_clear_scene_graph (DaxActor *self)
 {
     DaxActorPrivate *priv = self->priv;
-    DaxTraverser *traverser;
-    DaxTraverserClutter *traverser_clutter;
 
-    /* start by removing everyone */
     clutter_container_foreach (CLUTTER_CONTAINER (self), remove_actor, self);
 
+    if (priv->traverser) {
+        g_object_unref (priv->traverser);
+        priv->traverser = NULL;
+    }
+    if (priv->score) {
+        g_object_unref (priv->score);
+        priv->score = NULL;
+    }
+    if (priv->media) {
+        g_ptr_array_unref (priv->media);
+        priv->media = NULL;
+    }
+}
+
+static DaxTraverser *
+dax_actor_create_traverser (DaxActor *self)
+{
+    DaxActorPrivate *priv = self->priv;
+    DaxTraverser *traverser;
+    DaxTraverserClutter *traverser_clutter;
+
     traverser = dax_traverser_clutter_new (DAX_DOM_NODE (priv->document),
                                            CLUTTER_CONTAINER (self));
-    dax_traverser_apply (traverser);
 
     traverser_clutter = DAX_TRAVERSER_CLUTTER (traverser);
+    dax_traverser_clutter_set_group_cache_mode (traverser_clutter,
+                                                priv->group_cache_mode);
     priv->score =
         g_object_ref (dax_traverser_clutter_get_score (traverser_clutter));
     priv->media =
         g_ptr_array_ref (dax_traverser_clutter_get_media (traverser_clutter));
 
-    g_object_unref (traverser);
+    return traverser;
+}
+
+static void
+set_group_cache_mode (ClutterContainer  *container,
+                      DaxGroupCacheMode  mode)
+{
+    GList *children, *l;
+
+    children = clutter_container_get_children (container);
+    for (l = children; l; l = l->next) {
+        if (DAX_IS_GROUP (l->data))
+            dax_group_set_cache_mode (l->data, mode);
+        if (CLUTTER_IS_CONTAINER (l->data))
+            set_group_cache_mode (l->data, mode);
+    }
+    g_list_free (children);
+}
+
+static void
+dax_actor_rebuild_scene_graph (DaxActor *self)
+{
+    DaxActorPrivate *priv = self->priv;
+
+    /* start by removing everyone */
+    dax_actor_clear_scene_graph (self);
+
+    priv->traverser = dax_actor_create_traverser (self);
+    if (priv->use_display_list) {
+        dax_traverser_clutter_set_use_display_list (
+            DAX_TRAVERSER_CLUTTER (priv->traverser), TRUE);
+        dax_traverser_apply (priv->traverser);
+        return;
+    }
+
+    /* the traverser is kept around to update the scene graph when the
+     * document is modified afterwards */
+    dax_traverser_apply (priv->traverser);
+    dax_traverser_clutter_follow_mutations (
+        DAX_TRAVERSER_CLUTTER (priv->traverser), priv->document);
+}
+
+static void
+dax_actor_update_size (DaxActor *actor)
+{
+    DaxActorPrivate *priv = actor->priv;
+    DaxDomElement *element;
+    DaxElementSvg *svg;
+    ClutterUnits *width, *height;
+    DaxMatrix matrix;
+    GArray *viewbox;
+    double affine[6], scale_x = 1.0, scale_y = 1.0;
+    float width_px = 0.f, height_px = 0.f;
+
+    /* set the size of the actor as defined by <svg> width and height */
+    element = dax_dom_document_get_document_element (priv->document);
+    svg = DAX_ELEMENT_SVG (element);
+    width = dax_element_svg_get_width (svg);
+    height = dax_element_svg_get_height (svg);
+    if (width) {
+        width_px = clutter_units_to_pixels (width);
+        clutter_actor_set_width(CLUTTER_ACTOR (actor), width_px);
+    }
+    if (height) {
+        height_px = clutter_units_to_pixels (height);
+        clutter_actor_set_height(CLUTTER_ACTOR (actor), height_px);
+    }
+
+    g_object_get (svg, "viewBox", &viewbox, NULL);
+    if (width && height && viewbox) {
+        float vb_x, vb_y, vb_width, vb_height;
+
+        vb_x = g_array_index (viewbox, float, 0);
+        vb_y = g_array_index (viewbox, float, 1);
+        vb_width = g_array_index (viewbox, float, 2);
+        vb_height = g_array_index (viewbox, float, 3);
+
+        _dax_affine_identity (affine);
+        scale_x = width_px / (vb_width);
+        scale_y = height_px / (vb_height);
+        _dax_affine_translate (affine, -vb_x, -vb_y);
+        _dax_affine_scale (affine, scale_x, scale_y);
+
+        dax_matrix_from_array (&matrix, affine);
+        dax_group_set_matrix (DAX_GROUP (actor), &matrix);
+
+        DAX_NOTE (TRANSFORM, "Setting size %.02fx%.02f translate %.02f,%.02f "
+                  "scale %.02fx%.02f",
+                  clutter_units_to_pixels (width),
+                  clutter_units_to_pixels (height),
+                  -vb_x, -vb_y,
+                  scale_x, scale_y);
+    }
+
+    /* FIXME: still something wrong in the size, can't clip just yet... */
+#if 0
+    if (width && height)
+        clutter_actor_set_clip_to_allocation (CLUTTER_ACTOR (actor), TRUE);
+#endif
+}
+
+static void
+on_element_parsed (DaxParser     *parser,
+                   DaxDomElement *element,
+                   DaxActor      *actor)
+{
+    DaxActorPrivate *priv = actor->priv;
+
+    /* <svg> attributes are known as soon as its start tag is parsed */
+    if (!priv->has_size) {
+        dax_actor_update_size (actor);
+        priv->has_size = TRUE;
+    }
+
+    dax_traverser_set_root (priv->traverser, DAX_DOM_NODE (element));
+    dax_traverser_apply (priv->traverser);
+}
+
+static void
+dax_actor_release_parser (DaxActor *actor)
+{
+    DaxActorPrivate *priv = actor->priv;
+
+    if (priv->parser) {
+        g_signal_handlers_disconnect_by_func (priv->parser,
+                                              on_element_parsed,
+                                              actor);
+        g_object_unref (priv->parser);
+        priv->parser = NULL;
+    }
+}
+
+/*
+ * Hit-testing
+ *
+ * The actors are tested on the CPU, from the top-most one down, with the
+ * geometry of the shapes instead of painting them in the pick colors.
+ * pixel_size is the size of a pixel of the stage in the coordinates of the
+ * container, the width of the strokes.
+ */
+
+static ClutterActor *
+get_actor_at_position (ClutterContainer *container,
+                       gfloat            x,
+                       gfloat            y,
+                       gfloat            pixel_size)
+{
+    GList *children, *l;
+    ClutterActor *hit = NULL;
+
+    children = clutter_container_get_children (container);
+    for (l = g_list_last (children); l && hit == NULL; l = l->prev) {
+        ClutterActor *child = l->data;
+        CoglMatrix matrix;
+        double affine[6], inverse[6], expansion;
+        gfloat child_x, child_y, child_pixel_size, width, height;
+
+        /* the static shapes of a display list don't have an element */
+        if (!CLUTTER_ACTOR_IS_VISIBLE (child) || DAX_IS_DISPLAY_LIST (child))
+            continue;
+
+        /* the transformations of the scene graph are 2D */
+        clutter_actor_get_transformation_matrix (child, &matrix);
+        affine[0] = matrix.xx;
+        affine[1] = matrix.yx;
+        affine[2] = matrix.xy;
+        affine[3] = matrix.yy;
+        affine[4] = matrix.xw;
+        affine[5] = matrix.yw;
+
+        expansion = _dax_affine_expansion (affine);
+        if (expansion == 0)
+            continue;
+
+        _dax_affine_invert (inverse, affine);
+        child_x = inverse[0] * x + inverse[2] * y + inverse[4];
+        child_y = inverse[1] * x + inverse[3] * y + inverse[5];
+        child_pixel_size = pixel_size / expansion;
+
+        if (CLUTTER_IS_CONTAINER (child)) {
+            hit = get_actor_at_position (CLUTTER_CONTAINER (child),
+                                         child_x, child_y,
+                                         child_pixel_size);
+        } else if (CLUTTER_IS_SHAPE (child)) {
+            if (clutter_shape_contains_point (CLUTTER_SHAPE (child),
+                                              child_x, child_y,
+                                              child_pixel_size))
+            {
+                hit = child;
+            }
+        } else {
+            clutter_actor_get_size (child, &width, &height);
+            if (child_x >= 0 && child_x < width &&
+                child_y >= 0 && child_y < height)
+            {
+                hit = child;
+            }
+        }
+    }
+    g_list_free (children);
+
+    return hit;
+}
+
+static ClutterActor *
+dax_actor_get_actor_at_position (DaxActor *self,
+                                 gfloat    x,
+                                 gfloat    y)
+{
+    gfloat local_x, local_y, next_x, next_y, pixel_size;
+
+    if (!clutter_actor_transform_stage_point (CLUTTER_ACTOR (self), x, y,
+                                              &local_x, &local_y) ||
+        !clutter_actor_transform_stage_point (CLUTTER_ACTOR (self), x + 1, y,
+                                              &next_x, &next_y))
+    {
+        return NULL;
+    }
+
+    pixel_size = sqrtf ((next_x - local_x) * (next_x - local_x) +
+                        (next_y - local_y) * (next_y - local_y));
+
+    return get_actor_at_position (CLUTTER_CONTAINER (self), local_x, local_y,
+                                  pixel_size);
+}
+
+/*
+ * ClutterActor overloading
+ */
+
+static void
+dax_actor_pick (ClutterActor       *actor,
+                const ClutterColor *color)
+{
+    DaxActor *self = DAX_ACTOR (actor);
+    ClutterActorBox box;
+
+    if (!self->priv->geometric_picking) {
+        CLUTTER_ACTOR_CLASS (dax_actor_parent_class)->pick (actor, color);
+        return;
+    }
+
+    /* the whole document is picked as one rectangle, the events are then
+     * given to the actor found by hit-testing */
+    if (!clutter_actor_should_pick_paint (actor))
+        return;
+
+    /* documents without a size only cover what their children draw */
+    if (!_dax_group_get_bounds (DAX_GROUP (actor), &box)) {
+        ClutterActorBox allocation;
+
+        clutter_actor_get_allocation_box (actor, &allocation);
+        box.x1 = box.y1 = 0;
+        box.x2 = clutter_actor_box_get_width (&allocation);
+        box.y2 = clutter_actor_box_get_height (&allocation);
+    }
+
+    cogl_set_source_color4ub (color->red, color->green, color->blue,
+                              color->alpha);
+    cogl_rectangle (box.x1, box.y1, box.x2, box.y2);
+}
+
+static gboolean
+dax_actor_button_release_event (ClutterActor       *actor,
+                                ClutterButtonEvent *event)
+{
+    DaxActor *self = DAX_ACTOR (actor);
+    ClutterActor *hit;
+    gboolean handled = FALSE;
+
+    if (!self->priv->geometric_picking)
+        return FALSE;
+
+    /* the event bubbles up from the actor under the pointer, as it would
+     * have if that actor had been picked */
+    hit = dax_actor_get_actor_at_position (self, event->x, event->y);
+    for (; hit && hit != actor && !handled;
+         hit = clutter_actor_get_parent (hit))
+    {
+        if (clutter_actor_get_reactive (hit))
+            g_signal_emit_by_name (hit, "button-release-event", event,
+                                   &handled);
+    }
+
+    return handled;
 }
 
 /*
@@ -102,6 +417,16 @@ dax_actor_set_property (GObject      *object,
 static void
 dax_actor_dispose (GObject *object)
 {
+    DaxActor *actor = DAX_ACTOR (object);
+    DaxActorPrivate *priv = actor->priv;
+
+    dax_actor_release_parser (actor);
+
+    if (priv->traverser) {
+        g_object_unref (priv->traverser);
+        priv->traverser = NULL;
+    }
+
     G_OBJECT_CLASS (dax_actor_parent_class)->dispose (object);
 }
 
@@ -111,19 +436,29 @@ dax_actor_finalize (GObject *object)
     DaxActor *actor = DAX_ACTOR (object);
     DaxActorPrivate *priv = actor->priv;
 
+    /* released once the actors bound to its elements are gone */
+    if (priv->document)
+        g_object_unref (priv->document);
+
     G_OBJECT_CLASS (dax_actor_parent_class)->finalize (object);
 
-    g_object_unref (priv->score);
-    g_ptr_array_unref (priv->media);
+    if (priv->score)
+        g_object_unref (priv->score);
+    if (priv->media)
+        g_ptr_array_unref (priv->media);
 }
 
 static void
 dax_actor_class_init (DaxActorClass *klass)
 {
     GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
 
     g_type_class_add_private (klass, sizeof (DaxActorPrivate));
 
+    actor_class->pick = dax_actor_pick;
+    actor_class->button_release_event = dax_actor_button_release_event;
+
     object_class->get_property = dax_actor_get_property;
     object_class->set_property = dax_actor_set_property;
     object_class->dispose = dax_actor_dispose;
@@ -156,74 +491,71 @@ dax_actor_new_from_file (const gchar  *filename,
 
     actor = dax_actor_new ();
     dax_actor_set_document (DAX_ACTOR (actor), document);
+    g_object_unref (document);
 
     return actor;
 }
 
+/**
+ * dax_actor_set_document:
+ * @actor: a #DaxActor
+ * @document: the #DaxDomDocument to display
+ *
+ * Displays @document. @actor keeps a reference on it.
+ */
 void
 dax_actor_set_document (DaxActor       *actor,
                         DaxDomDocument *document)
 {
     DaxActorPrivate *priv;
-    DaxElementSvg *svg;
-    ClutterUnits *width, *height;
-    DaxMatrix matrix;
-    GArray *viewbox;
-    double affine[6], scale_x = 1.0, scale_y = 1.0;
-    float width_px = 0.f, height_px = 0.f;
 
     g_return_if_fail (DAX_IS_ACTOR (actor));
 
     priv = actor->priv;
+    dax_actor_release_parser (actor);
+    g_object_ref (document);
+    if (priv->document)
+        g_object_unref (priv->document);
     priv->document = document;
 
     dax_actor_rebuild_scene_graph (actor);
+    dax_actor_update_size (actor);
+}
 
-    /* set the size of the actor as defined by <svg> width and height */
-    svg = DAX_ELEMENT_SVG (dax_dom_document_get_document_element (document));
-    width = dax_element_svg_get_width (svg);
-    height = dax_element_svg_get_height (svg);
-    if (width) {
-        width_px = clutter_units_to_pixels (width);
-        clutter_actor_set_width(CLUTTER_ACTOR (actor), width_px);
-    }
-    if (height) {
-        height_px = clutter_units_to_pixels (height);
-        clutter_actor_set_height(CLUTTER_ACTOR (actor), height_px);
-    }
-
-    g_object_get (svg, "viewBox", &viewbox, NULL);
-    if (width && height && viewbox) {
-        float vb_x, vb_y, vb_width, vb_height;
-
-        vb_x = g_array_index (viewbox, float, 0);
-        vb_y = g_array_index (viewbox, float, 1);
-        vb_width = g_array_index (viewbox, float, 2);
-        vb_height = g_array_index (viewbox, float, 3);
+/**
+ * dax_actor_set_parser:
+ * @actor: a #DaxActor
+ * @parser: a #DaxParser that has not been fed yet
+ *
+ * Displays the document built by @parser, adding the children of the
+ * document element to the scene graph as soon as they have been parsed
+ * instead of waiting for the whole document.
+ */
+void
+dax_actor_set_parser (DaxActor  *actor,
+                      DaxParser *parser)
+{
+    DaxActorPrivate *priv;
 
-        _dax_affine_identity (affine);
-        scale_x = width_px / (vb_width);
-        scale_y = height_px / (vb_height);
-        _dax_affine_translate (affine, -vb_x, -vb_y);
-        _dax_affine_scale (affine, scale_x, scale_y);
+    g_return_if_fail (DAX_IS_ACTOR (actor));
+    g_return_if_fail (DAX_IS_PARSER (parser));
 
-        dax_matrix_from_array (&matrix, affine);
-        dax_group_set_matrix (DAX_GROUP (actor), &matrix);
+    priv = actor->priv;
+    dax_actor_release_parser (actor);
+    dax_actor_clear_scene_graph (actor);
 
-        DAX_NOTE (TRANSFORM, "Setting size %.02fx%.02f translate %.02f,%.02f "
-                  "scale %.02fx%.02f",
-                  clutter_units_to_pixels (width),
-                  clutter_units_to_pixels (height),
-                  -vb_x, -vb_y,
-                  scale_x, scale_y);
-    }
+    priv->parser = g_object_ref (parser);
+    if (priv->document)
+        g_object_unref (priv->document);
+    priv->document = g_object_ref (dax_parser_get_document (parser));
+    priv->has_size = FALSE;
 
-    /* FIXME: still something wrong in the size, can't clip just yet... */
-#if 0
-    if (width && height)
-        clutter_actor_set_clip_to_allocation (CLUTTER_ACTOR (actor), TRUE);
-#endif
+    /* a single traverser for the whole document, its root is changed to the
+     * top level elements as they come */
+    priv->traverser = dax_actor_create_traverser (actor);
 
+    g_signal_connect (parser, "element-parsed",
+                      G_CALLBACK (on_element_parsed), actor);
 }
 
 void
@@ -248,3 +580,141 @@ dax_actor_set_playing (DaxActor *actor,
         clutter_score_pause (priv->score);
     }
 }
+
+/**
+ * dax_actor_set_use_display_list:
+ * @actor: a #DaxActor
+ * @use_list: whether to draw the static parts of the document with display
+ *   lists
+ *
+ * Documents that are mostly static, like illustrations, are displayed with
+ * a handful of actors instead of one per element when @use_list is %TRUE.
+ * The scene graph is not updated when the document is modified afterwards.
+ * Documents set with dax_actor_set_parser() always have one actor per
+ * element.
+ *
+ * See dax_traverser_clutter_set_use_display_list().
+ */
+void
+dax_actor_set_use_display_list (DaxActor *actor,
+                                gboolean  use_list)
+{
+    DaxActorPrivate *priv;
+
+    g_return_if_fail (DAX_IS_ACTOR (actor));
+
+    priv = actor->priv;
+    use_list = !!use_list;
+    if (priv->use_display_list == use_list)
+        return;
+
+    priv->use_display_list = use_list;
+    if (priv->document && priv->parser == NULL)
+        dax_actor_rebuild_scene_graph (actor);
+}
+
+gboolean
+dax_actor_get_use_display_list (DaxActor *actor)
+{
+    g_return_val_if_fail (DAX_IS_ACTOR (actor), FALSE);
+
+    return actor->priv->use_display_list;
+}
+
+/**
+ * dax_actor_set_group_cache_mode:
+ * @actor: a #DaxActor
+ * @mode: the #DaxGroupCacheMode of the groups of the document
+ *
+ * Sets the cache mode of the groups built for the &lt;g&gt; elements of the
+ * document, see dax_group_set_cache_mode(). The mode of @actor itself,
+ * which is a #DaxGroup, is left alone.
+ */
+void
+dax_actor_set_group_cache_mode (DaxActor          *actor,
+                                DaxGroupCacheMode  mode)
+{
+    DaxActorPrivate *priv;
+
+    g_return_if_fail (DAX_IS_ACTOR (actor));
+
+    priv = actor->priv;
+    priv->group_cache_mode = mode;
+
+    if (priv->traverser)
+        dax_traverser_clutter_set_group_cache_mode (
+            DAX_TRAVERSER_CLUTTER (priv->traverser), mode);
+    set_group_cache_mode (CLUTTER_CONTAINER (actor), mode);
+}
+
+/**
+ * dax_actor_get_element_at_position:
+ * @actor: a #DaxActor
+ * @x: the x coordinate of the point, in stage coordinates
+ * @y: the y coordinate of the point, in stage coordinates
+ *
+ * Finds the top-most element painted at (@x, @y). The geometry of the
+ * shapes is tested on the CPU, nothing is painted. The shapes drawn by
+ * display lists (see dax_actor_set_use_display_list()) can't be found,
+ * the elements with event handlers always have their own actor.
+ *
+ * Return value: (transfer none): the element at (@x, @y), %NULL if there
+ * is none
+ */
+DaxDomElement *
+dax_actor_get_element_at_position (DaxActor *actor,
+                                   gfloat    x,
+                                   gfloat    y)
+{
+    ClutterActor *hit;
+
+    g_return_val_if_fail (DAX_IS_ACTOR (actor), NULL);
+
+    hit = dax_actor_get_actor_at_position (actor, x, y);
+
+    /* an actor added by someone else is part of the element of its
+     * parent */
+    for (; hit && hit != CLUTTER_ACTOR (actor);
+         hit = clutter_actor_get_parent (hit))
+    {
+        DaxDomElement *element = dax_traverser_clutter_get_element (hit);
+
+        if (element)
+            return element;
+    }
+
+    return NULL;
+}
+
+/**
+ * dax_actor_set_geometric_picking:
+ * @actor: a #DaxActor
+ * @geometric_picking: whether to find the actor under the pointer with the
+ *   geometry of the shapes
+ *
+ * Clutter finds the actor under the pointer by painting all the reactive
+ * actors in a color of their own, which is expensive for documents with
+ * many reactive shapes. When @geometric_picking is %TRUE, @actor is
+ * picked as a single rectangle, the bounds of what it draws, and made
+ * reactive; the button release events it receives are given to the actor
+ * found with dax_actor_get_element_at_position()'s hit-testing and bubble
+ * up from there.
+ */
+void
+dax_actor_set_geometric_picking (DaxActor *actor,
+                                 gboolean  geometric_picking)
+{
+    g_return_if_fail (DAX_IS_ACTOR (actor));
+
+    actor->priv->geometric_picking = !!geometric_picking;
+    if (geometric_picking)
+        clutter_actor_set_reactive (CLUTTER_ACTOR (actor), TRUE);
+}
+
+gboolean
+dax_actor_get_geometric_picking (DaxActor *actor)
+{
+    g_return_val_if_fail (DAX_IS_ACTOR (actor), FALSE);
+
+    return actor->priv->geometric_picking;
+}
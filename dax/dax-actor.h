@@ -29,6 +29,7 @@
 #include "dax-dom.h"
 
 #include "dax-group.h"
+#include "dax-parser.h"
 
 G_BEGIN_DECLS
 
@@ -72,8 +73,21 @@ ClutterActor *  dax_actor_new_from_file     (const gchar  *filename,
                                              GError      **error);
 void            dax_actor_set_document      (DaxActor       *actor,
                                              DaxDomDocument *document);
+void            dax_actor_set_parser        (DaxActor  *actor,
+                                             DaxParser *parser);
 void            dax_actor_set_playing       (DaxActor *self,
                                              gboolean  playing);
+void            dax_actor_set_use_display_list  (DaxActor *actor,
+                                                 gboolean  use_list);
+gboolean        dax_actor_get_use_display_list  (DaxActor *actor);
+void            dax_actor_set_group_cache_mode  (DaxActor          *actor,
+                                                 DaxGroupCacheMode  mode);
+DaxDomElement * dax_actor_get_element_at_position   (DaxActor *actor,
+                                                     gfloat    x,
+                                                     gfloat    y);
+void            dax_actor_set_geometric_picking (DaxActor *actor,
+                                                 gboolean  geometric_picking);
+gboolean        dax_actor_get_geometric_picking (DaxActor *actor);
 
 G_END_DECLS
 
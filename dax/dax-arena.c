@@ -0,0 +1,237 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "dax-arena.h"
+
+#define BLOCK_SIZE      (16 * 1024)
+#define ALIGNMENT       8
+#define ALIGN(size)     (((size) + ALIGNMENT - 1) & ~(gsize) (ALIGNMENT - 1))
+
+typedef struct _Block Block;
+
+struct _Block
+{
+    Block *next;
+    gsize size;                 /* usable bytes after the header */
+    gsize used;
+};
+
+typedef struct _Attachment Attachment;
+
+struct _Attachment
+{
+    Attachment *next;
+    gpointer data;
+    GDestroyNotify destroy;
+};
+
+/* the data of a block starts right after its (aligned) header */
+#define BLOCK_DATA(block)   ((guint8 *) (block) + ALIGN (sizeof (Block)))
+
+struct _DaxArena
+{
+    Block *blocks;              /* the current block is the first one */
+    gpointer last;              /* last allocation, can be shrunk */
+    gsize size;                 /* bytes taken from the system */
+    gsize used;                 /* bytes handed out */
+    Attachment *attachments;    /* allocated in the arena itself */
+    gint ref_count;
+};
+
+static Block *
+block_new (gsize size)
+{
+    Block *block;
+
+    block = g_malloc (ALIGN (sizeof (Block)) + size);
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+
+    return block;
+}
+
+DaxArena *
+_dax_arena_new (void)
+{
+    DaxArena *arena;
+
+    arena = g_slice_new0 (DaxArena);
+    arena->ref_count = 1;
+
+    return arena;
+}
+
+DaxArena *
+_dax_arena_ref (DaxArena *arena)
+{
+    g_atomic_int_inc (&arena->ref_count);
+
+    return arena;
+}
+
+void
+_dax_arena_unref (DaxArena *arena)
+{
+    Attachment *attachment;
+    Block *block, *next;
+
+    if (arena == NULL)
+        return;
+
+    if (!g_atomic_int_dec_and_test (&arena->ref_count))
+        return;
+
+    for (attachment = arena->attachments;
+         attachment;
+         attachment = attachment->next)
+    {
+        attachment->destroy (attachment->data);
+    }
+
+    for (block = arena->blocks; block; block = next) {
+        next = block->next;
+        g_free (block);
+    }
+
+    g_slice_free (DaxArena, arena);
+}
+
+/* @destroy is called on @data when the arena is freed. Used to keep alive
+ * what the memory handed out points to, like a mapped file */
+void
+_dax_arena_attach (DaxArena       *arena,
+                   gpointer        data,
+                   GDestroyNotify  destroy)
+{
+    Attachment *attachment;
+
+    attachment = _dax_arena_alloc (arena, sizeof (Attachment));
+    attachment->data = data;
+    attachment->destroy = destroy;
+    attachment->next = arena->attachments;
+    arena->attachments = attachment;
+}
+
+gpointer
+_dax_arena_alloc (DaxArena *arena,
+                  gsize     size)
+{
+    Block *block = arena->blocks;
+    gpointer mem;
+
+    size = ALIGN (size);
+
+    if (G_UNLIKELY (block == NULL || block->used + size > block->size)) {
+        if (size > BLOCK_SIZE / 4) {
+            /* big allocations get their own block, behind the current one
+             * so that the space left in the current one is not lost */
+            block = block_new (size);
+            if (arena->blocks) {
+                block->next = arena->blocks->next;
+                arena->blocks->next = block;
+            } else {
+                arena->blocks = block;
+            }
+        } else {
+            block = block_new (BLOCK_SIZE);
+            block->next = arena->blocks;
+            arena->blocks = block;
+        }
+        arena->size += block->size;
+    }
+
+    mem = BLOCK_DATA (block) + block->used;
+    block->used += size;
+    arena->used += size;
+    arena->last = mem;
+
+    return mem;
+}
+
+/* Gives back the end of the last allocation, useful when only an upper
+ * bound of the size was known when allocating */
+void
+_dax_arena_shrink (DaxArena *arena,
+                   gpointer  mem,
+                   gsize     size)
+{
+    Block *block;
+    gsize start, old_size;
+
+    if (mem == NULL || mem != arena->last)
+        return;
+
+    /* the last allocation is at the end of its block, be it the current
+     * one or a big one right behind it */
+    block = arena->blocks;
+    if ((guint8 *) mem < BLOCK_DATA (block) ||
+        (guint8 *) mem >= BLOCK_DATA (block) + block->size)
+    {
+        block = block->next;
+    }
+
+    start = (guint8 *) mem - BLOCK_DATA (block);
+    old_size = block->used - start;
+    size = ALIGN (size);
+    if (size >= old_size)
+        return;
+
+    block->used = start + size;
+    arena->used -= old_size - size;
+}
+
+gpointer
+_dax_arena_memdup (DaxArena      *arena,
+                   gconstpointer  mem,
+                   gsize          size)
+{
+    gpointer copy;
+
+    if (mem == NULL)
+        return NULL;
+
+    copy = _dax_arena_alloc (arena, size);
+    memcpy (copy, mem, size);
+
+    return copy;
+}
+
+gchar *
+_dax_arena_strdup (DaxArena    *arena,
+                   const gchar *str)
+{
+    if (str == NULL)
+        return NULL;
+
+    return _dax_arena_memdup (arena, str, strlen (str) + 1);
+}
+
+gsize
+_dax_arena_get_size (DaxArena *arena)
+{
+    return arena->size;
+}
+
+gsize
+_dax_arena_get_used (DaxArena *arena)
+{
+    return arena->used;
+}
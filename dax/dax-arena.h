@@ -0,0 +1,61 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DAX_ARENA_H__
+#define __DAX_ARENA_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * A bump allocator. Memory is carved out of big blocks and is only given
+ * back when the whole arena is freed. Documents use one to hold the data
+ * of their nodes so that loading does not go through malloc() for every
+ * string or array, and freeing the document releases everything at once.
+ *
+ * Arenas are reference counted: objects keeping pointers into an arena
+ * hold a reference on it so that they can outlive the document.
+ */
+
+typedef struct _DaxArena DaxArena;
+
+DaxArena *      _dax_arena_new          (void);
+DaxArena *      _dax_arena_ref          (DaxArena *arena);
+void            _dax_arena_unref        (DaxArena *arena);
+void            _dax_arena_attach       (DaxArena       *arena,
+                                         gpointer        data,
+                                         GDestroyNotify  destroy);
+
+gpointer        _dax_arena_alloc        (DaxArena      *arena,
+                                         gsize          size);
+void            _dax_arena_shrink       (DaxArena      *arena,
+                                         gpointer       mem,
+                                         gsize          size);
+gpointer        _dax_arena_memdup       (DaxArena      *arena,
+                                         gconstpointer  mem,
+                                         gsize          size);
+gchar *         _dax_arena_strdup       (DaxArena      *arena,
+                                         const gchar   *str);
+
+gsize           _dax_arena_get_size     (DaxArena      *arena);
+gsize           _dax_arena_get_used     (DaxArena      *arena);
+
+G_END_DECLS
+
+#endif /* __DAX_ARENA_H__ */
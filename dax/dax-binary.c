@@ -0,0 +1,1342 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Precompiled documents.
+ *
+ * A parsed document is saved as the list of its nodes with the values of the
+ * properties of the elements, so that loading it back does not involve any
+ * XML parsing or string to GValue transformation. The file is meant to be
+ * memory mapped: strings, text nodes and the arrays of paths and knot
+ * sequences are used in place. The mapping is attached to the arena of the
+ * document, which the nodes and arrays pointing into it keep alive.
+ *
+ * The layout is:
+ *   - a Header,
+ *   - the string table: n_strings offsets followed by the NUL terminated
+ *     strings,
+ *   - the node stream: the namespaces of the document then the elements,
+ *     depth first.
+ *
+ * Everything is written in the byte order and with the struct layout of
+ * the machine saving the file. The header records the byte order, the
+ * version of the library and the size of the structures saved as raw bytes,
+ * the loader refuses files that do not match.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gio/gio.h>
+
+#include "dax-debug.h"
+#include "dax-document.h"
+#include "dax-dom-private.h"
+#include "dax-dom-text.h"
+#include "dax-js-context.h"
+#include "dax-paramspec.h"
+#include "dax-private.h"
+#include "dax-types.h"
+#include "dax-xml-private.h"
+
+#include "dax-binary.h"
+
+#define BINARY_MAGIC        "DAXB"
+#define BINARY_VERSION      2
+#define BINARY_BYTE_ORDER   0x01020304
+
+#ifndef PACKAGE_VERSION
+#define PACKAGE_VERSION     "unknown"
+#endif
+
+#define NO_STRING           G_MAXUINT32
+#define MAX_DEPTH           1024
+
+typedef struct
+{
+    gchar magic[4];
+    guint32 version;
+    guint32 byte_order;
+    guint32 file_size;
+    guint32 n_strings;
+    guint32 strings_offset;
+    guint32 nodes_offset;
+    guint32 reserved;
+    gchar package_version[16];  /* of the library that wrote the file */
+    guint16 type_sizes[8];      /* see get_type_sizes() */
+} Header;
+
+enum
+{
+    NODE_END,
+    NODE_ELEMENT,
+    NODE_TEXT
+};
+
+enum
+{
+    VALUE_INT,              /* gint64, booleans, integers, enums and flags */
+    VALUE_DOUBLE,           /* gdouble */
+    VALUE_STRING,           /* string id */
+    VALUE_UNITS,            /* unit type and value */
+    VALUE_BOXED,            /* size and the bytes of the structure */
+    VALUE_FLOAT_ARRAY,      /* length and the floats */
+    VALUE_UNITS_ARRAY,      /* length and the (unit type, value) pairs */
+    VALUE_PATH,             /* sizes, coordinates then verbs */
+    VALUE_KNOTS,            /* number of knots and their coordinates */
+    VALUE_FROM_STRING       /* string id of the value transformed to a string */
+};
+
+/* boxed types that can be saved as raw bytes: no pointers in them */
+static gsize
+plain_boxed_size (GType type)
+{
+    if (type == CLUTTER_TYPE_COLOR)
+        return sizeof (ClutterColor);
+    if (type == DAX_TYPE_MATRIX)
+        return sizeof (DaxMatrix);
+    if (type == DAX_TYPE_DURATION)
+        return sizeof (DaxDuration);
+    if (type == DAX_TYPE_REPEAT_COUNT)
+        return sizeof (DaxRepeatCount);
+    if (type == DAX_TYPE_PRESERVE_ASPECT_RATIO)
+        return sizeof (DaxPreserveAspectRatio);
+
+    return 0;
+}
+
+/* the sizes of the types written as raw bytes, a library built with other
+ * definitions of the structures can't read them */
+static void
+get_type_sizes (guint16 sizes[8])
+{
+    sizes[0] = sizeof (gfloat);
+    sizes[1] = sizeof (gdouble);
+    sizes[2] = sizeof (ClutterColor);
+    sizes[3] = sizeof (DaxMatrix);
+    sizes[4] = sizeof (DaxDuration);
+    sizes[5] = sizeof (DaxRepeatCount);
+    sizes[6] = sizeof (DaxPreserveAspectRatio);
+    sizes[7] = 0;
+}
+
+GQuark
+dax_binary_error_quark (void)
+{
+    return g_quark_from_static_string ("dax-binary-error-quark");
+}
+
+/*
+ * Saving
+ */
+
+typedef struct
+{
+    GByteArray *nodes;
+    GHashTable *string_ids;     /* string -> id + 1 */
+    GPtrArray *strings;         /* id -> string, owns the strings */
+} Writer;
+
+static void
+write_align (Writer *writer,
+             guint   alignment)
+{
+    static const guint8 zeros[8] = { 0, };
+    guint padding;
+
+    padding = (alignment - writer->nodes->len % alignment) % alignment;
+    g_byte_array_append (writer->nodes, zeros, padding);
+}
+
+static void
+write_data (Writer        *writer,
+            gconstpointer  data,
+            gsize          size)
+{
+    g_byte_array_append (writer->nodes, data, size);
+}
+
+static void
+write_uint (Writer  *writer,
+            guint32  value)
+{
+    write_data (writer, &value, sizeof (value));
+}
+
+static void
+write_string (Writer      *writer,
+              const gchar *string)
+{
+    guint id;
+
+    if (string == NULL) {
+        write_uint (writer, NO_STRING);
+        return;
+    }
+
+    id = GPOINTER_TO_UINT (g_hash_table_lookup (writer->string_ids, string));
+    if (id == 0) {
+        gchar *copy = g_strdup (string);
+
+        g_ptr_array_add (writer->strings, copy);
+        id = writer->strings->len;
+        g_hash_table_insert (writer->string_ids, copy, GUINT_TO_POINTER (id));
+    }
+
+    write_uint (writer, id - 1);
+}
+
+static void
+write_units (Writer             *writer,
+             const ClutterUnits *units)
+{
+    gfloat value = clutter_units_get_unit_value (units);
+
+    write_uint (writer, clutter_units_get_unit_type (units));
+    write_data (writer, &value, sizeof (value));
+}
+
+static void
+write_array (Writer     *writer,
+             GParamSpec *pspec,
+             GArray     *array)
+{
+    DaxParamSpecArray *array_spec = DAX_PARAM_SPEC_ARRAY (pspec);
+    guint i;
+
+    if (array_spec->element_type == G_TYPE_FLOAT) {
+        write_uint (writer, VALUE_FLOAT_ARRAY);
+        write_uint (writer, array->len);
+        write_data (writer, array->data, array->len * sizeof (gfloat));
+        return;
+    }
+
+    /* the only other type of element is ClutterUnits */
+    write_uint (writer, VALUE_UNITS_ARRAY);
+    write_uint (writer, array->len);
+    for (i = 0; i < array->len; i++)
+        write_units (writer, &g_array_index (array, ClutterUnits, i));
+}
+
+static void
+write_path (Writer  *writer,
+            DaxPath *path)
+{
+    guint n_verbs = dax_path_get_n_verbs (path);
+    guint n_coords = dax_path_get_n_coords (path);
+
+    write_uint (writer, VALUE_PATH);
+    write_uint (writer, n_verbs);
+    write_uint (writer, n_coords);
+    write_data (writer, dax_path_get_coords (path), n_coords * sizeof (gfloat));
+    write_data (writer, dax_path_get_verbs (path), n_verbs);
+    write_align (writer, 4);
+}
+
+static void
+write_knot_sequence (Writer          *writer,
+                     DaxKnotSequence *seq)
+{
+    guint n_knots = dax_knot_sequence_get_size (seq);
+
+    write_uint (writer, VALUE_KNOTS);
+    write_uint (writer, n_knots);
+    write_data (writer,
+                dax_knot_sequence_get_array (seq),
+                n_knots * 2 * sizeof (gfloat));
+}
+
+static gint64
+get_int_value (const GValue *value)
+{
+    switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value))) {
+    case G_TYPE_BOOLEAN:
+        return g_value_get_boolean (value);
+    case G_TYPE_INT:
+        return g_value_get_int (value);
+    case G_TYPE_UINT:
+        return g_value_get_uint (value);
+    case G_TYPE_LONG:
+        return g_value_get_long (value);
+    case G_TYPE_ULONG:
+        return g_value_get_ulong (value);
+    case G_TYPE_INT64:
+        return g_value_get_int64 (value);
+    case G_TYPE_UINT64:
+        return g_value_get_uint64 (value);
+    case G_TYPE_ENUM:
+        return g_value_get_enum (value);
+    case G_TYPE_FLAGS:
+        return g_value_get_flags (value);
+    default:
+        g_assert_not_reached ();
+    }
+
+    return 0;
+}
+
+static gboolean
+is_int_type (GType type)
+{
+    switch (G_TYPE_FUNDAMENTAL (type)) {
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_LONG:
+    case G_TYPE_ULONG:
+    case G_TYPE_INT64:
+    case G_TYPE_UINT64:
+    case G_TYPE_ENUM:
+    case G_TYPE_FLAGS:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+static gboolean
+is_string_transformable (GType type)
+{
+    return g_value_type_transformable (type, G_TYPE_STRING) &&
+           g_value_type_transformable (G_TYPE_STRING, type);
+}
+
+/* returns FALSE when the value can't be saved, nothing is written then */
+static gboolean
+write_value (Writer       *writer,
+             GParamSpec   *pspec,
+             const GValue *value)
+{
+    GType type = pspec->value_type;
+    gsize boxed_size;
+
+    if (is_int_type (type)) {
+        gint64 int_value = get_int_value (value);
+
+        write_uint (writer, VALUE_INT);
+        write_align (writer, 8);
+        write_data (writer, &int_value, sizeof (int_value));
+    } else if (type == G_TYPE_FLOAT || type == G_TYPE_DOUBLE) {
+        gdouble double_value;
+
+        if (type == G_TYPE_FLOAT)
+            double_value = g_value_get_float (value);
+        else
+            double_value = g_value_get_double (value);
+
+        write_uint (writer, VALUE_DOUBLE);
+        write_align (writer, 8);
+        write_data (writer, &double_value, sizeof (double_value));
+    } else if (type == G_TYPE_STRING) {
+        write_uint (writer, VALUE_STRING);
+        write_string (writer, g_value_get_string (value));
+    } else if (type == DAX_TYPE_PATH) {
+        write_path (writer, g_value_get_object (value));
+    } else if (type == DAX_TYPE_KNOT_SEQUENCE) {
+        write_knot_sequence (writer, g_value_get_object (value));
+    } else if (type == CLUTTER_TYPE_UNITS) {
+        write_uint (writer, VALUE_UNITS);
+        write_units (writer, g_value_get_boxed (value));
+    } else if (DAX_IS_PARAM_SPEC_ARRAY (pspec)) {
+        write_array (writer, pspec, g_value_get_boxed (value));
+    } else if ((boxed_size = plain_boxed_size (type))) {
+        write_uint (writer, VALUE_BOXED);
+        write_uint (writer, boxed_size);
+        write_align (writer, 8);
+        write_data (writer, g_value_get_boxed (value), boxed_size);
+        write_align (writer, 4);
+    } else if (is_string_transformable (type)) {
+        GValue string_value = { 0, };
+
+        g_value_init (&string_value, G_TYPE_STRING);
+        g_value_transform (value, &string_value);
+        write_uint (writer, VALUE_FROM_STRING);
+        write_string (writer, g_value_get_string (&string_value));
+        g_value_unset (&string_value);
+    } else {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+should_save_property (GParamSpec   *pspec,
+                      const GValue *value)
+{
+    /* style has already been expanded into the other properties */
+    if (strcmp (pspec->name, "style") == 0)
+        return FALSE;
+
+    /* boxed and object values are NULL when they have not been set */
+    if ((G_TYPE_FUNDAMENTAL (pspec->value_type) == G_TYPE_BOXED ||
+         G_TYPE_FUNDAMENTAL (pspec->value_type) == G_TYPE_OBJECT) &&
+        g_value_peek_pointer (value) == NULL)
+    {
+        return FALSE;
+    }
+
+    return !g_param_value_defaults (pspec, (GValue *) value);
+}
+
+static void
+write_properties (Writer        *writer,
+                  DaxDomElement *element)
+{
+    GParamSpec **pspecs;
+    guint n_pspecs, n_props_offset, n_props = 0, i;
+
+    n_props_offset = writer->nodes->len;
+    write_uint (writer, 0);
+
+    pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (element),
+                                             &n_pspecs);
+    for (i = 0; i < n_pspecs; i++) {
+        GParamSpec *pspec = pspecs[i];
+        GValue value = { 0, };
+        guint start = writer->nodes->len;
+
+        if (!(pspec->flags & G_PARAM_READABLE) ||
+            !(pspec->flags & G_PARAM_WRITABLE) ||
+            pspec->flags & G_PARAM_CONSTRUCT_ONLY)
+        {
+            continue;
+        }
+
+        /* "base" reads as the resolved IRI, save xml:base as it was set so
+         * that relative IRIs stay relative to the file */
+        if (pspec->owner_type == DAX_TYPE_DOM_ELEMENT &&
+            strcmp (pspec->name, "base") == 0)
+        {
+            const gchar *xml_base = _dax_dom_element_get_xml_base (element);
+
+            if (xml_base) {
+                write_string (writer, pspec->name);
+                write_uint (writer, VALUE_STRING);
+                write_string (writer, xml_base);
+                n_props++;
+            }
+            continue;
+        }
+
+        g_value_init (&value, pspec->value_type);
+        g_object_get_property (G_OBJECT (element), pspec->name, &value);
+
+        if (should_save_property (pspec, &value)) {
+            write_string (writer, pspec->name);
+            if (write_value (writer, pspec, &value)) {
+                n_props++;
+            } else {
+                DAX_NOTE (LOADING, "can't save %s of type %s",
+                          pspec->name, g_type_name (pspec->value_type));
+                g_byte_array_set_size (writer->nodes, start);
+            }
+        }
+
+        g_value_unset (&value);
+    }
+    g_free (pspecs);
+
+    memcpy (writer->nodes->data + n_props_offset, &n_props, sizeof (n_props));
+}
+
+static void
+write_node (Writer     *writer,
+            DaxDomNode *node)
+{
+    DaxDomNode *child;
+
+    if (DAX_IS_DOM_TEXT (node)) {
+        DaxDomCharacterData *text = DAX_DOM_CHARACTER_DATA (node);
+
+        write_uint (writer, NODE_TEXT);
+        write_string (writer, dax_dom_character_data_get_data (text));
+        return;
+    }
+
+    if (!DAX_IS_DOM_ELEMENT (node))
+        return;
+
+    write_uint (writer, NODE_ELEMENT);
+    write_string (writer, G_OBJECT_TYPE_NAME (node));
+    write_properties (writer, DAX_DOM_ELEMENT (node));
+
+    for (child = node->first_child; child; child = child->next_sibling)
+        write_node (writer, child);
+
+    write_uint (writer, NODE_END);
+}
+
+static void
+write_namespaces (Writer         *writer,
+                  DaxDomDocument *document)
+{
+    const GPtrArray *namespaces;
+    guint i;
+
+    /* xml and xmlns are always there */
+    namespaces = _dax_dom_document_get_namespaces (document);
+    write_uint (writer, namespaces->len - 2);
+    for (i = 2; i < namespaces->len; i++) {
+        DaxXmlNamespace *ns = g_ptr_array_index (namespaces, i);
+
+        write_string (writer, ns->uri);
+        write_string (writer, ns->prefix);
+    }
+}
+
+/**
+ * dax_dom_document_save_binary:
+ * @document: a #DaxDomDocument
+ * @filename: the file to write
+ * @error: return location for a #GError, or %NULL
+ *
+ * Saves @document to @filename in a form that can be loaded back much faster
+ * than the SVG it comes from, without any XML parsing. Relative IRIs stay
+ * relative: they will be resolved against the directory of @filename.
+ *
+ * The file can only be loaded by the same version of Dax, on a machine with
+ * the same byte order.
+ *
+ * Return value: %TRUE if the file could be written
+ */
+gboolean
+dax_dom_document_save_binary (DaxDomDocument  *document,
+                              const gchar     *filename,
+                              GError         **error)
+{
+    static const guint8 zeros[8] = { 0, };
+    Writer writer;
+    GByteArray *file;
+    DaxDomNode *child;
+    Header header;
+    guint32 offset;
+    gboolean success;
+    guint i;
+
+    g_return_val_if_fail (DAX_IS_DOM_DOCUMENT (document), FALSE);
+    g_return_val_if_fail (filename != NULL, FALSE);
+
+    writer.nodes = g_byte_array_new ();
+    writer.string_ids = g_hash_table_new (g_str_hash, g_str_equal);
+    writer.strings = g_ptr_array_new_with_free_func (g_free);
+
+    write_namespaces (&writer, document);
+    for (child = DAX_DOM_NODE (document)->first_child;
+         child;
+         child = child->next_sibling)
+    {
+        write_node (&writer, child);
+    }
+    write_uint (&writer, NODE_END);
+
+    /* the header and the offsets of the strings */
+    memset (&header, 0, sizeof (header));
+    memcpy (header.magic, BINARY_MAGIC, 4);
+    header.version = BINARY_VERSION;
+    header.byte_order = BINARY_BYTE_ORDER;
+    g_strlcpy (header.package_version, PACKAGE_VERSION,
+               sizeof (header.package_version));
+    get_type_sizes (header.type_sizes);
+    header.n_strings = writer.strings->len;
+    header.strings_offset = sizeof (Header);
+
+    file = g_byte_array_new ();
+    g_byte_array_append (file, (guint8 *) &header, sizeof (header));
+
+    offset = 0;
+    for (i = 0; i < writer.strings->len; i++) {
+        g_byte_array_append (file, (guint8 *) &offset, sizeof (offset));
+        offset += strlen (g_ptr_array_index (writer.strings, i)) + 1;
+    }
+    for (i = 0; i < writer.strings->len; i++) {
+        const gchar *string = g_ptr_array_index (writer.strings, i);
+
+        g_byte_array_append (file, (guint8 *) string, strlen (string) + 1);
+    }
+
+    /* the node stream has 8 bytes aligned values */
+    g_byte_array_append (file, zeros, (8 - file->len % 8) % 8);
+    header.nodes_offset = file->len;
+    g_byte_array_append (file, writer.nodes->data, writer.nodes->len);
+    header.file_size = file->len;
+    memcpy (file->data, &header, sizeof (header));
+
+    DAX_NOTE (LOADING, "saving %s: %u strings, %u bytes of nodes",
+              filename, writer.strings->len, writer.nodes->len);
+
+    success = g_file_set_contents (filename, (gchar *) file->data, file->len,
+                                   error);
+
+    g_byte_array_free (file, TRUE);
+    g_byte_array_free (writer.nodes, TRUE);
+    g_hash_table_destroy (writer.string_ids);
+    g_ptr_array_free (writer.strings, TRUE);
+
+    return success;
+}
+
+/*
+ * Loading
+ */
+
+typedef struct
+{
+    const guint8 *data;         /* the whole file */
+    gsize pos, end;             /* in the node stream */
+    const guint32 *string_offsets;
+    const gchar *strings;
+    guint n_strings;
+    DaxDomDocument *document;
+    DaxArena *arena;            /* of the document, holds the mapping */
+    gboolean defer_setup;       /* see _dax_dom_document_finish_setup() */
+    GError **error;
+} Reader;
+
+static gboolean
+corrupted (Reader      *reader,
+           const gchar *what)
+{
+    if (reader->error && *reader->error == NULL)
+        g_set_error (reader->error, DAX_BINARY_ERROR,
+                     DAX_BINARY_ERROR_INVALID,
+                     "Corrupted precompiled document: %s", what);
+
+    return FALSE;
+}
+
+static gboolean
+read_data (Reader         *reader,
+           gsize           size,
+           guint           alignment,
+           gconstpointer  *data)
+{
+    gsize pos = reader->pos;
+
+    pos += (alignment - pos % alignment) % alignment;
+    if (pos > reader->end || size > reader->end - pos)
+        return corrupted (reader, "unexpected end of file");
+
+    *data = reader->data + pos;
+    reader->pos = pos + size;
+
+    return TRUE;
+}
+
+static gboolean
+read_uint (Reader  *reader,
+           guint32 *value)
+{
+    gconstpointer data;
+
+    if (!read_data (reader, sizeof (guint32), 4, &data))
+        return FALSE;
+
+    *value = *(const guint32 *) data;
+
+    return TRUE;
+}
+
+static gboolean
+read_string (Reader       *reader,
+             const gchar **string)
+{
+    guint32 id;
+
+    if (!read_uint (reader, &id))
+        return FALSE;
+
+    if (id == NO_STRING) {
+        *string = NULL;
+        return TRUE;
+    }
+
+    if (id >= reader->n_strings)
+        return corrupted (reader, "invalid string");
+
+    *string = reader->strings + reader->string_offsets[id];
+
+    return TRUE;
+}
+
+static gboolean
+read_units (Reader       *reader,
+            ClutterUnits *units)
+{
+    gconstpointer data;
+    guint32 unit_type;
+    gfloat value;
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE + 2];
+
+    if (!read_uint (reader, &unit_type) ||
+        !read_data (reader, sizeof (gfloat), 4, &data))
+    {
+        return FALSE;
+    }
+    value = *(const gfloat *) data;
+
+    switch (unit_type) {
+    case CLUTTER_UNIT_MM:
+        clutter_units_from_mm (units, value);
+        break;
+    case CLUTTER_UNIT_POINT:
+        clutter_units_from_pt (units, value);
+        break;
+    case CLUTTER_UNIT_EM:
+        clutter_units_from_em (units, value);
+        break;
+    case CLUTTER_UNIT_CM:
+        clutter_units_from_cm (units, value);
+        break;
+    case CLUTTER_UNIT_PIXEL:
+        /* clutter_units_from_pixels() only takes integers */
+        g_ascii_formatd (buffer, G_ASCII_DTOSTR_BUF_SIZE, "%.6f", value);
+        strcat (buffer, "px");
+        if (!clutter_units_from_string (units, buffer))
+            return corrupted (reader, "invalid unit");
+        break;
+    default:
+        return corrupted (reader, "invalid unit");
+    }
+
+    return TRUE;
+}
+
+static gboolean
+read_array (Reader     *reader,
+            guint       kind,
+            GParamSpec *pspec,
+            GValue     *value)
+{
+    DaxParamSpecArray *array_spec;
+    GArray *array;
+    guint32 len, i;
+
+    if (!DAX_IS_PARAM_SPEC_ARRAY (pspec))
+        return corrupted (reader, "unexpected array");
+    array_spec = DAX_PARAM_SPEC_ARRAY (pspec);
+
+    if (!read_uint (reader, &len))
+        return FALSE;
+
+    if (kind == VALUE_FLOAT_ARRAY) {
+        gconstpointer data;
+
+        if (array_spec->element_type != G_TYPE_FLOAT ||
+            len > G_MAXUINT32 / sizeof (gfloat) ||
+            !read_data (reader, len * sizeof (gfloat), 4, &data))
+        {
+            return corrupted (reader, "invalid array");
+        }
+
+        array = g_array_sized_new (FALSE, FALSE, sizeof (gfloat), len);
+        g_array_append_vals (array, data, len);
+    } else {
+        if (array_spec->element_type != CLUTTER_TYPE_UNITS ||
+            len > (reader->end - reader->pos) / 8)
+        {
+            return corrupted (reader, "invalid array");
+        }
+
+        array = g_array_sized_new (FALSE, FALSE, sizeof (ClutterUnits), len);
+        g_array_set_size (array, len);
+        for (i = 0; i < len; i++) {
+            if (!read_units (reader, &g_array_index (array, ClutterUnits, i)))
+            {
+                g_array_unref (array);
+                return FALSE;
+            }
+        }
+    }
+
+    g_value_take_boxed (value, array);
+
+    return TRUE;
+}
+
+/* the arrays of paths and knot sequences are used in place */
+static gboolean
+read_path (Reader *reader,
+           GValue *value)
+{
+    gconstpointer coords, verbs;
+    guint32 n_verbs, n_coords;
+    DaxPath *path;
+
+    if (!read_uint (reader, &n_verbs) ||
+        !read_uint (reader, &n_coords) ||
+        n_coords > G_MAXUINT32 / sizeof (gfloat) ||
+        !read_data (reader, n_coords * sizeof (gfloat), 4, &coords) ||
+        !read_data (reader, n_verbs, 1, &verbs))
+    {
+        return FALSE;
+    }
+
+    path = _dax_path_new_from_static_arrays (verbs, n_verbs, coords, n_coords,
+                                             reader->arena);
+    if (path == NULL)
+        return corrupted (reader, "invalid path");
+
+    g_value_take_object (value, path);
+
+    return TRUE;
+}
+
+static gboolean
+read_knot_sequence (Reader *reader,
+                    GValue *value)
+{
+    gconstpointer knots;
+    guint32 n_knots;
+
+    if (!read_uint (reader, &n_knots) ||
+        n_knots > G_MAXUINT32 / (2 * sizeof (gfloat)) ||
+        !read_data (reader, n_knots * 2 * sizeof (gfloat), 4, &knots))
+    {
+        return FALSE;
+    }
+
+    g_value_take_object (value,
+        _dax_knot_sequence_new_from_static_array_in_arena (knots, n_knots,
+                                                           reader->arena));
+
+    return TRUE;
+}
+
+/* FALSE if int_value is not one of the values of an enum or flags type */
+static gboolean
+set_int_value (GValue *value,
+               gint64  int_value)
+{
+    GEnumClass *enum_class;
+    GFlagsClass *flags_class;
+
+    switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value))) {
+    case G_TYPE_BOOLEAN:
+        g_value_set_boolean (value, int_value != 0);
+        break;
+    case G_TYPE_INT:
+        g_value_set_int (value, int_value);
+        break;
+    case G_TYPE_UINT:
+        g_value_set_uint (value, int_value);
+        break;
+    case G_TYPE_LONG:
+        g_value_set_long (value, int_value);
+        break;
+    case G_TYPE_ULONG:
+        g_value_set_ulong (value, int_value);
+        break;
+    case G_TYPE_INT64:
+        g_value_set_int64 (value, int_value);
+        break;
+    case G_TYPE_UINT64:
+        g_value_set_uint64 (value, int_value);
+        break;
+    case G_TYPE_ENUM:
+        enum_class = g_type_class_peek (G_VALUE_TYPE (value));
+        if (int_value < G_MININT || int_value > G_MAXINT ||
+            g_enum_get_value (enum_class, int_value) == NULL)
+        {
+            return FALSE;
+        }
+        g_value_set_enum (value, int_value);
+        break;
+    case G_TYPE_FLAGS:
+        flags_class = g_type_class_peek (G_VALUE_TYPE (value));
+        if (int_value < 0 || int_value > G_MAXUINT ||
+            (int_value & ~(gint64) flags_class->mask))
+        {
+            return FALSE;
+        }
+        g_value_set_flags (value, int_value);
+        break;
+    default:
+        g_assert_not_reached ();
+    }
+
+    return TRUE;
+}
+
+/* the structures read as raw bytes hold enums and counts the rest of the
+ * library trusts */
+static gboolean
+is_valid_boxed (GType         type,
+                gconstpointer data)
+{
+    if (type == DAX_TYPE_MATRIX) {
+        const DaxMatrix *matrix = data;
+        guint i;
+
+        if (matrix->n_elementary_matrices > DAX_MATRIX_MAX_ELEMENTARY)
+            return FALSE;
+
+        for (i = 0; i < matrix->n_elementary_matrices; i++)
+            if ((guint) matrix->elementary_matrices[i].type >
+                DAX_MATRIX_TYPE_SKEW_Y)
+            {
+                return FALSE;
+            }
+    } else if (type == DAX_TYPE_DURATION) {
+        const DaxDuration *duration = data;
+
+        if ((guint) duration->unit_type > DAX_DURATION_MS)
+            return FALSE;
+    } else if (type == DAX_TYPE_PRESERVE_ASPECT_RATIO) {
+        const DaxPreserveAspectRatio *ar = data;
+
+        if ((guint) ar->align > DAX_PRESERVE_ASPECT_RATIO_ALIGN_X_MAX_Y_MAX ||
+            (ar->flags & ~(DAX_PRESERVE_ASPECT_RATIO_FLAG_DEFER |
+                           DAX_PRESERVE_ASPECT_RATIO_FLAG_MEET)))
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static gboolean
+read_value (Reader     *reader,
+            GParamSpec *pspec,
+            GValue     *value)
+{
+    GType type = pspec->value_type;
+    gconstpointer data;
+    const gchar *string;
+    guint32 kind, size;
+    ClutterUnits units;
+
+    if (!read_uint (reader, &kind))
+        return FALSE;
+
+    switch (kind) {
+    case VALUE_INT:
+        if (!is_int_type (type))
+            break;
+        if (!read_data (reader, sizeof (gint64), 8, &data))
+            return FALSE;
+        if (!set_int_value (value, *(const gint64 *) data))
+            break;
+        return TRUE;
+
+    case VALUE_DOUBLE:
+        if (type != G_TYPE_FLOAT && type != G_TYPE_DOUBLE)
+            break;
+        if (!read_data (reader, sizeof (gdouble), 8, &data))
+            return FALSE;
+        if (type == G_TYPE_FLOAT)
+            g_value_set_float (value, *(const gdouble *) data);
+        else
+            g_value_set_double (value, *(const gdouble *) data);
+        return TRUE;
+
+    case VALUE_STRING:
+        if (type != G_TYPE_STRING)
+            break;
+        if (!read_string (reader, &string))
+            return FALSE;
+        g_value_set_static_string (value, string);
+        return TRUE;
+
+    case VALUE_UNITS:
+        if (type != CLUTTER_TYPE_UNITS)
+            break;
+        if (!read_units (reader, &units))
+            return FALSE;
+        g_value_set_boxed (value, &units);
+        return TRUE;
+
+    case VALUE_BOXED:
+        if (!read_uint (reader, &size))
+            return FALSE;
+        if (size == 0 || size != plain_boxed_size (type))
+            break;
+        if (!read_data (reader, size, 8, &data))
+            return FALSE;
+        if (!is_valid_boxed (type, data))
+            break;
+        g_value_set_boxed (value, data);
+        return TRUE;
+
+    case VALUE_FLOAT_ARRAY:
+    case VALUE_UNITS_ARRAY:
+        return read_array (reader, kind, pspec, value);
+
+    case VALUE_PATH:
+        if (type != DAX_TYPE_PATH)
+            break;
+        return read_path (reader, value);
+
+    case VALUE_KNOTS:
+        if (type != DAX_TYPE_KNOT_SEQUENCE)
+            break;
+        return read_knot_sequence (reader, value);
+
+    case VALUE_FROM_STRING:
+    {
+        GValue string_value = { 0, };
+        gboolean success;
+
+        if (!read_string (reader, &string))
+            return FALSE;
+
+        g_value_init (&string_value, G_TYPE_STRING);
+        g_value_set_static_string (&string_value, string);
+        success = g_value_transform (&string_value, value);
+        g_value_unset (&string_value);
+
+        if (!success)
+            break;
+        return TRUE;
+    }
+
+    default:
+        break;
+    }
+
+    return corrupted (reader, "invalid property value");
+}
+
+static gboolean
+read_properties (Reader        *reader,
+                 DaxDomElement *element)
+{
+    GObjectClass *object_class = G_OBJECT_GET_CLASS (element);
+    guint32 n_props, i;
+
+    if (!read_uint (reader, &n_props))
+        return FALSE;
+
+    for (i = 0; i < n_props; i++) {
+        GObjectClass *owner_class;
+        const gchar *name;
+        GParamSpec *pspec;
+        GValue value = { 0, };
+
+        if (!read_string (reader, &name))
+            return FALSE;
+
+        pspec = name ? g_object_class_find_property (object_class, name) : NULL;
+        if (pspec == NULL ||
+            !(pspec->flags & G_PARAM_WRITABLE) ||
+            pspec->flags & G_PARAM_CONSTRUCT_ONLY)
+        {
+            return corrupted (reader, "invalid property");
+        }
+
+        owner_class = g_type_class_peek (pspec->owner_type);
+        if (owner_class == NULL || owner_class->set_property == NULL)
+            return corrupted (reader, "invalid property");
+
+        g_value_init (&value, pspec->value_type);
+        if (!read_value (reader, pspec, &value)) {
+            g_value_unset (&value);
+            return FALSE;
+        }
+
+        /* like the attribute setters of DaxElement, no notification is
+         * needed while loading */
+        owner_class->set_property (G_OBJECT (element), pspec->param_id,
+                                   &value, pspec);
+        g_value_unset (&value);
+    }
+
+    return TRUE;
+}
+
+static gboolean read_children (Reader     *reader,
+                               DaxDomNode *parent,
+                               guint       depth);
+
+static gboolean
+read_element (Reader     *reader,
+              DaxDomNode *parent,
+              guint       depth)
+{
+    DaxDomDocument *document = reader->document;
+    DaxDomElement *element;
+    const gchar *type_name;
+    gboolean success;
+    GType type;
+
+    if (depth > MAX_DEPTH)
+        return corrupted (reader, "too many nested elements");
+
+    if (!read_string (reader, &type_name))
+        return FALSE;
+    if (type_name == NULL)
+        return corrupted (reader, "invalid element");
+
+    type = g_type_from_name (type_name);
+    if (type == G_TYPE_INVALID ||
+        !g_type_is_a (type, DAX_TYPE_DOM_ELEMENT) ||
+        G_TYPE_IS_ABSTRACT (type))
+    {
+        g_set_error (reader->error, DAX_BINARY_ERROR,
+                     DAX_BINARY_ERROR_UNKNOWN_ELEMENT,
+                     "Unknown element type %s", type_name);
+        return FALSE;
+    }
+
+    element = g_object_newv (type, 0, NULL);
+    DAX_DOM_NODE (element)->owner_document = document;
+    dax_dom_node_append_child (parent, DAX_DOM_NODE (element), NULL);
+
+    _dax_dom_document_begin_parsing (document);
+    success = read_properties (reader, element);
+    _dax_dom_document_end_parsing (document);
+
+    if (!success || !read_children (reader, DAX_DOM_NODE (element), depth + 1))
+        return FALSE;
+
+    if (!reader->defer_setup) {
+        _dax_js_udom_setup_element (dax_dom_document_get_js_context (document),
+                                    element);
+        _dax_dom_element_signal_parsed (element);
+    }
+
+    return TRUE;
+}
+
+static gboolean
+read_text (Reader     *reader,
+           DaxDomNode *parent)
+{
+    const gchar *data;
+    DaxDomText *text;
+
+    if (!read_string (reader, &data))
+        return FALSE;
+    if (data == NULL)
+        return corrupted (reader, "invalid text");
+
+    text = dax_dom_text_new ();
+    _dax_dom_character_data_set_static_data (DAX_DOM_CHARACTER_DATA (text),
+                                             data, reader->arena);
+    DAX_DOM_NODE (text)->owner_document = reader->document;
+    dax_dom_node_append_child (parent, DAX_DOM_NODE (text), NULL);
+
+    return TRUE;
+}
+
+static gboolean
+read_children (Reader     *reader,
+               DaxDomNode *parent,
+               guint       depth)
+{
+    guint32 kind;
+
+    for (;;) {
+        if (!read_uint (reader, &kind))
+            return FALSE;
+
+        switch (kind) {
+        case NODE_END:
+            return TRUE;
+        case NODE_ELEMENT:
+            if (!read_element (reader, parent, depth))
+                return FALSE;
+            break;
+        case NODE_TEXT:
+            if (!read_text (reader, parent))
+                return FALSE;
+            break;
+        default:
+            return corrupted (reader, "invalid node");
+        }
+    }
+}
+
+static gboolean
+read_namespaces (Reader *reader)
+{
+    guint32 n_namespaces, i;
+
+    if (!read_uint (reader, &n_namespaces))
+        return FALSE;
+
+    for (i = 0; i < n_namespaces; i++) {
+        const gchar *uri, *prefix;
+
+        if (!read_string (reader, &uri) || !read_string (reader, &prefix))
+            return FALSE;
+
+        _dax_dom_document_add_namespace (reader->document, uri, prefix);
+    }
+
+    return TRUE;
+}
+
+static gboolean
+read_header (Reader *reader,
+             gsize   length)
+{
+    const Header *header = (const Header *) reader->data;
+    gchar package_version[sizeof (header->package_version)];
+    guint16 type_sizes[G_N_ELEMENTS (header->type_sizes)];
+    gsize strings_size;
+    guint32 i;
+
+    if (length < sizeof (Header) || memcmp (header->magic, BINARY_MAGIC, 4))
+        return corrupted (reader, "not a precompiled document");
+
+    memset (package_version, 0, sizeof (package_version));
+    g_strlcpy (package_version, PACKAGE_VERSION, sizeof (package_version));
+    get_type_sizes (type_sizes);
+
+    if (header->byte_order != BINARY_BYTE_ORDER ||
+        header->version != BINARY_VERSION ||
+        memcmp (header->package_version, package_version,
+                sizeof (package_version)) ||
+        memcmp (header->type_sizes, type_sizes, sizeof (type_sizes)))
+    {
+        g_set_error (reader->error, DAX_BINARY_ERROR,
+                     DAX_BINARY_ERROR_VERSION,
+                     "Precompiled document of an unsupported version");
+        return FALSE;
+    }
+
+    if (header->file_size != length ||
+        header->strings_offset != sizeof (Header) ||
+        header->nodes_offset % 8 ||
+        header->nodes_offset > length ||
+        header->n_strings > (header->nodes_offset - sizeof (Header)) / 4)
+    {
+        return corrupted (reader, "invalid header");
+    }
+
+    /* every string has to be terminated before the node stream */
+    reader->string_offsets = (const guint32 *) (reader->data + sizeof (Header));
+    reader->strings = (const gchar *) (reader->string_offsets +
+                                       header->n_strings);
+    reader->n_strings = header->n_strings;
+    strings_size = header->nodes_offset - sizeof (Header) -
+                   header->n_strings * 4;
+    for (i = 0; i < header->n_strings; i++) {
+        if (reader->string_offsets[i] >= strings_size)
+            return corrupted (reader, "invalid string table");
+    }
+    if (header->n_strings && reader->data[header->nodes_offset - 1] != '\0')
+        return corrupted (reader, "invalid string table");
+
+    reader->pos = header->nodes_offset;
+    reader->end = length;
+
+    return TRUE;
+}
+
+gboolean
+_dax_binary_has_magic (const gchar *contents,
+                       gsize        length)
+{
+    return length >= sizeof (Header) &&
+           memcmp (contents, BINARY_MAGIC, 4) == 0;
+}
+
+DaxDomDocument *
+_dax_binary_load_mapped_file (GMappedFile  *mapped_file,
+                              const gchar  *base_iri,
+                              gboolean      defer_setup,
+                              GError      **error)
+{
+    DaxDomDocument *document;
+    Reader reader;
+
+    memset (&reader, 0, sizeof (reader));
+    reader.data = (const guint8 *) g_mapped_file_get_contents (mapped_file);
+    reader.defer_setup = defer_setup;
+    reader.error = error;
+
+    if (!read_header (&reader, g_mapped_file_get_length (mapped_file)))
+        return NULL;
+
+    /* make sure the element types are registered */
+    dax_document_lookup_element ("svg");
+
+    document = dax_document_new ();
+    dax_dom_document_set_base_iri (document, base_iri);
+    if (!defer_setup)
+        _dax_dom_document_setup_js (document);
+
+    /* text nodes and arrays point into the mapping, it lives as long as the
+     * arena of the document they keep a reference on */
+    reader.arena = _dax_dom_document_get_arena (document);
+    _dax_arena_attach (reader.arena, g_mapped_file_ref (mapped_file),
+                       (GDestroyNotify) g_mapped_file_unref);
+    reader.document = document;
+
+    if (!read_namespaces (&reader) ||
+        !read_children (&reader, DAX_DOM_NODE (document), 0))
+    {
+        g_object_unref (document);
+        return NULL;
+    }
+
+    if (reader.pos != reader.end) {
+        corrupted (&reader, "trailing data");
+        g_object_unref (document);
+        return NULL;
+    }
+
+    return document;
+}
+
+/**
+ * dax_dom_document_new_from_binary:
+ * @filename: a file written by dax_dom_document_save_binary()
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads a precompiled document. The file is memory mapped for as long as the
+ * document, or the paths, knot sequences and text nodes taken from it, live.
+ * dax_dom_document_new_from_file() recognizes precompiled documents too.
+ *
+ * Return value: the new document, or %NULL if @filename could not be loaded
+ */
+DaxDomDocument *
+dax_dom_document_new_from_binary (const gchar  *filename,
+                                  GError      **error)
+{
+    DaxDomDocument *document;
+    GMappedFile *mapped_file;
+    GFile *file, *directory;
+    gchar *base_uri;
+
+    g_return_val_if_fail (filename != NULL, NULL);
+
+    mapped_file = g_mapped_file_new (filename, FALSE, error);
+    if (mapped_file == NULL)
+        return NULL;
+
+    file = g_file_new_for_commandline_arg (filename);
+    directory = g_file_get_parent (file);
+    base_uri = g_file_get_uri (directory);
+    g_object_unref (file);
+    g_object_unref (directory);
+
+    document = _dax_binary_load_mapped_file (mapped_file, base_uri, FALSE,
+                                             error);
+
+    g_free (base_uri);
+    g_mapped_file_unref (mapped_file);
+
+    return document;
+}
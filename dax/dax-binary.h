@@ -0,0 +1,62 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__DAX_H_INSIDE__) && !defined(DAX_COMPILATION)
+#error "Only <dax/dax.h> can be included directly."
+#endif
+
+#ifndef __DAX_BINARY_H__
+#define __DAX_BINARY_H__
+
+#include <glib.h>
+
+#include "dax-dom-document.h"
+
+G_BEGIN_DECLS
+
+#define DAX_BINARY_ERROR (dax_binary_error_quark ())
+
+/**
+ * DaxBinaryError:
+ * @DAX_BINARY_ERROR_INVALID: the file is not a precompiled document or is
+ *   corrupted
+ * @DAX_BINARY_ERROR_VERSION: the file was written by an incompatible version
+ *   of Dax, or on a machine with a different byte order
+ * @DAX_BINARY_ERROR_UNKNOWN_ELEMENT: the file uses an element type that is
+ *   not registered
+ *
+ * Errors of dax_dom_document_new_from_binary().
+ */
+typedef enum /*< skip >*/
+{
+    DAX_BINARY_ERROR_INVALID,
+    DAX_BINARY_ERROR_VERSION,
+    DAX_BINARY_ERROR_UNKNOWN_ELEMENT
+} DaxBinaryError;
+
+GQuark          dax_binary_error_quark              (void);
+
+gboolean        dax_dom_document_save_binary        (DaxDomDocument  *document,
+                                                     const gchar     *filename,
+                                                     GError         **error);
+DaxDomDocument *dax_dom_document_new_from_binary    (const gchar     *filename,
+                                                     GError         **error);
+
+G_END_DECLS
+
+#endif /* __DAX_BINARY_H__ */
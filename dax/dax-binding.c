@@ -0,0 +1,181 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <clutter/clutter.h>
+
+#include "dax-binding.h"
+
+struct _DaxBinding
+{
+    GObject *element;               /* owns the binding */
+    GObject *target;                /* weak pointer */
+    const DaxBindingProperty *properties;
+    DaxBindingUpdateFunc update;
+
+    guint changes;                  /* not applied yet */
+    gboolean queued;
+};
+
+static GQuark quark_binding;
+
+/* bindings with changes, applied before the next frame */
+static GPtrArray *pending;
+static GPtrArray *flushing;
+static guint repaint_id;
+
+static void
+dax_binding_free (gpointer data)
+{
+    DaxBinding *binding = data;
+    guint i;
+
+    if (binding->target)
+        g_object_remove_weak_pointer (binding->target,
+                                      (gpointer *) &binding->target);
+
+    if (binding->queued && !g_ptr_array_remove_fast (pending, binding) &&
+        flushing)
+    {
+        for (i = 0; i < flushing->len; i++)
+            if (g_ptr_array_index (flushing, i) == binding)
+                g_ptr_array_index (flushing, i) = NULL;
+    }
+
+    g_slice_free (DaxBinding, binding);
+}
+
+static gboolean
+on_repaint (gpointer data)
+{
+    repaint_id = 0;
+    _dax_binding_flush ();
+
+    return FALSE;
+}
+
+static void
+dax_binding_queue (DaxBinding *binding)
+{
+    if (pending == NULL)
+        pending = g_ptr_array_new ();
+
+    binding->queued = TRUE;
+    g_ptr_array_add (pending, binding);
+
+    if (repaint_id == 0)
+        repaint_id = clutter_threads_add_repaint_func (on_repaint, NULL, NULL);
+
+    /* make sure there is a next frame */
+    if (CLUTTER_IS_ACTOR (binding->target))
+        clutter_actor_queue_redraw (CLUTTER_ACTOR (binding->target));
+}
+
+/*
+ * The element can only be bound to one target at a time, binding it again
+ * replaces the previous binding. The binding goes away with the element or
+ * when the target is finalized.
+ */
+DaxBinding *
+_dax_binding_new (GObject                  *element,
+                  GObject                  *target,
+                  const DaxBindingProperty *properties,
+                  DaxBindingUpdateFunc      update)
+{
+    DaxBinding *binding;
+
+    if (G_UNLIKELY (quark_binding == 0))
+        quark_binding = g_quark_from_static_string ("dax-binding");
+
+    binding = g_slice_new0 (DaxBinding);
+    binding->element = element;
+    binding->target = target;
+    binding->properties = properties;
+    binding->update = update;
+
+    g_object_add_weak_pointer (target, (gpointer *) &binding->target);
+    g_object_set_qdata_full (element, quark_binding, binding,
+                             dax_binding_free);
+
+    return binding;
+}
+
+/* To be called when the properties of an element change, instead of
+ * emitting notify */
+void
+_dax_binding_properties_changed (GObject     *element,
+                                 guint        n_pspecs,
+                                 GParamSpec **pspecs)
+{
+    const DaxBindingProperty *property;
+    DaxBinding *binding;
+    guint i, changes = 0;
+
+    if (quark_binding == 0)
+        return;
+
+    binding = g_object_get_qdata (element, quark_binding);
+    if (binding == NULL || binding->target == NULL)
+        return;
+
+    for (i = 0; i < n_pspecs; i++)
+        for (property = binding->properties; property->name; property++)
+            if (strcmp (pspecs[i]->name, property->name) == 0)
+                changes |= property->change;
+
+    if (changes == 0)
+        return;
+
+    binding->changes |= changes;
+    if (!binding->queued)
+        dax_binding_queue (binding);
+}
+
+/* Applies the pending changes now, each binding is updated once whatever
+ * the number of attributes that changed since the last time */
+void
+_dax_binding_flush (void)
+{
+    guint i;
+
+    if (pending == NULL || pending->len == 0 || flushing)
+        return;
+
+    /* updates could change the attributes of other elements, those are
+     * applied on the next frame */
+    flushing = pending;
+    pending = g_ptr_array_new ();
+
+    for (i = 0; i < flushing->len; i++) {
+        DaxBinding *binding = g_ptr_array_index (flushing, i);
+        guint changes;
+
+        if (binding == NULL)
+            continue;
+
+        changes = binding->changes;
+        binding->changes = 0;
+        binding->queued = FALSE;
+        if (binding->target)
+            binding->update (binding->element, binding->target, changes);
+    }
+
+    g_ptr_array_free (flushing, TRUE);
+    flushing = NULL;
+}
@@ -0,0 +1,59 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DAX_BINDING_H__
+#define __DAX_BINDING_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Binds the attributes of an element to the object displaying it, usually a
+ * ClutterActor. Instead of a notify handler per attribute, the changes are
+ * accumulated on the binding and applied all at once, right before the next
+ * frame is painted.
+ */
+
+typedef struct _DaxBinding DaxBinding;
+
+/* a property of the element and the bit it sets in the changes given to
+ * the update function. Arrays of those end with a NULL name */
+typedef struct
+{
+    const gchar *name;
+    guint change;
+} DaxBindingProperty;
+
+typedef void (*DaxBindingUpdateFunc) (GObject *element,
+                                      GObject *target,
+                                      guint    changes);
+
+DaxBinding *    _dax_binding_new                (GObject                  *element,
+                                                 GObject                  *target,
+                                                 const DaxBindingProperty *properties,
+                                                 DaxBindingUpdateFunc      update);
+
+void            _dax_binding_properties_changed (GObject     *element,
+                                                 guint        n_pspecs,
+                                                 GParamSpec **pspecs);
+void            _dax_binding_flush              (void);
+
+G_END_DECLS
+
+#endif /* __DAX_BINDING_H__ */
@@ -16,9 +16,12 @@
  * along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include <gio/gio.h>
 
 #include "dax-cache.h"
+#include "dax-debug.h"
 #include "dax-internals.h"
 #include "dax-utils.h"
 
@@ -38,7 +41,9 @@ enum
     PROP_CACHE,
     PROP_URI,
     PROP_LOCAL_URI,
-    PROP_READY
+    PROP_READY,
+    PROP_SIZE,
+    PROP_PIXBUF
 };
 
 struct _DaxCacheEntryPrivate
@@ -46,9 +51,39 @@ struct _DaxCacheEntryPrivate
     DaxCache *cache;        /* back pointer to the cache ths entry belongs to */
     gchar *uri;
     gchar *local_uri;
+    GByteArray *data;       /* in-memory content, eg. from a data: uri */
     gboolean ready;
+    gboolean failed;
+
+    const gchar *key;       /* key in the cache hash table, owned by cache */
+    gsize size;             /* memory accounted for this entry */
+
+    GdkPixbuf *pixbuf;      /* decoded image */
+    guint decode_pending : 1;   /* decode once ready */
+    guint decoding : 1;
+    guint decoded : 1;
 };
 
+static gsize
+entry_size (DaxCacheEntry *entry)
+{
+    DaxCacheEntryPrivate *priv = entry->priv;
+    gsize size;
+
+    size = sizeof (DaxCacheEntry) + sizeof (DaxCacheEntryPrivate);
+    if (priv->uri)
+        size += strlen (priv->uri) + 1;
+    if (priv->local_uri && priv->local_uri != priv->uri)
+        size += strlen (priv->local_uri) + 1;
+    if (priv->data)
+        size += priv->data->len;
+    if (priv->pixbuf)
+        size += gdk_pixbuf_get_rowstride (priv->pixbuf) *
+                gdk_pixbuf_get_height (priv->pixbuf);
+
+    return size;
+}
+
 static void
 invalidate_local_uri (DaxCacheEntry *entry)
 {
@@ -59,6 +94,51 @@ invalidate_local_uri (DaxCacheEntry *entry)
         g_free (priv->local_uri);
 
     priv->local_uri = NULL;
+
+    if (priv->data) {
+        g_byte_array_unref (priv->data);
+        priv->data = NULL;
+    }
+}
+
+static void
+invalidate_pixbuf (DaxCacheEntry *entry)
+{
+    DaxCacheEntryPrivate *priv = entry->priv;
+
+    if (priv->pixbuf) {
+        g_object_unref (priv->pixbuf);
+        priv->pixbuf = NULL;
+    }
+
+    /* a job still running for the previous uri will be discarded */
+    priv->decode_pending = priv->decoding = priv->decoded = FALSE;
+}
+
+static void
+start_decoding (DaxCacheEntry *entry)
+{
+    DaxCacheEntryPrivate *priv = entry->priv;
+    DaxCache *cache;
+
+    priv->decode_pending = FALSE;
+    priv->decoding = TRUE;
+
+    cache = priv->cache ? priv->cache : dax_cache_get_default ();
+    _dax_cache_decode_image (cache, entry);
+}
+
+static void
+set_ready (DaxCacheEntry *entry)
+{
+    DaxCacheEntryPrivate *priv = entry->priv;
+
+    priv->ready = TRUE;
+    _dax_cache_entry_set_size (entry, entry_size (entry));
+    g_object_notify ((GObject *) entry, "ready");
+
+    if (priv->decode_pending)
+        start_decoding (entry);
 }
 
 static void
@@ -68,17 +148,39 @@ dax_cache_entry_set_uri_internal (DaxCacheEntry *entry,
     DaxCacheEntryPrivate *priv = entry->priv;
 
     invalidate_local_uri (entry);
+    invalidate_pixbuf (entry);
+    priv->ready = priv->failed = FALSE;
     g_free (priv->uri);
     priv->uri = g_strdup (uri);
 
-    if (g_str_has_prefix (uri, "file://")) {
-        priv->ready = TRUE;
-        priv->local_uri = priv->uri;
-        g_object_notify ((GObject *) entry, "ready");
-    } else {
-        /* FIXME http:// uris could be useful */
-        g_message (G_STRLOC ": Unsupported uri %s", uri);
+    _dax_cache_entry_set_size (entry, entry_size (entry));
+}
+
+static void
+start_fetching (DaxCacheEntry *entry)
+{
+    DaxCacheEntryPrivate *priv = entry->priv;
+    const DaxCacheFetcher *fetcher;
+    DaxCache *cache;
+
+    if (priv->uri == NULL)
+        return;
+
+    cache = priv->cache ? priv->cache : dax_cache_get_default ();
+    fetcher = _dax_cache_lookup_fetcher (cache, priv->uri);
+    if (fetcher == NULL) {
+        GError *error = NULL;
+
+        g_set_error (&error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                     "Unsupported uri");
+        dax_cache_entry_set_failed (entry, error);
+        g_error_free (error);
+        return;
     }
+
+    DAX_NOTE (LOADING, "fetching %.64s with the %s fetcher",
+              priv->uri, fetcher->name);
+    fetcher->fetch (fetcher, entry, priv->uri);
 }
 
 /*
@@ -108,6 +210,12 @@ dax_cache_entry_get_property (GObject    *object,
     case PROP_READY:
         g_value_set_boolean (value, priv->ready);
         break;
+    case PROP_SIZE:
+        g_value_set_ulong (value, priv->size);
+        break;
+    case PROP_PIXBUF:
+        g_value_set_object (value, priv->pixbuf);
+        break;
 
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -121,11 +229,18 @@ dax_cache_entry_set_property (GObject      *object,
                               GParamSpec   *pspec)
 {
     DaxCacheEntry *entry = (DaxCacheEntry *) object;
+    DaxCacheEntryPrivate *priv = entry->priv;
 
     switch (property_id)
     {
     case PROP_CACHE:
-        /* read only */
+        /* construct only, the cache owns its entries so we don't take a
+         * reference back. Entries can outlive their cache when someone
+         * else holds them, the pointer is cleared when the cache goes */
+        priv->cache = g_value_get_object (value);
+        if (priv->cache)
+            g_object_add_weak_pointer (G_OBJECT (priv->cache),
+                                       (gpointer *) &priv->cache);
         break;
     case PROP_URI:
         dax_cache_entry_set_uri_internal (entry, g_value_get_string (value));
@@ -142,9 +257,25 @@ dax_cache_entry_set_property (GObject      *object,
     }
 }
 
+static void
+dax_cache_entry_constructed (GObject *object)
+{
+    /* the cache is known by now, it has the fetchers to use */
+    start_fetching ((DaxCacheEntry *) object);
+}
+
 static void
 dax_cache_entry_dispose (GObject *object)
 {
+    DaxCacheEntry *entry = (DaxCacheEntry *) object;
+    DaxCacheEntryPrivate *priv = entry->priv;
+
+    if (priv->cache) {
+        g_object_remove_weak_pointer (G_OBJECT (priv->cache),
+                                      (gpointer *) &priv->cache);
+        priv->cache = NULL;
+    }
+
     G_OBJECT_CLASS (dax_cache_entry_parent_class)->dispose (object);
 }
 
@@ -155,6 +286,7 @@ dax_cache_entry_finalize (GObject *object)
     DaxCacheEntryPrivate *priv = entry->priv;
 
     invalidate_local_uri (entry);
+    invalidate_pixbuf (entry);
     g_free (priv->uri);
 
     G_OBJECT_CLASS (dax_cache_entry_parent_class)->finalize (object);
@@ -170,6 +302,7 @@ dax_cache_entry_class_init (DaxCacheEntryClass *klass)
 
     object_class->get_property = dax_cache_entry_get_property;
     object_class->set_property = dax_cache_entry_set_property;
+    object_class->constructed = dax_cache_entry_constructed;
     object_class->dispose = dax_cache_entry_dispose;
     object_class->finalize = dax_cache_entry_finalize;
 
@@ -200,6 +333,20 @@ dax_cache_entry_class_init (DaxCacheEntryClass *klass)
                                   FALSE,
                                   DAX_GPARAM_READABLE);
     g_object_class_install_property (object_class, PROP_READY, pspec);
+
+    pspec = g_param_spec_ulong ("size",
+                                "Size",
+                                "Memory, in bytes, used by this entry",
+                                0, G_MAXULONG, 0,
+                                DAX_GPARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_SIZE, pspec);
+
+    pspec = g_param_spec_object ("pixbuf",
+                                 "Pixbuf",
+                                 "The decoded image",
+                                 GDK_TYPE_PIXBUF,
+                                 DAX_GPARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_PIXBUF, pspec);
 }
 
 static void
@@ -238,13 +385,17 @@ dax_cache_entry_get_uri (DaxCacheEntry *entry)
     return entry->priv->uri;
 }
 
+/* the entries a cache holds are looked up by their URI, only the ones
+ * evicted or outliving their cache can be pointed somewhere else */
 void
 dax_cache_entry_set_uri (DaxCacheEntry *entry,
                          const gchar   *uri)
 {
     g_return_if_fail (DAX_IS_CACHE_ENTRY (entry));
+    g_return_if_fail (entry->priv->key == NULL);
 
     dax_cache_entry_set_uri_internal (entry, uri);
+    start_fetching (entry);
 
     g_object_notify ((GObject *) entry, "uri");
 }
@@ -267,6 +418,9 @@ dax_cache_entry_get_local_path (const DaxCacheEntry *entry)
     g_return_val_if_fail (DAX_IS_CACHE_ENTRY (entry), NULL);
     priv = entry->priv;
 
+    if (priv->local_uri == NULL)
+        return NULL;
+
     file = g_file_new_for_uri (priv->local_uri);
     path = g_file_get_path (file);
     g_object_unref (file);
@@ -281,3 +435,255 @@ dax_cache_entry_is_ready (DaxCacheEntry *entry)
 
     return entry->priv->ready;
 }
+
+/**
+ * dax_cache_entry_get_data:
+ * @entry: a #DaxCacheEntry
+ *
+ * Returns the content of @entry when it's kept in memory rather than in a
+ * local file (see dax_cache_entry_get_local_uri()).
+ *
+ * Return value: the content of @entry, owned by @entry, or %NULL
+ */
+GByteArray *
+dax_cache_entry_get_data (DaxCacheEntry *entry)
+{
+    g_return_val_if_fail (DAX_IS_CACHE_ENTRY (entry), NULL);
+
+    return entry->priv->data;
+}
+
+gboolean
+dax_cache_entry_has_failed (DaxCacheEntry *entry)
+{
+    g_return_val_if_fail (DAX_IS_CACHE_ENTRY (entry), FALSE);
+
+    return entry->priv->failed;
+}
+
+/*
+ * To be used by the fetchers
+ */
+
+/**
+ * dax_cache_entry_set_local_uri:
+ * @entry: a #DaxCacheEntry
+ * @local_uri: file:// URI of the fetched content
+ *
+ * Called by a #DaxCacheFetcher once the content of @entry is available in a
+ * local file. @entry becomes ready.
+ */
+void
+dax_cache_entry_set_local_uri (DaxCacheEntry *entry,
+                               const gchar   *local_uri)
+{
+    DaxCacheEntryPrivate *priv;
+
+    g_return_if_fail (DAX_IS_CACHE_ENTRY (entry));
+    g_return_if_fail (local_uri);
+
+    priv = entry->priv;
+    invalidate_local_uri (entry);
+
+    /* no need to duplicate the uri of file:// entries */
+    if (priv->uri && strcmp (local_uri, priv->uri) == 0)
+        priv->local_uri = priv->uri;
+    else
+        priv->local_uri = g_strdup (local_uri);
+
+    g_object_notify ((GObject *) entry, "local-uri");
+    set_ready (entry);
+}
+
+/**
+ * dax_cache_entry_set_data:
+ * @entry: a #DaxCacheEntry
+ * @data: the fetched content
+ *
+ * Called by a #DaxCacheFetcher once the content of @entry is available in
+ * memory. @entry takes a reference on @data and becomes ready.
+ */
+void
+dax_cache_entry_set_data (DaxCacheEntry *entry,
+                          GByteArray    *data)
+{
+    g_return_if_fail (DAX_IS_CACHE_ENTRY (entry));
+    g_return_if_fail (data);
+
+    invalidate_local_uri (entry);
+    entry->priv->data = g_byte_array_ref (data);
+
+    set_ready (entry);
+}
+
+/**
+ * dax_cache_entry_set_failed:
+ * @entry: a #DaxCacheEntry
+ * @error: why the content could not be fetched
+ *
+ * Called by a #DaxCacheFetcher when the content of @entry cannot be
+ * retrieved. Users waiting for the image to be decoded are notified with a
+ * %NULL #DaxCacheEntry:pixbuf.
+ */
+void
+dax_cache_entry_set_failed (DaxCacheEntry *entry,
+                            const GError  *error)
+{
+    DaxCacheEntryPrivate *priv;
+
+    g_return_if_fail (DAX_IS_CACHE_ENTRY (entry));
+
+    priv = entry->priv;
+    priv->failed = TRUE;
+
+    g_message (G_STRLOC ": could not fetch %.64s: %s", priv->uri,
+               error ? error->message : "unknown error");
+
+    if (priv->decode_pending) {
+        priv->decode_pending = FALSE;
+        _dax_cache_entry_set_pixbuf (entry, NULL);
+    }
+}
+
+gsize
+dax_cache_entry_get_size (DaxCacheEntry *entry)
+{
+    g_return_val_if_fail (DAX_IS_CACHE_ENTRY (entry), 0);
+
+    return entry->priv->size;
+}
+
+void
+_dax_cache_entry_set_size (DaxCacheEntry *entry,
+                           gsize          size)
+{
+    DaxCacheEntryPrivate *priv = entry->priv;
+    gsize old_size = priv->size;
+
+    if (old_size == size)
+        return;
+
+    priv->size = size;
+
+    /* only tell the cache once the entry is part of it */
+    if (priv->cache && priv->key)
+        _dax_cache_entry_size_changed (priv->cache, entry, old_size, size);
+
+    g_object_notify ((GObject *) entry, "size");
+}
+
+/**
+ * dax_cache_entry_decode_image:
+ * @entry: a #DaxCacheEntry
+ *
+ * Asks for the image @entry points to to be decoded. Decoding happens in the
+ * background once the entry is ready, #DaxCacheEntry:pixbuf is notified when
+ * it is done (the pixbuf being %NULL if the image could not be decoded).
+ * Decoded images are shared by all the users of the entry.
+ */
+void
+dax_cache_entry_decode_image (DaxCacheEntry *entry)
+{
+    DaxCacheEntryPrivate *priv;
+
+    g_return_if_fail (DAX_IS_CACHE_ENTRY (entry));
+
+    priv = entry->priv;
+    if (priv->decoded || priv->decoding)
+        return;
+
+    if (priv->failed)
+        _dax_cache_entry_set_pixbuf (entry, NULL);
+    else if (priv->ready)
+        start_decoding (entry);
+    else
+        priv->decode_pending = TRUE;
+}
+
+/**
+ * dax_cache_entry_decode_image_sync:
+ * @entry: a #DaxCacheEntry
+ * @error: return location for a #GError, or %NULL
+ *
+ * Decodes the image @entry points to in the calling thread if it has not
+ * been decoded yet.
+ *
+ * Return value: the decoded image, owned by @entry, or %NULL if the entry
+ * is not ready or the image could not be decoded
+ */
+GdkPixbuf *
+dax_cache_entry_decode_image_sync (DaxCacheEntry  *entry,
+                                   GError        **error)
+{
+    DaxCacheEntryPrivate *priv;
+    GdkPixbuf *pixbuf;
+    gchar *path;
+
+    g_return_val_if_fail (DAX_IS_CACHE_ENTRY (entry), NULL);
+
+    priv = entry->priv;
+    if (priv->decoded || !priv->ready)
+        return priv->pixbuf;
+
+    path = dax_cache_entry_get_local_path (entry);
+    pixbuf = _dax_cache_load_pixbuf (path, priv->data, error);
+    g_free (path);
+
+    _dax_cache_entry_set_pixbuf (entry, pixbuf);
+    if (pixbuf)
+        g_object_unref (pixbuf);
+
+    return priv->pixbuf;
+}
+
+gboolean
+dax_cache_entry_is_decoded (DaxCacheEntry *entry)
+{
+    g_return_val_if_fail (DAX_IS_CACHE_ENTRY (entry), FALSE);
+
+    return entry->priv->decoded;
+}
+
+GdkPixbuf *
+dax_cache_entry_get_pixbuf (DaxCacheEntry *entry)
+{
+    g_return_val_if_fail (DAX_IS_CACHE_ENTRY (entry), NULL);
+
+    return entry->priv->pixbuf;
+}
+
+/* Called in the main thread once the image has been decoded, pixbuf is NULL
+ * when decoding failed */
+void
+_dax_cache_entry_set_pixbuf (DaxCacheEntry *entry,
+                             GdkPixbuf     *pixbuf)
+{
+    DaxCacheEntryPrivate *priv = entry->priv;
+
+    /* decoded synchronously while the job was running */
+    if (priv->decoded)
+        return;
+
+    priv->decoding = FALSE;
+    priv->decoded = TRUE;
+    if (pixbuf)
+        priv->pixbuf = g_object_ref (pixbuf);
+
+    DAX_NOTE (LOADING, "%s decoded", priv->uri);
+
+    _dax_cache_entry_set_size (entry, entry_size (entry));
+    g_object_notify ((GObject *) entry, "pixbuf");
+}
+
+const gchar *
+_dax_cache_entry_get_key (DaxCacheEntry *entry)
+{
+    return entry->priv->key;
+}
+
+void
+_dax_cache_entry_set_key (DaxCacheEntry *entry,
+                          const gchar   *key)
+{
+    entry->priv->key = key;
+}
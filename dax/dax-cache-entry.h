@@ -20,6 +20,7 @@
 #define __DAX_CACHE_ENTRY_H__
 
 #include <glib-object.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
 
 #include "dax-dom-forward.h"
 
@@ -72,6 +73,31 @@ void                dax_cache_entry_set_uri         (DaxCacheEntry *entry,
 const gchar *       dax_cache_entry_get_local_uri   (DaxCacheEntry *entry);
 gchar *             dax_cache_entry_get_local_path  (const DaxCacheEntry *entry);
 gboolean            dax_cache_entry_is_ready        (DaxCacheEntry *entry);
+GByteArray *        dax_cache_entry_get_data        (DaxCacheEntry *entry);
+gboolean            dax_cache_entry_has_failed      (DaxCacheEntry *entry);
+
+void                dax_cache_entry_set_local_uri   (DaxCacheEntry *entry,
+                                                     const gchar   *local_uri);
+void                dax_cache_entry_set_data        (DaxCacheEntry *entry,
+                                                     GByteArray    *data);
+void                dax_cache_entry_set_failed      (DaxCacheEntry *entry,
+                                                     const GError  *error);
+gsize               dax_cache_entry_get_size        (DaxCacheEntry *entry);
+
+void                dax_cache_entry_decode_image    (DaxCacheEntry *entry);
+GdkPixbuf *         dax_cache_entry_decode_image_sync
+                                                    (DaxCacheEntry  *entry,
+                                                     GError        **error);
+gboolean            dax_cache_entry_is_decoded      (DaxCacheEntry *entry);
+GdkPixbuf *         dax_cache_entry_get_pixbuf      (DaxCacheEntry *entry);
+
+void                _dax_cache_entry_set_size       (DaxCacheEntry *entry,
+                                                     gsize          size);
+void                _dax_cache_entry_set_pixbuf     (DaxCacheEntry *entry,
+                                                     GdkPixbuf     *pixbuf);
+const gchar *       _dax_cache_entry_get_key        (DaxCacheEntry *entry);
+void                _dax_cache_entry_set_key        (DaxCacheEntry *entry,
+                                                     const gchar   *key);
 
 G_END_DECLS
 
@@ -0,0 +1,381 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#include "dax-cache.h"
+#include "dax-debug.h"
+
+#include "dax-cache-fetcher.h"
+
+/*
+ * data: URIs (RFC 2397), decoded in memory
+ */
+
+static gboolean
+data_can_fetch (const DaxCacheFetcher *fetcher,
+                const gchar           *uri)
+{
+    return g_ascii_strncasecmp (uri, "data:", 5) == 0;
+}
+
+/* %XX escapes can encode any byte, NUL included, so the length of the
+ * decoded data is kept along with it */
+static GByteArray *
+unescape_data (const gchar *escaped)
+{
+    GByteArray *data;
+    const gchar *p;
+
+    data = g_byte_array_sized_new (strlen (escaped));
+    for (p = escaped; *p; p++) {
+        guint8 c = *p;
+
+        if (c == '%') {
+            gint high, low;
+
+            high = g_ascii_xdigit_value (p[1]);
+            low = high < 0 ? -1 : g_ascii_xdigit_value (p[2]);
+            if (low < 0) {
+                g_byte_array_unref (data);
+                return NULL;
+            }
+
+            c = high << 4 | low;
+            p += 2;
+        }
+
+        g_byte_array_append (data, &c, 1);
+    }
+
+    return data;
+}
+
+static void
+data_fetch (const DaxCacheFetcher *fetcher,
+            DaxCacheEntry         *entry,
+            const gchar           *uri)
+{
+    const gchar *comma;
+    GByteArray *data;
+    gsize len;
+
+    /* data:[<mediatype>][;base64],<data> */
+    comma = strchr (uri + 5, ',');
+    data = comma ? unescape_data (comma + 1) : NULL;
+    if (data == NULL) {
+        GError *error = NULL;
+
+        g_set_error (&error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                     "Malformed data: URI");
+        dax_cache_entry_set_failed (entry, error);
+        g_error_free (error);
+        return;
+    }
+
+    /* ";base64" can only be the last parameter */
+    if (comma - (uri + 5) >= 7 &&
+        g_ascii_strncasecmp (comma - 7, ";base64", 7) == 0)
+    {
+        guint8 nul = '\0';
+
+        g_byte_array_append (data, &nul, 1);
+        g_base64_decode_inplace ((gchar *) data->data, &len);
+        g_byte_array_set_size (data, len);
+    }
+
+    dax_cache_entry_set_data (entry, data);
+    g_byte_array_unref (data);
+}
+
+const DaxCacheFetcher dax_cache_fetcher_data =
+{
+    "data",
+    data_can_fetch,
+    data_fetch
+};
+
+/*
+ * file: URIs, used in place
+ */
+
+static gboolean
+file_can_fetch (const DaxCacheFetcher *fetcher,
+                const gchar           *uri)
+{
+    return g_ascii_strncasecmp (uri, "file:", 5) == 0;
+}
+
+static void
+file_fetch (const DaxCacheFetcher *fetcher,
+            DaxCacheEntry         *entry,
+            const gchar           *uri)
+{
+    dax_cache_entry_set_local_uri (entry, uri);
+}
+
+const DaxCacheFetcher dax_cache_fetcher_file =
+{
+    "file",
+    file_can_fetch,
+    file_fetch
+};
+
+/*
+ * Everything GIO can read. The content is stored in an on-disk cache, named
+ * after the hash of the content so a resource found at several URIs is only
+ * stored once. An index maps the URIs to the content, to skip the I/O the
+ * next time the same URI is needed.
+ *
+ *   <directory>/objects/<sha1 of the content>
+ *   <directory>/uris/<sha1 of the uri>         contains the content sha1
+ */
+
+typedef struct
+{
+    DaxCacheEntry *entry;
+    gchar *uri;             /* uri of the entry when the fetch started */
+    gchar *directory;
+} GioFetch;
+
+static gchar *
+get_index_path (const gchar *directory,
+                const gchar *uri)
+{
+    gchar *hash, *path;
+
+    hash = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+    path = g_build_filename (directory, "uris", hash, NULL);
+    g_free (hash);
+
+    return path;
+}
+
+static gchar *
+lookup_content (const gchar *directory,
+                const gchar *uri)
+{
+    gchar *index_path, *hash, *object_path, *local_uri = NULL;
+
+    index_path = get_index_path (directory, uri);
+
+    if (g_file_get_contents (index_path, &hash, NULL, NULL)) {
+        g_strstrip (hash);
+
+        object_path = g_build_filename (directory, "objects", hash, NULL);
+        if (g_file_test (object_path, G_FILE_TEST_IS_REGULAR))
+            local_uri = g_filename_to_uri (object_path, NULL, NULL);
+
+        g_free (object_path);
+        g_free (hash);
+    }
+
+    g_free (index_path);
+
+    return local_uri;
+}
+
+static gboolean
+make_directory (const gchar  *directory,
+                const gchar  *name,
+                GError      **error)
+{
+    gchar *path;
+    gboolean ret = TRUE;
+
+    path = g_build_filename (directory, name, NULL);
+    if (g_mkdir_with_parents (path, 0700) < 0) {
+        gint errsv = errno;
+
+        g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+                     "Could not create %s: %s", path, g_strerror (errsv));
+        ret = FALSE;
+    }
+    g_free (path);
+
+    return ret;
+}
+
+static gchar *
+store_content (const gchar  *directory,
+               const gchar  *uri,
+               const gchar  *content,
+               gsize         len,
+               GError      **error)
+{
+    gchar *hash, *object_path, *index_path, *local_uri = NULL;
+
+    if (!make_directory (directory, "objects", error) ||
+        !make_directory (directory, "uris", error))
+    {
+        return NULL;
+    }
+
+    hash = g_compute_checksum_for_data (G_CHECKSUM_SHA1,
+                                        (const guchar *) content,
+                                        len);
+    object_path = g_build_filename (directory, "objects", hash, NULL);
+    index_path = get_index_path (directory, uri);
+
+    if ((g_file_test (object_path, G_FILE_TEST_IS_REGULAR) ||
+         g_file_set_contents (object_path, content, len, error)) &&
+        g_file_set_contents (index_path, hash, -1, error))
+    {
+        local_uri = g_filename_to_uri (object_path, NULL, error);
+    }
+
+    g_free (index_path);
+    g_free (object_path);
+    g_free (hash);
+
+    return local_uri;
+}
+
+static void
+gio_fetch_free (GioFetch *fetch)
+{
+    g_object_unref (fetch->entry);
+    g_free (fetch->uri);
+    g_free (fetch->directory);
+    g_slice_free (GioFetch, fetch);
+}
+
+static void
+deliver_content (GioFetch    *fetch,
+                 const gchar *content,
+                 gsize        len)
+{
+    GByteArray *data;
+    gchar *local_uri;
+    GError *error = NULL;
+
+    local_uri = store_content (fetch->directory, fetch->uri, content, len,
+                               &error);
+    if (local_uri) {
+        dax_cache_entry_set_local_uri (fetch->entry, local_uri);
+        g_free (local_uri);
+        return;
+    }
+
+    /* no on-disk cache, keep the content in memory */
+    g_message (G_STRLOC ": could not cache %s: %s", fetch->uri,
+               error->message);
+    g_error_free (error);
+
+    data = g_byte_array_sized_new (len);
+    g_byte_array_append (data, (const guint8 *) content, len);
+    dax_cache_entry_set_data (fetch->entry, data);
+    g_byte_array_unref (data);
+}
+
+static void
+on_contents_loaded (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+    GioFetch *fetch = user_data;
+    gchar *content = NULL;
+    GError *error = NULL;
+    gsize len;
+
+    g_file_load_contents_finish (G_FILE (source), result, &content, &len,
+                                 NULL, &error);
+
+    /* the entry may have been pointed to another resource meanwhile */
+    if (g_strcmp0 (fetch->uri, dax_cache_entry_get_uri (fetch->entry)) == 0) {
+        if (content)
+            deliver_content (fetch, content, len);
+        else
+            dax_cache_entry_set_failed (fetch->entry, error);
+    }
+
+    g_clear_error (&error);
+    g_free (content);
+    gio_fetch_free (fetch);
+}
+
+static gboolean
+gio_can_fetch (const DaxCacheFetcher *fetcher,
+               const gchar           *uri)
+{
+    const gchar * const *schemes;
+    gchar *scheme;
+    gboolean ret = FALSE;
+    guint i;
+
+    scheme = g_uri_parse_scheme (uri);
+    if (scheme == NULL)
+        return FALSE;
+
+    schemes = g_vfs_get_supported_uri_schemes (g_vfs_get_default ());
+    for (i = 0; schemes && schemes[i]; i++) {
+        if (g_ascii_strcasecmp (schemes[i], scheme) == 0) {
+            ret = TRUE;
+            break;
+        }
+    }
+    g_free (scheme);
+
+    return ret;
+}
+
+static void
+gio_fetch (const DaxCacheFetcher *fetcher,
+           DaxCacheEntry         *entry,
+           const gchar           *uri)
+{
+    DaxCache *cache;
+    GioFetch *fetch;
+    const gchar *directory;
+    gchar *local_uri;
+    GFile *file;
+
+    cache = dax_cache_entry_get_cache (entry);
+    if (cache == NULL)
+        cache = dax_cache_get_default ();
+    directory = dax_cache_get_directory (cache);
+
+    /* the entry is indexed by its own uri, @uri is where to get it from */
+    local_uri = lookup_content (directory, dax_cache_entry_get_uri (entry));
+    if (local_uri) {
+        DAX_NOTE (LOADING, "%s found in %s", uri, directory);
+        dax_cache_entry_set_local_uri (entry, local_uri);
+        g_free (local_uri);
+        return;
+    }
+
+    fetch = g_slice_new (GioFetch);
+    fetch->entry = g_object_ref (entry);
+    fetch->uri = g_strdup (dax_cache_entry_get_uri (entry));
+    fetch->directory = g_strdup (directory);
+
+    file = g_file_new_for_uri (uri);
+    g_file_load_contents_async (file, NULL, on_contents_loaded, fetch);
+    g_object_unref (file);
+}
+
+const DaxCacheFetcher dax_cache_fetcher_gio =
+{
+    "gio",
+    gio_can_fetch,
+    gio_fetch
+};
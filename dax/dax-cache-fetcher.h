@@ -0,0 +1,59 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DAX_CACHE_FETCHER_H__
+#define __DAX_CACHE_FETCHER_H__
+
+#include <glib.h>
+
+#include "dax-dom-forward.h"
+
+G_BEGIN_DECLS
+
+typedef struct _DaxCacheFetcher DaxCacheFetcher;
+
+/**
+ * DaxCacheFetcher:
+ * @name: name of the fetcher, for debugging purposes
+ * @can_fetch: returns %TRUE if the fetcher knows how to retrieve @uri
+ * @fetch: starts retrieving @uri for @entry. Once done, the content is
+ *   handed to the entry with dax_cache_entry_set_local_uri() or
+ *   dax_cache_entry_set_data(), or dax_cache_entry_set_failed() is called.
+ *
+ * Fetchers retrieve the content of the #DaxCacheEntry<!-- -->s. A #DaxCache
+ * comes with fetchers for data:, file: and the URIs GIO knows about, more can
+ * be added with dax_cache_add_fetcher().
+ */
+struct _DaxCacheFetcher
+{
+    const gchar *name;
+
+    gboolean    (*can_fetch)    (const DaxCacheFetcher *fetcher,
+                                 const gchar           *uri);
+    void        (*fetch)        (const DaxCacheFetcher *fetcher,
+                                 DaxCacheEntry         *entry,
+                                 const gchar           *uri);
+};
+
+extern const DaxCacheFetcher dax_cache_fetcher_data;
+extern const DaxCacheFetcher dax_cache_fetcher_file;
+extern const DaxCacheFetcher dax_cache_fetcher_gio;
+
+G_END_DECLS
+
+#endif /* __DAX_CACHE_FETCHER_H__ */
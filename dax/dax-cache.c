@@ -16,8 +16,13 @@
  * along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include <gio/gio.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
 
+#include "dax-debug.h"
+#include "dax-internals.h"
 #include "dax-utils.h"
 #include "dax-dom-element.h"
 
@@ -28,11 +33,260 @@ G_DEFINE_TYPE (DaxCache, dax_cache, G_TYPE_OBJECT)
 #define CACHE_PRIVATE(o) \
         (G_TYPE_INSTANCE_GET_PRIVATE ((o), DAX_TYPE_CACHE, DaxCachePrivate))
 
+#define DEFAULT_MAX_SIZE            (32 * 1024 * 1024)
+#define DEFAULT_DECODING_THREADS    2
+
+enum
+{
+    PROP_0,
+
+    PROP_MAX_SIZE,
+    PROP_SIZE,
+    PROP_DECODING_THREADS,
+    PROP_DIRECTORY
+};
+
 struct _DaxCachePrivate
 {
-    GHashTable *entries;    /* "uri" -> DaxCacheEntry map */
+    GHashTable *entries;    /* normalized uri -> GList link in lru */
+    GQueue *lru;            /* DaxCacheEntry, most recently used first */
+
+    gsize size;
+    gsize max_size;
+
+    guint hits;
+    guint misses;
+    guint evictions;
+
+    GThreadPool *decoders;  /* created on the first decoding request */
+    guint decoding_threads;
+
+    GSList *fetchers;       /* const DaxCacheFetcher, tried in order */
+    gchar *directory;       /* on-disk cache of fetched content */
 };
 
+/* An image to decode. Jobs are created in the main thread, run in one of the
+ * decoding threads and handed back to the main thread with an idle */
+typedef struct
+{
+    DaxCacheEntry *entry;
+    gchar *uri;             /* uri of the entry when the job was queued */
+    gchar *path;
+    GByteArray *data;       /* in-memory content, path is NULL then */
+    GdkPixbuf *pixbuf;
+    GError *error;
+} DecodeJob;
+
+/*
+ * Private helpers
+ */
+
+/* lower case the scheme and the authority of an URI and strip the fragment
+ * identifier, so different spellings of the same resource share the same
+ * entry */
+static gchar *
+normalize_uri (const gchar *uri)
+{
+    gchar *normalized, *p, *fragment;
+
+    /* data: URIs are opaque, don't touch them */
+    if (g_ascii_strncasecmp (uri, "data:", 5) == 0)
+        return g_strdup (uri);
+
+    if (g_ascii_strncasecmp (uri, "file:", 5) == 0) {
+        GFile *file;
+
+        file = g_file_new_for_uri (uri);
+        normalized = g_file_get_uri (file);
+        g_object_unref (file);
+
+        return normalized;
+    }
+
+    normalized = g_strdup (uri);
+
+    fragment = strchr (normalized, '#');
+    if (fragment)
+        *fragment = '\0';
+
+    for (p = normalized; *p && *p != ':'; p++)
+        *p = g_ascii_tolower (*p);
+
+    if (p[0] == ':' && p[1] == '/' && p[2] == '/') {
+        for (p += 3; *p && *p != '/'; p++)
+            *p = g_ascii_tolower (*p);
+    }
+
+    return normalized;
+}
+
+static gchar *
+resolve_href (DaxDomElement *element,
+              const gchar   *href)
+{
+    const gchar *base_iri;
+    GFile *base_file, *resolved_file;
+    gchar *resolved_iri;
+
+    if (_dax_utils_is_iri (href))
+        return g_strdup (href);
+
+    base_iri = dax_dom_element_get_base_iri (element);
+    base_file = g_file_new_for_uri (base_iri);
+
+    resolved_file = g_file_resolve_relative_path (base_file, href);
+    resolved_iri = g_file_get_uri (resolved_file);
+
+    g_object_unref (base_file);
+    g_object_unref (resolved_file);
+
+    return resolved_iri;
+}
+
+static gboolean
+entry_is_used (DaxCacheEntry *entry)
+{
+    /* the cache holds one reference */
+    return G_OBJECT (entry)->ref_count > 1;
+}
+
+static void
+remove_link (DaxCache *cache,
+             GList    *link)
+{
+    DaxCachePrivate *priv = cache->priv;
+    DaxCacheEntry *entry = link->data;
+    const gchar *key;
+
+    priv->size -= dax_cache_entry_get_size (entry);
+
+    /* the key is freed with the hash table node */
+    key = _dax_cache_entry_get_key (entry);
+    _dax_cache_entry_set_key (entry, NULL);
+    g_hash_table_remove (priv->entries, key);
+    g_queue_delete_link (priv->lru, link);
+
+    g_object_unref (entry);
+}
+
+/* Drop the least recently used entries that are not referenced by anyone
+ * else until the cache fits in max_size */
+static void
+evict (DaxCache *cache)
+{
+    DaxCachePrivate *priv = cache->priv;
+    GList *link, *prev;
+
+    for (link = priv->lru->tail;
+         link && priv->size > priv->max_size;
+         link = prev)
+    {
+        DaxCacheEntry *entry = link->data;
+
+        prev = link->prev;
+
+        if (entry_is_used (entry))
+            continue;
+
+        DAX_NOTE (LOADING, "evicting %s (%" G_GSIZE_FORMAT " bytes)",
+                  dax_cache_entry_get_uri (entry),
+                  dax_cache_entry_get_size (entry));
+
+        remove_link (cache, link);
+        priv->evictions++;
+    }
+}
+
+static void
+decode_job_free (DecodeJob *job)
+{
+    g_object_unref (job->entry);
+    g_free (job->uri);
+    g_free (job->path);
+    if (job->data)
+        g_byte_array_unref (job->data);
+    if (job->pixbuf)
+        g_object_unref (job->pixbuf);
+    if (job->error)
+        g_error_free (job->error);
+    g_slice_free (DecodeJob, job);
+}
+
+static void
+decode_job_run (DecodeJob *job)
+{
+    job->pixbuf = _dax_cache_load_pixbuf (job->path, job->data, &job->error);
+}
+
+static gboolean
+decode_job_finish (gpointer data)
+{
+    DecodeJob *job = data;
+
+    /* the entry may have been pointed to another resource meanwhile */
+    if (g_strcmp0 (job->uri, dax_cache_entry_get_uri (job->entry)) == 0) {
+        if (job->error)
+            g_warning (G_STRLOC ": could not decode %s: %s",
+                       job->uri, job->error->message);
+        _dax_cache_entry_set_pixbuf (job->entry, job->pixbuf);
+    }
+
+    decode_job_free (job);
+
+    return FALSE;
+}
+
+static void
+decoder_thread (gpointer data,
+                gpointer user_data)
+{
+    DecodeJob *job = data;
+
+    decode_job_run (job);
+    g_idle_add (decode_job_finish, job);
+}
+
+static DaxCacheEntry *
+lookup_or_create (DaxCache    *cache,
+                  const gchar *uri)
+{
+    DaxCachePrivate *priv = cache->priv;
+    DaxCacheEntry *entry;
+    GList *link;
+    gchar *key;
+
+    key = normalize_uri (uri);
+
+    link = g_hash_table_lookup (priv->entries, key);
+    if (link) {
+        priv->hits++;
+
+        /* move the entry to the front of the LRU list */
+        g_queue_unlink (priv->lru, link);
+        g_queue_push_head_link (priv->lru, link);
+
+        g_free (key);
+        return g_object_ref (link->data);
+    }
+
+    priv->misses++;
+
+    entry = _dax_cache_entry_new (cache, key);
+    g_queue_push_head (priv->lru, entry);
+
+    /* the hash table owns key, the entry only borrows it */
+    _dax_cache_entry_set_key (entry, key);
+    g_hash_table_insert (priv->entries, key, priv->lru->head);
+
+    priv->size += dax_cache_entry_get_size (entry);
+
+    /* take the caller's reference before evicting so the new entry stays */
+    g_object_ref (entry);
+    evict (cache);
+
+    return entry;
+}
+
 /*
  * GObject implementation
  */
@@ -43,8 +297,23 @@ dax_cache_get_property (GObject    *object,
                         GValue     *value,
                         GParamSpec *pspec)
 {
+    DaxCache *cache = (DaxCache *) object;
+    DaxCachePrivate *priv = cache->priv;
+
     switch (property_id)
     {
+    case PROP_MAX_SIZE:
+        g_value_set_ulong (value, priv->max_size);
+        break;
+    case PROP_SIZE:
+        g_value_set_ulong (value, priv->size);
+        break;
+    case PROP_DECODING_THREADS:
+        g_value_set_uint (value, priv->decoding_threads);
+        break;
+    case PROP_DIRECTORY:
+        g_value_set_string (value, priv->directory);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -56,8 +325,19 @@ dax_cache_set_property (GObject      *object,
                         const GValue *value,
                         GParamSpec   *pspec)
 {
+    DaxCache *cache = (DaxCache *) object;
+
     switch (property_id)
     {
+    case PROP_MAX_SIZE:
+        dax_cache_set_max_size (cache, g_value_get_ulong (value));
+        break;
+    case PROP_DECODING_THREADS:
+        dax_cache_set_decoding_threads (cache, g_value_get_uint (value));
+        break;
+    case PROP_DIRECTORY:
+        dax_cache_set_directory (cache, g_value_get_string (value));
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -66,6 +346,19 @@ dax_cache_set_property (GObject      *object,
 static void
 dax_cache_dispose (GObject *object)
 {
+    DaxCache *cache = (DaxCache *) object;
+    DaxCachePrivate *priv = cache->priv;
+
+    /* let the running jobs finish, their results are delivered to entries
+     * that are not part of the cache anymore */
+    if (priv->decoders) {
+        g_thread_pool_free (priv->decoders, FALSE, TRUE);
+        priv->decoders = NULL;
+    }
+
+    while (priv->lru->head)
+        remove_link (cache, priv->lru->head);
+
     G_OBJECT_CLASS (dax_cache_parent_class)->dispose (object);
 }
 
@@ -76,6 +369,9 @@ dax_cache_finalize (GObject *object)
     DaxCachePrivate *priv = cache->priv;
 
     g_hash_table_unref (priv->entries);
+    g_queue_free (priv->lru);
+    g_slist_free (priv->fetchers);
+    g_free (priv->directory);
 
     G_OBJECT_CLASS (dax_cache_parent_class)->finalize (object);
 }
@@ -84,6 +380,7 @@ static void
 dax_cache_class_init (DaxCacheClass *klass)
 {
     GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    GParamSpec *pspec;
 
     g_type_class_add_private (klass, sizeof (DaxCachePrivate));
 
@@ -91,6 +388,38 @@ dax_cache_class_init (DaxCacheClass *klass)
     object_class->set_property = dax_cache_set_property;
     object_class->dispose = dax_cache_dispose;
     object_class->finalize = dax_cache_finalize;
+
+    pspec = g_param_spec_ulong ("max-size",
+                                "Maximum size",
+                                "Memory, in bytes, the unused entries of the "
+                                "cache can take before being evicted",
+                                0, G_MAXULONG, DEFAULT_MAX_SIZE,
+                                DAX_GPARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_MAX_SIZE, pspec);
+
+    pspec = g_param_spec_ulong ("size",
+                                "Size",
+                                "Memory, in bytes, used by the entries of "
+                                "the cache",
+                                0, G_MAXULONG, 0,
+                                DAX_GPARAM_READABLE);
+    g_object_class_install_property (object_class, PROP_SIZE, pspec);
+
+    pspec = g_param_spec_uint ("decoding-threads",
+                               "Decoding threads",
+                               "Number of threads decoding images in the "
+                               "background, 0 to decode them synchronously",
+                               0, G_MAXUINT, DEFAULT_DECODING_THREADS,
+                               DAX_GPARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_DECODING_THREADS,
+                                     pspec);
+
+    pspec = g_param_spec_string ("directory",
+                                 "Directory",
+                                 "Directory where fetched content is stored",
+                                 NULL,
+                                 DAX_GPARAM_READWRITE);
+    g_object_class_install_property (object_class, PROP_DIRECTORY, pspec);
 }
 
 static void
@@ -100,7 +429,19 @@ dax_cache_init (DaxCache *self)
 
     self->priv = priv = CACHE_PRIVATE (self);
 
-    priv->entries = g_hash_table_new (g_str_hash, g_str_equal);
+    priv->entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                           g_free, NULL);
+    priv->lru = g_queue_new ();
+    priv->max_size = DEFAULT_MAX_SIZE;
+    priv->decoding_threads = DEFAULT_DECODING_THREADS;
+    priv->directory = g_build_filename (g_get_user_cache_dir (), "dax", NULL);
+
+    priv->fetchers = g_slist_append (priv->fetchers,
+                                     (gpointer) &dax_cache_fetcher_data);
+    priv->fetchers = g_slist_append (priv->fetchers,
+                                     (gpointer) &dax_cache_fetcher_file);
+    priv->fetchers = g_slist_append (priv->fetchers,
+                                     (gpointer) &dax_cache_fetcher_gio);
 }
 
 DaxCache *
@@ -121,53 +462,298 @@ dax_cache_get_default (void)
     return singleton;
 }
 
+/**
+ * dax_cache_get_entry_for_uri:
+ * @cache: a #DaxCache
+ * @uri: an absolute URI
+ *
+ * Looks up the entry caching @uri, creating it if needed. Entries are
+ * shared, the caller owns a reference on the returned entry and has to
+ * release it with g_object_unref() once done with it.
+ */
 DaxCacheEntry *
 dax_cache_get_entry_for_uri (DaxCache      *cache,
                              const gchar   *uri)
 {
-    DaxCachePrivate *priv;
-    DaxCacheEntry *entry;
-
     g_return_val_if_fail (DAX_IS_CACHE (cache), NULL);
-    priv = cache->priv;
+    g_return_val_if_fail (uri, NULL);
 
-    entry = _dax_cache_entry_new (cache, uri);
-    g_hash_table_insert (priv->entries, (gchar *) uri, entry);
-
-    return entry;
+    return lookup_or_create (cache, uri);
 }
 
+/**
+ * dax_cache_get_entry_for_href:
+ * @cache: a #DaxCache
+ * @element: the element @href is found on
+ * @href: an IRI reference, relative or absolute
+ *
+ * Resolves @href against the base IRI of @element and looks up the entry
+ * for the resulting URI. See dax_cache_get_entry_for_uri().
+ */
 DaxCacheEntry *
 dax_cache_get_entry_for_href (DaxCache      *cache,
                               DaxDomElement *element,
                               const gchar   *href)
 {
-    DaxCachePrivate *priv;
     DaxCacheEntry *entry;
-    const gchar *base_iri;
     gchar *resolved_iri;
-    GFile *base_file, *resolved_file;
 
     g_return_val_if_fail (DAX_IS_CACHE (cache), NULL);
+    g_return_val_if_fail (href, NULL);
+
+    resolved_iri = resolve_href (element, href);
+    entry = lookup_or_create (cache, resolved_iri);
+    g_free (resolved_iri);
+
+    return entry;
+}
+
+gsize
+dax_cache_get_max_size (DaxCache *cache)
+{
+    g_return_val_if_fail (DAX_IS_CACHE (cache), 0);
+
+    return cache->priv->max_size;
+}
+
+void
+dax_cache_set_max_size (DaxCache *cache,
+                        gsize     max_size)
+{
+    DaxCachePrivate *priv;
+
+    g_return_if_fail (DAX_IS_CACHE (cache));
+
     priv = cache->priv;
+    if (priv->max_size == max_size)
+        return;
 
-    if (_dax_utils_is_iri (href)) {
-        entry = _dax_cache_entry_new (cache, href);
-        g_hash_table_insert (priv->entries, (gchar *) href, entry);
-    } else {
-        base_iri = dax_dom_element_get_base_iri (element);
-        base_file = g_file_new_for_uri (base_iri);
+    priv->max_size = max_size;
+    evict (cache);
+
+    g_object_notify (G_OBJECT (cache), "max-size");
+}
+
+gsize
+dax_cache_get_size (DaxCache *cache)
+{
+    g_return_val_if_fail (DAX_IS_CACHE (cache), 0);
+
+    return cache->priv->size;
+}
+
+guint
+dax_cache_get_decoding_threads (DaxCache *cache)
+{
+    g_return_val_if_fail (DAX_IS_CACHE (cache), 0);
+
+    return cache->priv->decoding_threads;
+}
+
+/**
+ * dax_cache_set_decoding_threads:
+ * @cache: a #DaxCache
+ * @n_threads: maximum number of decoding threads
+ *
+ * Sets how many images can be decoded in parallel in the background. When
+ * @n_threads is 0, images are decoded synchronously when requested.
+ */
+void
+dax_cache_set_decoding_threads (DaxCache *cache,
+                                guint     n_threads)
+{
+    DaxCachePrivate *priv;
+
+    g_return_if_fail (DAX_IS_CACHE (cache));
+
+    priv = cache->priv;
+    if (priv->decoding_threads == n_threads)
+        return;
+
+    priv->decoding_threads = n_threads;
+    if (priv->decoders && n_threads > 0)
+        g_thread_pool_set_max_threads (priv->decoders, n_threads, NULL);
+
+    g_object_notify (G_OBJECT (cache), "decoding-threads");
+}
+
+const gchar *
+dax_cache_get_directory (DaxCache *cache)
+{
+    g_return_val_if_fail (DAX_IS_CACHE (cache), NULL);
+
+    return cache->priv->directory;
+}
+
+/**
+ * dax_cache_set_directory:
+ * @cache: a #DaxCache
+ * @directory: a directory
+ *
+ * Sets the directory where the content fetched from non local URIs is
+ * stored. The directory is shared between runs, so the same resources are
+ * not fetched again. Defaults to a "dax" sub-directory of the user cache
+ * directory.
+ */
+void
+dax_cache_set_directory (DaxCache    *cache,
+                         const gchar *directory)
+{
+    DaxCachePrivate *priv;
+
+    g_return_if_fail (DAX_IS_CACHE (cache));
+    g_return_if_fail (directory);
+
+    priv = cache->priv;
+    g_free (priv->directory);
+    priv->directory = g_strdup (directory);
+
+    g_object_notify (G_OBJECT (cache), "directory");
+}
+
+/**
+ * dax_cache_add_fetcher:
+ * @cache: a #DaxCache
+ * @fetcher: a #DaxCacheFetcher
+ *
+ * Adds a way to retrieve the content of the entries of @cache. @fetcher is
+ * tried before the fetchers already known, so it can override them.
+ */
+void
+dax_cache_add_fetcher (DaxCache              *cache,
+                       const DaxCacheFetcher *fetcher)
+{
+    DaxCachePrivate *priv;
 
-        resolved_file = g_file_resolve_relative_path (base_file, href);
-        resolved_iri = g_file_get_uri (resolved_file);
+    g_return_if_fail (DAX_IS_CACHE (cache));
+    g_return_if_fail (fetcher && fetcher->can_fetch && fetcher->fetch);
+
+    priv = cache->priv;
+    priv->fetchers = g_slist_prepend (priv->fetchers, (gpointer) fetcher);
+}
+
+void
+dax_cache_get_stats (DaxCache      *cache,
+                     DaxCacheStats *stats)
+{
+    DaxCachePrivate *priv;
+
+    g_return_if_fail (DAX_IS_CACHE (cache));
+    g_return_if_fail (stats);
+
+    priv = cache->priv;
+
+    stats->hits = priv->hits;
+    stats->misses = priv->misses;
+    stats->evictions = priv->evictions;
+    stats->n_entries = g_hash_table_size (priv->entries);
+    stats->size = priv->size;
+    stats->max_size = priv->max_size;
+}
+
+void
+dax_cache_reset_stats (DaxCache *cache)
+{
+    DaxCachePrivate *priv;
 
-        entry = _dax_cache_entry_new (cache, resolved_iri);
-        g_hash_table_insert (priv->entries, (gchar *) resolved_iri, entry);
+    g_return_if_fail (DAX_IS_CACHE (cache));
 
-        g_object_unref (base_file);
-        g_object_unref (resolved_file);
-        g_free (resolved_iri);
+    priv = cache->priv;
+    priv->hits = priv->misses = priv->evictions = 0;
+}
+
+/* Called by the entries when the memory they use changes (eg. when their
+ * content has been fetched) */
+void
+_dax_cache_entry_size_changed (DaxCache      *cache,
+                               DaxCacheEntry *entry,
+                               gsize          old_size,
+                               gsize          new_size)
+{
+    DaxCachePrivate *priv = cache->priv;
+
+    priv->size = priv->size - old_size + new_size;
+
+    if (new_size > old_size)
+        evict (cache);
+}
+
+/* Decodes the image @entry points to, in one of the decoding threads if
+ * possible. The result is given back to @entry in the main thread with
+ * _dax_cache_entry_set_pixbuf() */
+void
+_dax_cache_decode_image (DaxCache      *cache,
+                         DaxCacheEntry *entry)
+{
+    DaxCachePrivate *priv = cache->priv;
+    DecodeJob *job;
+
+    job = g_slice_new0 (DecodeJob);
+    job->entry = g_object_ref (entry);
+    job->uri = g_strdup (dax_cache_entry_get_uri (entry));
+    job->path = dax_cache_entry_get_local_path (entry);
+    job->data = dax_cache_entry_get_data (entry);
+    if (job->data)
+        g_byte_array_ref (job->data);
+
+    if (priv->decoding_threads == 0) {
+        decode_job_run (job);
+        decode_job_finish (job);
+        return;
     }
 
-    return entry;
+    if (priv->decoders == NULL) {
+        priv->decoders = g_thread_pool_new (decoder_thread,
+                                            NULL,
+                                            priv->decoding_threads,
+                                            FALSE,
+                                            NULL);
+    }
+
+    DAX_NOTE (LOADING, "queuing decoding of %s", job->uri);
+    g_thread_pool_push (priv->decoders, job, NULL);
+}
+
+const DaxCacheFetcher *
+_dax_cache_lookup_fetcher (DaxCache    *cache,
+                           const gchar *uri)
+{
+    GSList *l;
+
+    for (l = cache->priv->fetchers; l; l = g_slist_next (l)) {
+        const DaxCacheFetcher *fetcher = l->data;
+
+        if (fetcher->can_fetch (fetcher, uri))
+            return fetcher;
+    }
+
+    return NULL;
+}
+
+/* Decodes an image from a file or from memory, can be called from any
+ * thread */
+GdkPixbuf *
+_dax_cache_load_pixbuf (const gchar  *path,
+                        GByteArray   *data,
+                        GError      **error)
+{
+    GdkPixbufLoader *loader;
+    GdkPixbuf *pixbuf = NULL;
+
+    if (data == NULL)
+        return gdk_pixbuf_new_from_file (path, error);
+
+    loader = gdk_pixbuf_loader_new ();
+    if (gdk_pixbuf_loader_write (loader, data->data, data->len, error)) {
+        if (gdk_pixbuf_loader_close (loader, error)) {
+            pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
+            if (pixbuf)
+                g_object_ref (pixbuf);
+        }
+    } else {
+        gdk_pixbuf_loader_close (loader, NULL);
+    }
+    g_object_unref (loader);
+
+    return pixbuf;
 }
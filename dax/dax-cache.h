@@ -23,6 +23,7 @@
 
 #include "dax-dom-element.h"
 #include "dax-cache-entry.h"
+#include "dax-cache-fetcher.h"
 
 G_BEGIN_DECLS
 
@@ -45,6 +46,7 @@ G_BEGIN_DECLS
 
 typedef struct _DaxCacheClass DaxCacheClass;
 typedef struct _DaxCachePrivate DaxCachePrivate;
+typedef struct _DaxCacheStats DaxCacheStats;
 
 struct _DaxCache
 {
@@ -58,6 +60,16 @@ struct _DaxCacheClass
     GObjectClass parent_class;
 };
 
+struct _DaxCacheStats
+{
+    guint hits;
+    guint misses;
+    guint evictions;
+    guint n_entries;
+    gsize size;
+    gsize max_size;
+};
+
 GType           dax_cache_get_type              (void) G_GNUC_CONST;
 
 DaxCache *      dax_cache_new                   (void);
@@ -68,6 +80,36 @@ DaxCacheEntry * dax_cache_get_entry_for_href    (DaxCache      *cache,
                                                  DaxDomElement *element,
                                                  const gchar   *href);
 
+gsize           dax_cache_get_max_size          (DaxCache      *cache);
+void            dax_cache_set_max_size          (DaxCache      *cache,
+                                                 gsize          max_size);
+gsize           dax_cache_get_size              (DaxCache      *cache);
+guint           dax_cache_get_decoding_threads  (DaxCache      *cache);
+void            dax_cache_set_decoding_threads  (DaxCache      *cache,
+                                                 guint          n_threads);
+const gchar *   dax_cache_get_directory         (DaxCache      *cache);
+void            dax_cache_set_directory         (DaxCache      *cache,
+                                                 const gchar   *directory);
+void            dax_cache_add_fetcher           (DaxCache              *cache,
+                                                 const DaxCacheFetcher *fetcher);
+
+void            dax_cache_get_stats             (DaxCache      *cache,
+                                                 DaxCacheStats *stats);
+void            dax_cache_reset_stats           (DaxCache      *cache);
+
+void            _dax_cache_entry_size_changed   (DaxCache      *cache,
+                                                 DaxCacheEntry *entry,
+                                                 gsize          old_size,
+                                                 gsize          new_size);
+void            _dax_cache_decode_image         (DaxCache      *cache,
+                                                 DaxCacheEntry *entry);
+const DaxCacheFetcher *
+                _dax_cache_lookup_fetcher       (DaxCache      *cache,
+                                                 const gchar   *uri);
+GdkPixbuf *     _dax_cache_load_pixbuf          (const gchar   *path,
+                                                 GByteArray    *data,
+                                                 GError       **error);
+
 G_END_DECLS
 
 #endif /* __DAX_CACHE_H__ */
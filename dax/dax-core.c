@@ -139,6 +139,24 @@ static enum_value script_type_enum_values[2] = {
 
 DEFINE_TRANSFORM_FUNCS(script_type, ScriptType)
 
+static void
+dax_init_common (gint    *argc,
+                 gchar ***argv)
+{
+    dax_dom_init (argc, argv, NULL);
+    svg_ns = I_(SVG_NS_URI);
+
+    g_value_register_transform_func (G_TYPE_STRING,
+                                     G_TYPE_FLOAT,
+                                     transform_string_float);
+
+    /* overrides of a few enums where we can't use the nick as the string to
+     * be compared with the input (because the input is expected to have non
+     * a-zA-Z- characters ("1.0", "application/ecmascript")) */
+    INSTALL_TRANSFORM_FUNCS(svg_version, SVG_VERSION)
+    INSTALL_TRANSFORM_FUNCS(script_type, SCRIPT_TYPE)
+}
+
 void
 dax_init (gint    *argc,
           gchar ***argv)
@@ -147,20 +165,32 @@ dax_init (gint    *argc,
     _dax_debug_init ();
 #endif
 
+    /* images are decoded in worker threads */
+    if (!g_thread_supported ())
+        g_thread_init (NULL);
+
     g_type_init ();
     clutter_init (argc, argv);
     clutter_gst_init (argc, argv);
 
-    dax_dom_init (argc, argv, NULL);
-    svg_ns = I_(SVG_NS_URI);
+    dax_init_common (argc, argv);
+}
 
-    g_value_register_transform_func (G_TYPE_STRING,
-                                     G_TYPE_FLOAT,
-                                     transform_string_float);
+/* Initialize Dax without connecting to a windowing system. Only the DOM and
+ * the traversers that do not need a stage (eg. DaxTraverserRaster) can be
+ * used after this call */
+void
+dax_init_headless (gint    *argc,
+                   gchar ***argv)
+{
+#ifdef DAX_ENABLE_DEBUG
+    _dax_debug_init ();
+#endif
 
-    /* overrides of a few enums where we can't use the nick as the string to
-     * be compared with the input (because the input is expected to have non
-     * a-zA-Z- characters ("1.0", "application/ecmascript")) */
-    INSTALL_TRANSFORM_FUNCS(svg_version, SVG_VERSION)
-    INSTALL_TRANSFORM_FUNCS(script_type, SCRIPT_TYPE)
+    if (!g_thread_supported ())
+        g_thread_init (NULL);
+
+    g_type_init ();
+
+    dax_init_common (argc, argv);
 }
@@ -27,7 +27,9 @@
 
 G_BEGIN_DECLS
 
-void        dax_init         (gint    *argc,
+void        dax_init            (gint    *argc,
+                                 gchar ***argv);
+void        dax_init_headless   (gint    *argc,
                                  gchar ***argv);
 
 G_END_DECLS
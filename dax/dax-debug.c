@@ -42,7 +42,8 @@ static const GDebugKey dax_debug_keys[] = {
   { "loading",   DAX_DEBUG_LOADING   },
   { "script",    DAX_DEBUG_SCRIPT    },
   { "animation", DAX_DEBUG_ANIMATION },
-  { "transform", DAX_DEBUG_TRANSFORM }
+  { "transform", DAX_DEBUG_TRANSFORM },
+  { "memory",    DAX_DEBUG_MEMORY    }
 };
 
 /**
@@ -83,4 +84,26 @@ _dax_debug_init (void)
   return TRUE;
 }
 
+/*
+ * Prints the memory used by an interned string table, and how much it saved
+ * compared to duplicating every string. Enabled with DAX_DEBUG=memory.
+ */
+void
+_dax_debug_dump_string_pool (const gchar   *owner,
+                             DaxStringPool *pool)
+{
+  DaxStringPoolStats stats;
+
+  if (pool == NULL)
+    return;
+
+  _dax_string_pool_get_stats (pool, &stats);
+
+  g_message ("[MEMORY] %s: %u strings interned out of %u lookups, "
+             "%" G_GSIZE_FORMAT " bytes of strings, %" G_GSIZE_FORMAT
+             " bytes of table, %" G_GSIZE_FORMAT " bytes saved",
+             owner, stats.n_strings, stats.n_lookups, stats.string_bytes,
+             stats.table_bytes, stats.saved_bytes);
+}
+
 #endif /* DAX_ENABLE_DEBUG */
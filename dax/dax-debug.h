@@ -28,6 +28,8 @@
 
 #include <glib.h>
 
+#include "dax-string-pool.h"
+
 G_BEGIN_DECLS
 
 #ifdef DAX_ENABLE_DEBUG
@@ -42,7 +44,8 @@ typedef enum
     DAX_DEBUG_LOADING         = 1 << 5,
     DAX_DEBUG_SCRIPT          = 1 << 6,
     DAX_DEBUG_ANIMATION       = 1 << 7,
-    DAX_DEBUG_TRANSFORM       = 1 << 8
+    DAX_DEBUG_TRANSFORM       = 1 << 8,
+    DAX_DEBUG_MEMORY          = 1 << 9
 } DaxDebugFlag;
 
 #ifdef __GNUC__
@@ -91,6 +94,12 @@ typedef enum
 
 #define DAX_MARK()      DAX_NOTE(MISC, "== mark ==")
 
+#define DAX_DUMP_STRING_POOL(owner,pool)                        \
+    G_STMT_START {                                              \
+        if (G_UNLIKELY (_dax_debug_flags & DAX_DEBUG_MEMORY))   \
+            _dax_debug_dump_string_pool (owner, pool);          \
+    } G_STMT_END
+
 /* We do not even define those (private) symbols when debug is disabled.
  * This is to ensure the debug code is not shiped with the program when
  * disabled */
@@ -100,11 +109,15 @@ extern guint _dax_debug_flags;
 gulong    _dax_get_timestamp    (void);
 gboolean  _dax_debug_init       (void);
 
+void      _dax_debug_dump_string_pool   (const gchar   *owner,
+                                         DaxStringPool *pool);
+
 #else /* !DAX_ENABLE_DEBUG */
 
 #define DAX_NOTE(type,...)         G_STMT_START { } G_STMT_END
 #define DAX_MARK()                 G_STMT_START { } G_STMT_END
 #define DAX_TIMESTAMP(type,...)    G_STMT_START { } G_STMT_END
+#define DAX_DUMP_STRING_POOL(owner,pool)    G_STMT_START { } G_STMT_END
 
 #endif /* DAX_ENABLE_DEBUG */
 
@@ -0,0 +1,268 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <cogl/cogl.h>
+
+#include "dax-path-cache.h"
+#include "dax-utils.h"
+
+#include "dax-display-list.h"
+
+G_DEFINE_TYPE (DaxDisplayList, dax_display_list, CLUTTER_TYPE_ACTOR)
+
+#define DISPLAY_LIST_PRIVATE(o)                                 \
+        (G_TYPE_INSTANCE_GET_PRIVATE ((o),                      \
+                                      DAX_TYPE_DISPLAY_LIST,    \
+                                      DaxDisplayListPrivate))
+
+/*
+ * The static parts of a document are recorded as a list of paths, each
+ * with its colors and the index of its transformation in the array of
+ * matrices. Consecutive items sharing the same transformation share the
+ * same matrix, which is only pushed once when painting.
+ */
+
+enum
+{
+    ITEM_HAS_FILL   = 1 << 0,
+    ITEM_HAS_STROKE = 1 << 1
+};
+
+typedef struct
+{
+    DaxPath *path;
+    DaxPathCacheEntry *geometry;    /* looked up when first painted */
+    guint matrix;
+    ClutterActorBox bounds;         /* of path */
+    ClutterColor fill_color;
+    ClutterColor stroke_color;
+    guint8 flags;
+} Item;
+
+struct _DaxDisplayListPrivate
+{
+    GArray *items;                  /* array of Item */
+    GArray *matrices;               /* array of CoglMatrix */
+    double last_affine[6];          /* the last one added to matrices */
+};
+
+static void
+cogl_matrix_from_dax_matrix (CoglMatrix      *cogl_matrix,
+                             const DaxMatrix *matrix)
+{
+    float m[16];
+
+    memset (m, 0, sizeof (m));
+
+    m[0] = matrix->affine[0];
+    m[1] = matrix->affine[1];
+    m[4] = matrix->affine[2];
+    m[5] = matrix->affine[3];
+    m[10] = 1;
+    m[12] = matrix->affine[4];
+    m[13] = matrix->affine[5];
+    m[15] = 1;
+
+    cogl_matrix_init_from_array (cogl_matrix, m);
+}
+
+static void
+set_source_color (const ClutterColor *color,
+                  guint8              paint_opacity)
+{
+    cogl_set_source_color4ub (color->red,
+                              color->green,
+                              color->blue,
+                              paint_opacity * color->alpha / 255);
+}
+
+/*
+ * ClutterActor implementation
+ */
+
+static void
+dax_display_list_paint (ClutterActor *actor)
+{
+    DaxDisplayList *self = DAX_DISPLAY_LIST (actor);
+    DaxDisplayListPrivate *priv = self->priv;
+    guint8 paint_opacity;
+    guint i, matrix = G_MAXUINT;
+
+    paint_opacity = clutter_actor_get_paint_opacity (actor);
+
+    for (i = 0; i < priv->items->len; i++) {
+        Item *item = &g_array_index (priv->items, Item, i);
+
+        if (item->matrix != matrix) {
+            if (matrix != G_MAXUINT)
+                cogl_pop_matrix ();
+            matrix = item->matrix;
+            cogl_push_matrix ();
+            cogl_transform (&g_array_index (priv->matrices, CoglMatrix,
+                                            matrix));
+        }
+
+        if (!_dax_utils_box_is_visible (&item->bounds))
+            continue;
+
+        if (item->geometry == NULL)
+            item->geometry = _dax_path_cache_lookup (item->path);
+        cogl_set_path (_dax_path_cache_entry_get_cogl_path (item->geometry));
+
+        if (item->flags & ITEM_HAS_FILL) {
+            set_source_color (&item->fill_color, paint_opacity);
+            if (item->flags & ITEM_HAS_STROKE)
+                cogl_path_fill_preserve ();
+            else
+                cogl_path_fill ();
+        }
+
+        if (item->flags & ITEM_HAS_STROKE) {
+            set_source_color (&item->stroke_color, paint_opacity);
+            cogl_path_stroke ();
+        }
+    }
+
+    if (matrix != G_MAXUINT)
+        cogl_pop_matrix ();
+}
+
+/*
+ * GObject implementation
+ */
+
+static void
+dax_display_list_finalize (GObject *object)
+{
+    DaxDisplayList *self = DAX_DISPLAY_LIST (object);
+    DaxDisplayListPrivate *priv = self->priv;
+    guint i;
+
+    for (i = 0; i < priv->items->len; i++) {
+        Item *item = &g_array_index (priv->items, Item, i);
+
+        g_object_unref (item->path);
+        _dax_path_cache_entry_unref (item->geometry);
+    }
+    g_array_free (priv->items, TRUE);
+    g_array_free (priv->matrices, TRUE);
+
+    G_OBJECT_CLASS (dax_display_list_parent_class)->finalize (object);
+}
+
+static void
+dax_display_list_class_init (DaxDisplayListClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+    g_type_class_add_private (klass, sizeof (DaxDisplayListPrivate));
+
+    object_class->finalize = dax_display_list_finalize;
+
+    actor_class->paint = dax_display_list_paint;
+}
+
+static void
+dax_display_list_init (DaxDisplayList *self)
+{
+    DaxDisplayListPrivate *priv;
+
+    self->priv = priv = DISPLAY_LIST_PRIVATE (self);
+
+    priv->items = g_array_new (FALSE, FALSE, sizeof (Item));
+    priv->matrices = g_array_new (FALSE, FALSE, sizeof (CoglMatrix));
+}
+
+ClutterActor *
+dax_display_list_new (void)
+{
+    return g_object_new (DAX_TYPE_DISPLAY_LIST, NULL);
+}
+
+/**
+ * dax_display_list_add_path:
+ * @self: a #DaxDisplayList
+ * @path: the #DaxPath to paint
+ * @matrix: the transformation of @path in the coordinates of @self
+ * @fill_color: (allow-none): the color to fill @path with
+ * @stroke_color: (allow-none): the color to stroke @path with
+ *
+ * Appends @path to the list, it will be painted on top of the paths already
+ * added.
+ */
+void
+dax_display_list_add_path (DaxDisplayList     *self,
+                           DaxPath            *path,
+                           const DaxMatrix    *matrix,
+                           const ClutterColor *fill_color,
+                           const ClutterColor *stroke_color)
+{
+    DaxDisplayListPrivate *priv;
+    Item item;
+
+    g_return_if_fail (DAX_IS_DISPLAY_LIST (self));
+    g_return_if_fail (DAX_IS_PATH (path));
+    g_return_if_fail (matrix != NULL);
+
+    priv = self->priv;
+
+    memset (&item, 0, sizeof (Item));
+    if ((fill_color == NULL && stroke_color == NULL) ||
+        !dax_path_get_bounds (path, &item.bounds.x1, &item.bounds.y1,
+                              &item.bounds.x2, &item.bounds.y2))
+    {
+        return;
+    }
+
+    if (priv->matrices->len == 0 ||
+        memcmp (matrix->affine, priv->last_affine,
+                sizeof (priv->last_affine)) != 0)
+    {
+        CoglMatrix cogl_matrix;
+
+        cogl_matrix_from_dax_matrix (&cogl_matrix, matrix);
+        g_array_append_val (priv->matrices, cogl_matrix);
+        memcpy (priv->last_affine, matrix->affine,
+                sizeof (priv->last_affine));
+    }
+
+    item.path = g_object_ref (path);
+    item.matrix = priv->matrices->len - 1;
+    if (fill_color) {
+        item.fill_color = *fill_color;
+        item.flags |= ITEM_HAS_FILL;
+    }
+    if (stroke_color) {
+        item.stroke_color = *stroke_color;
+        item.flags |= ITEM_HAS_STROKE;
+    }
+    g_array_append_val (priv->items, item);
+
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+}
+
+guint
+dax_display_list_get_n_items (DaxDisplayList *self)
+{
+    g_return_val_if_fail (DAX_IS_DISPLAY_LIST (self), 0);
+
+    return self->priv->items->len;
+}
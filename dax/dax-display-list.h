@@ -0,0 +1,75 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DAX_DISPLAY_LIST_H__
+#define __DAX_DISPLAY_LIST_H__
+
+#include <glib-object.h>
+#include <clutter/clutter.h>
+
+#include "dax-path.h"
+#include "dax-types.h"
+
+G_BEGIN_DECLS
+
+#define DAX_TYPE_DISPLAY_LIST dax_display_list_get_type()
+
+#define DAX_DISPLAY_LIST(obj) \
+    (G_TYPE_CHECK_INSTANCE_CAST ((obj), DAX_TYPE_DISPLAY_LIST, DaxDisplayList))
+
+#define DAX_DISPLAY_LIST_CLASS(klass) \
+    (G_TYPE_CHECK_CLASS_CAST ((klass), DAX_TYPE_DISPLAY_LIST, DaxDisplayListClass))
+
+#define DAX_IS_DISPLAY_LIST(obj) \
+    (G_TYPE_CHECK_INSTANCE_TYPE ((obj), DAX_TYPE_DISPLAY_LIST))
+
+#define DAX_IS_DISPLAY_LIST_CLASS(klass) \
+    (G_TYPE_CHECK_CLASS_TYPE ((klass), DAX_TYPE_DISPLAY_LIST))
+
+#define DAX_DISPLAY_LIST_GET_CLASS(obj) \
+    (G_TYPE_INSTANCE_GET_CLASS ((obj), DAX_TYPE_DISPLAY_LIST, DaxDisplayListClass))
+
+typedef struct _DaxDisplayList DaxDisplayList;
+typedef struct _DaxDisplayListClass DaxDisplayListClass;
+typedef struct _DaxDisplayListPrivate DaxDisplayListPrivate;
+
+struct _DaxDisplayList
+{
+    ClutterActor parent;
+
+    DaxDisplayListPrivate *priv;
+};
+
+struct _DaxDisplayListClass
+{
+    ClutterActorClass parent_class;
+};
+
+GType           dax_display_list_get_type       (void) G_GNUC_CONST;
+
+ClutterActor *  dax_display_list_new            (void);
+void            dax_display_list_add_path       (DaxDisplayList     *self,
+                                                 DaxPath            *path,
+                                                 const DaxMatrix    *matrix,
+                                                 const ClutterColor *fill_color,
+                                                 const ClutterColor *stroke_color);
+guint           dax_display_list_get_n_items    (DaxDisplayList *self);
+
+G_END_DECLS
+
+#endif /* __DAX_DISPLAY_LIST_H__ */
@@ -16,8 +16,6 @@
  * along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <string.h>
-
 #include "dax-dom.h"
 
 #include "dax-element-animate.h"
@@ -54,6 +52,61 @@ struct _DaxDocumentPrivate
 {
 };
 
+/*
+ * Element registry
+ */
+
+typedef struct
+{
+    const gchar *tag_name;
+    GType (*get_type) (void);
+} BuiltinElement;
+
+static const BuiltinElement builtin_elements[] =
+{
+    { "svg",                dax_element_svg_get_type                },
+    { "g",                  dax_element_g_get_type                  },
+    { "path",               dax_element_path_get_type               },
+    { "rect",               dax_element_rect_get_type               },
+    { "text",               dax_element_text_get_type               },
+    { "tspan",              dax_element_tspan_get_type              },
+    { "animate",            dax_element_animate_get_type            },
+    { "animateTransform",   dax_element_animate_transform_get_type  },
+    { "polyline",           dax_element_polyline_get_type           },
+    { "image",              dax_element_image_get_type              },
+    { "circle",             dax_element_circle_get_type             },
+    { "handler",            dax_element_handler_get_type            },
+    { "script",             dax_element_script_get_type             },
+    { "desc",               dax_element_desc_get_type               },
+    { "title",              dax_element_title_get_type              },
+    { "line",               dax_element_line_get_type               },
+    { "video",              dax_element_video_get_type              },
+};
+
+/* tag name -> GType of the element to create. Registering new elements is
+ * meant to be done before parsing any document, lookups are lock-free */
+static GHashTable *
+get_element_registry (void)
+{
+    static volatile gsize registry = 0;
+
+    if (g_once_init_enter (&registry)) {
+        GHashTable *table;
+        guint i;
+
+        table = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        for (i = 0; i < G_N_ELEMENTS (builtin_elements); i++) {
+            g_hash_table_insert (table,
+                                 g_strdup (builtin_elements[i].tag_name),
+                                 GSIZE_TO_POINTER (builtin_elements[i].get_type ()));
+        }
+
+        g_once_init_leave (&registry, (gsize) table);
+    }
+
+    return (GHashTable *) registry;
+}
+
 /*
  * DaxDomDocument implementation
  */
@@ -63,42 +116,14 @@ dax_document_create_element(DaxDomDocument  *self,
                             const gchar     *tag_name,
                             GError         **err)
 {
-    if (strcmp (tag_name, "svg") == 0)
-        return dax_element_svg_new ();
-    if (strcmp (tag_name, "g") == 0)
-        return dax_element_g_new ();
-    if (strcmp (tag_name, "path") == 0)
-        return dax_element_path_new ();
-    if (strcmp (tag_name, "rect") == 0)
-        return dax_element_rect_new ();
-    if (strcmp (tag_name, "text") == 0)
-        return dax_element_text_new ();
-    if (strcmp (tag_name, "tspan") == 0)
-        return dax_element_tspan_new ();
-    if (strcmp (tag_name, "animate") == 0)
-        return dax_element_animate_new ();
-    if (strcmp (tag_name, "animateTransform") == 0)
-        return dax_element_animate_transform_new ();
-    if (strcmp (tag_name, "polyline") == 0)
-        return dax_element_polyline_new ();
-    if (strcmp (tag_name, "image") == 0)
-        return dax_element_image_new ();
-    if (strcmp (tag_name, "circle") == 0)
-        return dax_element_circle_new ();
-    if (strcmp (tag_name, "handler") == 0)
-        return dax_element_handler_new ();
-    if (strcmp (tag_name, "script") == 0)
-        return dax_element_script_new ();
-    if (strcmp (tag_name, "desc") == 0)
-        return dax_element_desc_new ();
-    if (strcmp (tag_name, "title") == 0)
-        return dax_element_title_new ();
-    if (strcmp (tag_name, "line") == 0)
-        return dax_element_line_new ();
-    if (strcmp (tag_name, "video") == 0)
-        return dax_element_video_new ();
-
-    return NULL;
+    GType type;
+
+    type = GPOINTER_TO_SIZE (g_hash_table_lookup (get_element_registry (),
+                                                  tag_name));
+    if (G_UNLIKELY (type == G_TYPE_INVALID))
+        return NULL;
+
+    return g_object_newv (type, 0, NULL);
 }
 
 /*
@@ -174,3 +199,41 @@ dax_document_new (void)
 {
     return g_object_new (DAX_TYPE_DOCUMENT, NULL);
 }
+
+/**
+ * dax_document_register_element:
+ * @tag_name: the local name of the element
+ * @type: a #GType deriving from #DaxDomElement
+ *
+ * Makes the parser create elements of type @type for the @tag_name tags,
+ * replacing the built-in element if any. Applications can this way handle
+ * their own elements, or extend the ones provided by Dax. Elements should be
+ * registered before parsing documents.
+ */
+void
+dax_document_register_element (const gchar *tag_name,
+                               GType        type)
+{
+    g_return_if_fail (tag_name != NULL);
+    g_return_if_fail (g_type_is_a (type, DAX_TYPE_DOM_ELEMENT));
+
+    g_hash_table_replace (get_element_registry (),
+                          g_strdup (tag_name),
+                          GSIZE_TO_POINTER (type));
+}
+
+/**
+ * dax_document_lookup_element:
+ * @tag_name: the local name of the element
+ *
+ * Return value: the #GType of the elements created for @tag_name, or
+ * %G_TYPE_INVALID if the tag is not known
+ */
+GType
+dax_document_lookup_element (const gchar *tag_name)
+{
+    g_return_val_if_fail (tag_name != NULL, G_TYPE_INVALID);
+
+    return GPOINTER_TO_SIZE (g_hash_table_lookup (get_element_registry (),
+                                                  tag_name));
+}
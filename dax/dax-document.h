@@ -74,6 +74,10 @@ GType dax_document_get_type (void) G_GNUC_CONST;
 
 DaxDomDocument *    dax_document_new            (void);
 
+void                dax_document_register_element   (const gchar *tag_name,
+                                                     GType        type);
+GType               dax_document_lookup_element     (const gchar *tag_name);
+
 G_END_DECLS
 
 #endif /* __DAX_DOCUMENT_H__ */
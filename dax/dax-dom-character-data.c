@@ -18,6 +18,7 @@
  * along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "dax-dom-private.h"
 #include "dax-dom-character-data.h"
 
 G_DEFINE_TYPE (DaxDomCharacterData,
@@ -31,9 +32,24 @@ G_DEFINE_TYPE (DaxDomCharacterData,
 
 struct _DaxDomCharacterDataPrivate
 {
-    GString *data;
+    gchar *data;
+    gboolean static_data;       /* data is not ours, don't free it */
+    DaxArena *arena;            /* holds the static data, if any */
 };
 
+static void
+dax_dom_character_data_free_data (DaxDomCharacterData *char_data)
+{
+    DaxDomCharacterDataPrivate *priv = char_data->priv;
+
+    if (!priv->static_data)
+        g_free (priv->data);
+    _dax_arena_unref (priv->arena);
+    priv->arena = NULL;
+    priv->data = NULL;
+    priv->static_data = FALSE;
+}
+
 static void
 dax_dom_character_data_get_property (GObject    *object,
                                         guint       property_id,
@@ -69,6 +85,8 @@ dax_dom_character_data_dispose (GObject *object)
 static void
 dax_dom_character_data_finalize (GObject *object)
 {
+    dax_dom_character_data_free_data (DAX_DOM_CHARACTER_DATA (object));
+
     G_OBJECT_CLASS (dax_dom_character_data_parent_class)->finalize (object);
 }
 
@@ -88,11 +106,7 @@ dax_dom_character_data_class_init (DaxDomCharacterDataClass *klass)
 static void
 dax_dom_character_data_init (DaxDomCharacterData *self)
 {
-    DaxDomCharacterDataPrivate *priv;
-
-    self->priv = priv = DOM_CHARACTER_DATA_PRIVATE (self);
-
-    priv->data = g_string_new ("");
+    self->priv = DOM_CHARACTER_DATA_PRIVATE (self);
 }
 
 DaxDomCharacterData *
@@ -107,7 +121,25 @@ dax_dom_character_data_set_data (DaxDomCharacterData *char_data,
 {
     g_return_if_fail (DAX_IS_DOM_CHARACTER_DATA (char_data));
 
-    g_string_assign (char_data->priv->data, data);
+    dax_dom_character_data_free_data (char_data);
+    char_data->priv->data = g_strdup (data);
+}
+
+/* @data is not copied. When it belongs to @arena, eg. the arena of the
+ * document, @char_data keeps a reference on it. Without an arena, @data has
+ * to outlive @char_data */
+void
+_dax_dom_character_data_set_static_data (DaxDomCharacterData *char_data,
+                                         const gchar         *data,
+                                         DaxArena            *arena)
+{
+    DaxDomCharacterDataPrivate *priv = char_data->priv;
+
+    dax_dom_character_data_free_data (char_data);
+    priv->data = (gchar *) data;
+    priv->static_data = TRUE;
+    if (arena)
+        priv->arena = _dax_arena_ref (arena);
 }
 
 const gchar *
@@ -115,5 +147,5 @@ dax_dom_character_data_get_data (DaxDomCharacterData *char_data)
 {
     g_return_val_if_fail (DAX_IS_DOM_CHARACTER_DATA (char_data), NULL);
 
-    return char_data->priv->data->str;
+    return char_data->priv->data ? char_data->priv->data : "";
 }
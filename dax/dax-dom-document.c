@@ -16,6 +16,7 @@
  * along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "dax-debug.h"
 #include "dax-dom-private.h"
 #include "dax-dom-core.h"
 #include "dax-dom-element.h"
@@ -39,6 +40,16 @@ enum
     PROP_BASE_IRI
 };
 
+enum
+{
+    NODE_INSERTED,
+    NODE_REMOVED,
+
+    LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL];
+
 struct _DaxDomDocumentPrivate
 {
     GPtrArray *namespaces;
@@ -46,6 +57,12 @@ struct _DaxDomDocumentPrivate
     gchar *base_iri;
 
     DaxJsContext *js_context;
+    DaxTimerWheel *timer_wheel;
+
+    /* holds the data of the nodes, see _dax_dom_document_get_arena() */
+    DaxArena *arena;
+    DaxStringPool *strings;
+    guint parsing;              /* parsers setting attributes */
 };
 
 /*
@@ -101,6 +118,13 @@ _dax_dom_document_get_prefix_for_interned_uri (DaxDomDocument *document,
     return NULL;
 }
 
+/* an array of DaxXmlNamespace, in declaration order */
+const GPtrArray *
+_dax_dom_document_get_namespaces (DaxDomDocument *document)
+{
+    return document->priv->namespaces;
+}
+
 static void
 _dax_dom_document_free_namespaces (DaxDomDocument *document)
 {
@@ -140,6 +164,93 @@ _dax_dom_document_unset_id (DaxDomDocument *document,
     g_hash_table_remove (document->priv->id2element, id);
 }
 
+/* Text data, attribute values and arrays parsed for the nodes of the
+ * document can be allocated from this arena. They are freed all at once
+ * when the last reference on the arena goes away: objects keeping such
+ * data past the document take a reference on the arena */
+DaxArena *
+_dax_dom_document_get_arena (DaxDomDocument *document)
+{
+    DaxDomDocumentPrivate *priv = document->priv;
+
+    if (priv->arena == NULL)
+        priv->arena = _dax_arena_new ();
+
+    return priv->arena;
+}
+
+/* Attribute values and other strings repeated across the nodes of a
+ * document are stored once. Strings interned in the same document can be
+ * compared with ==. They live in the arena of the document. Without a
+ * document, the strings are interned for the life time of the program.
+ * Nothing is ever removed from the pool, only intern values read by the
+ * parsers, see _dax_dom_element_set_string() */
+const gchar *
+_dax_dom_document_intern_string (DaxDomDocument *document,
+                                 const gchar    *string)
+{
+    DaxDomDocumentPrivate *priv;
+
+    if (document == NULL)
+        return g_intern_string (string);
+
+    priv = document->priv;
+    if (G_UNLIKELY (priv->strings == NULL)) {
+        DaxArena *arena = _dax_dom_document_get_arena (document);
+
+        priv->strings = _dax_string_pool_new (arena);
+    }
+
+    return _dax_string_pool_intern (priv->strings, string);
+}
+
+/* The parsers call those around the attributes they set so that elements
+ * know the values come from the document and can be interned */
+void
+_dax_dom_document_begin_parsing (DaxDomDocument *document)
+{
+    document->priv->parsing++;
+}
+
+void
+_dax_dom_document_end_parsing (DaxDomDocument *document)
+{
+    g_return_if_fail (document->priv->parsing > 0);
+
+    document->priv->parsing--;
+}
+
+gboolean
+_dax_dom_document_is_parsing (DaxDomDocument *document)
+{
+    return document->priv->parsing > 0;
+}
+
+/* Mutations of the tree are only signalled when someone is listening, the
+ * parser appends thousands of nodes nobody wants to hear about */
+void
+_dax_dom_document_signal_node_inserted (DaxDomDocument *document,
+                                        DaxDomNode     *node)
+{
+    if (!g_signal_has_handler_pending (document, signals[NODE_INSERTED], 0,
+                                       TRUE))
+        return;
+
+    g_signal_emit (document, signals[NODE_INSERTED], 0, node);
+}
+
+void
+_dax_dom_document_signal_node_removed (DaxDomDocument *document,
+                                       DaxDomNode     *node,
+                                       DaxDomNode     *former_parent)
+{
+    if (!g_signal_has_handler_pending (document, signals[NODE_REMOVED], 0,
+                                       TRUE))
+        return;
+
+    g_signal_emit (document, signals[NODE_REMOVED], 0, node, former_parent);
+}
+
 /*
  * DaxDomDocument implementation
  */
@@ -209,6 +320,11 @@ dax_dom_document_finalize (GObject *object)
     _dax_dom_document_free_namespaces (document);
     g_hash_table_unref (priv->id2element);
     g_free (priv->base_iri);
+    if (priv->timer_wheel)
+        dax_timer_wheel_unref (priv->timer_wheel);
+    DAX_DUMP_STRING_POOL (G_OBJECT_TYPE_NAME (document), priv->strings);
+    _dax_string_pool_free (priv->strings);
+    _dax_arena_unref (priv->arena);
 
     G_OBJECT_CLASS (dax_dom_document_parent_class)->finalize (object);
 }
@@ -238,6 +354,45 @@ dax_dom_document_class_init (DaxDomDocumentClass *klass)
                                    DAX_PARAM_NONE,
                                    xml_ns);
     g_object_class_install_property (object_class, PROP_BASE_IRI, pspec);
+
+    /**
+     * DaxDomDocument::node-inserted:
+     * @document: the #DaxDomDocument
+     * @node: the #DaxDomNode that has just been inserted in the tree
+     *
+     * Emitted after @node has been inserted in the document with
+     * dax_dom_node_append_child() or dax_dom_node_insert_before().
+     */
+    signals[NODE_INSERTED] =
+        g_signal_new (I_("node-inserted"),
+                      G_TYPE_FROM_CLASS (object_class),
+                      G_SIGNAL_RUN_LAST,
+                      0,
+                      NULL, NULL,
+                      g_cclosure_marshal_VOID__OBJECT,
+                      G_TYPE_NONE, 1,
+                      DAX_TYPE_DOM_NODE);
+
+    /**
+     * DaxDomDocument::node-removed:
+     * @document: the #DaxDomDocument
+     * @node: the #DaxDomNode that has just been removed from the tree
+     * @former_parent: the node @node was a child of
+     *
+     * Emitted after @node has been removed from the document with
+     * dax_dom_node_remove_child(), or before it is moved elsewhere by
+     * dax_dom_node_insert_before().
+     */
+    signals[NODE_REMOVED] =
+        g_signal_new (I_("node-removed"),
+                      G_TYPE_FROM_CLASS (object_class),
+                      G_SIGNAL_RUN_LAST,
+                      0,
+                      NULL, NULL,
+                      g_cclosure_marshal_generic,
+                      G_TYPE_NONE, 2,
+                      DAX_TYPE_DOM_NODE,
+                      DAX_TYPE_DOM_NODE);
 }
 
 static void
@@ -252,8 +407,6 @@ dax_dom_document_init (DaxDomDocument *self)
     _dax_dom_document_add_namespace_static (self, xmlns_ns, "xmlns");
 
     priv->id2element = g_hash_table_new (g_str_hash, g_str_equal);
-
-    priv->js_context = dax_js_context_new ();
 }
 
 DaxDomDocument *
@@ -266,12 +419,43 @@ dax_dom_document_new (void)
  * DaxDomDocument
  */
 
+/* created on first use so that documents can be parsed in other threads
+ * than the main one, see dax_dom_document_new_from_file_async() */
 DaxJsContext *
 dax_dom_document_get_js_context (DaxDomDocument *document)
 {
+    DaxDomDocumentPrivate *priv;
+
     g_return_val_if_fail (DAX_IS_DOM_DOCUMENT (document), NULL);
 
-    return document->priv->js_context;
+    priv = document->priv;
+    if (priv->js_context == NULL)
+        priv->js_context = dax_js_context_new ();
+
+    return priv->js_context;
+}
+
+/**
+ * dax_dom_document_get_timer_wheel:
+ * @document: a #DaxDomDocument
+ *
+ * The timer wheel drives the timers created by the scripts of @document.
+ * Pausing it pauses the clock of the whole document.
+ *
+ * Returns: the #DaxTimerWheel of @document
+ */
+DaxTimerWheel *
+dax_dom_document_get_timer_wheel (DaxDomDocument *document)
+{
+    DaxDomDocumentPrivate *priv;
+
+    g_return_val_if_fail (DAX_IS_DOM_DOCUMENT (document), NULL);
+
+    priv = document->priv;
+    if (priv->timer_wheel == NULL)
+        priv->timer_wheel = dax_timer_wheel_new ();
+
+    return priv->timer_wheel;
 }
 
 DaxDomElement *
@@ -294,12 +478,16 @@ dax_dom_document_create_text_node (DaxDomDocument *document,
 {
     DaxDomNode *node;
     DaxDomText *text;
+    DaxArena *arena;
 
     text = dax_dom_text_new ();
     if (G_UNLIKELY (text == NULL))
         return NULL;
 
-    dax_dom_character_data_set_data (DAX_DOM_CHARACTER_DATA (text), data);
+    arena = _dax_dom_document_get_arena (document);
+    _dax_dom_character_data_set_static_data (DAX_DOM_CHARACTER_DATA (text),
+                                             _dax_arena_strdup (arena, data),
+                                             arena);
     node = DAX_DOM_NODE (text);
     node->owner_document = document;
 
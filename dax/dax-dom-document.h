@@ -26,6 +26,7 @@
 #include "dax-dom-element.h"
 #include "dax-dom-text.h"
 #include "dax-js-context.h"
+#include "dax-timer-wheel.h"
 
 G_BEGIN_DECLS
 
@@ -84,6 +85,7 @@ GType           dax_dom_document_get_type             (void) G_GNUC_CONST;
 DaxDomDocument *dax_dom_document_new                  (void);
 
 DaxJsContext *  dax_dom_document_get_js_context       (DaxDomDocument *document);
+DaxTimerWheel * dax_dom_document_get_timer_wheel      (DaxDomDocument *document);
 const gchar *   dax_dom_document_get_base_iri         (DaxDomDocument *document);
 void            dax_dom_document_set_base_iri         (DaxDomDocument *document,
                                                        const char  *base_iri);
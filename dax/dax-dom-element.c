@@ -68,6 +68,10 @@ struct _DaxDomElementPrivate
     gchar *id;
     gchar *base_iri;                /* xml:base value in the DOM tree */
     gchar *resolved_base_iri;       /* cache resolved xml:base */
+
+    /* see _dax_dom_element_set_string() */
+    DaxArena *arena;                /* holds the interned strings */
+    GHashTable *strings;            /* field -> copy owned by the element */
 };
 
 /*
@@ -154,6 +158,44 @@ on_child_loaded (DaxDomElement *child,
     }
 }
 
+/* Sets a string property stored in @field, like a style or a font family.
+ * Values set by the parsers repeat a lot and are interned in the owner
+ * document, @element then keeps a reference on the arena holding them.
+ * Values set afterwards, eg. from scripts, are copies owned by @element so
+ * that changing them over and over does not grow the pool */
+void
+_dax_dom_element_set_string (DaxDomElement  *element,
+                             const gchar   **field,
+                             const gchar    *string)
+{
+    DaxDomElementPrivate *priv = element->priv;
+    DaxDomDocument *document = ((DaxDomNode *) element)->owner_document;
+    const gchar *new_string;
+
+    if (string && document && _dax_dom_document_is_parsing (document)) {
+        new_string = _dax_dom_document_intern_string (document, string);
+        if (priv->arena == NULL)
+            priv->arena =
+                _dax_arena_ref (_dax_dom_document_get_arena (document));
+        /* frees the copy of the previous value, if any */
+        if (priv->strings)
+            g_hash_table_remove (priv->strings, field);
+    } else if (string) {
+        gchar *copy = g_strdup (string);
+
+        if (priv->strings == NULL)
+            priv->strings = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+        g_hash_table_replace (priv->strings, field, copy);
+        new_string = copy;
+    } else {
+        new_string = NULL;
+        if (priv->strings)
+            g_hash_table_remove (priv->strings, field);
+    }
+
+    *field = new_string;
+}
+
 void
 _dax_dom_element_signal_parsed (DaxDomElement *element)
 {
@@ -297,6 +339,10 @@ dax_dom_element_finalize (GObject *object)
     invalidate_resolved_iri (element);
     g_free (priv->base_iri);
 
+    if (priv->strings)
+        g_hash_table_destroy (priv->strings);
+    _dax_arena_unref (priv->arena);
+
     G_OBJECT_CLASS (dax_dom_element_parent_class)->finalize (object);
 }
 
@@ -396,8 +442,9 @@ dax_dom_element_set_id (DaxDomElement *element,
 
     priv = element->priv;
 
-    new_id = g_strdup (id);
+    /* ids are unique, there is nothing to gain in interning them */
     document = ((DaxDomNode *) element)->owner_document;
+    new_id = g_strdup (id);
     id_is_valid = _dax_dom_document_set_element_id (document, element, new_id);
     if (!id_is_valid) {
         g_free (new_id);
@@ -572,6 +619,13 @@ dax_dom_element_setAttribute (DaxDomElement  *self,
         klass->set_attribute (self, name, value, err);
 }
 
+/* the xml:base attribute as it was set, not resolved */
+const gchar *
+_dax_dom_element_get_xml_base (DaxDomElement *element)
+{
+    return element->priv->base_iri;
+}
+
 static const char *
 get_parent_base_iri (DaxDomElement *element)
 {
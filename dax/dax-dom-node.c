@@ -17,6 +17,8 @@
  */
 
 #include "dax-internals.h"
+#include "dax-dom-exception.h"
+#include "dax-dom-private.h"
 #include "dax-dom-node.h"
 
 G_DEFINE_ABSTRACT_TYPE (DaxDomNode, dax_dom_node, G_TYPE_OBJECT)
@@ -150,50 +152,182 @@ dax_dom_node_set_text_content(DaxDomNode *self,
 
 /* DOM methods */
 
-DaxDomNode *
-dax_dom_node_append_child (DaxDomNode  *self,
-                              DaxDomNode  *new_child,
-                              GError        **unused(err))
+static DaxDomDocument *
+dax_dom_node_get_document (DaxDomNode *node)
 {
-    g_return_val_if_fail(DAX_IS_DOM_NODE(self), NULL);
-    g_return_val_if_fail (new_child->parent_node == NULL, NULL);
+    if (DAX_IS_DOM_DOCUMENT (node))
+        return DAX_DOM_DOCUMENT (node);
 
-    if (self->first_child == NULL)
-        self->first_child = new_child;
-    if (self->last_child != NULL)
-        self->last_child->next_sibling = new_child;
+    return node->owner_document;
+}
 
-    new_child->parent_node = self;
-    new_child->next_sibling = NULL;
-    new_child->previous_sibling = self->last_child;
-    self->last_child = new_child;
+static void
+dax_dom_node_unlink (DaxDomNode *parent,
+                     DaxDomNode *child)
+{
+    if (child->previous_sibling)
+        child->previous_sibling->next_sibling = child->next_sibling;
+    else
+        parent->first_child = child->next_sibling;
+
+    if (child->next_sibling)
+        child->next_sibling->previous_sibling = child->previous_sibling;
+    else
+        parent->last_child = child->previous_sibling;
+
+    child->parent_node = NULL;
+    child->previous_sibling = NULL;
+    child->next_sibling = NULL;
+}
 
-    return new_child;
+/* The tree keeps the reference of the node removed by the unlink */
+static void
+dax_dom_node_detach (DaxDomNode *child)
+{
+    DaxDomNode *parent = child->parent_node;
+    DaxDomDocument *document;
+
+    dax_dom_node_unlink (parent, child);
+
+    document = dax_dom_node_get_document (parent);
+    if (document)
+        _dax_dom_document_signal_node_removed (document, child, parent);
 }
 
+/**
+ * dax_dom_node_append_child:
+ * @self: a #DaxDomNode
+ * @new_child: (transfer full): the node to append
+ * @err: return location for a #GError, or %NULL
+ *
+ * Appends @new_child to the children of @self, see
+ * dax_dom_node_insert_before().
+ *
+ * Return value: (transfer none): @new_child, or %NULL on error
+ */
+DaxDomNode *
+dax_dom_node_append_child (DaxDomNode  *self,
+                              DaxDomNode  *new_child,
+                              GError        **err)
+{
+    return dax_dom_node_insert_before (self, new_child, NULL, err);
+}
+
+/**
+ * dax_dom_node_insert_before:
+ * @self: a #DaxDomNode
+ * @new_child: (transfer full): the node to insert
+ * @ref_child: (allow-none): the child of @self to insert @new_child before,
+ *   %NULL to append it
+ * @err: return location for a #GError, or %NULL
+ *
+ * Inserts @new_child in the children of @self. The tree takes over the
+ * reference of the caller on @new_child. Like in the DOM, a node that is
+ * already in the tree is moved, the reference of the caller is released
+ * then as the tree already holds one. On error, the reference of the caller
+ * is left untouched.
+ *
+ * Return value: (transfer none): @new_child, or %NULL on error
+ */
 DaxDomNode *
 dax_dom_node_insert_before(DaxDomNode  *self,
-                              DaxDomNode  *unused(new_child),
-                              DaxDomNode  *unused(ref_child),
-                              GError        **unused(err))
+                              DaxDomNode  *new_child,
+                              DaxDomNode  *ref_child,
+                              GError        **err)
 {
+    DaxDomDocument *document;
+    DaxDomNode *ancestor;
+    gboolean moved;
+
     g_return_val_if_fail(DAX_IS_DOM_NODE(self), NULL);
+    g_return_val_if_fail(DAX_IS_DOM_NODE(new_child), NULL);
+
+    if (G_UNLIKELY (ref_child && ref_child->parent_node != self)) {
+        g_set_error (err,
+                     DAX_DOM_EXCEPTION_ERROR,
+                     DAX_DOM_EXCEPTION_ERROR_NOT_FOUND,
+                     "The reference node is not a child of this node");
+        return NULL;
+    }
 
-    g_warning("Not implemented");
+    /* only a node with children can be an ancestor of self, the parser
+     * appends childless nodes to very deep trees */
+    if (new_child == self || new_child->first_child) {
+        for (ancestor = self; ancestor; ancestor = ancestor->parent_node)
+            if (G_UNLIKELY (ancestor == new_child)) {
+                g_set_error (err,
+                             DAX_DOM_EXCEPTION_ERROR,
+                             DAX_DOM_EXCEPTION_ERROR_HIERARCHY_REQUEST,
+                             "Cannot insert a node in its own subtree");
+                return NULL;
+            }
+    }
 
-    return NULL;
+    /* already where it should be */
+    if (new_child == ref_child) {
+        g_object_unref (new_child);
+        return new_child;
+    }
+
+    moved = new_child->parent_node != NULL;
+    if (moved)
+        dax_dom_node_detach (new_child);
+
+    new_child->parent_node = self;
+    new_child->next_sibling = ref_child;
+    if (ref_child) {
+        new_child->previous_sibling = ref_child->previous_sibling;
+        ref_child->previous_sibling = new_child;
+    } else {
+        new_child->previous_sibling = self->last_child;
+        self->last_child = new_child;
+    }
+    if (new_child->previous_sibling)
+        new_child->previous_sibling->next_sibling = new_child;
+    else
+        self->first_child = new_child;
+
+    document = dax_dom_node_get_document (self);
+    if (document)
+        _dax_dom_document_signal_node_inserted (document, new_child);
+
+    /* the reference the tree had before the move is kept */
+    if (moved)
+        g_object_unref (new_child);
+
+    return new_child;
 }
 
+/**
+ * dax_dom_node_remove_child:
+ * @self: a #DaxDomNode
+ * @old_child: the child of @self to remove
+ * @err: return location for a #GError, or %NULL
+ *
+ * Removes @old_child from the children of @self. The reference the tree had
+ * on @old_child is given to the caller.
+ *
+ * Return value: (transfer full): @old_child, or %NULL on error
+ */
 DaxDomNode *
 dax_dom_node_remove_child(DaxDomNode  *self,
-                         DaxDomNode  *unused(old_child),
-                         GError        **unused(err))
+                         DaxDomNode  *old_child,
+                         GError        **err)
 {
     g_return_val_if_fail(DAX_IS_DOM_NODE(self), NULL);
+    g_return_val_if_fail(DAX_IS_DOM_NODE(old_child), NULL);
+
+    if (G_UNLIKELY (old_child->parent_node != self)) {
+        g_set_error (err,
+                     DAX_DOM_EXCEPTION_ERROR,
+                     DAX_DOM_EXCEPTION_ERROR_NOT_FOUND,
+                     "The node to remove is not a child of this node");
+        return NULL;
+    }
 
-    g_warning("Not implemented");
+    dax_dom_node_detach (old_child);
 
-    return NULL;
+    return old_child;
 }
 
 DaxDomNode *
@@ -237,9 +371,44 @@ dax_dom_node_set_property (GObject      *object,
     }
 }
 
+/* The tree owns its nodes. They are released from the leaves up without
+ * recursing as documents can be very deep. A node someone else still holds
+ * a reference on keeps its subtree */
+static void
+dax_dom_node_release_children (DaxDomNode *node)
+{
+    DaxDomNode *current = node->first_child;
+
+    while (current && current != node) {
+        DaxDomNode *parent, *next;
+
+        if (current->first_child && G_OBJECT (current)->ref_count == 1) {
+            current = current->first_child;
+            continue;
+        }
+
+        parent = current->parent_node;
+        next = current->next_sibling;
+
+        parent->first_child = next;
+        if (next)
+            next->previous_sibling = NULL;
+        else
+            parent->last_child = NULL;
+        current->parent_node = NULL;
+        current->next_sibling = NULL;
+
+        g_object_unref (current);
+
+        current = next ? next : parent;
+    }
+}
+
 static void
 dax_dom_node_dispose (GObject *object)
 {
+    dax_dom_node_release_children (DAX_DOM_NODE (object));
+
     G_OBJECT_CLASS (dax_dom_node_parent_class)->dispose (object);
 }
 
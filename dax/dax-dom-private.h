@@ -23,8 +23,11 @@
 
 #include <glib.h>
 
+#include "dax-arena.h"
+#include "dax-string-pool.h"
 #include "dax-xml-private.h"
 #include "dax-xml-event.h"
+#include "dax-dom-character-data.h"
 #include "dax-dom-document.h"
 #include "dax-dom-element.h"
 
@@ -49,9 +52,49 @@ gboolean        _dax_dom_document_set_element_id    (DaxDomDocument *document,
 void            _dax_dom_document_unset_id          (DaxDomDocument *document,
                                                      const gchar    *id);
 
+const GPtrArray *
+                _dax_dom_document_get_namespaces    (DaxDomDocument *document);
+
+DaxArena *      _dax_dom_document_get_arena         (DaxDomDocument *document);
+const gchar *   _dax_dom_document_intern_string     (DaxDomDocument *document,
+                                                     const gchar    *string);
+void            _dax_dom_document_begin_parsing     (DaxDomDocument *document);
+void            _dax_dom_document_end_parsing       (DaxDomDocument *document);
+gboolean        _dax_dom_document_is_parsing        (DaxDomDocument *document);
+
+void    _dax_dom_document_signal_node_inserted  (DaxDomDocument *document,
+                                                 DaxDomNode     *node);
+void    _dax_dom_document_signal_node_removed   (DaxDomDocument *document,
+                                                 DaxDomNode     *node,
+                                                 DaxDomNode     *former_parent);
+
+/* dax-binary.c */
+
+gboolean         _dax_binary_has_magic          (const gchar  *contents,
+                                                 gsize         length);
+DaxDomDocument * _dax_binary_load_mapped_file   (GMappedFile  *mapped_file,
+                                                 const gchar  *base_iri,
+                                                 gboolean      defer_setup,
+                                                 GError      **error);
+
+/* dax-dom-character-data.c */
+
+void    _dax_dom_character_data_set_static_data (DaxDomCharacterData *char_data,
+                                                 const gchar         *data,
+                                                 DaxArena            *arena);
+
 /* dax-dom-element.c */
 
 void            _dax_dom_element_signal_parsed  (DaxDomElement *element);
+const gchar *   _dax_dom_element_get_xml_base   (DaxDomElement *element);
+void            _dax_dom_element_set_string     (DaxDomElement  *element,
+                                                 const gchar   **field,
+                                                 const gchar    *string);
+
+/* dax-parser.c */
+
+void            _dax_dom_document_setup_js      (DaxDomDocument *document);
+void            _dax_dom_document_finish_setup  (DaxDomDocument *document);
 
 G_END_DECLS
 
@@ -19,6 +19,7 @@
  */
 
 #include "dax-dom.h"
+#include "dax-dom-private.h"
 
 #include "dax-internals.h"
 #include "dax-enum-types.h"
@@ -52,9 +53,10 @@ enum
 struct _DaxElementAnimationPrivate
 {
     DaxAnimationAttributeType attribute_type;
-    gchar *attribute_name;
-    gchar *from;
-    gchar *to;
+    /* see _dax_dom_element_set_string() */
+    const gchar *attribute_name;
+    const gchar *from;
+    const gchar *to;
     DaxDuration *duration;
     DaxRepeatCount *repeat_count;
     gchar *href;
@@ -137,13 +139,19 @@ dax_element_animation_set_property (GObject      *object,
         priv->attribute_type = g_value_get_enum (value);
         break;
     case PROP_ATTRIBUTE_NAME:
-        priv->attribute_name = g_strdup (g_value_get_string (value));
+        _dax_dom_element_set_string (DAX_DOM_ELEMENT (object),
+                                     &priv->attribute_name,
+                                     g_value_get_string (value));
         break;
     case PROP_FROM:
-        priv->from = g_strdup (g_value_get_string (value));
+        _dax_dom_element_set_string (DAX_DOM_ELEMENT (object),
+                                     &priv->from,
+                                     g_value_get_string (value));
         break;
     case PROP_TO:
-        priv->to = g_strdup (g_value_get_string (value));
+        _dax_dom_element_set_string (DAX_DOM_ELEMENT (object),
+                                     &priv->to,
+                                     g_value_get_string (value));
         break;
     case PROP_DURATION:
         dax_element_animation_set_duration (self, g_value_get_boxed (value));
@@ -173,9 +181,6 @@ dax_element_animation_finalize (GObject *object)
     DaxElementAnimation *self = DAX_ELEMENT_ANIMATION (object);
     DaxElementAnimationPrivate *priv = self->priv;
 
-    g_free (priv->attribute_name);
-    g_free (priv->from);
-    g_free (priv->to);
     dax_duration_free (priv->duration);
     g_free (priv->href);
 
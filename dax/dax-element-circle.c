@@ -20,6 +20,7 @@
 #include "dax-internals.h"
 #include "dax-private.h"
 #include "dax-paramspec.h"
+#include "dax-utils.h"
 #include "dax-element-circle.h"
 
 G_DEFINE_TYPE (DaxElementCircle, dax_element_circle, DAX_TYPE_ELEMENT)
@@ -35,7 +36,9 @@ enum
 
     PROP_CX,
     PROP_CY,
-    PROP_RADIUS
+    PROP_RADIUS,
+
+    PROP_TRANSFORM
 };
 
 struct _DaxElementCirclePrivate
@@ -43,6 +46,8 @@ struct _DaxElementCirclePrivate
     ClutterUnits *cx;
     ClutterUnits *cy;
     ClutterUnits *radius;
+    DaxMatrix transform;
+    gboolean has_transform;
 };
 
 static void
@@ -108,6 +113,10 @@ dax_element_circle_get_property (GObject    *object,
     case PROP_RADIUS:
         clutter_value_set_units (value, priv->radius);
         break;
+    case PROP_TRANSFORM:
+        g_value_set_boxed (value,
+                           priv->has_transform ? &priv->transform : NULL);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -133,6 +142,15 @@ dax_element_circle_set_property (GObject      *object,
         dax_element_circle_set_radius (self,
                                           clutter_value_get_units (value));
         break;
+    case PROP_TRANSFORM:
+    {
+        const DaxMatrix *transform = g_value_get_boxed (value);
+
+        self->priv->has_transform = transform != NULL;
+        if (transform)
+            self->priv->transform = *transform;
+        break;
+    }
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -198,6 +216,10 @@ dax_element_circle_class_init (DaxElementCircleClass *klass)
                                   DAX_PARAM_NONE,
                                   svg_ns);
     g_object_class_install_property (object_class, PROP_RADIUS, pspec);
+
+    _dax_utils_install_properties (object_class,
+                                   _DAX_PROP_TRANSFORM, PROP_TRANSFORM,
+                                   0);
 }
 
 static void
@@ -243,3 +265,14 @@ dax_element_circle_get_r (DaxElementCircle *circle)
 
     return circle->priv->radius;
 }
+
+const DaxMatrix *
+dax_element_circle_get_transform (DaxElementCircle *circle)
+{
+    DaxElementCirclePrivate *priv;
+
+    g_return_val_if_fail (DAX_IS_ELEMENT_CIRCLE (circle), NULL);
+
+    priv = circle->priv;
+    return priv->has_transform ? &priv->transform : NULL;
+}
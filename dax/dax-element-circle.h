@@ -26,6 +26,7 @@
 #include <glib-object.h>
 
 #include "dax-element.h"
+#include "dax-types.h"
 
 G_BEGIN_DECLS
 
@@ -74,6 +75,8 @@ DaxDomElement *     dax_element_circle_new       (void);
 ClutterUnits *      dax_element_circle_get_cx    (DaxElementCircle *circle);
 ClutterUnits *      dax_element_circle_get_cy    (DaxElementCircle *circle);
 ClutterUnits *      dax_element_circle_get_r     (DaxElementCircle *circle);
+const DaxMatrix *   dax_element_circle_get_transform
+                                                 (DaxElementCircle *circle);
 
 G_END_DECLS
 
@@ -36,7 +36,8 @@ enum
 
 struct _DaxElementGPrivate
 {
-    DaxMatrix *transform;
+    DaxMatrix transform;
+    gboolean has_transform;
 };
 
 static void
@@ -51,7 +52,8 @@ dax_element_g_get_property (GObject    *object,
     switch (property_id)
     {
     case PROP_TRANSFORM:
-        g_value_set_boxed (value, priv->transform);
+        g_value_set_boxed (value,
+                           priv->has_transform ? &priv->transform : NULL);
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -70,10 +72,14 @@ dax_element_g_set_property (GObject      *object,
     switch (property_id)
     {
     case PROP_TRANSFORM:
-        if (priv->transform)
-            dax_matrix_free (priv->transform);
-        priv->transform = dax_matrix_deep_copy (g_value_get_boxed (value));
+    {
+        const DaxMatrix *transform = g_value_get_boxed (value);
+
+        priv->has_transform = transform != NULL;
+        if (transform)
+            priv->transform = *transform;
         break;
+    }
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -123,7 +129,28 @@ dax_element_g_new (void)
 const DaxMatrix *
 dax_element_g_get_transform (DaxElementG *g)
 {
+    DaxElementGPrivate *priv;
+
     g_return_val_if_fail (DAX_IS_ELEMENT_G (g), NULL);
 
-    return g->priv->transform;
+    priv = g->priv;
+    return priv->has_transform ? &priv->transform : NULL;
+}
+
+/* Same as setting the "transform" property without the boxed copies, used
+ * to update the transform at every frame of an animation */
+void
+dax_element_g_set_transform (DaxElementG     *g,
+                             const DaxMatrix *transform)
+{
+    DaxElementGPrivate *priv;
+
+    g_return_if_fail (DAX_IS_ELEMENT_G (g));
+
+    priv = g->priv;
+    priv->has_transform = transform != NULL;
+    if (transform)
+        priv->transform = *transform;
+
+    g_object_notify (G_OBJECT (g), "transform");
 }
@@ -66,6 +66,8 @@ GType		    dax_element_g_get_type	(void) G_GNUC_CONST;
 
 DaxDomElement *	    dax_element_g_new	        (void);
 const DaxMatrix *   dax_element_g_get_transform (DaxElementG *g);
+void                dax_element_g_set_transform (DaxElementG     *g,
+                                                 const DaxMatrix *transform);
 
 G_END_DECLS
 
@@ -18,10 +18,9 @@
  * along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <string.h>
-
 #include "dax-dom.h"
 #include "dax-internals.h"
+#include "dax-debug.h"
 #include "dax-private.h"
 #include "dax-enum-types.h"
 #include "dax-paramspec.h"
@@ -56,8 +55,63 @@ struct _DaxElementHandlerPrivate
 {
     DaxScriptType type;
     DaxXmlEventType event_type;
+
+    /* the handler code is compiled once and kept until it changes */
+    DaxJsContext *js_context;           /* kept alive by the listener */
+    DaxJsFunctionListener *listener;
+    gchar *source;
 };
 
+static void
+dax_element_handler_release_listener (DaxElementHandler *handler)
+{
+    DaxElementHandlerPrivate *priv = handler->priv;
+
+    if (priv->listener) {
+        g_object_unref (priv->listener);
+        priv->listener = NULL;
+    }
+
+    priv->js_context = NULL;
+    g_free (priv->source);
+    priv->source = NULL;
+}
+
+static DaxXmlEventListener *
+dax_element_handler_get_listener (DaxElementHandler *handler,
+                                  DaxJsContext      *js_context)
+{
+    DaxElementHandlerPrivate *priv = handler->priv;
+    DaxDomNode *text;
+    const gchar *source;
+
+    text = dax_dom_node_get_first_child (DAX_DOM_NODE (handler));
+    if (text == NULL || !DAX_IS_DOM_TEXT (text))
+        return NULL;
+
+    source = dax_dom_character_data_get_data (DAX_DOM_CHARACTER_DATA (text));
+    if (priv->listener &&
+        priv->js_context == js_context &&
+        g_strcmp0 (priv->source, source) == 0)
+    {
+        return DAX_XML_EVENT_LISTENER (priv->listener);
+    }
+
+    dax_element_handler_release_listener (handler);
+
+    DAX_NOTE (SCRIPT, "compiling handler %p", handler);
+
+    priv->listener = dax_js_function_listener_new_from_code (js_context,
+                                                             source);
+    if (priv->listener == NULL)
+        return NULL;
+
+    priv->source = g_strdup (source);
+    priv->js_context = js_context;
+
+    return DAX_XML_EVENT_LISTENER (priv->listener);
+}
+
 /*
  * DaxXmlEventListener implementation
  */
@@ -71,18 +125,17 @@ dax_element_handler_handle_event (DaxXmlEventListener *listener,
     DaxDomNode *node;
     DaxDomDocument *document;
     DaxJsContext *js_context;
-    DaxJsObject *event;
-    gchar *code;
+    DaxXmlEventListener *compiled;
 
     target = dax_element_handler_get_target (handler);
     node = DAX_DOM_NODE (target);
     document = node->owner_document;
     js_context = dax_dom_document_get_js_context (document);
-    code = dax_element_handler_get_code (handler);
-    event = dax_js_context_new_object_from_xml_event (js_context, xml_event);
+    compiled = dax_element_handler_get_listener (handler, js_context);
+    if (compiled == NULL)
+        return;
 
-    dax_js_context_eval (js_context, code, strlen (code), "svg", NULL, NULL);
-    dax_js_context_call_function (js_context, "__dax_handler", "o", event);
+    dax_xml_event_listener_handle_event (compiled, xml_event);
 }
 
 static void
@@ -142,6 +195,8 @@ dax_element_handler_set_property (GObject      *object,
 static void
 dax_element_handler_dispose (GObject *object)
 {
+    dax_element_handler_release_listener (DAX_ELEMENT_HANDLER (object));
+
     G_OBJECT_CLASS (dax_element_handler_parent_class)->dispose (object);
 }
 
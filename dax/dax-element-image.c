@@ -17,6 +17,7 @@
  */
 
 #include "dax-dom.h"
+#include "dax-dom-private.h"
 
 #include "dax-cache.h"
 #include "dax-paramspec.h"
@@ -43,7 +44,9 @@ enum
     PROP_HEIGHT,
     PROP_PAR,
     PROP_HREF,
-    PROP_TYPE
+    PROP_TYPE,
+
+    PROP_TRANSFORM
 };
 
 struct _DaxElementImagePrivate
@@ -57,7 +60,9 @@ struct _DaxElementImagePrivate
     ClutterUnits *height;
     DaxPreserveAspectRatio *par;
     gchar *href;
-    gchar *type;
+    const gchar *type;          /* see _dax_dom_element_set_string() */
+    DaxMatrix transform;
+    gboolean has_transform;
 };
 
 static void
@@ -125,9 +130,9 @@ dax_element_image_set_par (DaxElementImage              *image,
  */
 
 static void
-on_cache_entry_ready (DaxCacheEntry   *entry,
-                      GParamSpec      *pspec,
-                      DaxDomElement   *element)
+on_cache_entry_decoded (DaxCacheEntry   *entry,
+                        GParamSpec      *pspec,
+                        DaxDomElement   *element)
 {
     dax_dom_element_set_loaded (element, TRUE);
 }
@@ -143,10 +148,13 @@ dax_element_image_parsed (DaxDomElement *element)
     priv->cached_file =
         dax_cache_get_entry_for_href (cache, element, priv->href);
 
-    if (!dax_cache_entry_is_ready (priv->cached_file)) {
+    /* the image is decoded in the background while the parsing goes on,
+     * we are loaded once the pixels are available */
+    if (!dax_cache_entry_is_decoded (priv->cached_file)) {
         dax_dom_element_set_loaded (element, FALSE);
-        g_signal_connect (priv->cached_file, "notify::ready",
-                          G_CALLBACK (on_cache_entry_ready), element);
+        g_signal_connect (priv->cached_file, "notify::pixbuf",
+                          G_CALLBACK (on_cache_entry_decoded), element);
+        dax_cache_entry_decode_image (priv->cached_file);
     }
 }
 
@@ -187,6 +195,11 @@ dax_element_image_get_property (GObject    *object,
         g_value_set_string (value, priv->type);
         break;
 
+    case PROP_TRANSFORM:
+        g_value_set_boxed (value,
+                           priv->has_transform ? &priv->transform : NULL);
+        break;
+
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -223,10 +236,21 @@ dax_element_image_set_property (GObject      *object,
         priv->href = g_value_dup_string (value);
         break;
     case PROP_TYPE:
-        g_free (priv->type);
-        priv->type = g_value_dup_string (value);
+        _dax_dom_element_set_string (DAX_DOM_ELEMENT (object),
+                                     &priv->type,
+                                     g_value_get_string (value));
         break;
 
+    case PROP_TRANSFORM:
+    {
+        const DaxMatrix *transform = g_value_get_boxed (value);
+
+        image->priv->has_transform = transform != NULL;
+        if (transform)
+            image->priv->transform = *transform;
+        break;
+    }
+
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -235,6 +259,18 @@ dax_element_image_set_property (GObject      *object,
 static void
 dax_element_image_dispose (GObject *object)
 {
+    DaxElementImage *image = (DaxElementImage *) object;
+    DaxElementImagePrivate *priv = image->priv;
+
+    /* cache entries are shared and can outlive us */
+    if (priv->cached_file) {
+        g_signal_handlers_disconnect_by_func (priv->cached_file,
+                                              on_cache_entry_decoded,
+                                              image);
+        g_object_unref (priv->cached_file);
+        priv->cached_file = NULL;
+    }
+
     G_OBJECT_CLASS (dax_element_image_parent_class)->dispose (object);
 }
 
@@ -252,7 +288,6 @@ dax_element_image_finalize (GObject *object)
     dax_preserve_aspect_ratio_free (priv->par);
 
     g_free (priv->href);
-    g_free (priv->type);
 
     G_OBJECT_CLASS (dax_element_image_parent_class)->finalize (object);
 }
@@ -338,6 +373,10 @@ dax_element_image_class_init (DaxElementImageClass *klass)
                                    DAX_PARAM_ANIMATABLE,
                                    svg_ns);
     g_object_class_install_property (object_class, PROP_TYPE, pspec);
+
+    _dax_utils_install_properties (object_class,
+                                   _DAX_PROP_TRANSFORM, PROP_TRANSFORM,
+                                   0);
 }
 
 static void
@@ -408,3 +447,14 @@ dax_element_image_get_cache_entry (DaxElementImage *image)
 
     return image->priv->cached_file;
 }
+
+const DaxMatrix *
+dax_element_image_get_transform (DaxElementImage *image)
+{
+    DaxElementImagePrivate *priv;
+
+    g_return_val_if_fail (DAX_IS_ELEMENT_IMAGE (image), NULL);
+
+    priv = image->priv;
+    return priv->has_transform ? &priv->transform : NULL;
+}
@@ -26,6 +26,7 @@
 #include <glib-object.h>
 
 #include "dax-element.h"
+#include "dax-types.h"
 
 G_BEGIN_DECLS
 
@@ -77,6 +78,7 @@ ClutterUnits *          dax_element_image_get_y             (DaxElementImage *im
 ClutterUnits *          dax_element_image_get_width         (DaxElementImage *image);
 ClutterUnits *          dax_element_image_get_height        (DaxElementImage *image);
 const DaxCacheEntry *   dax_element_image_get_cache_entry   (DaxElementImage *image);
+const DaxMatrix *       dax_element_image_get_transform     (DaxElementImage *image);
 
 G_END_DECLS
 
@@ -19,6 +19,7 @@
 #include "dax-internals.h"
 #include "dax-private.h"
 #include "dax-paramspec.h"
+#include "dax-utils.h"
 #include "dax-element-line.h"
 
 G_DEFINE_TYPE (DaxElementLine, dax_element_line, DAX_TYPE_ELEMENT)
@@ -34,13 +35,17 @@ enum {
     PROP_X1,
     PROP_Y1,
     PROP_X2,
-    PROP_Y2
+    PROP_Y2,
+
+    PROP_TRANSFORM
 };
 
 struct _DaxElementLinePrivate
 {
     ClutterUnits *x1, *y1;
     ClutterUnits *x2, *y2;
+    DaxMatrix transform;
+    gboolean has_transform;
 };
 
 static void
@@ -118,6 +123,10 @@ dax_element_line_get_property (GObject    *object,
     case PROP_Y2:
         clutter_value_set_units (value, priv->y2);
         break;
+    case PROP_TRANSFORM:
+        g_value_set_boxed (value,
+                           priv->has_transform ? &priv->transform : NULL);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -145,6 +154,15 @@ dax_element_line_set_property (GObject      *object,
     case PROP_Y2:
         dax_element_line_set_y2 (self, clutter_value_get_units (value));
         break;
+    case PROP_TRANSFORM:
+    {
+        const DaxMatrix *transform = g_value_get_boxed (value);
+
+        self->priv->has_transform = transform != NULL;
+        if (transform)
+            self->priv->transform = *transform;
+        break;
+    }
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -214,6 +232,10 @@ dax_element_line_class_init (DaxElementLineClass *klass)
                                   DAX_PARAM_NONE,
                                   svg_ns);
     g_object_class_install_property (object_class, PROP_Y2, pspec);
+
+    _dax_utils_install_properties (object_class,
+                                   _DAX_PROP_TRANSFORM, PROP_TRANSFORM,
+                                   0);
 }
 
 static void
@@ -259,3 +281,14 @@ dax_element_line_get_y2 (const DaxElementLine *line)
 
     return line->priv->y2;
 }
+
+const DaxMatrix *
+dax_element_line_get_transform (DaxElementLine *line)
+{
+    DaxElementLinePrivate *priv;
+
+    g_return_val_if_fail (DAX_IS_ELEMENT_LINE (line), NULL);
+
+    priv = line->priv;
+    return priv->has_transform ? &priv->transform : NULL;
+}
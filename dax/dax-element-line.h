@@ -27,6 +27,7 @@
 #include <clutter/clutter.h>
 
 #include "dax-element.h"
+#include "dax-types.h"
 
 G_BEGIN_DECLS
 
@@ -75,6 +76,7 @@ ClutterUnits *      dax_element_line_get_x1     (const DaxElementLine *line);
 ClutterUnits *      dax_element_line_get_y1     (const DaxElementLine *line);
 ClutterUnits *      dax_element_line_get_x2     (const DaxElementLine *line);
 ClutterUnits *      dax_element_line_get_y2     (const DaxElementLine *line);
+const DaxMatrix *   dax_element_line_get_transform (DaxElementLine *line);
 
 G_END_DECLS
 
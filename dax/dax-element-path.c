@@ -19,6 +19,7 @@
  */
 
 #include "dax-internals.h"
+#include "dax-path.h"
 #include "dax-types.h"
 #include "dax-utils.h"
 
@@ -41,8 +42,9 @@ enum
 
 struct _DaxElementPathPrivate
 {
-    ClutterPath2D *path;
-    DaxMatrix *transform;
+    DaxPath *path;
+    DaxMatrix transform;
+    gboolean has_transform;
 };
 
 static void
@@ -60,7 +62,8 @@ dax_element_path_get_property (GObject    *object,
         g_value_set_object (value, priv->path);
         break;
     case PROP_TRANSFORM:
-        g_value_set_boxed (value, priv->transform);
+        g_value_set_boxed (value,
+                           priv->has_transform ? &priv->transform : NULL);
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -81,13 +84,17 @@ dax_element_path_set_property (GObject      *object,
     case PROP_PATH:
         if (priv->path)
             g_object_unref (priv->path);
-        priv->path = g_object_ref (g_value_get_object (value));
+        priv->path = g_value_dup_object (value);
         break;
     case PROP_TRANSFORM:
-        if (priv->transform)
-            dax_matrix_free (priv->transform);
-        priv->transform = dax_matrix_deep_copy (g_value_get_boxed (value));
+    {
+        const DaxMatrix *transform = g_value_get_boxed (value);
+
+        priv->has_transform = transform != NULL;
+        if (transform)
+            priv->transform = *transform;
         break;
+    }
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -102,6 +109,12 @@ dax_element_path_dispose (GObject *object)
 static void
 dax_element_path_finalize (GObject *object)
 {
+    DaxElementPath *self = DAX_ELEMENT_PATH (object);
+    DaxElementPathPrivate *priv = self->priv;
+
+    if (priv->path)
+        g_object_unref (priv->path);
+
     G_OBJECT_CLASS (dax_element_path_parent_class)->finalize (object);
 }
 
@@ -121,7 +134,7 @@ dax_element_path_class_init (DaxElementPathClass *klass)
     pspec = g_param_spec_object ("d",
                                 "Path data",
                                 "", /* FIXME */
-                                CLUTTER_TYPE_PATH_2D,
+                                DAX_TYPE_PATH,
                                 DAX_GPARAM_READWRITE);
     g_object_class_install_property (object_class, PROP_PATH, pspec);
 
@@ -142,18 +155,45 @@ dax_element_path_new (void)
     return g_object_new (DAX_TYPE_ELEMENT_PATH, NULL);
 }
 
-ClutterPath2D *
+DaxPath *
 dax_element_path_get_path (DaxElementPath *self)
 {
+    DaxElementPathPrivate *priv;
+
     g_return_val_if_fail (DAX_IS_ELEMENT_PATH (self), NULL);
 
-    return g_object_ref (self->priv->path);
+    priv = self->priv;
+    if (priv->path == NULL)
+        priv->path = dax_path_new ();
+
+    return g_object_ref (priv->path);
 }
 
 const DaxMatrix *
 dax_element_path_get_transform (DaxElementPath *path)
 {
+    DaxElementPathPrivate *priv;
+
     g_return_val_if_fail (DAX_IS_ELEMENT_PATH (path), NULL);
 
-    return path->priv->transform;
+    priv = path->priv;
+    return priv->has_transform ? &priv->transform : NULL;
+}
+
+/* Same as setting the "transform" property without the boxed copies, used
+ * to update the transform at every frame of an animation */
+void
+dax_element_path_set_transform (DaxElementPath  *path,
+                                const DaxMatrix *transform)
+{
+    DaxElementPathPrivate *priv;
+
+    g_return_if_fail (DAX_IS_ELEMENT_PATH (path));
+
+    priv = path->priv;
+    priv->has_transform = transform != NULL;
+    if (transform)
+        priv->transform = *transform;
+
+    g_object_notify (G_OBJECT (path), "transform");
 }
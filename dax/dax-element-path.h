@@ -29,6 +29,7 @@
 #include <clutter/clutter.h>
 
 #include "dax-element.h"
+#include "dax-path.h"
 
 G_BEGIN_DECLS
 
@@ -72,8 +73,10 @@ struct _DaxElementPathClass
 GType               dax_element_path_get_type       (void) G_GNUC_CONST;
 
 DaxDomElement *     dax_element_path_new            (void);
-ClutterPath2D *     dax_element_path_get_path       (DaxElementPath *self);
+DaxPath *           dax_element_path_get_path       (DaxElementPath *self);
 const DaxMatrix *   dax_element_path_get_transform  (DaxElementPath *path);
+void                dax_element_path_set_transform  (DaxElementPath  *path,
+                                                     const DaxMatrix *transform);
 
 G_END_DECLS
 
@@ -18,6 +18,7 @@
 
 #include "dax-internals.h"
 #include "dax-knot-sequence.h"
+#include "dax-utils.h"
 #include "dax-element-polyline.h"
 
 G_DEFINE_TYPE (DaxElementPolyline,
@@ -32,12 +33,16 @@ G_DEFINE_TYPE (DaxElementPolyline,
 enum {
     PROP_0,
 
-    PROP_POINTS
+    PROP_POINTS,
+
+    PROP_TRANSFORM
 };
 
 struct _DaxElementPolylinePrivate
 {
     DaxKnotSequence *knots;
+    DaxMatrix transform;
+    gboolean has_transform;
 };
 
 static void
@@ -54,6 +59,10 @@ dax_element_polyline_get_property (GObject    *object,
     case PROP_POINTS:
         g_value_set_object (value, priv->knots);
         break;
+    case PROP_TRANSFORM:
+        g_value_set_boxed (value,
+                           priv->has_transform ? &priv->transform : NULL);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -73,8 +82,17 @@ dax_element_polyline_set_property (GObject      *object,
     case PROP_POINTS:
         if (priv->knots)
             g_object_unref (priv->knots);
-        priv->knots = g_value_get_object (value);
+        priv->knots = g_value_dup_object (value);
+        break;
+    case PROP_TRANSFORM:
+    {
+        const DaxMatrix *transform = g_value_get_boxed (value);
+
+        polyline->priv->has_transform = transform != NULL;
+        if (transform)
+            polyline->priv->transform = *transform;
         break;
+    }
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -89,6 +107,12 @@ dax_element_polyline_dispose (GObject *object)
 static void
 dax_element_polyline_finalize (GObject *object)
 {
+    DaxElementPolyline *polyline = DAX_ELEMENT_POLYLINE (object);
+    DaxElementPolylinePrivate *priv = polyline->priv;
+
+    if (priv->knots)
+        g_object_unref (priv->knots);
+
     G_OBJECT_CLASS (dax_element_polyline_parent_class)->finalize (object);
 }
 
@@ -112,6 +136,10 @@ dax_element_polyline_class_init (DaxElementPolylineClass *klass)
                                  DAX_TYPE_KNOT_SEQUENCE,
                                  DAX_GPARAM_READWRITE);
     g_object_class_install_property (object_class, PROP_POINTS, pspec);
+
+    _dax_utils_install_properties (object_class,
+                                   _DAX_PROP_TRANSFORM, PROP_TRANSFORM,
+                                   0);
 }
 
 static void
@@ -129,3 +157,14 @@ dax_element_polyline_new (void)
 {
     return g_object_new (DAX_TYPE_ELEMENT_POLYLINE, NULL);
 }
+
+const DaxMatrix *
+dax_element_polyline_get_transform (DaxElementPolyline *polyline)
+{
+    DaxElementPolylinePrivate *priv;
+
+    g_return_val_if_fail (DAX_IS_ELEMENT_POLYLINE (polyline), NULL);
+
+    priv = polyline->priv;
+    return priv->has_transform ? &priv->transform : NULL;
+}
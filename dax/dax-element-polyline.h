@@ -26,6 +26,7 @@
 #include <glib-object.h>
 
 #include "dax-element.h"
+#include "dax-types.h"
 
 G_BEGIN_DECLS
 
@@ -74,6 +75,9 @@ GType dax_element_polyline_get_type (void) G_GNUC_CONST;
 
 DaxDomElement *dax_element_polyline_new (void);
 
+const DaxMatrix *
+dax_element_polyline_get_transform (DaxElementPolyline *polyline);
+
 G_END_DECLS
 
 #endif /* __DAX_ELEMENT_POLYLINE_H__ */
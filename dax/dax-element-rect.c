@@ -17,6 +17,7 @@
  */
 
 #include "dax-internals.h"
+#include "dax-utils.h"
 #include "dax-element-rect.h"
 
 G_DEFINE_TYPE (DaxElementRect, dax_element_rect, DAX_TYPE_ELEMENT)
@@ -35,6 +36,8 @@ enum {
     PROP_HEIGHT,
     PROP_RX,
     PROP_RY,
+
+    PROP_TRANSFORM
 };
 
 struct _DaxElementRectPrivate
@@ -45,6 +48,8 @@ struct _DaxElementRectPrivate
     ClutterUnits *height;
     ClutterUnits *rx;
     ClutterUnits *ry;
+    DaxMatrix transform;
+    gboolean has_transform;
 };
 
 void
@@ -170,6 +175,10 @@ dax_element_rect_get_property (GObject    *object,
     case PROP_RY:
         clutter_value_set_units (value, priv->ry);
         break;
+    case PROP_TRANSFORM:
+        g_value_set_boxed (value,
+                           priv->has_transform ? &priv->transform : NULL);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -203,6 +212,15 @@ dax_element_rect_set_property (GObject      *object,
     case PROP_RY:
         dax_element_rect_set_ry (rect, clutter_value_get_units (value));
         break;
+    case PROP_TRANSFORM:
+    {
+        const DaxMatrix *transform = g_value_get_boxed (value);
+
+        rect->priv->has_transform = transform != NULL;
+        if (transform)
+            rect->priv->transform = *transform;
+        break;
+    }
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -286,6 +304,10 @@ dax_element_rect_class_init (DaxElementRectClass *klass)
                                       0.0f,
                                       DAX_GPARAM_READWRITE);
     g_object_class_install_property (object_class, PROP_RY, pspec);
+
+    _dax_utils_install_properties (object_class,
+                                   _DAX_PROP_TRANSFORM, PROP_TRANSFORM,
+                                   0);
 }
 
 static void
@@ -343,3 +365,14 @@ gfloat dax_element_rect_set_ry_px (DaxElementRect  *self)
 {
     return clutter_units_to_pixels (self->priv->ry);
 }
+
+const DaxMatrix *
+dax_element_rect_get_transform (DaxElementRect *rect)
+{
+    DaxElementRectPrivate *priv;
+
+    g_return_val_if_fail (DAX_IS_ELEMENT_RECT (rect), NULL);
+
+    priv = rect->priv;
+    return priv->has_transform ? &priv->transform : NULL;
+}
@@ -27,6 +27,7 @@
 #include <clutter/clutter.h>
 
 #include "dax-element.h"
+#include "dax-types.h"
 
 G_BEGIN_DECLS
 
@@ -94,6 +95,7 @@ gfloat            dax_element_rect_get_width_px  (DaxElementRect  *self);
 gfloat            dax_element_rect_get_height_px (DaxElementRect  *self);
 gfloat            dax_element_rect_set_rx_px     (DaxElementRect  *self);
 gfloat            dax_element_rect_set_ry_px     (DaxElementRect  *self);
+const DaxMatrix * dax_element_rect_get_transform (DaxElementRect  *self);
 
 G_END_DECLS
 
@@ -133,8 +133,8 @@ dax_element_svg_set_property (GObject      *object,
         break;
     case PROP_VIEW_BOX:
         if (priv->view_box)
-            g_array_free (priv->view_box, TRUE);
-        priv->view_box = g_value_get_boxed (value);
+            g_array_unref (priv->view_box);
+        priv->view_box = g_value_dup_boxed (value);
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -17,10 +17,12 @@
  */
 
 #include "dax-dom-character-data.h"
+#include "dax-dom-private.h"
 #include "dax-enum-types.h"
 #include "dax-internals.h"
 #include "dax-private.h"
 #include "dax-paramspec.h"
+#include "dax-utils.h"
 #include "dax-element-text.h"
 
 G_DEFINE_TYPE (DaxElementText, dax_element_text, DAX_TYPE_ELEMENT)
@@ -42,6 +44,8 @@ enum {
     PROP_FONT_STYLE,
     PROP_FONT_WEIGHT,
     PROP_FONT_SIZE,
+
+    PROP_TRANSFORM
 };
 
 struct _DaxElementTextPrivate
@@ -51,10 +55,13 @@ struct _DaxElementTextPrivate
     DaxTextEditable editable;
     GArray *rotate;
 
-    gchar *font_family;
-    gchar *font_style;
-    gchar *font_weight;
-    gchar *font_size;
+    /* see _dax_dom_element_set_string() */
+    const gchar *font_family;
+    const gchar *font_style;
+    const gchar *font_weight;
+    const gchar *font_size;
+    DaxMatrix transform;
+    gboolean has_transform;
 };
 
 
@@ -93,6 +100,10 @@ dax_element_text_get_property (GObject    *object,
     case PROP_FONT_SIZE:
         g_value_set_string (value, priv->font_size);
         break;
+    case PROP_TRANSFORM:
+        g_value_set_boxed (value,
+                           priv->has_transform ? &priv->transform : NULL);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -111,38 +122,51 @@ dax_element_text_set_property (GObject      *object,
     {
     case PROP_X:
         if (priv->x)
-            g_array_free (priv->x, TRUE);
-        priv->x = g_value_get_boxed (value);
+            g_array_unref (priv->x);
+        priv->x = g_value_dup_boxed (value);
         break;
     case PROP_Y:
         if (priv->y)
-            g_array_free (priv->y, TRUE);
-        priv->y = g_value_get_boxed (value);
+            g_array_unref (priv->y);
+        priv->y = g_value_dup_boxed (value);
         break;
     case PROP_EDITABLE:
          priv->editable = g_value_get_enum (value);
         break;
     case PROP_ROTATE:
         if (priv->rotate)
-            g_array_free (priv->rotate, TRUE);
-        priv->rotate = g_value_get_boxed (value);
+            g_array_unref (priv->rotate);
+        priv->rotate = g_value_dup_boxed (value);
         break;
     case PROP_FONT_FAMILY:
-        g_free (priv->font_family);
-        priv->font_family = g_value_dup_string (value);
+        _dax_dom_element_set_string (DAX_DOM_ELEMENT (object),
+                                     &priv->font_family,
+                                     g_value_get_string (value));
         break;
     case PROP_FONT_STYLE:
-        g_free (priv->font_style);
-        priv->font_style = g_value_dup_string (value);
+        _dax_dom_element_set_string (DAX_DOM_ELEMENT (object),
+                                     &priv->font_style,
+                                     g_value_get_string (value));
         break;
     case PROP_FONT_WEIGHT:
-        g_free (priv->font_weight);
-        priv->font_weight = g_value_dup_string (value);
+        _dax_dom_element_set_string (DAX_DOM_ELEMENT (object),
+                                     &priv->font_weight,
+                                     g_value_get_string (value));
         break;
     case PROP_FONT_SIZE:
-        g_free (priv->font_size);
-        priv->font_size = g_value_dup_string (value);
+        _dax_dom_element_set_string (DAX_DOM_ELEMENT (object),
+                                     &priv->font_size,
+                                     g_value_get_string (value));
         break;
+    case PROP_TRANSFORM:
+    {
+        const DaxMatrix *transform = g_value_get_boxed (value);
+
+        self->priv->has_transform = transform != NULL;
+        if (transform)
+            self->priv->transform = *transform;
+        break;
+    }
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
@@ -161,11 +185,11 @@ dax_element_text_finalize (GObject *object)
     DaxElementTextPrivate *priv = self->priv;
 
     if (priv->x)
-        g_array_free (priv->x, TRUE);
+        g_array_unref (priv->x);
     if (priv->y)
-        g_array_free (priv->y, TRUE);
+        g_array_unref (priv->y);
     if (priv->rotate)
-        g_array_free (priv->rotate, TRUE);
+        g_array_unref (priv->rotate);
 
     G_OBJECT_CLASS (dax_element_text_parent_class)->finalize (object);
 }
@@ -260,6 +284,10 @@ dax_element_text_class_init (DaxElementTextClass *klass)
                                    DAX_PARAM_NONE,
                                    svg_ns);
     g_object_class_install_property (object_class, PROP_FONT_SIZE, pspec);
+
+    _dax_utils_install_properties (object_class,
+                                   _DAX_PROP_TRANSFORM, PROP_TRANSFORM,
+                                   0);
 }
 
 static void
@@ -354,3 +382,14 @@ dax_element_text_get_text (const DaxElementText *text)
 
     return g_string_free (string, FALSE);
 }
+
+const DaxMatrix *
+dax_element_text_get_transform (DaxElementText *text)
+{
+    DaxElementTextPrivate *priv;
+
+    g_return_val_if_fail (DAX_IS_ELEMENT_TEXT (text), NULL);
+
+    priv = text->priv;
+    return priv->has_transform ? &priv->transform : NULL;
+}
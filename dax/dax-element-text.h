@@ -27,6 +27,7 @@
 #include <glib-object.h>
 
 #include "dax-element.h"
+#include "dax-types.h"
 
 G_BEGIN_DECLS
 
@@ -82,6 +83,7 @@ GArray *        dax_element_text_get_y          (const DaxElementText *text);
 DaxTextEditable dax_element_text_get_editable   (const DaxElementText *text);
 const GArray *  dax_element_text_get_rotation   (const DaxElementText *text);
 gchar *         dax_element_text_get_text       (const DaxElementText *text);
+const DaxMatrix *dax_element_text_get_transform  (DaxElementText *text);
 
 G_END_DECLS
 
@@ -108,14 +108,17 @@ dax_element_traversal_get_child_element_count(DaxElementTraversal *self)
 
 GType dax_element_traversal_get_type(void)
 {
-    static GType element_traversal_type = 0;
-
-    if (!element_traversal_type)
-        element_traversal_type =
-            g_type_register_static_simple(G_TYPE_INTERFACE,
-                                          "DaxElementTraversal",
-                                          sizeof(DaxElementTraversalIface),
-                                          NULL, 0, NULL, 0);
+    static volatile gsize element_traversal_type = 0;
+
+    if (g_once_init_enter (&element_traversal_type)) {
+        GType type;
+
+        type = g_type_register_static_simple(G_TYPE_INTERFACE,
+                                             "DaxElementTraversal",
+                                             sizeof(DaxElementTraversalIface),
+                                             NULL, 0, NULL, 0);
+        g_once_init_leave (&element_traversal_type, type);
+    }
 
     return element_traversal_type;
 }
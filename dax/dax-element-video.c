@@ -19,6 +19,7 @@
  */
 
 #include "dax-dom.h"
+#include "dax-dom-private.h"
 
 #include "dax-paramspec.h"
 #include "dax-private.h"
@@ -56,7 +57,7 @@ struct _DaxElementVideoPrivate
     ClutterUnits *height;
     DaxPreserveAspectRatio *par;
     gchar *href;
-    gchar *type;
+    const gchar *type;          /* see _dax_dom_element_set_string() */
 
     gchar *uri;
 };
@@ -194,8 +195,9 @@ dax_element_video_set_property (GObject      *object,
         priv->href = g_value_dup_string (value);
         break;
     case PROP_TYPE:
-        g_free (priv->type);
-        priv->type = g_value_dup_string (value);
+        _dax_dom_element_set_string (DAX_DOM_ELEMENT (object),
+                                     &priv->type,
+                                     g_value_get_string (value));
         break;
 
     default:
@@ -223,7 +225,6 @@ dax_element_video_finalize (GObject *object)
     dax_preserve_aspect_ratio_free (priv->par);
 
     g_free (priv->href);
-    g_free (priv->type);
     g_free (priv->uri);
 
     G_OBJECT_CLASS (dax_element_video_parent_class)->finalize (object);
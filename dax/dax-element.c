@@ -25,6 +25,8 @@
 #include "dax-dom.h"
 #include "dax-internals.h"
 #include "dax-debug.h"
+#include "dax-binding.h"
+#include "dax-dom-private.h"
 #include "dax-private.h"
 #include "dax-paramspec.h"
 #include "dax-js-context.h"
@@ -63,14 +65,35 @@ enum
 
 struct _DaxElementPrivate
 {
-    ClutterColor *fill;
+    ClutterColor fill;
+    ClutterColor stroke;
+    guint has_fill : 1;
+    guint has_stroke : 1;
     gfloat fill_opacity;
-    ClutterColor *stroke;
-    gchar *style;
+    const gchar *style;         /* see _dax_dom_element_set_string() */
 
     gchar *onload_handler;
+
+    /* onload_handler, compiled the first time it is needed */
+    DaxJsContext *js_context;           /* kept alive by the listeners */
+    DaxJsFunctionListener *onload_listener;
 };
 
+static guint notify_signal_id;
+
+static void
+dax_element_release_handlers (DaxElement *element)
+{
+    DaxElementPrivate *priv = element->priv;
+
+    if (priv->onload_listener) {
+        g_object_unref (priv->onload_listener);
+        priv->onload_listener = NULL;
+    }
+
+    priv->js_context = NULL;
+}
+
 static void
 on_load_event (DaxElement *element,
                gboolean    loaded,
@@ -93,6 +116,7 @@ dax_element_set_onload_handler (DaxElement  *element,
 
     if (priv->onload_handler) {
         g_free (priv->onload_handler);
+        dax_element_release_handlers (element);
     } else {
         /* time to add the listener */
         DaxXmlEventTarget *target = DAX_XML_EVENT_TARGET (element);
@@ -104,11 +128,7 @@ dax_element_set_onload_handler (DaxElement  *element,
                                                  FALSE);
     }
 
-    priv->onload_handler = g_strdup_printf ("function __dax_handler(event) {"
-                                                "let evt=event;"
-                                                "%s"
-                                            "}",
-                                            script);
+    priv->onload_handler = g_strdup (script);
 
     if (dax_dom_element_is_loaded ((DaxDomElement *) element)) {
         on_load_event (element, TRUE, NULL);
@@ -132,8 +152,8 @@ dax_element_set_style (DaxElement  *element,
     gchar **props;
     guint i;
 
-    g_free (priv->style);
-    priv->style = g_strdup (style);
+    _dax_dom_element_set_string (DAX_DOM_ELEMENT (element), &priv->style,
+                                 style);
 
     props = g_strsplit (style, ";", 0);
 
@@ -155,6 +175,8 @@ dax_element_set_style (DaxElement  *element,
                                    value,
                                    NULL);
     }
+
+    g_strfreev (props);
 }
 
 /*
@@ -171,23 +193,48 @@ dax_element_get_document (DaxElement *element)
     return node->owner_document;
 }
 
+static DaxXmlEventListener *
+dax_element_compile_handler (DaxElement             *element,
+                             DaxJsContext           *js_context,
+                             DaxJsFunctionListener **listener,
+                             const gchar            *code)
+{
+    DaxElementPrivate *priv = element->priv;
+
+    if (priv->js_context != js_context) {
+        dax_element_release_handlers (element);
+        priv->js_context = js_context;
+    }
+
+    if (*listener == NULL) {
+        DAX_NOTE (SCRIPT, "compiling handler for %s",
+                  G_OBJECT_TYPE_NAME (element));
+
+        *listener = dax_js_function_listener_new_from_code (js_context, code);
+    }
+
+    return (DaxXmlEventListener *) *listener;
+}
+
 static void
 dax_element_handle_event (DaxXmlEventListener *listener,
                           DaxXmlEvent         *xml_event)
 {
     DaxElement *element = DAX_ELEMENT (listener);
     DaxElementPrivate *priv = element->priv;
-    DaxDomElement *target;
     DaxDomDocument *document;
     DaxJsContext *js_context;
-    DaxJsObject *event;
-    gchar *code;
+    DaxXmlEventListener *compiled;
 
-    target = (DaxDomElement *) element;
+    document = dax_element_get_document (element);
+    js_context = dax_dom_document_get_js_context (document);
 
     switch (xml_event->type) {
     case DAX_XML_EVENT_TYPE_LOAD:
-        code = priv->onload_handler;
+        compiled = dax_element_compile_handler (element,
+                                                js_context,
+                                                &priv->onload_listener,
+                                                priv->onload_handler);
         break;
 
     case DAX_XML_EVENT_TYPE_NONE:
@@ -198,12 +245,10 @@ dax_element_handle_event (DaxXmlEventListener *listener,
         return;
     }
 
-    document = dax_element_get_document (element);
-    js_context = dax_dom_document_get_js_context (document);
-    event = dax_js_context_new_object_from_xml_event (js_context, xml_event);
+    if (compiled == NULL)
+        return;
 
-    dax_js_context_eval (js_context, code, strlen (code), "svg", NULL, NULL);
-    dax_js_context_call_function (js_context, "__dax_handler", "o", event);
+    dax_xml_event_listener_handle_event (compiled, xml_event);
 }
 
 static void
@@ -227,6 +272,206 @@ dax_element_get_attribute (DaxDomElement *self,
     return NULL;
 }
 
+/*
+ * Attributes are set through a per-class table of setters. It maps the name
+ * of each writable property to a parser producing a GValue of the right type
+ * and to the set_property() of the class that installed it, skipping the
+ * property lookup and notification machinery of g_object_set_property().
+ * The table can only be built once the subclasses have installed their
+ * properties, so it is created the first time a class sets an attribute.
+ */
+
+typedef gboolean (*AttributeParser) (GParamSpec  *pspec,
+                                     const gchar *string,
+                                     DaxArena    *arena,
+                                     GValue      *value);
+
+typedef struct
+{
+    GParamSpec *pspec;
+    GQuark name_quark;
+    AttributeParser parse;
+    GObjectSetPropertyFunc set_property;
+} AttributeSetter;
+
+G_LOCK_DEFINE_STATIC (attribute_setters);
+
+static gboolean
+parse_string (GParamSpec  *pspec,
+              const gchar *string,
+              DaxArena    *arena,
+              GValue      *value)
+{
+    g_value_set_static_string (value, string);
+
+    return TRUE;
+}
+
+static gboolean
+parse_transform (GParamSpec  *pspec,
+                 const gchar *string,
+                 DaxArena    *arena,
+                 GValue      *value)
+{
+    GValue string_value = { 0, };
+    gboolean success;
+
+    /* we don't want to duplicate the string here */
+    g_value_init (&string_value, G_TYPE_STRING);
+    g_value_set_static_string (&string_value, string);
+
+    success = g_value_transform (&string_value, value);
+    g_value_unset (&string_value);
+
+    return success;
+}
+
+static gboolean
+parse_from_string (GParamSpec  *pspec,
+                   const gchar *string,
+                   DaxArena    *arena,
+                   GValue      *value)
+{
+    DaxParamSpecClass *pspec_klass;
+
+    pspec_klass = DAX_PARAM_SPEC_GET_CLASS (pspec);
+
+    return pspec_klass->from_string (pspec, string, value);
+}
+
+/* the arrays of paths and knot sequences live in the arena of the document
+ * when there is one */
+static gboolean
+parse_path (GParamSpec  *pspec,
+            const gchar *string,
+            DaxArena    *arena,
+            GValue      *value)
+{
+    if (arena)
+        g_value_take_object (value,
+                             _dax_path_new_from_string_in_arena (string,
+                                                                 arena));
+    else
+        g_value_take_object (value, dax_path_new_from_string (string));
+
+    return TRUE;
+}
+
+static gboolean
+parse_knot_sequence (GParamSpec  *pspec,
+                     const gchar *string,
+                     DaxArena    *arena,
+                     GValue      *value)
+{
+    DaxKnotSequence *seq;
+
+    if (arena)
+        seq = _dax_knot_sequence_new_from_string_in_arena (string, arena);
+    else
+        seq = dax_knot_sequence_new_from_string (string);
+    g_value_take_object (value, seq);
+
+    return TRUE;
+}
+
+static GHashTable *
+build_attribute_setters (GObjectClass *object_class)
+{
+    GHashTable *setters;
+    GParamSpec **pspecs;
+    guint n_pspecs, i;
+
+    setters = g_hash_table_new (g_str_hash, g_str_equal);
+
+    pspecs = g_object_class_list_properties (object_class, &n_pspecs);
+    for (i = 0; i < n_pspecs; i++) {
+        GParamSpec *pspec = pspecs[i];
+        GObjectClass *owner_class;
+        AttributeSetter *setter;
+
+        if (!(pspec->flags & G_PARAM_WRITABLE) ||
+            pspec->flags & G_PARAM_CONSTRUCT_ONLY)
+        {
+            continue;
+        }
+
+        owner_class = g_type_class_peek (pspec->owner_type);
+        if (owner_class == NULL || owner_class->set_property == NULL)
+            continue;
+
+        setter = g_new (AttributeSetter, 1);
+        setter->pspec = pspec;
+        setter->name_quark = g_quark_from_string (pspec->name);
+        setter->set_property = owner_class->set_property;
+
+        /* leave parse to NULL when there is no way to convert a string */
+        if (pspec->value_type == G_TYPE_STRING)
+            setter->parse = parse_string;
+        else if (pspec->value_type == DAX_TYPE_PATH)
+            setter->parse = parse_path;
+        else if (pspec->value_type == DAX_TYPE_KNOT_SEQUENCE)
+            setter->parse = parse_knot_sequence;
+        else if (g_value_type_transformable (G_TYPE_STRING,
+                                             pspec->value_type))
+            setter->parse = parse_transform;
+        else if (DAX_IS_PARAM_SPEC_ARRAY (pspec))
+            setter->parse = parse_from_string;
+        else
+            setter->parse = NULL;
+
+        g_hash_table_insert (setters, (gchar *) pspec->name, setter);
+    }
+    g_free (pspecs);
+
+    DAX_NOTE (PARSING, "built %u attribute setters for %s",
+              g_hash_table_size (setters),
+              G_OBJECT_CLASS_NAME (object_class));
+
+    return setters;
+}
+
+static const AttributeSetter *
+lookup_attribute_setter (GObjectClass *object_class,
+                         const gchar  *name)
+{
+    static GQuark setters_quark = 0;
+    GType type = G_OBJECT_CLASS_TYPE (object_class);
+    GHashTable *setters;
+
+    G_LOCK (attribute_setters);
+
+    if (G_UNLIKELY (setters_quark == 0))
+        setters_quark = g_quark_from_static_string ("dax-attribute-setters");
+
+    setters = g_type_get_qdata (type, setters_quark);
+    if (G_UNLIKELY (setters == NULL)) {
+        setters = build_attribute_setters (object_class);
+        g_type_set_qdata (type, setters_quark, setters);
+    }
+
+    G_UNLOCK (attribute_setters);
+
+    return g_hash_table_lookup (setters, name);
+}
+
+/* only emit notify when someone listens to it, the binding of the element
+ * is told directly otherwise */
+static void
+notify_attribute (GObject               *object,
+                  const AttributeSetter *setter)
+{
+    GParamSpec *pspec = setter->pspec;
+
+    if (g_signal_has_handler_pending (object, notify_signal_id,
+                                      setter->name_quark, FALSE) ||
+        g_signal_has_handler_pending (object, notify_signal_id, 0, FALSE))
+    {
+        g_object_notify (object, pspec->name);
+    }
+    else
+        _dax_binding_properties_changed (object, 1, &pspec);
+}
+
 static void
 dax_element_set_attribute (DaxDomElement  *self,
                            const gchar    *name,
@@ -234,45 +479,39 @@ dax_element_set_attribute (DaxDomElement  *self,
                            GError        **err)
 {
     GObjectClass *object_class= G_OBJECT_GET_CLASS (self);
+    DaxDomDocument *document = DAX_DOM_NODE (self)->owner_document;
+    DaxArena *arena = NULL;
+    const AttributeSetter *setter;
     GParamSpec *pspec;
-    GValue string_value = { 0, };
     GValue new_value = { 0, };
-    gboolean success;
 
-    pspec = g_object_class_find_property (object_class, name);
-    if (pspec == NULL) {
+    setter = lookup_attribute_setter (object_class, name);
+    if (setter == NULL) {
         /* FIXME exception */
         DAX_NOTE (PARSING, "Unsupported attribute %s for %s",
                   name,
                   G_OBJECT_CLASS_NAME (object_class));
         return;
     }
+    pspec = setter->pspec;
 
     /* skip leading white space */
     while (g_ascii_isspace (*value))
         value++;
 
-    /* we don't want to duplicate the string here */
-    g_value_init (&string_value, G_TYPE_STRING);
-    g_value_set_static_string (&string_value, value);
-
     /* this GValue holds the new value of the property we want to set */
     g_value_init (&new_value, pspec->value_type);
 
-    success = g_value_transform (&string_value, &new_value);
-
-    /* fallback to using the from_string() vfunc of DaxParamSpecClass */
-    if (success == FALSE && DAX_IS_PARAM_SPEC_ARRAY (pspec)) {
-        DaxParamSpecClass *pspec_klass;
+    if (document)
+        arena = _dax_dom_document_get_arena (document);
 
-        pspec_klass = DAX_PARAM_SPEC_GET_CLASS (pspec);
-        success = pspec_klass->from_string (pspec, value, &new_value);
-    }
-
-    if (success == FALSE) {
+    if (setter->parse == NULL ||
+        !setter->parse (pspec, value, arena, &new_value))
+    {
         /* FIXME exception ? */
         g_warning ("Could not transform a string into a %s",
                    g_type_name (pspec->value_type));
+        g_value_unset (&new_value);
         return;
     }
 
@@ -281,7 +520,11 @@ dax_element_set_attribute (DaxDomElement  *self,
               value,
               G_OBJECT_TYPE_NAME (self));
 
-    g_object_set_property (G_OBJECT (self), name, &new_value);
+    g_param_value_validate (pspec, &new_value);
+    setter->set_property (G_OBJECT (self), pspec->param_id, &new_value, pspec);
+    notify_attribute (G_OBJECT (self), setter);
+
+    g_value_unset (&new_value);
 }
 
 /*
@@ -300,10 +543,11 @@ dax_element_get_property (GObject    *object,
     switch (property_id)
     {
     case PROP_FILL:
-        clutter_value_set_color (value, priv->fill);
+        clutter_value_set_color (value, priv->has_fill ? &priv->fill : NULL);
         break;
     case PROP_STROKE:
-        clutter_value_set_color (value, priv->stroke);
+        clutter_value_set_color (value,
+                                 priv->has_stroke ? &priv->stroke : NULL);
         break;
     case PROP_FILL_OPACITY:
         g_value_set_float (value, priv->fill_opacity);
@@ -336,14 +580,18 @@ dax_element_set_property (GObject      *object,
     {
         const ClutterColor *color;
         color = clutter_value_get_color (value);
-        priv->fill = clutter_color_copy (color);
+        priv->has_fill = color != NULL;
+        if (color)
+            priv->fill = *color;
         break;
     }
     case PROP_STROKE:
     {
         const ClutterColor *color;
         color = clutter_value_get_color (value);
-        priv->stroke = clutter_color_copy (color);
+        priv->has_stroke = color != NULL;
+        if (color)
+            priv->stroke = *color;
         break;
     }
     case PROP_FILL_OPACITY:
@@ -365,15 +613,54 @@ dax_element_set_property (GObject      *object,
 static void
 dax_element_dispose (GObject *object)
 {
+    dax_element_release_handlers (DAX_ELEMENT (object));
+
     G_OBJECT_CLASS (dax_element_parent_class)->dispose (object);
 }
 
 static void
 dax_element_finalize (GObject *object)
 {
+    DaxElementPrivate *priv = DAX_ELEMENT (object)->priv;
+
+    g_free (priv->onload_handler);
+
     G_OBJECT_CLASS (dax_element_parent_class)->finalize (object);
 }
 
+/* Animations change attributes at every frame. The actors displaying the
+ * element are updated through its binding and notify is only emitted when
+ * someone else is listening */
+static void
+dax_element_dispatch_properties_changed (GObject     *object,
+                                         guint        n_pspecs,
+                                         GParamSpec **pspecs)
+{
+    GObjectClass *parent_class = G_OBJECT_CLASS (dax_element_parent_class);
+    guint i;
+
+    _dax_binding_properties_changed (object, n_pspecs, pspecs);
+
+    /* handlers without detail are called for every property */
+    if (g_signal_has_handler_pending (object, notify_signal_id, 0, FALSE)) {
+        parent_class->dispatch_properties_changed (object, n_pspecs, pspecs);
+        return;
+    }
+
+    /* the others have the quark of the name of their property as detail */
+    for (i = 0; i < n_pspecs; i++) {
+        GQuark detail = g_quark_try_string (pspecs[i]->name);
+
+        if (g_signal_has_handler_pending (object, notify_signal_id, detail,
+                                          FALSE))
+        {
+            parent_class->dispatch_properties_changed (object, n_pspecs,
+                                                       pspecs);
+            return;
+        }
+    }
+}
+
 static void
 dax_element_class_init (DaxElementClass *klass)
 {
@@ -387,6 +674,10 @@ dax_element_class_init (DaxElementClass *klass)
     object_class->set_property = dax_element_set_property;
     object_class->dispose = dax_element_dispose;
     object_class->finalize = dax_element_finalize;
+    object_class->dispatch_properties_changed =
+        dax_element_dispatch_properties_changed;
+
+    notify_signal_id = g_signal_lookup ("notify", G_TYPE_OBJECT);
 
     dom_element_class->get_attribute = dax_element_get_attribute;
     dom_element_class->set_attribute = dax_element_set_attribute;
@@ -461,8 +752,8 @@ dax_element_get_fill_color (DaxElement *element)
     g_return_val_if_fail (DAX_IS_ELEMENT (element), NULL);
 
     priv = element->priv;
-    if (priv->fill)
-        return priv->fill;
+    if (priv->has_fill)
+        return &priv->fill;
 
     /* casting here as g_return_val_if_fail has already checked for the type */
     parent = ((DaxDomNode  *)element)->parent_node;
@@ -481,8 +772,8 @@ dax_element_get_stroke_color (DaxElement *element)
     g_return_val_if_fail (DAX_IS_ELEMENT (element), NULL);
 
     priv = element->priv;
-    if (priv->stroke)
-        return priv->stroke;
+    if (priv->has_stroke)
+        return &priv->stroke;
 
     /* casting here as g_return_val_if_fail has already checked for the type */
     parent = ((DaxDomNode  *)element)->parent_node;
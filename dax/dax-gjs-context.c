@@ -39,6 +39,9 @@ struct _DaxJsContextPrivate
     JSContext *js_context;
 
     JSObject *xml_event_prototype;
+
+    /* compiled functions, rooted until they are released */
+    GHashTable *functions;
 };
 
 static void
@@ -122,6 +125,15 @@ dax_js_context_finalize (GObject *object)
 {
     DaxJsContext *context = DAX_JS_CONTEXT (object);
     DaxJsContextPrivate *priv = context->priv;
+    GHashTableIter iter;
+    gpointer slot;
+
+    g_hash_table_iter_init (&iter, priv->functions);
+    while (g_hash_table_iter_next (&iter, NULL, &slot)) {
+        JS_RemoveRoot (priv->js_context, slot);
+        g_slice_free (JSObject *, slot);
+    }
+    g_hash_table_destroy (priv->functions);
 
     g_object_unref (priv->gjs_context);
 
@@ -174,6 +186,8 @@ dax_js_context_init (DaxJsContext *self)
 
     g_assert (xml_event_prototype != NULL);
     priv->xml_event_prototype = xml_event_prototype;
+
+    priv->functions = g_hash_table_new (NULL, NULL);
 }
 
 DaxJsContext *
@@ -331,3 +345,78 @@ dax_js_context_add_global_object (DaxJsContext *context,
 
     return ok;
 }
+
+/*
+ * Compiled functions are rooted so the GC does not collect them while they
+ * are held by C code, call dax_js_context_release_function() when done.
+ */
+
+DaxJsFunction *
+dax_js_context_compile_function (DaxJsContext       *context,
+                                 const gchar        *name,
+                                 const gchar *const *arg_names,
+                                 const gchar        *body,
+                                 const gchar        *file)
+{
+    DaxJsContextPrivate *priv;
+    JSFunction *function;
+    JSObject **slot;
+    guint n_args = 0;
+
+    g_return_val_if_fail (DAX_IS_JS_CONTEXT (context), NULL);
+    g_return_val_if_fail (body != NULL, NULL);
+
+    priv = context->priv;
+
+    if (arg_names)
+        n_args = g_strv_length ((gchar **) arg_names);
+
+    function = JS_CompileFunction (priv->js_context,
+                                   JS_GetGlobalObject (priv->js_context),
+                                   name,
+                                   n_args,
+                                   (const char **) arg_names,
+                                   body,
+                                   strlen (body),
+                                   file,
+                                   1);
+    if (G_UNLIKELY (function == NULL)) {
+        gjs_log_exception (priv->js_context, NULL);
+        return NULL;
+    }
+
+    slot = g_slice_new (JSObject *);
+    *slot = JS_GetFunctionObject (function);
+    if (G_UNLIKELY (!JS_AddNamedRoot (priv->js_context, slot, name))) {
+        g_warning (G_STRLOC ": could not root function %s", name);
+        g_slice_free (JSObject *, slot);
+        return NULL;
+    }
+
+    g_hash_table_insert (priv->functions, *slot, slot);
+
+    return *slot;
+}
+
+void
+dax_js_context_release_function (DaxJsContext  *context,
+                                 DaxJsFunction *function)
+{
+    DaxJsContextPrivate *priv;
+    JSObject **slot;
+
+    g_return_if_fail (DAX_IS_JS_CONTEXT (context));
+
+    priv = context->priv;
+
+    slot = g_hash_table_lookup (priv->functions, function);
+    if (G_UNLIKELY (slot == NULL)) {
+        g_warning (G_STRLOC ": function %p was not compiled by this context",
+                   function);
+        return;
+    }
+
+    g_hash_table_remove (priv->functions, function);
+    JS_RemoveRoot (priv->js_context, slot);
+    g_slice_free (JSObject *, slot);
+}
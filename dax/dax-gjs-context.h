@@ -85,6 +85,14 @@ gboolean        dax_js_context_call_function    (DaxJsContext *context,
                                                  const char   *nb_args,
                                                  ...);
 
+DaxJsFunction * dax_js_context_compile_function (DaxJsContext       *context,
+                                                 const gchar        *name,
+                                                 const gchar *const *arg_names,
+                                                 const gchar        *body,
+                                                 const gchar        *file);
+void            dax_js_context_release_function (DaxJsContext  *context,
+                                                 DaxJsFunction *function);
+
 DaxJsObject*    dax_js_context_new_object_from_gobject   (DaxJsContext *context,
                                                           GObject     *object);
 DaxJsObject*    dax_js_context_new_object_from_xml_event (DaxJsContext *context,
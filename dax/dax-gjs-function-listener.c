@@ -44,11 +44,14 @@ enum
     PROP_FUNCTION
 };
 
+/* The listener keeps its JS context alive and roots its function, so it can
+ * be called for as long as it is registered */
 struct _DaxJsFunctionListenerPrivate
 {
     DaxJsContext *js_context;
     JSContext *native_context;
     jsval function;
+    gboolean rooted;
 };
 
 static void
@@ -57,7 +60,7 @@ dax_js_function_listener_set_context (DaxJsFunctionListener *listener,
 {
     DaxJsFunctionListenerPrivate *priv = listener->priv;
 
-    priv->js_context = context;
+    priv->js_context = g_object_ref (context);
     priv->native_context = dax_js_context_get_native_context (context);
 }
 
@@ -69,23 +72,14 @@ dax_js_function_listener_get_function (DaxJsFunctionListener *listener)
     return (JSFunction *) JSVAL_TO_OBJECT (priv->function);
 }
 
+/* converted to a function once the context is known, see constructed() */
 static void
 dax_js_function_listener_set_function (DaxJsFunctionListener *listener,
                                        DaxJsFunction         *function)
 {
     DaxJsFunctionListenerPrivate *priv = listener->priv;
-    jsval in_function;
-    JSBool ret;
 
-    in_function = OBJECT_TO_JSVAL (function);
-    ret = JS_ConvertValue (priv->native_context,
-                           in_function,
-                           JSTYPE_FUNCTION,
-                           &priv->function);
-    if (G_UNLIKELY (ret == JS_FALSE)) {
-        g_warning (G_STRLOC ": could not convert pointer to a JS function");
-        priv->function = JSVAL_NULL;
-    }
+    priv->function = OBJECT_TO_JSVAL (function);
 }
 
 /*
@@ -102,6 +96,9 @@ dax_js_function_listener_handle_event (DaxXmlEventListener *listener,
     jsval argv[1], ret_val;
     JSBool ret;
 
+    if (G_UNLIKELY (JSVAL_IS_NULL (priv->function)))
+        return;
+
     event = dax_js_context_new_object_from_xml_event (priv->js_context,
                                                       xml_event);
     argv[0] = OBJECT_TO_JSVAL (event);
@@ -179,9 +176,47 @@ dax_js_function_listener_set_property (GObject      *object,
     }
 }
 
+static void
+dax_js_function_listener_constructed (GObject *object)
+{
+    DaxJsFunctionListener *listener = (DaxJsFunctionListener *) object;
+    DaxJsFunctionListenerPrivate *priv = listener->priv;
+    JSBool ret;
+
+    g_return_if_fail (priv->js_context != NULL);
+
+    ret = JS_ConvertValue (priv->native_context,
+                           priv->function,
+                           JSTYPE_FUNCTION,
+                           &priv->function);
+    if (G_UNLIKELY (ret == JS_FALSE)) {
+        g_warning (G_STRLOC ": could not convert pointer to a JS function");
+        priv->function = JSVAL_NULL;
+        return;
+    }
+
+    priv->rooted = JS_AddNamedRoot (priv->native_context, &priv->function,
+                                    "DaxJsFunctionListener");
+}
+
 static void
 dax_js_function_listener_dispose (GObject *object)
 {
+    DaxJsFunctionListener *listener = (DaxJsFunctionListener *) object;
+    DaxJsFunctionListenerPrivate *priv = listener->priv;
+
+    if (priv->rooted) {
+        JS_RemoveRoot (priv->native_context, &priv->function);
+        priv->rooted = FALSE;
+    }
+    priv->function = JSVAL_NULL;
+
+    if (priv->js_context) {
+        g_object_unref (priv->js_context);
+        priv->js_context = NULL;
+        priv->native_context = NULL;
+    }
+
     G_OBJECT_CLASS (dax_js_function_listener_parent_class)->dispose (object);
 }
 
@@ -195,6 +230,7 @@ dax_js_function_listener_class_init (DaxJsFunctionListenerClass *klass)
 
     object_class->get_property = dax_js_function_listener_get_property;
     object_class->set_property = dax_js_function_listener_set_property;
+    object_class->constructed = dax_js_function_listener_constructed;
     object_class->dispose = dax_js_function_listener_dispose;
 
     pspec = g_param_spec_pointer ("function",
@@ -216,6 +252,7 @@ dax_js_function_listener_init (DaxJsFunctionListener *self)
     DaxJsFunctionListenerPrivate *priv;
 
     self->priv = priv = JS_FUNCTION_LISTENER_PRIVATE (self);
+    priv->function = JSVAL_NULL;
 }
 
 DaxJsFunctionListener *
@@ -227,3 +264,33 @@ dax_js_function_listener_new (DaxJsContext  *context,
                          "function", function,
                          NULL);
 }
+
+/* Event handlers, <handler> elements and on* attributes, are compiled once
+ * into a listener. Their code sees the event as both event and evt */
+DaxJsFunctionListener *
+dax_js_function_listener_new_from_code (DaxJsContext *context,
+                                        const gchar  *code)
+{
+    static const gchar *const handler_args[] = { "event", NULL };
+    DaxJsFunctionListener *listener;
+    DaxJsFunction *function;
+    gchar *body;
+
+    g_return_val_if_fail (code != NULL, NULL);
+
+    body = g_strconcat ("let evt=event;", code, NULL);
+    function = dax_js_context_compile_function (context,
+                                                "__dax_handler",
+                                                handler_args,
+                                                body,
+                                                "svg");
+    g_free (body);
+    if (function == NULL)
+        return NULL;
+
+    /* the listener roots the function itself */
+    listener = dax_js_function_listener_new (context, function);
+    dax_js_context_release_function (context, function);
+
+    return listener;
+}
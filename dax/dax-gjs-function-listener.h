@@ -72,6 +72,9 @@ GType                   dax_js_function_listener_get_type   (void) G_GNUC_CONST;
 
 DaxJsFunctionListener * dax_js_function_listener_new        (DaxJsContext  *context,
                                                              DaxJsFunction *function);
+DaxJsFunctionListener * dax_js_function_listener_new_from_code
+                                                            (DaxJsContext  *context,
+                                                             const gchar   *code);
 
 G_END_DECLS
 
@@ -27,6 +27,25 @@
 #include "dax-gjs-function-listener.h"
 #include "dax-gjs-udom.h"
 
+/* the document the scripts of cx belong to */
+static DaxDomDocument *
+get_document (JSContext *cx)
+{
+    JSObject *js_document;
+    jsval value;
+
+    if (!JS_GetProperty (cx, JS_GetGlobalObject (cx), "document", &value) ||
+        !JSVAL_IS_OBJECT (value) ||
+        JSVAL_IS_NULL (value))
+    {
+        return NULL;
+    }
+
+    js_document = JSVAL_TO_OBJECT (value);
+
+    return (DaxDomDocument *) gjs_g_object_from_object (cx, js_document);
+}
+
 static JSBool
 add_event_listener (JSContext *cx,
                     JSObject  *obj,
@@ -50,8 +69,18 @@ add_event_listener (JSContext *cx,
         }
 
     target = DAX_XML_EVENT_TARGET (gjs_g_object_from_object (cx, obj));
-    node = DAX_DOM_NODE (target);
-    document = node->owner_document;
+    if (DAX_IS_DOM_NODE (target)) {
+        node = DAX_DOM_NODE (target);
+        document = node->owner_document;
+    } else {
+        /* SVGTimer objects are not part of the tree */
+        document = get_document (cx);
+    }
+    if (G_UNLIKELY (document == NULL)) {
+        g_warning (G_STRLOC ": could not find the document of the listener");
+        return JS_FALSE;
+    }
+
     js_context = dax_dom_document_get_js_context (document);
     listener = dax_js_function_listener_new (js_context,
                                              (DaxJsFunction *) listener_func);
@@ -76,6 +105,8 @@ create_timer (JSContext *cx,
               jsval     *rval)
 {
     int32 initial_interval, repeat_interval;
+    DaxDomDocument *document;
+    DaxTimerWheel *wheel = NULL;
     DaxSvgTimer *timer;
     JSObject *js_timer;
     JSBool ret;
@@ -86,7 +117,12 @@ create_timer (JSContext *cx,
             return JS_FALSE;
         }
 
-    timer = dax_svg_timer_new (initial_interval, repeat_interval);
+    /* timers are driven by the clock of their document */
+    document = get_document (cx);
+    if (document)
+        wheel = dax_dom_document_get_timer_wheel (document);
+
+    timer = dax_svg_timer_new_full (wheel, initial_interval, repeat_interval);
     js_timer = gjs_object_from_g_object (cx, (GObject *) timer);
     *rval = OBJECT_TO_JSVAL (js_timer);
 
@@ -18,6 +18,11 @@
  * along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <math.h>
+#include <string.h>
+
+#include "clutter-shape.h"
+#include "dax-debug.h"
 #include "dax-utils.h"
 
 #include "dax-group.h"
@@ -27,15 +32,553 @@ G_DEFINE_TYPE (DaxGroup, dax_group, CLUTTER_TYPE_GROUP)
 #define GROUP_PRIVATE(o) \
   (G_TYPE_INSTANCE_GET_PRIVATE ((o), DAX_TYPE_GROUP, DaxGroupPrivate))
 
+#define DEFAULT_CACHE_MAX_SIZE  (16 * 1024 * 1024)
+
+/* in auto mode, a group is cached once it has been painted that many
+ * times without changing and if it has enough actors to be worth it */
+#define AUTO_CLEAN_FRAMES       3
+#define AUTO_MIN_ACTORS         8
+
+/* what the content of the texture depends on, besides the children */
+typedef struct
+{
+    float modelview[16];
+    float projection[16];
+    float viewport[4];
+    guint8 opacity;
+} CacheKey;
+
+/* the bounds of the children are computed again when something in the
+ * subtree changed */
+typedef enum
+{
+    BOUNDS_DIRTY,
+    BOUNDS_EMPTY,
+    BOUNDS_VALID,
+    BOUNDS_UNKNOWN                      /* a child can't tell its bounds */
+} BoundsState;
+
 struct _DaxGroupPrivate
 {
     CoglMatrix cogl_matrix;
+
+    /* offscreen cache */
+    DaxGroupCacheMode cache_mode;
+    CoglHandle texture;
+    CoglHandle offscreen;
+    gint x, y;                          /* of the texture, in window
+                                           coordinates */
+    guint width, height;
+    gboolean cache_valid;
+    gboolean changed;                   /* since the last paint */
+    guint clean_frames;
+    CacheKey key;                       /* of the last paint */
+    GList *cache_link;                  /* in cached_groups */
+
+    /* culling */
+    ClutterActorBox bounds;             /* of the children, in the
+                                           coordinates of the group */
+    BoundsState bounds_state;
 };
 
+static DaxGroupCacheStats cache_stats = { 0, 0, 0, 0, 0,
+                                          DEFAULT_CACHE_MAX_SIZE };
+
+/* the groups holding a texture, most recently painted first */
+static GQueue cached_groups = G_QUEUE_INIT;
+
+/*
+ * Offscreen cache
+ *
+ * A group can be rendered once into a texture, the texture being painted
+ * instead of the children as long as nothing changed in the subtree and
+ * the group is drawn at the same place. Any redraw queued by a descendant
+ * invalidates the texture.
+ */
+
+static void
+get_cache_key (ClutterActor *actor,
+               CacheKey     *key)
+{
+    CoglMatrix matrix;
+
+    memset (key, 0, sizeof (CacheKey));
+
+    cogl_get_modelview_matrix (&matrix);
+    memcpy (key->modelview, cogl_matrix_get_array (&matrix),
+            sizeof (key->modelview));
+    cogl_get_projection_matrix (&matrix);
+    memcpy (key->projection, cogl_matrix_get_array (&matrix),
+            sizeof (key->projection));
+    cogl_get_viewport (key->viewport);
+    key->opacity = clutter_actor_get_paint_opacity (actor);
+}
+
+static void
+free_texture (DaxGroup *self)
+{
+    DaxGroupPrivate *priv = self->priv;
+
+    if (priv->texture == COGL_INVALID_HANDLE)
+        return;
+
+    cogl_handle_unref (priv->offscreen);
+    cogl_handle_unref (priv->texture);
+    priv->offscreen = COGL_INVALID_HANDLE;
+    priv->texture = COGL_INVALID_HANDLE;
+
+    g_queue_delete_link (&cached_groups, priv->cache_link);
+    priv->cache_link = NULL;
+
+    cache_stats.n_textures--;
+    cache_stats.size -= priv->width * priv->height * 4;
+    priv->width = priv->height = 0;
+    priv->cache_valid = FALSE;
+}
+
+static void
+invalidate_cache (DaxGroup *self)
+{
+    DaxGroupPrivate *priv = self->priv;
+
+    if (priv->cache_valid)
+        cache_stats.invalidations++;
+
+    priv->cache_valid = FALSE;
+    priv->changed = TRUE;
+
+    /* in auto mode, the memory is better used by groups that don't
+     * change */
+    if (priv->cache_mode == DAX_GROUP_CACHE_AUTO)
+        free_texture (self);
+}
+
+static void
+union_point (ClutterActorBox *box,
+             gboolean        *empty,
+             gfloat           x,
+             gfloat           y)
+{
+    if (*empty) {
+        box->x1 = box->x2 = x;
+        box->y1 = box->y2 = y;
+        *empty = FALSE;
+        return;
+    }
+
+    box->x1 = MIN (box->x1, x);
+    box->y1 = MIN (box->y1, y);
+    box->x2 = MAX (box->x2, x);
+    box->y2 = MAX (box->y2, y);
+}
+
+static void
+union_transformed_box (ClutterActorBox       *box,
+                       gboolean              *empty,
+                       const CoglMatrix      *matrix,
+                       const ClutterActorBox *child_box)
+{
+    gfloat corners[4][2] = {
+        { child_box->x1, child_box->y1 },
+        { child_box->x2, child_box->y1 },
+        { child_box->x2, child_box->y2 },
+        { child_box->x1, child_box->y2 }
+    };
+    guint i;
+
+    for (i = 0; i < 4; i++) {
+        gfloat x = corners[i][0], y = corners[i][1], z = 0, w = 1;
+
+        cogl_matrix_transform_point (matrix, &x, &y, &z, &w);
+        union_point (box, empty, x, y);
+    }
+}
+
+static gboolean get_children_bounds (ClutterContainer *container,
+                                     ClutterActorBox  *box,
+                                     gboolean         *empty);
+static BoundsState get_group_bounds (DaxGroup        *self,
+                                     ClutterActorBox *box);
+
+/* Bounds of what actor paints, in its own coordinates. Returns FALSE if
+ * they can't be known */
+static gboolean
+get_actor_bounds (ClutterActor    *actor,
+                  ClutterActorBox *box,
+                  gboolean        *empty)
+{
+    ClutterActorBox child_box;
+    gfloat width, height;
+
+    /* nested groups keep their bounds */
+    if (DAX_IS_GROUP (actor)) {
+        switch (get_group_bounds (DAX_GROUP (actor), &child_box)) {
+        case BOUNDS_VALID:
+            union_point (box, empty, child_box.x1, child_box.y1);
+            union_point (box, empty, child_box.x2, child_box.y2);
+            return TRUE;
+        case BOUNDS_EMPTY:
+            return TRUE;
+        default:
+            return FALSE;
+        }
+    }
+
+    if (CLUTTER_IS_CONTAINER (actor))
+        return get_children_bounds (CLUTTER_CONTAINER (actor), box, empty);
+
+    if (CLUTTER_IS_SHAPE (actor)) {
+        if (clutter_shape_get_bounds (CLUTTER_SHAPE (actor), &child_box)) {
+            union_point (box, empty, child_box.x1, child_box.y1);
+            union_point (box, empty, child_box.x2, child_box.y2);
+        }
+        return TRUE;
+    }
+
+    clutter_actor_get_size (actor, &width, &height);
+    if (width <= 0 || height <= 0)
+        return FALSE;
+
+    union_point (box, empty, 0, 0);
+    union_point (box, empty, width, height);
+
+    return TRUE;
+}
+
+static gboolean
+get_children_bounds (ClutterContainer *container,
+                     ClutterActorBox  *box,
+                     gboolean         *empty)
+{
+    GList *children, *l;
+    gboolean known = TRUE;
+
+    children = clutter_container_get_children (container);
+    for (l = children; l && known; l = l->next) {
+        ClutterActor *child = l->data;
+        ClutterActorBox child_box;
+        gboolean child_empty = TRUE;
+        CoglMatrix matrix;
+
+        if (!CLUTTER_ACTOR_IS_VISIBLE (child))
+            continue;
+
+        known = get_actor_bounds (child, &child_box, &child_empty);
+        if (!known || child_empty)
+            continue;
+
+        clutter_actor_get_transformation_matrix (child, &matrix);
+        union_transformed_box (box, empty, &matrix, &child_box);
+    }
+    g_list_free (children);
+
+    return known;
+}
+
+static BoundsState
+get_group_bounds (DaxGroup        *self,
+                  ClutterActorBox *box)
+{
+    DaxGroupPrivate *priv = self->priv;
+
+    if (priv->bounds_state == BOUNDS_DIRTY) {
+        gboolean empty = TRUE;
+
+        if (!get_children_bounds (CLUTTER_CONTAINER (self), &priv->bounds,
+                                  &empty))
+        {
+            priv->bounds_state = BOUNDS_UNKNOWN;
+        }
+        else if (empty)
+            priv->bounds_state = BOUNDS_EMPTY;
+        else
+            priv->bounds_state = BOUNDS_VALID;
+    }
+
+    *box = priv->bounds;
+
+    return priv->bounds_state;
+}
+
+/* Bounds of the children, in the coordinates of the group. Returns FALSE
+ * if they are empty or can't be known */
+gboolean
+_dax_group_get_bounds (DaxGroup        *self,
+                       ClutterActorBox *box)
+{
+    return get_group_bounds (self, box) == BOUNDS_VALID;
+}
+
+/* whether the children can draw something in the viewport */
+static gboolean
+is_visible (DaxGroup *self)
+{
+    ClutterActorBox bounds;
+
+    switch (get_group_bounds (self, &bounds)) {
+    case BOUNDS_EMPTY:
+        return FALSE;
+    case BOUNDS_VALID:
+        return _dax_utils_box_is_visible (&bounds);
+    default:
+        return TRUE;
+    }
+}
+
+static guint
+count_actors (ClutterContainer *container)
+{
+    GList *children, *l;
+    guint n_actors = 0;
+
+    children = clutter_container_get_children (container);
+    for (l = children; l; l = l->next) {
+        n_actors++;
+        if (CLUTTER_IS_CONTAINER (l->data))
+            n_actors += count_actors (l->data);
+    }
+    g_list_free (children);
+
+    return n_actors;
+}
+
+/* The rectangle of the window covered by the group, clipped to the
+ * viewport and with a pixel around for the strokes */
+static gboolean
+get_window_rectangle (DaxGroup       *self,
+                      const CacheKey *key,
+                      gint           *x,
+                      gint           *y,
+                      guint          *width,
+                      guint          *height)
+{
+    ClutterActorBox bounds, window;
+    CoglMatrix modelview, projection;
+    const float *viewport = key->viewport;
+    gint x1, y1, x2, y2;
+
+    if (get_group_bounds (self, &bounds) != BOUNDS_VALID)
+        return FALSE;
+
+    cogl_matrix_init_from_array (&modelview, key->modelview);
+    cogl_matrix_init_from_array (&projection, key->projection);
+    if (!_dax_utils_project_box (&modelview, &projection, viewport, &bounds,
+                                 &window))
+    {
+        return FALSE;
+    }
+
+    x1 = MAX (floorf (window.x1) - 1, viewport[0]);
+    y1 = MAX (floorf (window.y1) - 1, viewport[1]);
+    x2 = MIN (ceilf (window.x2) + 1, viewport[0] + viewport[2]);
+    y2 = MIN (ceilf (window.y2) + 1, viewport[1] + viewport[3]);
+    if (x2 <= x1 || y2 <= y1)
+        return FALSE;
+
+    *x = x1;
+    *y = y1;
+    *width = x2 - x1;
+    *height = y2 - y1;
+
+    return TRUE;
+}
+
+static gboolean
+render_texture (DaxGroup       *self,
+                const CacheKey *key)
+{
+    DaxGroupPrivate *priv = self->priv;
+    const float *viewport = key->viewport;
+    CoglMatrix modelview, projection;
+    CoglColor transparent;
+    guint width, height;
+    gint x, y;
+
+    if (!get_window_rectangle (self, key, &x, &y, &width, &height))
+        return FALSE;
+
+    if (width != priv->width || height != priv->height) {
+        gsize size = width * height * 4;
+
+        free_texture (self);
+
+        if (cache_stats.size + size > cache_stats.max_size) {
+            DAX_NOTE (MEMORY, "no room to cache a %ux%u group",
+                      width, height);
+            return FALSE;
+        }
+
+        priv->texture =
+            cogl_texture_new_with_size (width, height,
+                                        COGL_TEXTURE_NO_SLICING,
+                                        COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+        if (priv->texture == COGL_INVALID_HANDLE)
+            return FALSE;
+
+        priv->offscreen = cogl_offscreen_new_to_texture (priv->texture);
+        if (priv->offscreen == COGL_INVALID_HANDLE) {
+            cogl_handle_unref (priv->texture);
+            priv->texture = COGL_INVALID_HANDLE;
+            return FALSE;
+        }
+
+        priv->width = width;
+        priv->height = height;
+        g_queue_push_head (&cached_groups, self);
+        priv->cache_link = cached_groups.head;
+        cache_stats.n_textures++;
+        cache_stats.size += size;
+    }
+    priv->x = x;
+    priv->y = y;
+
+    /* draw the children as they would be drawn in the window, shifted so
+     * that the rectangle lands in the texture */
+    cogl_matrix_init_from_array (&modelview, key->modelview);
+    cogl_matrix_init_from_array (&projection, key->projection);
+
+    cogl_push_framebuffer (priv->offscreen);
+    cogl_set_viewport (viewport[0] - x, viewport[1] - y,
+                       viewport[2], viewport[3]);
+    cogl_set_projection_matrix (&projection);
+    cogl_set_modelview_matrix (&modelview);
+
+    cogl_color_set_from_4ub (&transparent, 0, 0, 0, 0);
+    cogl_clear (&transparent, COGL_BUFFER_BIT_COLOR);
+
+    CLUTTER_ACTOR_CLASS (dax_group_parent_class)->paint (CLUTTER_ACTOR (self));
+
+    cogl_pop_framebuffer ();
+
+    priv->cache_valid = TRUE;
+    cache_stats.renders++;
+
+    return TRUE;
+}
+
+static void
+paint_texture (DaxGroup       *self,
+               const CacheKey *key)
+{
+    DaxGroupPrivate *priv = self->priv;
+    const float *viewport = key->viewport;
+    CoglMatrix identity, projection;
+
+    cogl_get_projection_matrix (&projection);
+    cogl_push_matrix ();
+
+    /* the texture is drawn in window coordinates */
+    cogl_matrix_init_identity (&identity);
+    cogl_set_modelview_matrix (&identity);
+    cogl_ortho (viewport[0], viewport[0] + viewport[2],
+                viewport[1] + viewport[3], viewport[1],
+                -1, 1);
+
+    cogl_set_source_texture (priv->texture);
+    cogl_rectangle (priv->x, priv->y,
+                    priv->x + priv->width, priv->y + priv->height);
+
+    cogl_pop_matrix ();
+    cogl_set_projection_matrix (&projection);
+}
+
+static gboolean
+should_render_texture (DaxGroup *self)
+{
+    DaxGroupPrivate *priv = self->priv;
+
+    switch (priv->cache_mode) {
+    case DAX_GROUP_CACHE_ALWAYS:
+        return TRUE;
+    case DAX_GROUP_CACHE_AUTO:
+        return priv->clean_frames >= AUTO_CLEAN_FRAMES &&
+               count_actors (CLUTTER_CONTAINER (self)) >= AUTO_MIN_ACTORS;
+    case DAX_GROUP_CACHE_NONE:
+    default:
+        return FALSE;
+    }
+}
+
 /*
  * ClutterActor implementation
  */
 
+static void
+dax_group_paint (ClutterActor *actor)
+{
+    DaxGroup *self = DAX_GROUP (actor);
+    DaxGroupPrivate *priv = self->priv;
+    CacheKey key;
+
+    /* scrolled out of the stage */
+    if (!is_visible (self))
+        return;
+
+    if (priv->cache_mode == DAX_GROUP_CACHE_NONE) {
+        CLUTTER_ACTOR_CLASS (dax_group_parent_class)->paint (actor);
+        return;
+    }
+
+    /* drawn somewhere else, the texture can't be used */
+    get_cache_key (actor, &key);
+    if (memcmp (&key, &priv->key, sizeof (CacheKey)) != 0) {
+        invalidate_cache (self);
+        priv->key = key;
+    }
+
+    if (priv->changed)
+        priv->clean_frames = 0;
+    else
+        priv->clean_frames++;
+    priv->changed = FALSE;
+
+    if (priv->cache_valid) {
+        cache_stats.hits++;
+        g_queue_unlink (&cached_groups, priv->cache_link);
+        g_queue_push_head_link (&cached_groups, priv->cache_link);
+        paint_texture (self, &key);
+        return;
+    }
+
+    if (should_render_texture (self) && render_texture (self, &key)) {
+        paint_texture (self, &key);
+        return;
+    }
+
+    CLUTTER_ACTOR_CLASS (dax_group_parent_class)->paint (actor);
+}
+
+static void
+dax_group_pick (ClutterActor       *actor,
+                const ClutterColor *color)
+{
+    DaxGroup *self = DAX_GROUP (actor);
+
+    /* the group itself may be picked where its children aren't */
+    if (!clutter_actor_should_pick_paint (actor) && !is_visible (self))
+        return;
+
+    CLUTTER_ACTOR_CLASS (dax_group_parent_class)->pick (actor, color);
+}
+
+static void
+dax_group_queue_redraw (ClutterActor *actor,
+                        ClutterActor *origin)
+{
+    DaxGroup *self = DAX_GROUP (actor);
+
+    /* the group hiding a child queues a redraw of itself, the bounds are
+     * cheap to compute again from the ones of the children */
+    self->priv->bounds_state = BOUNDS_DIRTY;
+
+    /* a change of the group itself (eg. its transform) is caught by the
+     * key when painting */
+    if (origin != actor)
+        invalidate_cache (self);
+
+    CLUTTER_ACTOR_CLASS (dax_group_parent_class)->queue_redraw (actor, origin);
+}
+
 static void
 dax_group_apply_transform (ClutterActor *self,
                            CoglMatrix   *matrix)
@@ -46,17 +589,56 @@ dax_group_apply_transform (ClutterActor *self,
     cogl_matrix_multiply (matrix, matrix, &priv->cogl_matrix);
 }
 
+/* the texture doesn't have the actors added or removed, and a descendant
+ * group has to tell its ancestors */
+static void
+on_children_changed (ClutterContainer *container,
+                     ClutterActor     *actor,
+                     DaxGroup         *self)
+{
+    self->priv->bounds_state = BOUNDS_DIRTY;
+    invalidate_cache (self);
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+}
+
+/* the children don't queue redraws while the group is unmapped, what they
+ * did is not known */
+static void
+on_mapped_changed (GObject    *object,
+                   GParamSpec *pspec,
+                   DaxGroup   *self)
+{
+    self->priv->bounds_state = BOUNDS_DIRTY;
+    invalidate_cache (self);
+}
+
 /*
  * GObject implementation
  */
 
+static void
+dax_group_dispose (GObject *object)
+{
+    DaxGroup *self = DAX_GROUP (object);
+
+    free_texture (self);
+
+    G_OBJECT_CLASS (dax_group_parent_class)->dispose (object);
+}
+
 static void
 dax_group_class_init (DaxGroupClass *klass)
 {
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
     ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
 
     g_type_class_add_private (klass, sizeof (DaxGroupPrivate));
 
+    object_class->dispose = dax_group_dispose;
+
+    actor_class->paint = dax_group_paint;
+    actor_class->pick = dax_group_pick;
+    actor_class->queue_redraw = dax_group_queue_redraw;
     actor_class->apply_transform = dax_group_apply_transform;
 }
 
@@ -67,6 +649,14 @@ dax_group_init (DaxGroup *self)
 
     self->priv = priv = GROUP_PRIVATE (self);
     cogl_matrix_init_identity (&priv->cogl_matrix);
+    priv->changed = TRUE;
+
+    g_signal_connect (self, "actor-added",
+                      G_CALLBACK (on_children_changed), self);
+    g_signal_connect (self, "actor-removed",
+                      G_CALLBACK (on_children_changed), self);
+    g_signal_connect (self, "notify::mapped",
+                      G_CALLBACK (on_mapped_changed), self);
 }
 
 ClutterActor *
@@ -113,3 +703,86 @@ dax_group_set_matrix (DaxGroup        *self,
 
     clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
 }
+
+/**
+ * dax_group_set_cache_mode:
+ * @self: a #DaxGroup
+ * @mode: when to render the children of @self into a texture
+ *
+ * Sets whether the children of @self are rendered once into a texture, the
+ * texture being painted instead of them as long as they don't change. This
+ * saves painting static parts of a scene every frame when something else
+ * is animated, at the cost of the memory taken by the texture.
+ *
+ * With %DAX_GROUP_CACHE_AUTO, the texture is only rendered for groups
+ * with enough actors that didn't change for a few frames.
+ */
+void
+dax_group_set_cache_mode (DaxGroup          *self,
+                          DaxGroupCacheMode  mode)
+{
+    DaxGroupPrivate *priv;
+
+    g_return_if_fail (DAX_IS_GROUP (self));
+
+    priv = self->priv;
+    if (priv->cache_mode == mode)
+        return;
+
+    priv->cache_mode = mode;
+    free_texture (self);
+    priv->changed = TRUE;
+
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+}
+
+DaxGroupCacheMode
+dax_group_get_cache_mode (DaxGroup *self)
+{
+    g_return_val_if_fail (DAX_IS_GROUP (self), DAX_GROUP_CACHE_NONE);
+
+    return self->priv->cache_mode;
+}
+
+/**
+ * dax_group_set_cache_max_size:
+ * @max_size: the memory, in bytes, the textures of the groups can take
+ *
+ * Sets the budget of texture memory shared by all the groups. A group
+ * whose texture doesn't fit is painted as usual. Lowering the budget frees
+ * the textures of the least recently painted groups until it is met.
+ */
+void
+dax_group_set_cache_max_size (gsize max_size)
+{
+    cache_stats.max_size = max_size;
+
+    while (cache_stats.size > cache_stats.max_size)
+        free_texture (g_queue_peek_tail (&cached_groups));
+}
+
+gsize
+dax_group_get_cache_max_size (void)
+{
+    return cache_stats.max_size;
+}
+
+/**
+ * dax_group_get_cache_stats:
+ * @stats: (out): a #DaxGroupCacheStats to fill
+ *
+ * Retrieves how often the groups have been painted from their textures.
+ */
+void
+dax_group_get_cache_stats (DaxGroupCacheStats *stats)
+{
+    g_return_if_fail (stats);
+
+    *stats = cache_stats;
+}
+
+void
+dax_group_reset_cache_stats (void)
+{
+    cache_stats.hits = cache_stats.renders = cache_stats.invalidations = 0;
+}
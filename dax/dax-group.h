@@ -45,6 +45,47 @@ G_BEGIN_DECLS
 #define DAX_GROUP_GET_CLASS(obj) \
     (G_TYPE_INSTANCE_GET_CLASS ((obj), DAX_TYPE_GROUP, DaxGroupClass))
 
+/**
+ * DaxGroupCacheMode:
+ * @DAX_GROUP_CACHE_NONE: the children are painted every frame
+ * @DAX_GROUP_CACHE_ALWAYS: the children are rendered into a texture,
+ *   rendered again when they change
+ * @DAX_GROUP_CACHE_AUTO: the children are rendered into a texture once
+ *   they haven't changed for a few frames, if there are enough of them
+ *
+ * When to render the children of a #DaxGroup into a texture.
+ */
+typedef enum
+{
+    DAX_GROUP_CACHE_NONE,
+    DAX_GROUP_CACHE_ALWAYS,
+    DAX_GROUP_CACHE_AUTO
+} DaxGroupCacheMode;
+
+typedef struct _DaxGroupCacheStats DaxGroupCacheStats;
+
+/**
+ * DaxGroupCacheStats:
+ * @hits: frames a group has been painted from its texture
+ * @renders: times a texture has been rendered
+ * @invalidations: times a texture has been made stale by a change
+ * @n_textures: number of textures allocated
+ * @size: memory taken by the textures, in bytes
+ * @max_size: memory the textures can take
+ *
+ * Statistics of the offscreen cache of the groups, see
+ * dax_group_get_cache_stats().
+ */
+struct _DaxGroupCacheStats
+{
+    guint hits;
+    guint renders;
+    guint invalidations;
+    guint n_textures;
+    gsize size;
+    gsize max_size;
+};
+
 typedef struct _DaxGroup DaxGroup;
 typedef struct _DaxGroupClass DaxGroupClass;
 typedef struct _DaxGroupPrivate DaxGroupPrivate;
@@ -67,6 +108,17 @@ ClutterActor *  dax_group_new           (void);
 void            dax_group_set_matrix    (DaxGroup        *self,
                                          const DaxMatrix *matrix);
 
+void                dax_group_set_cache_mode        (DaxGroup          *self,
+                                                     DaxGroupCacheMode  mode);
+DaxGroupCacheMode   dax_group_get_cache_mode        (DaxGroup          *self);
+void                dax_group_set_cache_max_size    (gsize max_size);
+gsize               dax_group_get_cache_max_size    (void);
+void                dax_group_get_cache_stats       (DaxGroupCacheStats *stats);
+void                dax_group_reset_cache_stats     (void);
+
+gboolean            _dax_group_get_bounds           (DaxGroup          *self,
+                                                     ClutterActorBox   *box);
+
 G_END_DECLS
 
 #endif /* __DAX_GROUP_H__ */
@@ -16,6 +16,9 @@
  * along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
+#include "dax-private.h"
 #include "dax-utils.h"
 #include "dax-knot-sequence.h"
 
@@ -39,29 +42,9 @@ struct _DaxKnotSequencePrivate
   gfloat *data;
   guint   nb_knots;
   guint   flags;
+  DaxArena *arena;      /* holds the static array, if any */
 };
 
-static gboolean
-str_parse_float_list (gchar  **str,
-                      guint    n_values,
-                      gfloat  *values)
-{
-	char *ptr = *str;
-	unsigned int i;
-
-	_dax_utils_skip_space_and_char (str, ',');
-
-	for (i = 0; i < n_values; i++) {
-		if (!_dax_utils_parse_float (str, &values[i])) {
-			*str = ptr;
-			return FALSE;
-		}
-        _dax_utils_skip_space_and_char (str, ',');
-	}
-
-	return TRUE;
-}
-
 static void
 dax_value_transform_knot_sequence_string (const GValue *src,
                                           GValue       *dest)
@@ -130,6 +113,7 @@ dax_knot_sequence_finalize (GObject *object)
 
     if (!(priv->flags & DAX_KNOT_SEQUENCE_FLAG_STATIC_ARRAY))
         g_free (priv->data);
+    _dax_arena_unref (priv->arena);
 
     G_OBJECT_CLASS (dax_knot_sequence_parent_class)->finalize (object);
 }
@@ -174,40 +158,78 @@ dax_knot_sequence_new_from_static_array (gfloat *data,
     return seq;
 }
 
-/**
- * dax_knot_sequence_new_from_string:
- * @string: FIXME
- *
- * Return value: a new #DaxKnotSequence creating from @string
- *
- * Since: 0.2
- */
+/* same as dax_knot_sequence_new_from_static_array() for knots in @arena,
+ * the sequence keeps a reference on it */
 DaxKnotSequence *
-dax_knot_sequence_new_from_string (const gchar *string)
+_dax_knot_sequence_new_from_static_array_in_arena (const gfloat *data,
+                                                   guint         nb_knots,
+                                                   DaxArena     *arena)
+{
+    DaxKnotSequence *seq;
+
+    seq = dax_knot_sequence_new_from_static_array ((gfloat *) data, nb_knots);
+    seq->priv->arena = _dax_arena_ref (arena);
+
+    return seq;
+}
+
+static DaxKnotSequence *
+dax_knot_sequence_parse (const gchar *string,
+                         DaxArena    *arena)
 {
     DaxKnotSequence *seq;
     DaxKnotSequencePrivate *priv;
     gchar *cur = (gchar *)string;
-    guint nb_commas, nb_floats = 0;
-
-    nb_commas = _dax_utils_count_commas (string);
+    guint max_floats, nb_floats;
 
     seq = dax_knot_sequence_new ();
     priv = seq->priv;
-    priv->data = g_malloc (sizeof (gfloat) * nb_commas * 2);
-    priv->nb_knots = 0;
 
-    while (str_parse_float_list (&cur, 2, priv->data + nb_floats) &&
-           nb_floats < nb_commas * 2)
-    {
-        _dax_utils_skip_space_and_char (&cur, ',');
-        nb_floats += 2;
+    /* a number and its separator take at least 2 characters */
+    max_floats = strlen (string) / 2 + 1;
+    if (arena) {
+        priv->data = _dax_arena_alloc (arena, sizeof (gfloat) * max_floats);
+        priv->flags |= DAX_KNOT_SEQUENCE_FLAG_STATIC_ARRAY;
+        priv->arena = _dax_arena_ref (arena);
+    } else {
+        priv->data = g_new (gfloat, max_floats);
     }
+
+    nb_floats = _dax_utils_parse_float_list (&cur, priv->data, max_floats);
     priv->nb_knots = nb_floats / 2;
 
+    if (arena)
+        _dax_arena_shrink (arena, priv->data,
+                           sizeof (gfloat) * priv->nb_knots * 2);
+    else
+        priv->data = g_renew (gfloat, priv->data, priv->nb_knots * 2);
+
     return seq;
 }
 
+/**
+ * dax_knot_sequence_new_from_string:
+ * @string: FIXME
+ *
+ * Return value: a new #DaxKnotSequence creating from @string
+ *
+ * Since: 0.2
+ */
+DaxKnotSequence *
+dax_knot_sequence_new_from_string (const gchar *string)
+{
+    return dax_knot_sequence_parse (string, NULL);
+}
+
+/* same as dax_knot_sequence_new_from_string() with the knots allocated in
+ * @arena, the sequence keeps a reference on it */
+DaxKnotSequence *
+_dax_knot_sequence_new_from_string_in_arena (const gchar *string,
+                                             DaxArena    *arena)
+{
+    return dax_knot_sequence_parse (string, arena);
+}
+
 const gfloat *
 dax_knot_sequence_get_array (const DaxKnotSequence *seq)
 {
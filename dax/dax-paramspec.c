@@ -397,21 +397,19 @@ dax_param_float_array_from_string (GParamSpec *pspec,
                                    GArray     *array)
 {
     gchar *cur = (gchar *)str;
-    gint parsed_elements = 0;
-    gboolean success;
-    gfloat value;
-
-    while (*cur) {
-        _dax_utils_skip_space (&cur);
-        success = _dax_utils_parse_float (&cur, &value);
-        if (!success) {
-            parsed_elements = -1;
-            break;
-        }
-        parsed_elements++;
-        g_array_append_val (array, value);
-        _dax_utils_skip_space_and_char (&cur, ',');
-    }
+    guint max_elements, parsed_elements;
+
+    /* a number and its separator take at least 2 characters */
+    max_elements = strlen (str) / 2 + 1;
+    g_array_set_size (array, max_elements);
+
+    parsed_elements = _dax_utils_parse_float_list (&cur,
+                                                   (gfloat *) array->data,
+                                                   max_elements);
+    g_array_set_size (array, parsed_elements);
+
+    if (*cur != '\0')
+        return -1;
 
     return parsed_elements;
 }
@@ -16,6 +16,11 @@
  * along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
+#include <libxml/parser.h>
+#include <libxml/parserInternals.h>
+#include <libxml/SAX2.h>
 #include <libxml/xmlreader.h>
 #include <gio/gio.h>
 
@@ -33,26 +38,115 @@ struct _ParserContext {
     xmlTextReaderPtr reader;
     DaxDomDocument *document;
     DaxDomNode *current_node;
+
+    /* progressive parsing */
+    DaxParser *parser;
+    GString *text;              /* character data not flushed yet */
+    gboolean text_is_cdata;
+    GString *name, *value;      /* scratch buffers for the attributes */
+
+    /* parsing in a worker thread, the JS setup and "parsed" are left to
+     * _dax_dom_document_finish_setup() */
+    gboolean defer_setup;
+    GCancellable *cancellable;  /* stops the parsing, can be NULL */
+};
+
+enum
+{
+    ELEMENT_PARSED,
+
+    LAST_SIGNAL
 };
 
+static guint parser_signals[LAST_SIGNAL];
+
 static void
-dax_dom_document_end_element (ParserContext *ctx)
+dax_dom_document_finish_element (DaxDomDocument *document,
+                                 DaxDomElement  *element)
 {
     DaxJsContext *js_context;
-    DaxDomElement *element;
-
-    js_context = dax_dom_document_get_js_context (ctx->document);
-    element = DAX_DOM_ELEMENT (ctx->current_node);
 
-    DAX_NOTE (PARSING, "end of %s", G_OBJECT_TYPE_NAME (ctx->current_node));
+    js_context = dax_dom_document_get_js_context (document);
 
     /* install some udom methods on the element */
     _dax_js_udom_setup_element (js_context, element);
 
     /* Signal the element its children and itself have been parsed */
     _dax_dom_element_signal_parsed (element);
+}
+
+static void
+dax_dom_document_end_element (ParserContext *ctx)
+{
+    DaxDomElement *element;
+    DaxDomNode *parent;
+
+    element = DAX_DOM_ELEMENT (ctx->current_node);
+
+    DAX_NOTE (PARSING, "end of %s", G_OBJECT_TYPE_NAME (ctx->current_node));
+
+    if (!ctx->defer_setup)
+        dax_dom_document_finish_element (ctx->document, element);
+
+    parent = ctx->current_node->parent_node;
+    ctx->current_node = parent;
+
+    /* top level elements, children of the document element, can be rendered
+     * while the rest of the document is still being parsed */
+    if (ctx->parser && parent &&
+        parent->parent_node == DAX_DOM_NODE (ctx->document))
+    {
+        g_signal_emit (ctx->parser, parser_signals[ELEMENT_PARSED], 0,
+                       element);
+    }
+}
+
+static DaxDomElement *
+dax_dom_document_start_element (ParserContext *ctx,
+                                const gchar   *name)
+{
+    DaxDomElement *new_element;
+
+    new_element = dax_dom_document_create_element (ctx->document, name, NULL);
+
+    if (G_UNLIKELY (new_element == NULL)) {
+        g_message ("Unsupported element %s", name);
+        new_element =
+            dax_dom_document_create_element (ctx->document, "desc", NULL);
+    }
+
+    DAX_NOTE (PARSING, "Append %s to %s",
+                 G_OBJECT_TYPE_NAME (new_element),
+                 G_OBJECT_TYPE_NAME (ctx->current_node));
+
+    dax_dom_node_append_child (ctx->current_node,
+                                  DAX_DOM_NODE (new_element),
+                                  NULL);
+    ctx->current_node = DAX_DOM_NODE (new_element);
+
+    return new_element;
+}
+
+static void
+dax_dom_document_add_text (ParserContext *ctx,
+                           const gchar   *data)
+{
+    DaxDomText *new_text;
+
+    new_text = dax_dom_document_create_text_node (ctx->document, data);
+
+    /* Happens if we are short on memory, hopefully never */
+    if (G_UNLIKELY (new_text == NULL)) {
+        g_critical ("Cannot create text node");
+        return;
+    }
+
+    DAX_NOTE (PARSING, "Append text node to %s",
+                 G_OBJECT_TYPE_NAME (ctx->current_node));
 
-    ctx->current_node = ctx->current_node->parent_node;
+    dax_dom_node_append_child (ctx->current_node,
+                                  DAX_DOM_NODE (new_text),
+                                  NULL);
 }
 
 static void
@@ -67,31 +161,18 @@ dax_dom_document_read_node (DaxDomDocument *document,
     case DAX_DOM_NODE_TYPE_ELEMENT:
     {
         const xmlChar *local_name = xmlTextReaderConstLocalName (ctx->reader);
-        const gchar *name = (const gchar *)local_name;
         DaxDomElement *new_element;
         gboolean is_empty = FALSE;
 
-        new_element = dax_dom_document_create_element (document, name, NULL);
-
-        if (G_UNLIKELY (new_element == NULL)) {
-            g_message ("Unsupported element %s", name);
-            new_element =
-                dax_dom_document_create_element (document, "desc", NULL);
-        }
-
-        DAX_NOTE (PARSING, "Append %s to %s",
-                     G_OBJECT_TYPE_NAME (new_element),
-                     G_OBJECT_TYPE_NAME (ctx->current_node));
-
-        dax_dom_node_append_child (ctx->current_node,
-                                      DAX_DOM_NODE (new_element),
-                                      NULL);
-        ctx->current_node = DAX_DOM_NODE (new_element);
+        new_element = dax_dom_document_start_element (ctx,
+                                                      (const gchar *)
+                                                      local_name);
 
         if (xmlTextReaderIsEmptyElement (ctx->reader))
             is_empty = TRUE;
 
         /* Parse attributes */
+        _dax_dom_document_begin_parsing (ctx->document);
         while (xmlTextReaderMoveToNextAttribute (ctx->reader) == 1) {
             const xmlChar *_name = xmlTextReaderConstName (ctx->reader);
             const xmlChar *_value = xmlTextReaderConstValue (ctx->reader);
@@ -103,6 +184,7 @@ dax_dom_document_read_node (DaxDomDocument *document,
                                                  (const gchar *)_value,
                                                  NULL);
         }
+        _dax_dom_document_end_parsing (ctx->document);
 
         /* if the element is empty a DAX_DOM_NODE_TYPE_END_ELEMENT won't
          * be emited, so update current_node here */
@@ -120,23 +202,8 @@ dax_dom_document_read_node (DaxDomDocument *document,
     case DAX_DOM_NODE_TYPE_CDATA_SECTION:
     {
         const xmlChar *value = xmlTextReaderConstValue (ctx->reader);
-        const gchar *data = (const gchar *)value;
-        DaxDomText *new_text;
-
-        new_text = dax_dom_document_create_text_node (document, data);
-
-        /* Happens if we are short on memory, hopefully never */
-        if (G_UNLIKELY (new_text == NULL)) {
-            g_critical ("Cannot create text node");
-            break;
-        }
-
-        DAX_NOTE (PARSING, "Append text node to %s",
-                     G_OBJECT_TYPE_NAME (ctx->current_node));
 
-        dax_dom_node_append_child (ctx->current_node,
-                                      DAX_DOM_NODE (new_text),
-                                      NULL);
+        dax_dom_document_add_text (ctx, (const gchar *)value);
         break;
     }
     default:
@@ -144,14 +211,13 @@ dax_dom_document_read_node (DaxDomDocument *document,
     }
 }
 
-static void
-dax_dom_document_parse_and_setup (DaxDomDocument *document,
-                                  ParserContext  *ctx)
+/* also used when loading precompiled documents */
+void
+_dax_dom_document_setup_js (DaxDomDocument *document)
 {
     DoxNavigator *navigator;
     DaxJsContext *js_context;
     DaxJsObject *js_object;
-    int ret;
 
     /* setup a few JS global objects */
     js_context = dax_dom_document_get_js_context (document);
@@ -161,41 +227,448 @@ dax_dom_document_parse_and_setup (DaxDomDocument *document,
     js_object = dax_js_context_new_object_from_gobject (js_context,
                                                         G_OBJECT (navigator));
     dax_js_context_add_global_object (js_context, "navigator", js_object);
+}
+
+static void
+dax_dom_document_parse_and_setup (DaxDomDocument *document,
+                                  ParserContext  *ctx)
+{
+    guint n_nodes = 0;
+    int ret;
+
+    if (!ctx->defer_setup)
+        _dax_dom_document_setup_js (document);
 
     ctx->document = document;
+    ctx->parser = NULL;
 
     ret = xmlTextReaderRead (ctx->reader);
     while (ret == 1) {
         dax_dom_document_read_node (document, ctx);
+
+        /* the caller checks the cancellable again once we are done */
+        if (ctx->cancellable && (++n_nodes & 0xff) == 0 &&
+            g_cancellable_is_cancelled (ctx->cancellable))
+        {
+            break;
+        }
+
         ret = xmlTextReaderRead(ctx->reader);
     }
     xmlFreeTextReader(ctx->reader);
     /* FIXME: handle the error case where ret = -1 */
 }
 
+/*
+ * Progressive parsing, libxml2's SAX2 push parser feeds the same helpers as
+ * the xmlTextReader above
+ */
+
+static gboolean
+is_blank (const GString *string)
+{
+    gsize i;
+
+    for (i = 0; i < string->len; i++)
+        if (!g_ascii_isspace (string->str[i]))
+            return FALSE;
+
+    return TRUE;
+}
+
+/* SAX gives character data in pieces, create a text node once it's all
+ * there. Like xmlTextReader, blank text is not part of the tree */
+static void
+flush_text (ParserContext *ctx)
+{
+    if (ctx->text->len == 0)
+        return;
+
+    if (ctx->text_is_cdata || !is_blank (ctx->text))
+        dax_dom_document_add_text (ctx, ctx->text->str);
+
+    g_string_truncate (ctx->text, 0);
+}
+
+static void
+append_text (ParserContext *ctx,
+             const xmlChar *ch,
+             int            len,
+             gboolean       is_cdata)
+{
+    if (ctx->text->len && ctx->text_is_cdata != is_cdata)
+        flush_text (ctx);
+
+    ctx->text_is_cdata = is_cdata;
+    g_string_append_len (ctx->text, (const gchar *) ch, len);
+}
+
+/* the default SAX2 handlers kept for the DTD and the entities expect the
+ * libxml2 context as user data, ours is stored in its _private field */
+#define SAX_CONTEXT(user_data) \
+        ((ParserContext *) ((xmlParserCtxtPtr) (user_data))->_private)
+
+static void
+sax_characters (void          *user_data,
+                const xmlChar *ch,
+                int            len)
+{
+    append_text (SAX_CONTEXT (user_data), ch, len, FALSE);
+}
+
+static void
+sax_cdata_block (void          *user_data,
+                 const xmlChar *value,
+                 int            len)
+{
+    append_text (SAX_CONTEXT (user_data), value, len, TRUE);
+}
+
+static void
+sax_start_element (void           *user_data,
+                   const xmlChar  *localname,
+                   const xmlChar  *prefix,
+                   const xmlChar  *uri,
+                   int             nb_namespaces,
+                   const xmlChar **namespaces,
+                   int             nb_attributes,
+                   int             nb_defaulted,
+                   const xmlChar **attributes)
+{
+    ParserContext *ctx = SAX_CONTEXT (user_data);
+    DaxDomElement *new_element;
+    GString *name = ctx->name, *value = ctx->value;
+    int i;
+
+    flush_text (ctx);
+
+    new_element = dax_dom_document_start_element (ctx,
+                                                  (const gchar *) localname);
+
+    _dax_dom_document_begin_parsing (ctx->document);
+
+    /* xmlTextReader reports namespace declarations as attributes */
+    for (i = 0; i < nb_namespaces; i++) {
+        const xmlChar *ns_prefix = namespaces[i * 2];
+        const xmlChar *ns_uri = namespaces[i * 2 + 1];
+
+        g_string_assign (name, "xmlns");
+        if (ns_prefix) {
+            g_string_append_c (name, ':');
+            g_string_append (name, (const gchar *) ns_prefix);
+        }
+
+        dax_dom_element_set_attribute_ns (new_element,
+                                          DAX_DOM_XMLNS_NS_URI,
+                                          name->str,
+                                          (const gchar *) ns_uri,
+                                          NULL);
+    }
+
+    /* attributes are (localname, prefix, URI, value, end) tuples */
+    for (i = 0; i < nb_attributes; i++) {
+        const xmlChar **attribute = &attributes[i * 5];
+
+        g_string_truncate (name, 0);
+        if (attribute[1]) {
+            g_string_append (name, (const gchar *) attribute[1]);
+            g_string_append_c (name, ':');
+        }
+        g_string_append (name, (const gchar *) attribute[0]);
+
+        /* values are not NUL terminated, reuse the same buffer for all of
+         * them, string attributes are interned by the elements */
+        g_string_truncate (value, 0);
+        g_string_append_len (value, (const gchar *) attribute[3],
+                             attribute[4] - attribute[3]);
+        dax_dom_element_set_attribute_ns (new_element,
+                                          (const gchar *) attribute[2],
+                                          name->str,
+                                          value->str,
+                                          NULL);
+    }
+
+    _dax_dom_document_end_parsing (ctx->document);
+}
+
+static void
+sax_end_element (void          *user_data,
+                 const xmlChar *localname,
+                 const xmlChar *prefix,
+                 const xmlChar *uri)
+{
+    ParserContext *ctx = SAX_CONTEXT (user_data);
+
+    flush_text (ctx);
+    dax_dom_document_end_element (ctx);
+}
+
+G_DEFINE_TYPE (DaxParser, dax_parser, G_TYPE_OBJECT)
+
+#define PARSER_PRIVATE(o)                               \
+        (G_TYPE_INSTANCE_GET_PRIVATE ((o),              \
+                                      DAX_TYPE_PARSER,  \
+                                      DaxParserPrivate))
+
+struct _DaxParserPrivate
+{
+    ParserContext ctx;
+    xmlParserCtxtPtr xml_ctxt;
+    gboolean finished;
+};
+
+GQuark
+dax_parser_error_quark (void)
+{
+    return g_quark_from_static_string ("dax-parser-error-quark");
+}
+
+static gboolean
+dax_parser_check_error (DaxParser  *parser,
+                        int         ret,
+                        GError    **error)
+{
+    xmlErrorPtr xml_error;
+
+    if (ret == XML_ERR_OK)
+        return TRUE;
+
+    xml_error = xmlCtxtGetLastError (parser->priv->xml_ctxt);
+    g_set_error (error,
+                 DAX_PARSER_ERROR,
+                 DAX_PARSER_ERROR_INVALID_XML,
+                 "%s",
+                 xml_error && xml_error->message ?
+                 xml_error->message : "Invalid XML");
+
+    return FALSE;
+}
+
+/*
+ * GObject implementation
+ */
+
+static void
+dax_parser_finalize (GObject *object)
+{
+    DaxParser *parser = (DaxParser *) object;
+    DaxParserPrivate *priv = parser->priv;
+
+    if (priv->xml_ctxt) {
+        /* the default startDocument handler builds a xmlDoc holding the
+         * DTD and the entities */
+        if (priv->xml_ctxt->myDoc)
+            xmlFreeDoc (priv->xml_ctxt->myDoc);
+        xmlFreeParserCtxt (priv->xml_ctxt);
+    }
+
+    g_string_free (priv->ctx.text, TRUE);
+    g_string_free (priv->ctx.name, TRUE);
+    g_string_free (priv->ctx.value, TRUE);
+    g_object_unref (priv->ctx.document);
+
+    G_OBJECT_CLASS (dax_parser_parent_class)->finalize (object);
+}
+
+static void
+dax_parser_class_init (DaxParserClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (klass, sizeof (DaxParserPrivate));
+
+    object_class->finalize = dax_parser_finalize;
+
+    /**
+     * DaxParser::element-parsed:
+     * @parser: the #DaxParser that received the signal
+     * @element: the #DaxDomElement that has just been parsed
+     *
+     * Emitted when the end tag of a child of the document element has been
+     * parsed. @element and its subtree are complete and can be rendered
+     * while the rest of the document is still to come.
+     */
+    parser_signals[ELEMENT_PARSED] =
+        g_signal_new (I_("element-parsed"),
+                      G_TYPE_FROM_CLASS (klass),
+                      G_SIGNAL_RUN_LAST,
+                      0,
+                      NULL, NULL,
+                      g_cclosure_marshal_VOID__OBJECT,
+                      G_TYPE_NONE, 1,
+                      DAX_TYPE_DOM_ELEMENT);
+}
+
+static void
+dax_parser_init (DaxParser *self)
+{
+    self->priv = PARSER_PRIVATE (self);
+}
+
+static gpointer
+init_sax_handler (gpointer data)
+{
+    xmlSAXHandler *sax = data;
+
+    /* keep the default handlers for the DTD and the entities */
+    xmlSAXVersion (sax, 2);
+    sax->startElementNs = sax_start_element;
+    sax->endElementNs = sax_end_element;
+    sax->characters = sax_characters;
+    sax->ignorableWhitespace = sax_characters;
+    sax->cdataBlock = sax_cdata_block;
+    sax->reference = NULL;
+    sax->comment = NULL;
+    sax->processingInstruction = NULL;
+
+    return sax;
+}
+
 /**
- * dax_dom_document_new_from_memory:
+ * dax_parser_new:
+ * @base_iri: the base IRI of the document
  *
- * Creates a new #DaxDomDocument. FIXME
+ * Creates a parser building a #DaxDomDocument from the chunks given to
+ * dax_parser_feed(). #DaxParser::element-parsed is emitted as soon as each
+ * top level element is complete.
  *
- * Return value: the newly created #DaxDomDocument instance
+ * Return value: the newly created #DaxParser
+ */
+DaxParser *
+dax_parser_new (const gchar *base_iri)
+{
+    static xmlSAXHandler sax;
+    static GOnce sax_once = G_ONCE_INIT;
+    DaxParser *parser;
+    DaxParserPrivate *priv;
+
+    /* the handler is shared by all the parsers */
+    g_once (&sax_once, init_sax_handler, &sax);
+
+    parser = g_object_new (DAX_TYPE_PARSER, NULL);
+    priv = parser->priv;
+
+    priv->ctx.document = dax_document_new ();
+    priv->ctx.current_node = DAX_DOM_NODE (priv->ctx.document);
+    priv->ctx.parser = parser;
+    priv->ctx.text = g_string_new (NULL);
+    priv->ctx.name = g_string_new (NULL);
+    priv->ctx.value = g_string_new (NULL);
+
+    dax_dom_document_set_base_iri (priv->ctx.document, base_iri);
+    _dax_dom_document_setup_js (priv->ctx.document);
+
+    priv->xml_ctxt = xmlCreatePushParserCtxt (&sax, NULL, NULL, 0, base_iri);
+    priv->xml_ctxt->_private = &priv->ctx;
+    xmlCtxtUseOptions (priv->xml_ctxt, XML_PARSE_NOENT);
+
+    return parser;
+}
+
+/**
+ * dax_parser_feed:
+ * @parser: a #DaxParser
+ * @buffer: the next chunk of the document
+ * @size: the size of @buffer, or -1 if it is nul-terminated
+ * @error: return location for a #GError, or %NULL
+ *
+ * Parses the next chunk of the document.
+ *
+ * Return value: %FALSE if the document is not well formed
+ */
+gboolean
+dax_parser_feed (DaxParser    *parser,
+                 const gchar  *buffer,
+                 gssize        size,
+                 GError      **error)
+{
+    DaxParserPrivate *priv;
+    int ret;
+
+    g_return_val_if_fail (DAX_IS_PARSER (parser), FALSE);
+    g_return_val_if_fail (buffer != NULL || size == 0, FALSE);
+
+    priv = parser->priv;
+    g_return_val_if_fail (!priv->finished, FALSE);
+
+    if (size < 0)
+        size = strlen (buffer);
+    if (size == 0)
+        return TRUE;
+
+    ret = xmlParseChunk (priv->xml_ctxt, buffer, size, 0);
+
+    return dax_parser_check_error (parser, ret, error);
+}
+
+/**
+ * dax_parser_end:
+ * @parser: a #DaxParser
+ * @error: return location for a #GError, or %NULL
+ *
+ * Tells @parser the whole document has been fed.
+ *
+ * Return value: %FALSE if the document is not well formed
+ */
+gboolean
+dax_parser_end (DaxParser  *parser,
+                GError    **error)
+{
+    DaxParserPrivate *priv;
+    int ret;
+
+    g_return_val_if_fail (DAX_IS_PARSER (parser), FALSE);
+
+    priv = parser->priv;
+    if (priv->finished)
+        return TRUE;
+
+    priv->finished = TRUE;
+    ret = xmlParseChunk (priv->xml_ctxt, NULL, 0, 1);
+    flush_text (&priv->ctx);
+
+    return dax_parser_check_error (parser, ret, error);
+}
+
+/**
+ * dax_parser_get_document:
+ * @parser: a #DaxParser
+ *
+ * The document is available right after dax_parser_new() and grows as
+ * chunks are fed.
+ *
+ * Return value: the #DaxDomDocument built by @parser, owned by @parser
  */
 DaxDomDocument *
-dax_dom_document_new_from_memory (const gchar  *buffer,
-                                  gint          size,
-                                  const gchar  *base_iri,
-                                  GError      **error)
+dax_parser_get_document (DaxParser *parser)
+{
+    g_return_val_if_fail (DAX_IS_PARSER (parser), NULL);
+
+    return parser->priv->ctx.document;
+}
+
+/* @url is the one of the document for libxml2, @options its parser flags */
+static DaxDomDocument *
+load_memory (const gchar  *buffer,
+             gint          size,
+             const gchar  *url,
+             gint          options,
+             const gchar  *base_iri,
+             gboolean      defer_setup,
+             GCancellable *cancellable,
+             GError      **error)
 {
     DaxDomDocument *document;
     ParserContext ctx;
 
-    ctx.reader = xmlReaderForMemory(buffer, size, base_iri, NULL,
-                                    XML_PARSE_XINCLUDE);
+    ctx.reader = xmlReaderForMemory(buffer, size, url, NULL, options);
     if (ctx.reader == NULL)
         return NULL;
 
     document = dax_document_new ();
     ctx.current_node = DAX_DOM_NODE (document);
+    ctx.defer_setup = defer_setup;
+    ctx.cancellable = cancellable;
 
     /* Set up the base uri */
     dax_dom_document_set_base_iri (document, base_iri);
@@ -205,39 +678,370 @@ dax_dom_document_new_from_memory (const gchar  *buffer,
     return document;
 }
 
-/**
- * dax_dom_document_new_from_file:
- *
- * Creates a new #DaxDomDocument. FIXME
- *
- * Return value: the newly created #DaxDomDocument instance
- */
-DaxDomDocument *
-dax_dom_document_new_from_file (const gchar  *filename,
-                                GError      **error)
+static DaxDomDocument *
+load_file (const gchar  *filename,
+           gboolean      defer_setup,
+           GCancellable *cancellable,
+           GError      **error)
 {
     DaxDomDocument *document;
+    GMappedFile *mapped_file;
     GFile *file, *directory;
     ParserContext ctx;
-    gchar *base_uri;
+    gchar *file_uri, *base_uri;
+
+    file = g_file_new_for_commandline_arg (filename);
+    directory = g_file_get_parent (file);
+    file_uri = g_file_get_uri (file);
+    base_uri = g_file_get_uri (directory);
+    g_object_unref (file);
+    g_object_unref (directory);
+
+    /* Map the file and have libxml2 read it in place rather than copying it
+     * through its buffered I/O. The memory reader is limited to G_MAXINT
+     * bytes, bigger files go through the usual reader */
+    mapped_file = g_mapped_file_new (filename, FALSE, NULL);
+    if (mapped_file) {
+        const gchar *contents = g_mapped_file_get_contents (mapped_file);
+        gsize length = g_mapped_file_get_length (mapped_file);
+
+        /* documents precompiled with dax_dom_document_save_binary() */
+        if (_dax_binary_has_magic (contents, length)) {
+            document = _dax_binary_load_mapped_file (mapped_file, base_uri,
+                                                     defer_setup, error);
+            g_mapped_file_unref (mapped_file);
+            g_free (file_uri);
+            g_free (base_uri);
+            return document;
+        }
+
+        /* same URL and flags as xmlNewTextReaderFilename() below */
+        document = NULL;
+        if (length > 0 && length <= G_MAXINT)
+            document = load_memory (contents, length, file_uri, 0, base_uri,
+                                    defer_setup, cancellable, error);
+        g_mapped_file_unref (mapped_file);
+
+        if (document) {
+            g_free (file_uri);
+            g_free (base_uri);
+            return document;
+        }
+    }
+    g_free (file_uri);
 
     ctx.reader = xmlNewTextReaderFilename(filename);
-    if (ctx.reader == NULL)
+    if (ctx.reader == NULL) {
+        g_free (base_uri);
         return NULL;
+    }
 
     document = dax_document_new();
     ctx.current_node = DAX_DOM_NODE (document);
+    ctx.defer_setup = defer_setup;
+    ctx.cancellable = cancellable;
 
     /* Set up the base uri */
-    file = g_file_new_for_commandline_arg (filename);
-    directory = g_file_get_parent (file);
-    base_uri = g_file_get_uri (directory);
     dax_dom_document_set_base_iri (document, base_uri);
     g_free (base_uri);
-    g_object_unref (file);
-    g_object_unref (directory);
 
     dax_dom_document_parse_and_setup (document, &ctx);
 
     return document;
 }
+
+/**
+ * dax_dom_document_new_from_memory:
+ *
+ * Creates a new #DaxDomDocument. FIXME
+ *
+ * Return value: the newly created #DaxDomDocument instance
+ */
+DaxDomDocument *
+dax_dom_document_new_from_memory (const gchar  *buffer,
+                                  gint          size,
+                                  const gchar  *base_iri,
+                                  GError      **error)
+{
+    return load_memory (buffer, size, base_iri, XML_PARSE_XINCLUDE, base_iri,
+                        FALSE, NULL, error);
+}
+
+/**
+ * dax_dom_document_new_from_file:
+ *
+ * Creates a new #DaxDomDocument. FIXME
+ *
+ * The file is memory mapped for the time of the parsing, the document does
+ * not reference it once loaded. Documents precompiled with
+ * dax_dom_document_save_binary() are recognized and loaded without parsing
+ * any XML.
+ *
+ * Return value: the newly created #DaxDomDocument instance
+ */
+DaxDomDocument *
+dax_dom_document_new_from_file (const gchar  *filename,
+                                GError      **error)
+{
+    return load_file (filename, FALSE, NULL, error);
+}
+
+/* @node or the first of its next siblings that is an element */
+static DaxDomNode *
+skip_to_element (DaxDomNode *node)
+{
+    while (node && !DAX_IS_DOM_ELEMENT (node))
+        node = node->next_sibling;
+
+    return node;
+}
+
+/* children first, in the order the parser would have ended them. The walk
+ * follows the links of the tree rather than recursing, documents can be
+ * deeper than the stack */
+static void
+dax_dom_document_finish_subtree (DaxDomDocument *document,
+                                 DaxDomNode     *root)
+{
+    DaxDomNode *node = root, *child;
+
+    for (;;) {
+        child = skip_to_element (node->first_child);
+        if (child) {
+            node = child;
+            continue;
+        }
+
+        /* all the children of node are finished, finish it and go to its
+         * next sibling, or up to its parent */
+        for (;;) {
+            DaxDomNode *next;
+
+            dax_dom_document_finish_element (document, DAX_DOM_ELEMENT (node));
+            if (node == root)
+                return;
+
+            next = skip_to_element (node->next_sibling);
+            if (next) {
+                node = next;
+                break;
+            }
+            node = node->parent_node;
+        }
+    }
+}
+
+/* what the parser did not do when parsing in a worker thread, has to be
+ * called from the main thread */
+void
+_dax_dom_document_finish_setup (DaxDomDocument *document)
+{
+    DaxDomNode *child;
+
+    _dax_dom_document_setup_js (document);
+
+    for (child = DAX_DOM_NODE (document)->first_child;
+         child;
+         child = child->next_sibling)
+    {
+        if (DAX_IS_DOM_ELEMENT (child))
+            dax_dom_document_finish_subtree (document, child);
+    }
+}
+
+/*
+ * Asynchronous loading. The documents are parsed in a pool of threads, the
+ * parts touching the JS context and the "parsed" signals, that can start
+ * loading images or run scripts, are done back in the main thread with an
+ * idle.
+ */
+
+#define DEFAULT_LOADING_THREADS     2
+
+/* only used from the main thread */
+static GThreadPool *loaders;    /* created on the first asynchronous load */
+static guint loading_threads = DEFAULT_LOADING_THREADS;
+
+typedef struct
+{
+    gchar *filename;
+    GCancellable *cancellable;
+    GSimpleAsyncResult *result;
+    DaxDomDocument *document;
+    GError *error;
+} LoadJob;
+
+static void
+load_job_free (LoadJob *job)
+{
+    g_free (job->filename);
+    if (job->cancellable)
+        g_object_unref (job->cancellable);
+    g_object_unref (job->result);
+    if (job->document)
+        g_object_unref (job->document);
+    if (job->error)
+        g_error_free (job->error);
+    g_slice_free (LoadJob, job);
+}
+
+static void
+load_job_run (LoadJob *job)
+{
+    if (g_cancellable_set_error_if_cancelled (job->cancellable, &job->error))
+        return;
+
+    job->document = load_file (job->filename, TRUE, job->cancellable,
+                               &job->error);
+
+    /* cancelled while loading, the document may be incomplete */
+    if (job->document &&
+        g_cancellable_set_error_if_cancelled (job->cancellable, &job->error))
+    {
+        g_object_unref (job->document);
+        job->document = NULL;
+    }
+
+    if (job->document == NULL && job->error == NULL)
+        g_set_error (&job->error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                     "Could not load %s", job->filename);
+}
+
+static gboolean
+load_job_finish (gpointer data)
+{
+    LoadJob *job = data;
+
+    /* the operation can be cancelled until it completes */
+    if (job->document &&
+        g_cancellable_set_error_if_cancelled (job->cancellable, &job->error))
+    {
+        g_object_unref (job->document);
+        job->document = NULL;
+    }
+
+    if (job->document) {
+        _dax_dom_document_finish_setup (job->document);
+        g_simple_async_result_set_op_res_gpointer (job->result,
+                                                   g_object_ref (job->document),
+                                                   g_object_unref);
+    } else {
+        g_simple_async_result_set_from_error (job->result, job->error);
+    }
+
+    g_simple_async_result_complete (job->result);
+    load_job_free (job);
+
+    return FALSE;
+}
+
+static void
+loader_thread (gpointer data,
+               gpointer user_data)
+{
+    LoadJob *job = data;
+
+    DAX_NOTE (LOADING, "loading %s in a worker thread", job->filename);
+    load_job_run (job);
+    g_idle_add (load_job_finish, job);
+}
+
+/**
+ * dax_dom_document_new_from_file_async:
+ * @filename: the file to load
+ * @cancellable: a #GCancellable, or %NULL
+ * @callback: called when the document is loaded
+ * @user_data: data for @callback
+ *
+ * Loads a document in a worker thread, see
+ * dax_dom_document_set_loading_threads(). Several documents can be loaded in
+ * parallel this way. The scripts of the document are set up in the main
+ * thread, before @callback is called. Call
+ * dax_dom_document_new_from_file_finish() from @callback to get the
+ * document.
+ */
+void
+dax_dom_document_new_from_file_async (const gchar         *filename,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+    LoadJob *job;
+
+    g_return_if_fail (filename != NULL);
+
+    job = g_slice_new0 (LoadJob);
+    job->filename = g_strdup (filename);
+    if (cancellable)
+        job->cancellable = g_object_ref (cancellable);
+    job->result =
+        g_simple_async_result_new (NULL, callback, user_data,
+                                   dax_dom_document_new_from_file_async);
+
+    if (loading_threads == 0) {
+        load_job_run (job);
+        g_idle_add (load_job_finish, job);
+        return;
+    }
+
+    if (loaders == NULL) {
+        /* libxml2 has to be initialized before being used by threads */
+        xmlInitParser ();
+        /* and the element types registered */
+        dax_document_lookup_element ("svg");
+
+        loaders = g_thread_pool_new (loader_thread,
+                                     NULL,
+                                     loading_threads,
+                                     FALSE,
+                                     NULL);
+    }
+
+    g_thread_pool_push (loaders, job, NULL);
+}
+
+/**
+ * dax_dom_document_new_from_file_finish:
+ * @result: the #GAsyncResult given to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finishes loading a document started with
+ * dax_dom_document_new_from_file_async().
+ *
+ * Return value: the new document, or %NULL on error
+ */
+DaxDomDocument *
+dax_dom_document_new_from_file_finish (GAsyncResult  *result,
+                                       GError       **error)
+{
+    GSimpleAsyncResult *simple;
+
+    g_return_val_if_fail (g_simple_async_result_is_valid (result, NULL,
+                              dax_dom_document_new_from_file_async), NULL);
+
+    simple = G_SIMPLE_ASYNC_RESULT (result);
+    if (g_simple_async_result_propagate_error (simple, error))
+        return NULL;
+
+    return g_object_ref (g_simple_async_result_get_op_res_gpointer (simple));
+}
+
+/**
+ * dax_dom_document_set_loading_threads:
+ * @n_threads: number of threads, 0 to load the documents synchronously
+ *
+ * Sets the number of threads used by dax_dom_document_new_from_file_async().
+ */
+void
+dax_dom_document_set_loading_threads (guint n_threads)
+{
+    loading_threads = n_threads;
+    if (loaders && n_threads > 0)
+        g_thread_pool_set_max_threads (loaders, n_threads, NULL);
+}
+
+guint
+dax_dom_document_get_loading_threads (void)
+{
+    return loading_threads;
+}
@@ -25,10 +25,57 @@
 
 #include "dax-dom-document.h"
 
-#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
+#define DAX_TYPE_PARSER dax_parser_get_type()
+
+#define DAX_PARSER(obj)                                 \
+    (G_TYPE_CHECK_INSTANCE_CAST ((obj),                 \
+                                 DAX_TYPE_PARSER,       \
+                                 DaxParser))
+
+#define DAX_PARSER_CLASS(klass)                         \
+    (G_TYPE_CHECK_CLASS_CAST ((klass),                  \
+                              DAX_TYPE_PARSER,          \
+                              DaxParserClass))
+
+#define DAX_IS_PARSER(obj)                              \
+    (G_TYPE_CHECK_INSTANCE_TYPE ((obj), DAX_TYPE_PARSER))
+
+#define DAX_IS_PARSER_CLASS(klass)                      \
+    (G_TYPE_CHECK_CLASS_TYPE ((klass), DAX_TYPE_PARSER))
+
+#define DAX_PARSER_GET_CLASS(obj)                       \
+    (G_TYPE_INSTANCE_GET_CLASS ((obj),                  \
+                                DAX_TYPE_PARSER,        \
+                                DaxParserClass))
+
+#define DAX_PARSER_ERROR (dax_parser_error_quark ())
+
+typedef enum /*< skip >*/
+{
+    DAX_PARSER_ERROR_INVALID_XML
+} DaxParserError;
+
+typedef struct _DaxParser DaxParser;
+typedef struct _DaxParserClass DaxParserClass;
+typedef struct _DaxParserPrivate DaxParserPrivate;
+
+struct _DaxParser
+{
+    GObject parent;
+
+    DaxParserPrivate *priv;
+};
+
+struct _DaxParserClass
+{
+    GObjectClass parent_class;
+};
+
 DaxDomDocument *    dax_dom_document_new_from_file      (const gchar  *filename,
                                                          GError      **error);
 DaxDomDocument *    dax_dom_document_new_from_memory    (const gchar  *buffer,
@@ -36,6 +83,27 @@ DaxDomDocument *    dax_dom_document_new_from_memory    (const gchar  *buffer,
                                                          const gchar  *base_iri,
                                                          GError      **error);
 
+void                dax_dom_document_new_from_file_async  (const gchar         *filename,
+                                                           GCancellable        *cancellable,
+                                                           GAsyncReadyCallback  callback,
+                                                           gpointer             user_data);
+DaxDomDocument *    dax_dom_document_new_from_file_finish (GAsyncResult        *result,
+                                                           GError             **error);
+void                dax_dom_document_set_loading_threads  (guint n_threads);
+guint               dax_dom_document_get_loading_threads  (void);
+
+GType               dax_parser_get_type                 (void) G_GNUC_CONST;
+GQuark              dax_parser_error_quark              (void);
+
+DaxParser *         dax_parser_new                      (const gchar  *base_iri);
+gboolean            dax_parser_feed                     (DaxParser    *parser,
+                                                         const gchar  *buffer,
+                                                         gssize        size,
+                                                         GError      **error);
+gboolean            dax_parser_end                      (DaxParser    *parser,
+                                                         GError      **error);
+DaxDomDocument *    dax_parser_get_document             (DaxParser    *parser);
+
 G_END_DECLS
 
 #endif /* __DAX_DOM_PARSER_H__ */
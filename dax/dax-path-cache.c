@@ -0,0 +1,338 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "dax-debug.h"
+
+#include "dax-path-cache.h"
+
+/*
+ * The geometry of the shapes is tessellated once per distinct path data,
+ * whatever the number of shapes drawing it. A CoglPath keeps the fill and
+ * stroke geometry it tessellated, so the entries share CoglPath handles.
+ *
+ * The entries are referenced by the shapes using them. The unused ones
+ * stay around, in case the same path data comes back, until the cache
+ * grows over max_size. The cache is only used from the main thread, when
+ * painting.
+ */
+
+#define DEFAULT_MAX_SIZE    (4 * 1024 * 1024)
+
+/* rough estimate of what cogl keeps for each point of a path: the stroke
+ * vertex, the fill triangles, curves being flattened into a few segments */
+#define POINT_SIZE          (8 * sizeof (gfloat))
+#define CURVE_SEGMENTS      8
+
+struct _DaxPathCacheEntry
+{
+    guint hash;
+    guint ref_count;
+
+    guint n_verbs;
+    guint n_coords;
+    guint8 *verbs;
+    gfloat *coords;
+
+    CoglHandle cogl_path;
+    gsize size;
+    GList *link;                    /* in the lru queue */
+};
+
+typedef struct
+{
+    GHashTable *entries;            /* DaxPathCacheEntry, used as key */
+    GQueue *lru;                    /* DaxPathCacheEntry, most recently used
+                                       first */
+    gsize size;
+    gsize max_size;
+
+    guint hits;
+    guint misses;
+    guint evictions;
+} DaxPathCache;
+
+static DaxPathCache *path_cache;
+
+static guint
+hash_bytes (guint         hash,
+            gconstpointer data,
+            gsize         len)
+{
+    const guchar *p = data;
+    gsize i;
+
+    for (i = 0; i < len; i++)
+        hash = (hash << 5) + hash + p[i];
+
+    return hash;
+}
+
+static guint
+entry_hash (gconstpointer key)
+{
+    const DaxPathCacheEntry *entry = key;
+
+    return entry->hash;
+}
+
+static gboolean
+entry_equal (gconstpointer a,
+             gconstpointer b)
+{
+    const DaxPathCacheEntry *entry_a = a, *entry_b = b;
+
+    return entry_a->hash == entry_b->hash &&
+           entry_a->n_verbs == entry_b->n_verbs &&
+           entry_a->n_coords == entry_b->n_coords &&
+           memcmp (entry_a->verbs, entry_b->verbs, entry_a->n_verbs) == 0 &&
+           memcmp (entry_a->coords, entry_b->coords,
+                   entry_a->n_coords * sizeof (gfloat)) == 0;
+}
+
+static DaxPathCache *
+get_cache (void)
+{
+    if (G_UNLIKELY (path_cache == NULL)) {
+        path_cache = g_slice_new0 (DaxPathCache);
+        path_cache->entries = g_hash_table_new (entry_hash, entry_equal);
+        path_cache->lru = g_queue_new ();
+        path_cache->max_size = DEFAULT_MAX_SIZE;
+    }
+
+    return path_cache;
+}
+
+static void
+draw_cogl_path (DaxPathCacheEntry *entry)
+{
+    const gfloat *p = entry->coords;
+    guint i;
+
+    cogl_path_new ();
+
+    for (i = 0; i < entry->n_verbs; i++) {
+        switch (entry->verbs[i]) {
+        case DAX_PATH_MOVE_TO:
+            cogl_path_move_to (p[0], p[1]);
+            p += 2;
+            break;
+        case DAX_PATH_LINE_TO:
+            cogl_path_line_to (p[0], p[1]);
+            p += 2;
+            break;
+        case DAX_PATH_CURVE_TO:
+            cogl_path_curve_to (p[0], p[1], p[2], p[3], p[4], p[5]);
+            p += 6;
+            break;
+        case DAX_PATH_CLOSE:
+            cogl_path_close ();
+            break;
+        default:
+            g_assert_not_reached ();
+        }
+    }
+}
+
+static gsize
+estimate_size (DaxPathCacheEntry *entry)
+{
+    gsize n_points = 0;
+    guint i;
+
+    for (i = 0; i < entry->n_verbs; i++)
+        n_points += entry->verbs[i] == DAX_PATH_CURVE_TO ? CURVE_SEGMENTS : 1;
+
+    return sizeof (DaxPathCacheEntry) + entry->n_verbs +
+           entry->n_coords * sizeof (gfloat) + n_points * POINT_SIZE;
+}
+
+static void
+remove_entry (DaxPathCache      *cache,
+              DaxPathCacheEntry *entry)
+{
+    cache->size -= entry->size;
+
+    g_hash_table_remove (cache->entries, entry);
+    g_queue_delete_link (cache->lru, entry->link);
+
+    cogl_handle_unref (entry->cogl_path);
+    g_free (entry->verbs);
+    g_free (entry->coords);
+    g_slice_free (DaxPathCacheEntry, entry);
+}
+
+/* Drop the least recently used entries that no shape uses until the cache
+ * fits in max_size */
+static void
+evict (DaxPathCache *cache)
+{
+    GList *link, *prev;
+
+    for (link = cache->lru->tail;
+         link && cache->size > cache->max_size;
+         link = prev)
+    {
+        DaxPathCacheEntry *entry = link->data;
+
+        prev = link->prev;
+
+        if (entry->ref_count)
+            continue;
+
+        DAX_NOTE (MEMORY, "evicting a path of %u verbs (%" G_GSIZE_FORMAT
+                  " bytes)", entry->n_verbs, entry->size);
+
+        remove_entry (cache, entry);
+        cache->evictions++;
+    }
+}
+
+/*
+ * Returns the entry holding the tessellated geometry of path, a reference
+ * to be released with _dax_path_cache_entry_unref(). Has to be called when
+ * painting as the geometry is built with the current cogl context.
+ */
+DaxPathCacheEntry *
+_dax_path_cache_lookup (DaxPath *path)
+{
+    DaxPathCache *cache = get_cache ();
+    DaxPathCacheEntry key, *entry;
+
+    /* the key borrows the data of path */
+    key.n_verbs = dax_path_get_n_verbs (path);
+    key.n_coords = dax_path_get_n_coords (path);
+    key.verbs = (guint8 *) dax_path_get_verbs (path);
+    key.coords = (gfloat *) dax_path_get_coords (path);
+    key.hash = hash_bytes (5381, key.verbs, key.n_verbs);
+    key.hash = hash_bytes (key.hash, key.coords,
+                           key.n_coords * sizeof (gfloat));
+
+    entry = g_hash_table_lookup (cache->entries, &key);
+    if (entry) {
+        cache->hits++;
+
+        /* move the entry to the front of the LRU list */
+        g_queue_unlink (cache->lru, entry->link);
+        g_queue_push_head_link (cache->lru, entry->link);
+
+        entry->ref_count++;
+        return entry;
+    }
+
+    cache->misses++;
+
+    entry = g_slice_new (DaxPathCacheEntry);
+    entry->hash = key.hash;
+    entry->ref_count = 1;
+    entry->n_verbs = key.n_verbs;
+    entry->n_coords = key.n_coords;
+    entry->verbs = g_memdup (key.verbs, key.n_verbs);
+    entry->coords = g_memdup (key.coords, key.n_coords * sizeof (gfloat));
+
+    draw_cogl_path (entry);
+    entry->cogl_path = cogl_handle_ref (cogl_get_path ());
+    entry->size = estimate_size (entry);
+
+    g_queue_push_head (cache->lru, entry);
+    entry->link = cache->lru->head;
+    g_hash_table_insert (cache->entries, entry, entry);
+    cache->size += entry->size;
+
+    /* the new entry is referenced, it stays */
+    evict (cache);
+
+    return entry;
+}
+
+CoglHandle
+_dax_path_cache_entry_get_cogl_path (DaxPathCacheEntry *entry)
+{
+    return entry->cogl_path;
+}
+
+void
+_dax_path_cache_entry_unref (DaxPathCacheEntry *entry)
+{
+    if (entry == NULL)
+        return;
+
+    g_return_if_fail (entry->ref_count > 0);
+
+    if (--entry->ref_count == 0)
+        evict (get_cache ());
+}
+
+/**
+ * dax_path_cache_get_max_size:
+ *
+ * Return value: the memory, in bytes, the geometry cache can take before
+ * the geometry no shape uses is dropped.
+ */
+gsize
+dax_path_cache_get_max_size (void)
+{
+    return get_cache ()->max_size;
+}
+
+/**
+ * dax_path_cache_set_max_size:
+ * @max_size: the memory, in bytes, the geometry cache can take
+ *
+ * Sets the memory the geometry cache can take before dropping the least
+ * recently used geometry that no shape uses. The geometry in use is never
+ * dropped.
+ */
+void
+dax_path_cache_set_max_size (gsize max_size)
+{
+    DaxPathCache *cache = get_cache ();
+
+    cache->max_size = max_size;
+    evict (cache);
+}
+
+/**
+ * dax_path_cache_get_stats:
+ * @stats: (out): a #DaxPathCacheStats to fill
+ *
+ * Retrieves the statistics of the geometry cache shared by the shapes.
+ */
+void
+dax_path_cache_get_stats (DaxPathCacheStats *stats)
+{
+    DaxPathCache *cache = get_cache ();
+
+    g_return_if_fail (stats);
+
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    stats->evictions = cache->evictions;
+    stats->n_entries = g_hash_table_size (cache->entries);
+    stats->size = cache->size;
+    stats->max_size = cache->max_size;
+}
+
+void
+dax_path_cache_reset_stats (void)
+{
+    DaxPathCache *cache = get_cache ();
+
+    cache->hits = cache->misses = cache->evictions = 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__DAX_H_INSIDE__) && !defined(DAX_COMPILATION)
+#error "Only <dax/dax.h> can be included directly."
+#endif
+
+#ifndef __DAX_PATH_CACHE_H__
+#define __DAX_PATH_CACHE_H__
+
+#include <glib.h>
+#include <cogl/cogl.h>
+
+#include "dax-path.h"
+
+G_BEGIN_DECLS
+
+typedef struct _DaxPathCacheEntry DaxPathCacheEntry;
+typedef struct _DaxPathCacheStats DaxPathCacheStats;
+
+/**
+ * DaxPathCacheStats:
+ * @hits: lookups that found the geometry already tessellated
+ * @misses: lookups that had to tessellate the geometry
+ * @evictions: entries dropped to keep the cache under @max_size
+ * @n_entries: number of entries in the cache
+ * @size: estimated memory taken by the entries, in bytes
+ * @max_size: memory the unused entries can take before being evicted
+ *
+ * Statistics of the geometry cache, see dax_path_cache_get_stats().
+ */
+struct _DaxPathCacheStats
+{
+    guint hits;
+    guint misses;
+    guint evictions;
+    guint n_entries;
+    gsize size;
+    gsize max_size;
+};
+
+gsize               dax_path_cache_get_max_size     (void);
+void                dax_path_cache_set_max_size     (gsize max_size);
+void                dax_path_cache_get_stats        (DaxPathCacheStats *stats);
+void                dax_path_cache_reset_stats      (void);
+
+DaxPathCacheEntry * _dax_path_cache_lookup          (DaxPath *path);
+CoglHandle          _dax_path_cache_entry_get_cogl_path
+                                                    (DaxPathCacheEntry *entry);
+void                _dax_path_cache_entry_unref     (DaxPathCacheEntry *entry);
+
+G_END_DECLS
+
+#endif /* __DAX_PATH_CACHE_H__ */
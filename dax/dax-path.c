@@ -0,0 +1,1208 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "dax-debug.h"
+#include "dax-private.h"
+#include "dax-utils.h"
+#include "dax-path.h"
+
+static void _register_transform_funcs (GType type);
+
+G_DEFINE_TYPE_WITH_CODE (DaxPath,
+                         dax_path,
+                         G_TYPE_OBJECT,
+                         _register_transform_funcs (g_define_type_id))
+
+#define PATH_PRIVATE(o)                                 \
+        (G_TYPE_INSTANCE_GET_PRIVATE ((o),              \
+                                      DAX_TYPE_PATH,    \
+                                      DaxPathPrivate))
+
+/* number of straight segments a curve is flattened into when hit-testing */
+#define CURVE_SEGMENTS  16
+
+/* number of coordinates used by each verb */
+static const guint verb_n_coords[] = { 2, 2, 6, 0 };
+
+struct _DaxPathPrivate
+{
+    guint8 *verbs;
+    guint n_verbs;
+    guint verbs_size;
+
+    gfloat *coords;
+    guint n_coords;
+    guint coords_size;
+
+    gboolean static_arrays;     /* arrays are not ours, don't free them */
+    DaxArena *arena;            /* holds the static arrays, if any */
+};
+
+static void
+dax_path_reserve (DaxPath *path,
+                  guint    n_verbs,
+                  guint    n_coords)
+{
+    DaxPathPrivate *priv = path->priv;
+
+    /* copy the arrays we don't own before growing them */
+    if (G_UNLIKELY (priv->static_arrays)) {
+        priv->verbs = g_memdup (priv->verbs, priv->verbs_size);
+        priv->coords = g_memdup (priv->coords,
+                                 priv->coords_size * sizeof (gfloat));
+        priv->static_arrays = FALSE;
+        _dax_arena_unref (priv->arena);
+        priv->arena = NULL;
+    }
+
+    if (priv->n_verbs + n_verbs > priv->verbs_size) {
+        priv->verbs_size = MAX (priv->verbs_size * 2, priv->n_verbs + n_verbs);
+        priv->verbs = g_realloc (priv->verbs, priv->verbs_size);
+    }
+
+    if (priv->n_coords + n_coords > priv->coords_size) {
+        priv->coords_size = MAX (priv->coords_size * 2,
+                                 priv->n_coords + n_coords);
+        priv->coords = g_realloc (priv->coords,
+                                  priv->coords_size * sizeof (gfloat));
+    }
+}
+
+/* give back what was reserved and not used */
+static void
+dax_path_shrink (DaxPath *path)
+{
+    DaxPathPrivate *priv = path->priv;
+
+    priv->verbs_size = priv->n_verbs;
+    priv->verbs = g_realloc (priv->verbs, priv->verbs_size);
+    priv->coords_size = priv->n_coords;
+    priv->coords = g_realloc (priv->coords,
+                              priv->coords_size * sizeof (gfloat));
+}
+
+static inline gfloat *
+dax_path_append (DaxPath     *path,
+                 DaxPathVerb  verb)
+{
+    DaxPathPrivate *priv = path->priv;
+    gfloat *coords;
+
+    if (G_UNLIKELY (priv->n_verbs == priv->verbs_size ||
+                    priv->n_coords + 6 > priv->coords_size))
+    {
+        dax_path_reserve (path, 1, 6);
+    }
+
+    priv->verbs[priv->n_verbs++] = verb;
+    coords = priv->coords + priv->n_coords;
+    priv->n_coords += verb_n_coords[verb];
+
+    return coords;
+}
+
+/*
+ * Path data parser.
+ *
+ * A single pass over the string, numbers are scanned in place and every
+ * command is converted to absolute move/line/curve/close verbs right away.
+ * Reference: SVG 1.1, section 8.3 and appendix F.6 for the arcs.
+ */
+
+typedef struct
+{
+    DaxPath *path;
+    const gchar *p;
+    const gchar *end;
+
+    gfloat x, y;                /* current point */
+    gfloat start_x, start_y;    /* start of the current sub-path */
+    gfloat ctrl_x, ctrl_y;      /* last control point, for S and T */
+    gchar last;                 /* last command, upper case */
+    gboolean closed;
+} PathParser;
+
+static inline void
+skip_space (PathParser *parser)
+{
+    while (g_ascii_isspace (*parser->p))
+        parser->p++;
+}
+
+/* white space with at most one comma */
+static inline void
+skip_separator (PathParser *parser)
+{
+    skip_space (parser);
+    if (*parser->p == ',') {
+        parser->p++;
+        skip_space (parser);
+    }
+}
+
+static inline gboolean
+starts_number (gchar c)
+{
+    return g_ascii_isdigit (c) || c == '-' || c == '+' || c == '.';
+}
+
+static gboolean
+parse_numbers (PathParser *parser,
+               gfloat     *numbers,
+               guint       n_numbers)
+{
+    guint i;
+
+    for (i = 0; i < n_numbers; i++) {
+        if (i)
+            skip_separator (parser);
+        if (!_dax_utils_parse_number (&parser->p, parser->end, &numbers[i]))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* flags are a single character, "a1 1 0 00 1 1" is valid */
+static gboolean
+parse_flag (PathParser *parser,
+            gboolean   *flag)
+{
+    skip_separator (parser);
+
+    if (*parser->p != '0' && *parser->p != '1')
+        return FALSE;
+
+    *flag = *parser->p == '1';
+    parser->p++;
+
+    return TRUE;
+}
+
+static void
+emit_move_to (PathParser *parser,
+              gfloat      x,
+              gfloat      y)
+{
+    gfloat *coords = dax_path_append (parser->path, DAX_PATH_MOVE_TO);
+
+    coords[0] = parser->x = parser->start_x = x;
+    coords[1] = parser->y = parser->start_y = y;
+    parser->closed = FALSE;
+}
+
+/* after a closepath, the next sub-path starts at the same initial point */
+static inline void
+ensure_sub_path (PathParser *parser)
+{
+    if (parser->closed)
+        emit_move_to (parser, parser->start_x, parser->start_y);
+}
+
+static void
+emit_line_to (PathParser *parser,
+              gfloat      x,
+              gfloat      y)
+{
+    gfloat *coords;
+
+    ensure_sub_path (parser);
+
+    coords = dax_path_append (parser->path, DAX_PATH_LINE_TO);
+    coords[0] = parser->x = x;
+    coords[1] = parser->y = y;
+}
+
+static void
+emit_curve_to (PathParser *parser,
+               gfloat      x1,
+               gfloat      y1,
+               gfloat      x2,
+               gfloat      y2,
+               gfloat      x3,
+               gfloat      y3)
+{
+    gfloat *coords;
+
+    ensure_sub_path (parser);
+
+    coords = dax_path_append (parser->path, DAX_PATH_CURVE_TO);
+    coords[0] = x1;
+    coords[1] = y1;
+    coords[2] = parser->ctrl_x = x2;
+    coords[3] = parser->ctrl_y = y2;
+    coords[4] = parser->x = x3;
+    coords[5] = parser->y = y3;
+}
+
+/* quadratic Bézier curves are exactly represented by cubic ones */
+static void
+emit_quad_to (PathParser *parser,
+              gfloat      qx,
+              gfloat      qy,
+              gfloat      x,
+              gfloat      y)
+{
+    gfloat x0 = parser->x, y0 = parser->y;
+
+    emit_curve_to (parser,
+                   x0 + 2.0f / 3.0f * (qx - x0), y0 + 2.0f / 3.0f * (qy - y0),
+                   x + 2.0f / 3.0f * (qx - x), y + 2.0f / 3.0f * (qy - y),
+                   x, y);
+    parser->ctrl_x = qx;
+    parser->ctrl_y = qy;
+}
+
+/* Convert an arc from the endpoint to the center parameterization, then
+ * approximate it with one cubic curve per quarter of ellipse at most */
+static void
+emit_arc_to (PathParser *parser,
+             gfloat      rx,
+             gfloat      ry,
+             gfloat      angle,
+             gboolean    large_arc,
+             gboolean    sweep,
+             gfloat      x,
+             gfloat      y)
+{
+    double x0 = parser->x, y0 = parser->y;
+    double sin_phi, cos_phi, dx2, dy2, x1p, y1p, rx2, ry2, x1p2, y1p2;
+    double lambda, num, coef, cxp, cyp, cx, cy, ux, uy, vx, vy;
+    double theta1, dtheta, delta, t;
+    guint n_segments, i;
+
+    /* the end point is the current point: the arc is omitted */
+    if (x0 == x && y0 == y)
+        return;
+
+    rx = fabsf (rx);
+    ry = fabsf (ry);
+    if (rx == 0.0f || ry == 0.0f) {
+        emit_line_to (parser, x, y);
+        return;
+    }
+
+    sin_phi = sin (angle * G_PI / 180.0);
+    cos_phi = cos (angle * G_PI / 180.0);
+
+    dx2 = (x0 - x) / 2.0;
+    dy2 = (y0 - y) / 2.0;
+    x1p = cos_phi * dx2 + sin_phi * dy2;
+    y1p = -sin_phi * dx2 + cos_phi * dy2;
+
+    /* scale up the radii if they can't reach the end point */
+    rx2 = (double) rx * rx;
+    ry2 = (double) ry * ry;
+    x1p2 = x1p * x1p;
+    y1p2 = y1p * y1p;
+    lambda = x1p2 / rx2 + y1p2 / ry2;
+    if (lambda > 1.0) {
+        double s = sqrt (lambda);
+
+        rx *= s;
+        ry *= s;
+        rx2 = (double) rx * rx;
+        ry2 = (double) ry * ry;
+    }
+
+    num = rx2 * ry2 - rx2 * y1p2 - ry2 * x1p2;
+    coef = num > 0.0 ? sqrt (num / (rx2 * y1p2 + ry2 * x1p2)) : 0.0;
+    if (large_arc == sweep)
+        coef = -coef;
+    cxp = coef * rx * y1p / ry;
+    cyp = -coef * ry * x1p / rx;
+
+    cx = cos_phi * cxp - sin_phi * cyp + (x0 + x) / 2.0;
+    cy = sin_phi * cxp + cos_phi * cyp + (y0 + y) / 2.0;
+
+    ux = (x1p - cxp) / rx;
+    uy = (y1p - cyp) / ry;
+    vx = (-x1p - cxp) / rx;
+    vy = (-y1p - cyp) / ry;
+    theta1 = atan2 (uy, ux);
+    dtheta = atan2 (ux * vy - uy * vx, ux * vx + uy * vy);
+    if (!sweep && dtheta > 0.0)
+        dtheta -= 2.0 * G_PI;
+    else if (sweep && dtheta < 0.0)
+        dtheta += 2.0 * G_PI;
+
+    n_segments = MAX (1, (guint) ceil (fabs (dtheta) / G_PI_2 - 1e-3));
+    delta = dtheta / n_segments;
+    t = 4.0 / 3.0 * tan (delta / 4.0);
+
+    for (i = 0; i < n_segments; i++) {
+        double a1 = theta1 + i * delta, a2 = a1 + delta;
+        double cos1 = cos (a1), sin1 = sin (a1);
+        double cos2 = cos (a2), sin2 = sin (a2);
+        double p[6];
+        guint j;
+
+        /* control and end points on the unit circle */
+        p[0] = cos1 - t * sin1;
+        p[1] = sin1 + t * cos1;
+        p[2] = cos2 + t * sin2;
+        p[3] = sin2 - t * cos2;
+        p[4] = cos2;
+        p[5] = sin2;
+
+        /* back to user space */
+        for (j = 0; j < 6; j += 2) {
+            double px = rx * p[j], py = ry * p[j + 1];
+
+            p[j] = cx + cos_phi * px - sin_phi * py;
+            p[j + 1] = cy + sin_phi * px + cos_phi * py;
+        }
+
+        /* don't accumulate errors on the end point */
+        if (i == n_segments - 1) {
+            p[4] = x;
+            p[5] = y;
+        }
+
+        emit_curve_to (parser, p[0], p[1], p[2], p[3], p[4], p[5]);
+    }
+}
+
+static gboolean
+parse_command (PathParser *parser,
+               gchar       command)
+{
+    gboolean relative = g_ascii_islower (command);
+    gchar type = g_ascii_toupper (command);
+    gfloat ox = 0.f, oy = 0.f, n[7];
+    gboolean large_arc, sweep;
+
+    if (relative) {
+        ox = parser->x;
+        oy = parser->y;
+    }
+
+    switch (type) {
+    case 'M':
+        if (!parse_numbers (parser, n, 2))
+            return FALSE;
+        emit_move_to (parser, ox + n[0], oy + n[1]);
+        break;
+
+    case 'L':
+        if (!parse_numbers (parser, n, 2))
+            return FALSE;
+        emit_line_to (parser, ox + n[0], oy + n[1]);
+        break;
+
+    case 'H':
+        if (!parse_numbers (parser, n, 1))
+            return FALSE;
+        emit_line_to (parser, ox + n[0], parser->y);
+        break;
+
+    case 'V':
+        if (!parse_numbers (parser, n, 1))
+            return FALSE;
+        emit_line_to (parser, parser->x, oy + n[0]);
+        break;
+
+    case 'C':
+        if (!parse_numbers (parser, n, 6))
+            return FALSE;
+        emit_curve_to (parser,
+                       ox + n[0], oy + n[1],
+                       ox + n[2], oy + n[3],
+                       ox + n[4], oy + n[5]);
+        break;
+
+    case 'S':
+    {
+        gfloat x1 = parser->x, y1 = parser->y;
+
+        if (!parse_numbers (parser, n, 4))
+            return FALSE;
+        if (parser->last == 'C' || parser->last == 'S') {
+            x1 = 2 * parser->x - parser->ctrl_x;
+            y1 = 2 * parser->y - parser->ctrl_y;
+        }
+        emit_curve_to (parser,
+                       x1, y1,
+                       ox + n[0], oy + n[1],
+                       ox + n[2], oy + n[3]);
+        break;
+    }
+
+    case 'Q':
+        if (!parse_numbers (parser, n, 4))
+            return FALSE;
+        emit_quad_to (parser, ox + n[0], oy + n[1], ox + n[2], oy + n[3]);
+        break;
+
+    case 'T':
+    {
+        gfloat qx = parser->x, qy = parser->y;
+
+        if (!parse_numbers (parser, n, 2))
+            return FALSE;
+        if (parser->last == 'Q' || parser->last == 'T') {
+            qx = 2 * parser->x - parser->ctrl_x;
+            qy = 2 * parser->y - parser->ctrl_y;
+        }
+        emit_quad_to (parser, qx, qy, ox + n[0], oy + n[1]);
+        break;
+    }
+
+    case 'A':
+        if (!parse_numbers (parser, n, 3) ||
+            !parse_flag (parser, &large_arc) ||
+            !parse_flag (parser, &sweep))
+        {
+            return FALSE;
+        }
+        skip_separator (parser);
+        if (!parse_numbers (parser, n + 3, 2))
+            return FALSE;
+        emit_arc_to (parser, n[0], n[1], n[2], large_arc, sweep,
+                     ox + n[3], oy + n[4]);
+        break;
+
+    case 'Z':
+        if (!parser->closed)
+            dax_path_append (parser->path, DAX_PATH_CLOSE);
+        parser->x = parser->start_x;
+        parser->y = parser->start_y;
+        parser->closed = TRUE;
+        break;
+
+    default:
+        return FALSE;
+    }
+
+    parser->last = type;
+
+    return TRUE;
+}
+
+/* Parses @string into @path. Per the SVG error handling rules, what was
+ * parsed before an error is kept */
+static gboolean
+dax_path_parse (DaxPath     *path,
+                const gchar *string,
+                gsize        len)
+{
+    PathParser parser;
+    gchar command = 0;
+
+    memset (&parser, 0, sizeof (PathParser));
+    parser.path = path;
+    parser.p = string;
+    parser.end = string + len;
+
+    skip_space (&parser);
+    if (*parser.p == '\0')
+        return TRUE;
+
+    /* a path data starts with a moveto */
+    if (*parser.p != 'M' && *parser.p != 'm')
+        return FALSE;
+
+    for (;;) {
+        skip_space (&parser);
+        if (*parser.p == '\0')
+            return TRUE;
+
+        if (g_ascii_isalpha (*parser.p)) {
+            command = *parser.p++;
+            skip_space (&parser);
+        } else if (!starts_number (*parser.p) ||
+                   command == 'z' || command == 'Z')
+        {
+            return FALSE;
+        }
+
+        if (!parse_command (&parser, command))
+            return FALSE;
+
+        /* pairs of coordinates after a moveto are implicit linetos */
+        if (command == 'M')
+            command = 'L';
+        else if (command == 'm')
+            command = 'l';
+
+        skip_separator (&parser);
+    }
+}
+
+static void
+dax_value_transform_path_string (const GValue *src,
+                                 GValue       *dest)
+{
+    gchar *string = dax_path_to_string (src->data[0].v_pointer);
+
+    g_value_take_string (dest, string);
+}
+
+static void
+dax_value_transform_string_path (const GValue *src,
+                                 GValue       *dest)
+{
+    DaxPath *path;
+
+    path = dax_path_new_from_string (g_value_get_string (src));
+
+    g_value_take_object (dest, path);
+}
+
+static void
+_register_transform_funcs (GType type)
+{
+    g_value_register_transform_func (type, G_TYPE_STRING,
+                                     dax_value_transform_path_string);
+
+    g_value_register_transform_func (G_TYPE_STRING, type,
+                                     dax_value_transform_string_path);
+}
+
+/*
+ * GObject overloading
+ */
+
+static void
+dax_path_finalize (GObject *object)
+{
+    DaxPath *path = DAX_PATH (object);
+    DaxPathPrivate *priv = path->priv;
+
+    if (!priv->static_arrays) {
+        g_free (priv->verbs);
+        g_free (priv->coords);
+    }
+    _dax_arena_unref (priv->arena);
+
+    G_OBJECT_CLASS (dax_path_parent_class)->finalize (object);
+}
+
+static void
+dax_path_class_init (DaxPathClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    g_type_class_add_private (klass, sizeof (DaxPathPrivate));
+
+    object_class->finalize = dax_path_finalize;
+}
+
+static void
+dax_path_init (DaxPath *self)
+{
+    self->priv = PATH_PRIVATE (self);
+}
+
+/**
+ * dax_path_new:
+ *
+ * Creates an empty path, use dax_path_move_to() and friends to fill it.
+ *
+ * Return value: a new #DaxPath
+ */
+DaxPath *
+dax_path_new (void)
+{
+    return g_object_new (DAX_TYPE_PATH, NULL);
+}
+
+static DaxPath *
+dax_path_parse_string (const gchar *string,
+                       DaxArena    *arena)
+{
+    DaxPath *path;
+    DaxPathPrivate *priv;
+    gsize len;
+
+    path = dax_path_new ();
+    if (string == NULL)
+        return path;
+    priv = path->priv;
+
+    /* a rough guess of the size, the arrays are shrunk afterwards */
+    len = strlen (string);
+    dax_path_reserve (path, len / 12 + 1, len / 4 + 6);
+
+    if (!dax_path_parse (path, string, len))
+        DAX_NOTE (PARSING, "Invalid path data: %s", string);
+
+    if (arena) {
+        guint8 *verbs = priv->verbs;
+        gfloat *coords = priv->coords;
+
+        priv->verbs = _dax_arena_memdup (arena, verbs, priv->n_verbs);
+        priv->coords = _dax_arena_memdup (arena, coords,
+                                          priv->n_coords * sizeof (gfloat));
+        priv->verbs_size = priv->n_verbs;
+        priv->coords_size = priv->n_coords;
+        priv->static_arrays = TRUE;
+        priv->arena = _dax_arena_ref (arena);
+        g_free (verbs);
+        g_free (coords);
+    } else {
+        dax_path_shrink (path);
+    }
+
+    return path;
+}
+
+/**
+ * dax_path_new_from_string:
+ * @string: SVG path data, the value of a "d" attribute
+ *
+ * Parses @string. If @string has an error, the path is made of the
+ * commands before the error, as the SVG specification asks.
+ *
+ * Return value: a new #DaxPath
+ */
+DaxPath *
+dax_path_new_from_string (const gchar *string)
+{
+    return dax_path_parse_string (string, NULL);
+}
+
+/* same as dax_path_new_from_string() with the arrays in @arena, the path
+ * keeps a reference on it */
+DaxPath *
+_dax_path_new_from_string_in_arena (const gchar *string,
+                                    DaxArena    *arena)
+{
+    return dax_path_parse_string (string, arena);
+}
+
+/* a path using @verbs and @coords where they are, in @arena. The path keeps
+ * a reference on @arena. Returns NULL if the verbs don't use exactly
+ * @n_coords coordinates */
+DaxPath *
+_dax_path_new_from_static_arrays (const guint8 *verbs,
+                                  guint         n_verbs,
+                                  const gfloat *coords,
+                                  guint         n_coords,
+                                  DaxArena     *arena)
+{
+    DaxPath *path;
+    DaxPathPrivate *priv;
+    guint64 n_used = 0;
+    guint i;
+
+    for (i = 0; i < n_verbs; i++) {
+        if (verbs[i] >= G_N_ELEMENTS (verb_n_coords))
+            return NULL;
+        n_used += verb_n_coords[verbs[i]];
+    }
+    if (n_used != n_coords)
+        return NULL;
+
+    path = dax_path_new ();
+    priv = path->priv;
+
+    priv->verbs = (guint8 *) verbs;
+    priv->n_verbs = priv->verbs_size = n_verbs;
+    priv->coords = (gfloat *) coords;
+    priv->n_coords = priv->coords_size = n_coords;
+    priv->static_arrays = TRUE;
+    priv->arena = _dax_arena_ref (arena);
+
+    return path;
+}
+
+static void
+append_coords (GString      *string,
+               const gfloat *coords,
+               guint         n_coords)
+{
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+    guint i;
+
+    for (i = 0; i < n_coords; i++) {
+        g_ascii_formatd (buffer, sizeof (buffer), "%g", coords[i]);
+        g_string_append_c (string, i % 2 ? ',' : ' ');
+        g_string_append (string, buffer);
+    }
+}
+
+gchar *
+dax_path_to_string (const DaxPath *path)
+{
+    static const gchar verb_commands[] = { 'M', 'L', 'C', 'Z' };
+    DaxPathPrivate *priv;
+    const gfloat *coords;
+    GString *string;
+    guint i;
+
+    g_return_val_if_fail (DAX_IS_PATH (path), NULL);
+
+    priv = path->priv;
+    coords = priv->coords;
+    string = g_string_sized_new (priv->n_coords * 6);
+
+    for (i = 0; i < priv->n_verbs; i++) {
+        guint8 verb = priv->verbs[i];
+
+        if (i)
+            g_string_append_c (string, ' ');
+        g_string_append_c (string, verb_commands[verb]);
+        append_coords (string, coords, verb_n_coords[verb]);
+        coords += verb_n_coords[verb];
+    }
+
+    return g_string_free (string, FALSE);
+}
+
+void
+dax_path_move_to (DaxPath *path,
+                  gfloat   x,
+                  gfloat   y)
+{
+    gfloat *coords;
+
+    g_return_if_fail (DAX_IS_PATH (path));
+
+    coords = dax_path_append (path, DAX_PATH_MOVE_TO);
+    coords[0] = x;
+    coords[1] = y;
+}
+
+void
+dax_path_line_to (DaxPath *path,
+                  gfloat   x,
+                  gfloat   y)
+{
+    gfloat *coords;
+
+    g_return_if_fail (DAX_IS_PATH (path));
+
+    coords = dax_path_append (path, DAX_PATH_LINE_TO);
+    coords[0] = x;
+    coords[1] = y;
+}
+
+void
+dax_path_curve_to (DaxPath *path,
+                   gfloat   x1,
+                   gfloat   y1,
+                   gfloat   x2,
+                   gfloat   y2,
+                   gfloat   x3,
+                   gfloat   y3)
+{
+    gfloat *coords;
+
+    g_return_if_fail (DAX_IS_PATH (path));
+
+    coords = dax_path_append (path, DAX_PATH_CURVE_TO);
+    coords[0] = x1;
+    coords[1] = y1;
+    coords[2] = x2;
+    coords[3] = y2;
+    coords[4] = x3;
+    coords[5] = y3;
+}
+
+void
+dax_path_close (DaxPath *path)
+{
+    g_return_if_fail (DAX_IS_PATH (path));
+
+    dax_path_append (path, DAX_PATH_CLOSE);
+}
+
+guint
+dax_path_get_n_verbs (const DaxPath *path)
+{
+    g_return_val_if_fail (DAX_IS_PATH (path), 0);
+
+    return path->priv->n_verbs;
+}
+
+/**
+ * dax_path_get_verbs:
+ * @path: a #DaxPath
+ *
+ * Return value: the array of #DaxPathVerb of @path, one byte per verb
+ */
+const guint8 *
+dax_path_get_verbs (const DaxPath *path)
+{
+    g_return_val_if_fail (DAX_IS_PATH (path), NULL);
+
+    return path->priv->verbs;
+}
+
+guint
+dax_path_get_n_coords (const DaxPath *path)
+{
+    g_return_val_if_fail (DAX_IS_PATH (path), 0);
+
+    return path->priv->n_coords;
+}
+
+/**
+ * dax_path_get_coords:
+ * @path: a #DaxPath
+ *
+ * The coordinates of all the verbs, one after the other. See #DaxPathVerb
+ * for the number of coordinates of each verb.
+ *
+ * Return value: the coordinates of @path
+ */
+const gfloat *
+dax_path_get_coords (const DaxPath *path)
+{
+    g_return_val_if_fail (DAX_IS_PATH (path), NULL);
+
+    return path->priv->coords;
+}
+
+static void
+extend_bounds (gfloat  x,
+               gfloat  y,
+               gfloat *bounds)
+{
+    bounds[0] = MIN (bounds[0], x);
+    bounds[1] = MIN (bounds[1], y);
+    bounds[2] = MAX (bounds[2], x);
+    bounds[3] = MAX (bounds[3], y);
+}
+
+static gfloat
+curve_value (gfloat p0,
+             gfloat p1,
+             gfloat p2,
+             gfloat p3,
+             gfloat t)
+{
+    gfloat mt = 1 - t;
+
+    return mt * mt * mt * p0 + 3 * mt * mt * t * p1 +
+           3 * mt * t * t * p2 + t * t * t * p3;
+}
+
+/* The parameters, in ]0,1[, where the derivative of one coordinate of a
+ * cubic curve is 0. Returns the number of them */
+static guint
+curve_extrema (gfloat  p0,
+               gfloat  p1,
+               gfloat  p2,
+               gfloat  p3,
+               gfloat *t)
+{
+    gfloat a, b, c, delta, r[2];
+    guint i, n_roots = 0, n_t = 0;
+
+    a = -p0 + 3 * p1 - 3 * p2 + p3;
+    b = 2 * (p0 - 2 * p1 + p2);
+    c = p1 - p0;
+
+    if (fabsf (a) < 1e-6f) {
+        if (fabsf (b) < 1e-6f)
+            return 0;
+        r[n_roots++] = -c / b;
+    } else {
+        delta = b * b - 4 * a * c;
+        if (delta < 0)
+            return 0;
+        delta = sqrtf (delta);
+        r[n_roots++] = (-b + delta) / (2 * a);
+        r[n_roots++] = (-b - delta) / (2 * a);
+    }
+
+    for (i = 0; i < n_roots; i++)
+        if (r[i] > 0 && r[i] < 1)
+            t[n_t++] = r[i];
+
+    return n_t;
+}
+
+/**
+ * dax_path_get_bounds:
+ * @path: a #DaxPath
+ * @x1: (out): return location for the left edge
+ * @y1: (out): return location for the top edge
+ * @x2: (out): return location for the right edge
+ * @y2: (out): return location for the bottom edge
+ *
+ * Computes the smallest rectangle enclosing the geometry of @path. The
+ * curves are bounded by their extrema, not by their control points.
+ *
+ * Return value: %FALSE if @path has no point, the bounds are not set then
+ */
+gboolean
+dax_path_get_bounds (const DaxPath *path,
+                     gfloat        *x1,
+                     gfloat        *y1,
+                     gfloat        *x2,
+                     gfloat        *y2)
+{
+    DaxPathPrivate *priv;
+    const gfloat *coords;
+    gfloat bounds[4], x = 0, y = 0, start_x = 0, start_y = 0;
+    guint i;
+
+    g_return_val_if_fail (DAX_IS_PATH (path), FALSE);
+
+    priv = path->priv;
+    if (priv->n_coords == 0)
+        return FALSE;
+
+    coords = priv->coords;
+    bounds[0] = bounds[2] = coords[0];
+    bounds[1] = bounds[3] = coords[1];
+
+    for (i = 0; i < priv->n_verbs; i++) {
+        guint8 verb = priv->verbs[i];
+
+        if (verb == DAX_PATH_CURVE_TO) {
+            gfloat t[2];
+            guint j, n_t;
+
+            n_t = curve_extrema (x, coords[0], coords[2], coords[4], t);
+            for (j = 0; j < n_t; j++)
+                extend_bounds (curve_value (x, coords[0], coords[2],
+                                            coords[4], t[j]),
+                               y, bounds);
+
+            n_t = curve_extrema (y, coords[1], coords[3], coords[5], t);
+            for (j = 0; j < n_t; j++)
+                extend_bounds (x, curve_value (y, coords[1], coords[3],
+                                               coords[5], t[j]),
+                               bounds);
+        }
+
+        if (verb == DAX_PATH_CLOSE) {
+            x = start_x;
+            y = start_y;
+        } else {
+            x = coords[verb_n_coords[verb] - 2];
+            y = coords[verb_n_coords[verb] - 1];
+            extend_bounds (x, y, bounds);
+        }
+
+        if (verb == DAX_PATH_MOVE_TO) {
+            start_x = x;
+            start_y = y;
+        }
+
+        coords += verb_n_coords[verb];
+    }
+
+    if (x1)
+        *x1 = bounds[0];
+    if (y1)
+        *y1 = bounds[1];
+    if (x2)
+        *x2 = bounds[2];
+    if (y2)
+        *y2 = bounds[3];
+
+    return TRUE;
+}
+
+/*
+ * Hit-testing
+ *
+ * The path is flattened into straight segments, the curves being cut in
+ * CURVE_SEGMENTS pieces, and the segments are given to a function. This
+ * is precise enough for the curves of a path drawn at its size.
+ */
+
+typedef void (*SegmentFunc) (gfloat   x0,
+                             gfloat   y0,
+                             gfloat   x1,
+                             gfloat   y1,
+                             gpointer data);
+
+static void
+foreach_segment (const DaxPath *path,
+                 gboolean       close_subpaths,
+                 SegmentFunc    func,
+                 gpointer       data)
+{
+    DaxPathPrivate *priv = path->priv;
+    const gfloat *coords = priv->coords;
+    gfloat x = 0, y = 0, start_x = 0, start_y = 0;
+    guint i, j;
+
+    for (i = 0; i < priv->n_verbs; i++) {
+        switch (priv->verbs[i]) {
+        case DAX_PATH_MOVE_TO:
+            /* filling closes the sub-paths */
+            if (close_subpaths)
+                func (x, y, start_x, start_y, data);
+            x = start_x = coords[0];
+            y = start_y = coords[1];
+            break;
+        case DAX_PATH_LINE_TO:
+            func (x, y, coords[0], coords[1], data);
+            x = coords[0];
+            y = coords[1];
+            break;
+        case DAX_PATH_CURVE_TO:
+            for (j = 1; j <= CURVE_SEGMENTS; j++) {
+                gfloat t = (gfloat) j / CURVE_SEGMENTS, next_x, next_y;
+
+                next_x = curve_value (x, coords[0], coords[2], coords[4], t);
+                next_y = curve_value (y, coords[1], coords[3], coords[5], t);
+                func (x, y, next_x, next_y, data);
+                x = next_x;
+                y = next_y;
+            }
+            break;
+        case DAX_PATH_CLOSE:
+            func (x, y, start_x, start_y, data);
+            x = start_x;
+            y = start_y;
+            break;
+        default:
+            g_assert_not_reached ();
+        }
+
+        coords += verb_n_coords[priv->verbs[i]];
+    }
+
+    if (close_subpaths)
+        func (x, y, start_x, start_y, data);
+}
+
+typedef struct
+{
+    gfloat x, y;
+    gint winding;
+} WindingData;
+
+static void
+add_winding (gfloat   x0,
+             gfloat   y0,
+             gfloat   x1,
+             gfloat   y1,
+             gpointer user_data)
+{
+    WindingData *data = user_data;
+    gfloat side;
+
+    /* side of the point relative to the segment, > 0 when on the left */
+    side = (x1 - x0) * (data->y - y0) - (data->x - x0) * (y1 - y0);
+
+    if (y0 <= data->y) {
+        if (y1 > data->y && side > 0)
+            data->winding++;
+    } else {
+        if (y1 <= data->y && side < 0)
+            data->winding--;
+    }
+}
+
+/**
+ * dax_path_fill_contains_point:
+ * @path: a #DaxPath
+ * @fill_rule: the #DaxFillRule to use
+ * @x: the x coordinate of the point
+ * @y: the y coordinate of the point
+ *
+ * Tests whether the point (@x, @y) is inside @path when filled with
+ * @fill_rule. The sub-paths are closed as they are when filling.
+ *
+ * Return value: %TRUE if the fill of @path covers the point
+ */
+gboolean
+dax_path_fill_contains_point (const DaxPath *path,
+                              DaxFillRule    fill_rule,
+                              gfloat         x,
+                              gfloat         y)
+{
+    WindingData data;
+
+    g_return_val_if_fail (DAX_IS_PATH (path), FALSE);
+
+    data.x = x;
+    data.y = y;
+    data.winding = 0;
+    foreach_segment (path, TRUE, add_winding, &data);
+
+    if (fill_rule == DAX_FILL_RULE_EVEN_ODD)
+        return data.winding % 2 != 0;
+
+    return data.winding != 0;
+}
+
+typedef struct
+{
+    gfloat x, y;
+    gfloat max_distance2;
+    gboolean hit;
+} DistanceData;
+
+static void
+test_distance (gfloat   x0,
+               gfloat   y0,
+               gfloat   x1,
+               gfloat   y1,
+               gpointer user_data)
+{
+    DistanceData *data = user_data;
+    gfloat dx = x1 - x0, dy = y1 - y0, length2, t, px, py;
+
+    if (data->hit)
+        return;
+
+    /* the closest point of the segment */
+    length2 = dx * dx + dy * dy;
+    t = 0;
+    if (length2 > 0)
+        t = CLAMP (((data->x - x0) * dx + (data->y - y0) * dy) / length2,
+                   0, 1);
+
+    px = data->x - (x0 + t * dx);
+    py = data->y - (y0 + t * dy);
+    data->hit = px * px + py * py <= data->max_distance2;
+}
+
+/**
+ * dax_path_stroke_contains_point:
+ * @path: a #DaxPath
+ * @width: the width of the stroke
+ * @x: the x coordinate of the point
+ * @y: the y coordinate of the point
+ *
+ * Tests whether the point (@x, @y) is on the outline of @path stroked
+ * @width wide. The joins and caps are considered round.
+ *
+ * Return value: %TRUE if the stroke of @path covers the point
+ */
+gboolean
+dax_path_stroke_contains_point (const DaxPath *path,
+                                gfloat         width,
+                                gfloat         x,
+                                gfloat         y)
+{
+    DistanceData data;
+
+    g_return_val_if_fail (DAX_IS_PATH (path), FALSE);
+
+    data.x = x;
+    data.y = y;
+    data.max_distance2 = width * width / 4;
+    data.hit = FALSE;
+    foreach_segment (path, FALSE, test_distance, &data);
+
+    return data.hit;
+}
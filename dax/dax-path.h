@@ -0,0 +1,148 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__DAX_H_INSIDE__) && !defined(DAX_COMPILATION)
+#error "Only <dax/dax.h> can be included directly."
+#endif
+
+#ifndef __DAX_PATH_H__
+#define __DAX_PATH_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define DAX_TYPE_PATH dax_path_get_type()
+
+#define DAX_PATH(obj)                                   \
+    (G_TYPE_CHECK_INSTANCE_CAST ((obj),                 \
+                                 DAX_TYPE_PATH,         \
+                                 DaxPath))
+
+#define DAX_PATH_CLASS(klass)                           \
+    (G_TYPE_CHECK_CLASS_CAST ((klass),                  \
+                              DAX_TYPE_PATH,            \
+                              DaxPathClass))
+
+#define DAX_IS_PATH(obj)                                \
+    (G_TYPE_CHECK_INSTANCE_TYPE ((obj), DAX_TYPE_PATH))
+
+#define DAX_IS_PATH_CLASS(klass)                        \
+    (G_TYPE_CHECK_CLASS_TYPE ((klass), DAX_TYPE_PATH))
+
+#define DAX_PATH_GET_CLASS(obj)                         \
+    (G_TYPE_INSTANCE_GET_CLASS ((obj),                  \
+                                DAX_TYPE_PATH,          \
+                                DaxPathClass))
+
+/**
+ * DaxPathVerb:
+ * @DAX_PATH_MOVE_TO: starts a new sub-path, uses 2 coordinates
+ * @DAX_PATH_LINE_TO: straight line, uses 2 coordinates
+ * @DAX_PATH_CURVE_TO: cubic Bézier curve, uses 6 coordinates (2 control
+ *   points and the end point)
+ * @DAX_PATH_CLOSE: closes the current sub-path, uses no coordinate
+ *
+ * The verbs of a #DaxPath. All the SVG path commands are stored with these
+ * four verbs in absolute coordinates: relative, horizontal, vertical and
+ * smooth commands are resolved, quadratic curves and arcs are converted to
+ * cubic curves.
+ */
+typedef enum /*< skip >*/
+{
+    DAX_PATH_MOVE_TO,
+    DAX_PATH_LINE_TO,
+    DAX_PATH_CURVE_TO,
+    DAX_PATH_CLOSE
+} DaxPathVerb;
+
+/**
+ * DaxFillRule:
+ * @DAX_FILL_RULE_NONZERO: a point is inside if the path winds around it
+ *   a non-zero number of times
+ * @DAX_FILL_RULE_EVEN_ODD: a point is inside if a ray from it crosses the
+ *   path an odd number of times
+ *
+ * How the inside of a path crossing itself is determined, see
+ * dax_path_fill_contains_point().
+ */
+typedef enum /*< skip >*/
+{
+    DAX_FILL_RULE_NONZERO,
+    DAX_FILL_RULE_EVEN_ODD
+} DaxFillRule;
+
+typedef struct _DaxPath DaxPath;
+typedef struct _DaxPathClass DaxPathClass;
+typedef struct _DaxPathPrivate DaxPathPrivate;
+
+struct _DaxPath
+{
+    GObject parent;
+
+    DaxPathPrivate *priv;
+};
+
+struct _DaxPathClass
+{
+    GObjectClass parent_class;
+};
+
+GType           dax_path_get_type           (void) G_GNUC_CONST;
+
+DaxPath *       dax_path_new                (void);
+DaxPath *       dax_path_new_from_string    (const gchar *string);
+gchar *         dax_path_to_string          (const DaxPath *path);
+
+void            dax_path_move_to            (DaxPath *path,
+                                             gfloat   x,
+                                             gfloat   y);
+void            dax_path_line_to            (DaxPath *path,
+                                             gfloat   x,
+                                             gfloat   y);
+void            dax_path_curve_to           (DaxPath *path,
+                                             gfloat   x1,
+                                             gfloat   y1,
+                                             gfloat   x2,
+                                             gfloat   y2,
+                                             gfloat   x3,
+                                             gfloat   y3);
+void            dax_path_close              (DaxPath *path);
+
+guint           dax_path_get_n_verbs        (const DaxPath *path);
+const guint8 *  dax_path_get_verbs          (const DaxPath *path);
+guint           dax_path_get_n_coords       (const DaxPath *path);
+const gfloat *  dax_path_get_coords         (const DaxPath *path);
+
+gboolean        dax_path_get_bounds         (const DaxPath *path,
+                                             gfloat        *x1,
+                                             gfloat        *y1,
+                                             gfloat        *x2,
+                                             gfloat        *y2);
+gboolean        dax_path_fill_contains_point    (const DaxPath *path,
+                                                 DaxFillRule    fill_rule,
+                                                 gfloat         x,
+                                                 gfloat         y);
+gboolean        dax_path_stroke_contains_point  (const DaxPath *path,
+                                                 gfloat         width,
+                                                 gfloat         x,
+                                                 gfloat         y);
+
+G_END_DECLS
+
+#endif /* __DAX_PATH_H__ */
@@ -23,10 +23,34 @@
 
 #include <glib.h>
 
+#include "dax-arena.h"
+#include "dax-knot-sequence.h"
+#include "dax-path.h"
+
 G_BEGIN_DECLS
 
 const gchar *svg_ns;
 
+/* dax-knot-sequence.c */
+
+DaxKnotSequence *
+_dax_knot_sequence_new_from_string_in_arena (const gchar *string,
+                                             DaxArena    *arena);
+DaxKnotSequence *
+_dax_knot_sequence_new_from_static_array_in_arena (const gfloat *data,
+                                                   guint         nb_knots,
+                                                   DaxArena     *arena);
+
+/* dax-path.c */
+
+DaxPath *   _dax_path_new_from_string_in_arena  (const gchar *string,
+                                                 DaxArena    *arena);
+DaxPath *   _dax_path_new_from_static_arrays    (const guint8 *verbs,
+                                                 guint         n_verbs,
+                                                 const gfloat *coords,
+                                                 guint         n_coords,
+                                                 DaxArena     *arena);
+
 G_END_DECLS
 
 #endif /* __DAX_PRIVATE_H__ */
@@ -0,0 +1,790 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "dax-affine.h"
+
+#include "dax-rasterizer.h"
+
+/* maximum distance, in device pixels, between a bezier curve and its
+ * flattened version */
+#define FLATTENING_TOLERANCE    0.2
+
+typedef struct
+{
+    gfloat x, y;
+} Point;
+
+typedef struct
+{
+    guint first;
+    guint n_points;
+    gboolean closed;
+} SubPath;
+
+typedef struct
+{
+    gfloat x0, y0;                  /* x0 is the x coordinate at y0 */
+    gfloat y1;
+    gfloat dxdy;
+    gint dir;
+} Edge;
+
+typedef struct
+{
+    gfloat x;
+    gint dir;
+} Crossing;
+
+struct _DaxRasterizer
+{
+    double affine[6];
+
+    /* the flattened path, in device space */
+    GArray *points;                 /* array of Point */
+    GArray *subpaths;               /* array of SubPath */
+    gboolean has_current_point;
+    gboolean in_subpath;
+    gfloat start_x, start_y;        /* user space */
+    gfloat cur_x, cur_y;            /* user space */
+
+    /* scratch buffers reused between fills */
+    GArray *edges;                  /* array of Edge */
+    GArray *active;                 /* array of guint (index in edges) */
+    GArray *crossings;              /* array of Crossing */
+    gfloat *cover;
+    gfloat *delta;
+    gint scratch_width;
+};
+
+/*
+ * Private helpers
+ */
+
+static void
+transform_point (DaxRasterizer *rasterizer,
+                 gfloat         x,
+                 gfloat         y,
+                 Point         *out)
+{
+    const double *a = rasterizer->affine;
+
+    out->x = a[0] * x + a[2] * y + a[4];
+    out->y = a[1] * x + a[3] * y + a[5];
+}
+
+static SubPath *
+current_subpath (DaxRasterizer *rasterizer)
+{
+    return &g_array_index (rasterizer->subpaths, SubPath,
+                           rasterizer->subpaths->len - 1);
+}
+
+static void
+append_device_point (DaxRasterizer *rasterizer,
+                     const Point   *point)
+{
+    g_array_append_val (rasterizer->points, *point);
+    current_subpath (rasterizer)->n_points++;
+}
+
+static void
+ensure_subpath (DaxRasterizer *rasterizer)
+{
+    if (rasterizer->in_subpath)
+        return;
+
+    /* A drawing command after a close (or without any move to) starts a new
+     * subpath at the current point */
+    _dax_rasterizer_move_to (rasterizer, rasterizer->cur_x, rasterizer->cur_y);
+}
+
+static void
+add_edge (GArray *edges,
+          gfloat  x0,
+          gfloat  y0,
+          gfloat  x1,
+          gfloat  y1)
+{
+    Edge edge;
+
+    if (y0 == y1)
+        return;
+
+    if (y0 < y1) {
+        edge.x0 = x0;
+        edge.y0 = y0;
+        edge.y1 = y1;
+        edge.dir = 1;
+    } else {
+        edge.x0 = x1;
+        edge.y0 = y1;
+        edge.y1 = y0;
+        edge.dir = -1;
+    }
+    edge.dxdy = (x1 - x0) / (y1 - y0);
+
+    g_array_append_val (edges, edge);
+}
+
+static gint
+compare_edges (gconstpointer a,
+               gconstpointer b)
+{
+    const Edge *ea = a, *eb = b;
+
+    if (ea->y0 < eb->y0)
+        return -1;
+    if (ea->y0 > eb->y0)
+        return 1;
+    return 0;
+}
+
+static void
+ensure_scratch (DaxRasterizer *rasterizer,
+                gint           width)
+{
+    if (rasterizer->scratch_width >= width)
+        return;
+
+    g_free (rasterizer->cover);
+    g_free (rasterizer->delta);
+    rasterizer->cover = g_new0 (gfloat, width + 1);
+    rasterizer->delta = g_new0 (gfloat, width + 2);
+    rasterizer->scratch_width = width;
+}
+
+static inline void
+blend_pixel (guint32            *dst,
+             const ClutterColor *color,
+             guint               alpha)
+{
+    guint32 d = *dst;
+    guint inv, r, g, b, a;
+
+    if (alpha == 0)
+        return;
+
+    if (alpha == 255) {
+        *dst = 0xff000000 | color->red << 16 | color->green << 8 | color->blue;
+        return;
+    }
+
+    inv = 255 - alpha;
+    a = alpha + ((d >> 24) & 0xff) * inv / 255;
+    r = color->red * alpha / 255 + ((d >> 16) & 0xff) * inv / 255;
+    g = color->green * alpha / 255 + ((d >> 8) & 0xff) * inv / 255;
+    b = color->blue * alpha / 255 + (d & 0xff) * inv / 255;
+
+    *dst = a << 24 | r << 16 | g << 8 | b;
+}
+
+static inline void
+add_span (gfloat *cover,
+          gfloat *delta,
+          gfloat  xa,
+          gfloat  xb,
+          gfloat  weight,
+          gint    width)
+{
+    gint ia, ib;
+
+    if (xa < 0)
+        xa = 0;
+    if (xb > width)
+        xb = width;
+    if (xb <= xa)
+        return;
+
+    ia = (gint) xa;
+    ib = (gint) xb;
+
+    if (ia == ib) {
+        cover[ia] += (xb - xa) * weight;
+        return;
+    }
+
+    cover[ia] += (ia + 1 - xa) * weight;
+    delta[ia + 1] += weight;
+    delta[ib] -= weight;
+    cover[ib] += (xb - ib) * weight;
+}
+
+static void
+sort_crossings (GArray *crossings)
+{
+    Crossing *c = (Crossing *) crossings->data;
+    guint i, j;
+
+    /* insertion sort, the number of crossings on one line is small */
+    for (i = 1; i < crossings->len; i++) {
+        Crossing tmp = c[i];
+
+        for (j = i; j > 0 && c[j - 1].x > tmp.x; j--)
+            c[j] = c[j - 1];
+        c[j] = tmp;
+    }
+}
+
+/* Scan convert rasterizer->edges into the surface */
+static void
+rasterize_edges (DaxRasterizer         *rasterizer,
+                 DaxRasterizerSurface  *surface,
+                 const ClutterColor    *color,
+                 gfloat                 opacity,
+                 DaxRasterizerFillRule  rule)
+{
+    GArray *edges = rasterizer->edges;
+    GArray *active = rasterizer->active;
+    GArray *crossings = rasterizer->crossings;
+    gfloat xmin = G_MAXFLOAT, xmax = -G_MAXFLOAT;
+    gfloat ymin = G_MAXFLOAT, ymax = -G_MAXFLOAT;
+    gfloat *cover, *delta;
+    gfloat weight, alpha_scale;
+    gint x_start, x_end, y_start, y_end, x, y, s;
+    guint next_edge = 0, i;
+
+    if (edges->len == 0)
+        return;
+
+    alpha_scale = color->alpha * CLAMP (opacity, 0.0f, 1.0f);
+    if (alpha_scale <= 0)
+        return;
+
+    for (i = 0; i < edges->len; i++) {
+        Edge *e = &g_array_index (edges, Edge, i);
+        gfloat x1 = e->x0 + (e->y1 - e->y0) * e->dxdy;
+
+        xmin = MIN (xmin, MIN (e->x0, x1));
+        xmax = MAX (xmax, MAX (e->x0, x1));
+        ymin = MIN (ymin, e->y0);
+        ymax = MAX (ymax, e->y1);
+    }
+
+    x_start = MAX (0, (gint) floorf (xmin));
+    x_end = MIN (surface->width - 1, (gint) ceilf (xmax));
+    y_start = MAX (0, (gint) floorf (ymin));
+    y_end = MIN (surface->height - 1, (gint) ceilf (ymax));
+    if (x_start > x_end || y_start > y_end)
+        return;
+
+    g_array_sort (edges, compare_edges);
+    g_array_set_size (active, 0);
+
+    ensure_scratch (rasterizer, surface->width);
+    cover = rasterizer->cover;
+    delta = rasterizer->delta;
+    weight = 1.0f / DAX_RASTERIZER_SUBSAMPLES;
+
+    for (y = y_start; y <= y_end; y++) {
+        guint32 *row = surface->pixels + y * surface->stride;
+        gfloat run = 0;
+
+        for (s = 0; s < DAX_RASTERIZER_SUBSAMPLES; s++) {
+            gfloat sy = y + (s + 0.5f) / DAX_RASTERIZER_SUBSAMPLES;
+            gint winding = 0;
+            gfloat span_start = 0;
+
+            /* update the active edge list */
+            while (next_edge < edges->len &&
+                   g_array_index (edges, Edge, next_edge).y0 <= sy)
+            {
+                g_array_append_val (active, next_edge);
+                next_edge++;
+            }
+
+            g_array_set_size (crossings, 0);
+            for (i = 0; i < active->len; ) {
+                Edge *e = &g_array_index (edges, Edge,
+                                          g_array_index (active, guint, i));
+                Crossing c;
+
+                if (e->y1 <= sy) {
+                    g_array_remove_index_fast (active, i);
+                    continue;
+                }
+
+                c.x = e->x0 + (sy - e->y0) * e->dxdy;
+                c.dir = e->dir;
+                g_array_append_val (crossings, c);
+                i++;
+            }
+
+            sort_crossings (crossings);
+
+            for (i = 0; i < crossings->len; i++) {
+                Crossing *c = &g_array_index (crossings, Crossing, i);
+                gboolean was_inside, is_inside;
+
+                if (rule == DAX_RASTERIZER_FILL_EVEN_ODD) {
+                    was_inside = winding & 1;
+                    winding++;
+                    is_inside = winding & 1;
+                } else {
+                    was_inside = winding != 0;
+                    winding += c->dir;
+                    is_inside = winding != 0;
+                }
+
+                if (!was_inside && is_inside)
+                    span_start = c->x;
+                else if (was_inside && !is_inside)
+                    add_span (cover, delta, span_start, c->x, weight,
+                              surface->width);
+            }
+        }
+
+        for (x = x_start; x <= x_end; x++) {
+            gfloat coverage;
+
+            run += delta[x];
+            coverage = cover[x] + run;
+            cover[x] = 0;
+            delta[x] = 0;
+
+            if (coverage <= 0)
+                continue;
+            if (coverage > 1)
+                coverage = 1;
+
+            blend_pixel (&row[x], color,
+                         (guint) (coverage * alpha_scale + 0.5f));
+        }
+        delta[x_end + 1] = 0;
+    }
+}
+
+static void
+add_segment_quad (GArray      *edges,
+                  const Point *a,
+                  const Point *b,
+                  gfloat       half_width)
+{
+    gfloat dx, dy, len, nx, ny;
+    Point q[4];
+    gint i;
+
+    dx = b->x - a->x;
+    dy = b->y - a->y;
+    len = sqrtf (dx * dx + dy * dy);
+    if (len == 0)
+        return;
+
+    nx = -dy / len * half_width;
+    ny = dx / len * half_width;
+
+    q[0].x = a->x + nx; q[0].y = a->y + ny;
+    q[1].x = b->x + nx; q[1].y = b->y + ny;
+    q[2].x = b->x - nx; q[2].y = b->y - ny;
+    q[3].x = a->x - nx; q[3].y = a->y - ny;
+
+    for (i = 0; i < 4; i++)
+        add_edge (edges, q[i].x, q[i].y, q[(i + 1) % 4].x, q[(i + 1) % 4].y);
+}
+
+/* A square centered on p, aligned with the a -> b direction. It covers the
+ * gap between two consecutive segment quads */
+static void
+add_join (GArray      *edges,
+          const Point *p,
+          const Point *a,
+          const Point *b,
+          gfloat       half_width)
+{
+    gfloat dx, dy, len;
+    Point from, to;
+
+    dx = b->x - a->x;
+    dy = b->y - a->y;
+    len = sqrtf (dx * dx + dy * dy);
+    if (len == 0)
+        return;
+
+    dx = dx / len * half_width;
+    dy = dy / len * half_width;
+    from.x = p->x - dx; from.y = p->y - dy;
+    to.x = p->x + dx; to.y = p->y + dy;
+
+    add_segment_quad (edges, &from, &to, half_width);
+}
+
+/*
+ * Path building
+ */
+
+DaxRasterizer *
+_dax_rasterizer_new (void)
+{
+    DaxRasterizer *rasterizer;
+
+    rasterizer = g_slice_new0 (DaxRasterizer);
+    _dax_affine_identity (rasterizer->affine);
+    rasterizer->points = g_array_new (FALSE, FALSE, sizeof (Point));
+    rasterizer->subpaths = g_array_new (FALSE, FALSE, sizeof (SubPath));
+    rasterizer->edges = g_array_new (FALSE, FALSE, sizeof (Edge));
+    rasterizer->active = g_array_new (FALSE, FALSE, sizeof (guint));
+    rasterizer->crossings = g_array_new (FALSE, FALSE, sizeof (Crossing));
+
+    return rasterizer;
+}
+
+void
+_dax_rasterizer_free (DaxRasterizer *rasterizer)
+{
+    if (rasterizer == NULL)
+        return;
+
+    g_array_free (rasterizer->points, TRUE);
+    g_array_free (rasterizer->subpaths, TRUE);
+    g_array_free (rasterizer->edges, TRUE);
+    g_array_free (rasterizer->active, TRUE);
+    g_array_free (rasterizer->crossings, TRUE);
+    g_free (rasterizer->cover);
+    g_free (rasterizer->delta);
+    g_slice_free (DaxRasterizer, rasterizer);
+}
+
+void
+_dax_rasterizer_reset (DaxRasterizer *rasterizer)
+{
+    g_array_set_size (rasterizer->points, 0);
+    g_array_set_size (rasterizer->subpaths, 0);
+    rasterizer->has_current_point = FALSE;
+    rasterizer->in_subpath = FALSE;
+    rasterizer->cur_x = rasterizer->cur_y = 0;
+}
+
+void
+_dax_rasterizer_set_transform (DaxRasterizer *rasterizer,
+                               const double   affine[6])
+{
+    memcpy (rasterizer->affine, affine, sizeof (rasterizer->affine));
+}
+
+void
+_dax_rasterizer_move_to (DaxRasterizer *rasterizer,
+                         gfloat         x,
+                         gfloat         y)
+{
+    SubPath subpath;
+    Point p;
+
+    subpath.first = rasterizer->points->len;
+    subpath.n_points = 0;
+    subpath.closed = FALSE;
+    g_array_append_val (rasterizer->subpaths, subpath);
+
+    transform_point (rasterizer, x, y, &p);
+    append_device_point (rasterizer, &p);
+
+    rasterizer->start_x = rasterizer->cur_x = x;
+    rasterizer->start_y = rasterizer->cur_y = y;
+    rasterizer->has_current_point = TRUE;
+    rasterizer->in_subpath = TRUE;
+}
+
+void
+_dax_rasterizer_line_to (DaxRasterizer *rasterizer,
+                         gfloat         x,
+                         gfloat         y)
+{
+    Point p;
+
+    ensure_subpath (rasterizer);
+
+    transform_point (rasterizer, x, y, &p);
+    append_device_point (rasterizer, &p);
+
+    rasterizer->cur_x = x;
+    rasterizer->cur_y = y;
+}
+
+void
+_dax_rasterizer_curve_to (DaxRasterizer *rasterizer,
+                          gfloat         x1,
+                          gfloat         y1,
+                          gfloat         x2,
+                          gfloat         y2,
+                          gfloat         x3,
+                          gfloat         y3)
+{
+    Point p0, p1, p2, p3, p;
+    gfloat ddx1, ddy1, ddx2, ddy2, dd, t;
+    guint n, i;
+
+    ensure_subpath (rasterizer);
+
+    transform_point (rasterizer, rasterizer->cur_x, rasterizer->cur_y, &p0);
+    transform_point (rasterizer, x1, y1, &p1);
+    transform_point (rasterizer, x2, y2, &p2);
+    transform_point (rasterizer, x3, y3, &p3);
+
+    /* Wang's formula for the number of segments needed to stay within the
+     * flattening tolerance */
+    ddx1 = p0.x - 2 * p1.x + p2.x;
+    ddy1 = p0.y - 2 * p1.y + p2.y;
+    ddx2 = p1.x - 2 * p2.x + p3.x;
+    ddy2 = p1.y - 2 * p2.y + p3.y;
+    dd = MAX (sqrtf (ddx1 * ddx1 + ddy1 * ddy1),
+              sqrtf (ddx2 * ddx2 + ddy2 * ddy2));
+    n = (guint) ceilf (sqrtf (0.75f * dd / FLATTENING_TOLERANCE));
+    n = CLAMP (n, 1, 256);
+
+    for (i = 1; i <= n; i++) {
+        gfloat mt, a, b, c, d;
+
+        t = (gfloat) i / n;
+        mt = 1 - t;
+        a = mt * mt * mt;
+        b = 3 * mt * mt * t;
+        c = 3 * mt * t * t;
+        d = t * t * t;
+
+        p.x = a * p0.x + b * p1.x + c * p2.x + d * p3.x;
+        p.y = a * p0.y + b * p1.y + c * p2.y + d * p3.y;
+        append_device_point (rasterizer, &p);
+    }
+
+    rasterizer->cur_x = x3;
+    rasterizer->cur_y = y3;
+}
+
+void
+_dax_rasterizer_close (DaxRasterizer *rasterizer)
+{
+    if (!rasterizer->in_subpath)
+        return;
+
+    current_subpath (rasterizer)->closed = TRUE;
+    rasterizer->in_subpath = FALSE;
+    rasterizer->cur_x = rasterizer->start_x;
+    rasterizer->cur_y = rasterizer->start_y;
+}
+
+void
+_dax_rasterizer_add_path (DaxRasterizer *rasterizer,
+                          DaxPath       *path)
+{
+    const guint8 *verbs;
+    const gfloat *p;
+    guint i, n_verbs;
+
+    if (path == NULL)
+        return;
+
+    verbs = dax_path_get_verbs (path);
+    p = dax_path_get_coords (path);
+    n_verbs = dax_path_get_n_verbs (path);
+
+    for (i = 0; i < n_verbs; i++) {
+        switch (verbs[i]) {
+        case DAX_PATH_MOVE_TO:
+            _dax_rasterizer_move_to (rasterizer, p[0], p[1]);
+            p += 2;
+            break;
+        case DAX_PATH_LINE_TO:
+            _dax_rasterizer_line_to (rasterizer, p[0], p[1]);
+            p += 2;
+            break;
+        case DAX_PATH_CURVE_TO:
+            _dax_rasterizer_curve_to (rasterizer,
+                                      p[0], p[1], p[2], p[3], p[4], p[5]);
+            p += 6;
+            break;
+        case DAX_PATH_CLOSE:
+            _dax_rasterizer_close (rasterizer);
+            break;
+        default:
+            g_assert_not_reached ();
+        }
+    }
+}
+
+/*
+ * Painting
+ */
+
+void
+_dax_rasterizer_fill (DaxRasterizer         *rasterizer,
+                      DaxRasterizerSurface  *surface,
+                      const ClutterColor    *color,
+                      gfloat                 opacity,
+                      DaxRasterizerFillRule  rule)
+{
+    Point *points = (Point *) rasterizer->points->data;
+    guint i, j;
+
+    g_array_set_size (rasterizer->edges, 0);
+
+    /* every subpath is implicitly closed when filling */
+    for (i = 0; i < rasterizer->subpaths->len; i++) {
+        SubPath *sp = &g_array_index (rasterizer->subpaths, SubPath, i);
+        Point *p = points + sp->first;
+
+        if (sp->n_points < 3)
+            continue;
+
+        for (j = 0; j < sp->n_points; j++) {
+            Point *next = p + (j + 1) % sp->n_points;
+
+            add_edge (rasterizer->edges, p[j].x, p[j].y, next->x, next->y);
+        }
+    }
+
+    rasterize_edges (rasterizer, surface, color, opacity, rule);
+}
+
+void
+_dax_rasterizer_stroke (DaxRasterizer         *rasterizer,
+                        DaxRasterizerSurface  *surface,
+                        const ClutterColor    *color,
+                        gfloat                 opacity,
+                        gfloat                 width)
+{
+    Point *points = (Point *) rasterizer->points->data;
+    gfloat half_width;
+    guint i, j;
+
+    /* the line width is given in user space */
+    half_width = width * _dax_affine_expansion (rasterizer->affine) / 2;
+    if (half_width <= 0)
+        return;
+
+    g_array_set_size (rasterizer->edges, 0);
+
+    /* Each segment is turned into a quad, all quads having the same
+     * orientation so the union can be filled with the nonzero rule */
+    for (i = 0; i < rasterizer->subpaths->len; i++) {
+        SubPath *sp = &g_array_index (rasterizer->subpaths, SubPath, i);
+        Point *p = points + sp->first;
+        guint n_segments;
+
+        if (sp->n_points < 2)
+            continue;
+
+        n_segments = sp->closed ? sp->n_points : sp->n_points - 1;
+        for (j = 0; j < n_segments; j++) {
+            Point *next = p + (j + 1) % sp->n_points;
+
+            add_segment_quad (rasterizer->edges, &p[j], next, half_width);
+            if (j > 0 || sp->closed)
+                add_join (rasterizer->edges, &p[j], &p[j], next, half_width);
+        }
+    }
+
+    rasterize_edges (rasterizer, surface, color, opacity,
+                     DAX_RASTERIZER_FILL_NONZERO);
+}
+
+void
+_dax_rasterizer_composite_a8 (DaxRasterizerSurface *surface,
+                              const guint8         *mask,
+                              gint                  mask_stride,
+                              gint                  x,
+                              gint                  y,
+                              gint                  width,
+                              gint                  height,
+                              const ClutterColor   *color,
+                              gfloat                opacity)
+{
+    gfloat alpha_scale;
+    gint i, j;
+
+    alpha_scale = color->alpha * CLAMP (opacity, 0.0f, 1.0f) / 255.f;
+
+    for (j = MAX (0, -y); j < height && y + j < surface->height; j++) {
+        guint32 *row = surface->pixels + (y + j) * surface->stride;
+        const guint8 *m = mask + j * mask_stride;
+
+        for (i = MAX (0, -x); i < width && x + i < surface->width; i++) {
+            if (m[i] == 0)
+                continue;
+
+            blend_pixel (&row[x + i], color,
+                         (guint) (m[i] * alpha_scale + 0.5f));
+        }
+    }
+}
+
+/* Composite a non premultiplied RGB(A) image, @affine transforms image
+ * pixels into device pixels. The image is sampled with a nearest filter */
+void
+_dax_rasterizer_composite_image (DaxRasterizerSurface *surface,
+                                 const guint8         *pixels,
+                                 gint                  width,
+                                 gint                  height,
+                                 gint                  rowstride,
+                                 gint                  n_channels,
+                                 const double          affine[6],
+                                 gfloat                opacity)
+{
+    double inverse[6];
+    gfloat xmin = G_MAXFLOAT, xmax = -G_MAXFLOAT;
+    gfloat ymin = G_MAXFLOAT, ymax = -G_MAXFLOAT;
+    gint x_start, x_end, y_start, y_end, x, y, i;
+    const gint corners[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+
+    if (width <= 0 || height <= 0)
+        return;
+
+    for (i = 0; i < 4; i++) {
+        gfloat u = corners[i][0] * width, v = corners[i][1] * height;
+        gfloat dx = affine[0] * u + affine[2] * v + affine[4];
+        gfloat dy = affine[1] * u + affine[3] * v + affine[5];
+
+        xmin = MIN (xmin, dx);
+        xmax = MAX (xmax, dx);
+        ymin = MIN (ymin, dy);
+        ymax = MAX (ymax, dy);
+    }
+
+    x_start = MAX (0, (gint) floorf (xmin));
+    x_end = MIN (surface->width - 1, (gint) ceilf (xmax));
+    y_start = MAX (0, (gint) floorf (ymin));
+    y_end = MIN (surface->height - 1, (gint) ceilf (ymax));
+
+    _dax_affine_invert (inverse, affine);
+    opacity = CLAMP (opacity, 0.0f, 1.0f);
+
+    for (y = y_start; y <= y_end; y++) {
+        guint32 *row = surface->pixels + y * surface->stride;
+
+        for (x = x_start; x <= x_end; x++) {
+            gdouble px = x + 0.5, py = y + 0.5;
+            gint u, v;
+            const guint8 *src;
+            ClutterColor color;
+            guint alpha;
+
+            u = (gint) floor (inverse[0] * px + inverse[2] * py + inverse[4]);
+            v = (gint) floor (inverse[1] * px + inverse[3] * py + inverse[5]);
+            if (u < 0 || u >= width || v < 0 || v >= height)
+                continue;
+
+            src = pixels + v * rowstride + u * n_channels;
+            color.red = src[0];
+            color.green = src[1];
+            color.blue = src[2];
+            alpha = n_channels == 4 ? src[3] : 255;
+
+            blend_pixel (&row[x], &color, (guint) (alpha * opacity + 0.5f));
+        }
+    }
+}
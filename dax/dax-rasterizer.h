@@ -0,0 +1,113 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DAX_RASTERIZER_H__
+#define __DAX_RASTERIZER_H__
+
+#include <glib.h>
+#include <clutter/clutter.h>
+
+#include "dax-path.h"
+
+G_BEGIN_DECLS
+
+/*
+ * A small scanline rasterizer working on premultiplied ARGB32 pixels
+ * (0xAARRGGBB in native endianness, the same layout as cairo's
+ * CAIRO_FORMAT_ARGB32).
+ *
+ * Paths are flattened in device space when they are built: the rasterizer
+ * keeps a list of polylines and computes the per pixel coverage using
+ * DAX_RASTERIZER_SUBSAMPLES sample lines per pixel row and exact horizontal
+ * span coverage.
+ */
+
+#define DAX_RASTERIZER_SUBSAMPLES   5
+
+typedef struct _DaxRasterizer DaxRasterizer;
+
+typedef enum
+{
+    DAX_RASTERIZER_FILL_NONZERO,
+    DAX_RASTERIZER_FILL_EVEN_ODD
+} DaxRasterizerFillRule;
+
+typedef struct
+{
+    guint32 *pixels;
+    gint width;
+    gint height;
+    gint stride;                    /* in pixels */
+} DaxRasterizerSurface;
+
+DaxRasterizer * _dax_rasterizer_new             (void);
+void            _dax_rasterizer_free            (DaxRasterizer *rasterizer);
+
+void            _dax_rasterizer_reset           (DaxRasterizer *rasterizer);
+void            _dax_rasterizer_set_transform   (DaxRasterizer *rasterizer,
+                                                 const double   affine[6]);
+
+void            _dax_rasterizer_move_to         (DaxRasterizer *rasterizer,
+                                                 gfloat         x,
+                                                 gfloat         y);
+void            _dax_rasterizer_line_to         (DaxRasterizer *rasterizer,
+                                                 gfloat         x,
+                                                 gfloat         y);
+void            _dax_rasterizer_curve_to        (DaxRasterizer *rasterizer,
+                                                 gfloat         x1,
+                                                 gfloat         y1,
+                                                 gfloat         x2,
+                                                 gfloat         y2,
+                                                 gfloat         x3,
+                                                 gfloat         y3);
+void            _dax_rasterizer_close           (DaxRasterizer *rasterizer);
+void            _dax_rasterizer_add_path        (DaxRasterizer *rasterizer,
+                                                 DaxPath       *path);
+
+void            _dax_rasterizer_fill            (DaxRasterizer         *rasterizer,
+                                                 DaxRasterizerSurface  *surface,
+                                                 const ClutterColor    *color,
+                                                 gfloat                 opacity,
+                                                 DaxRasterizerFillRule  rule);
+void            _dax_rasterizer_stroke          (DaxRasterizer         *rasterizer,
+                                                 DaxRasterizerSurface  *surface,
+                                                 const ClutterColor    *color,
+                                                 gfloat                 opacity,
+                                                 gfloat                 width);
+
+void            _dax_rasterizer_composite_a8    (DaxRasterizerSurface  *surface,
+                                                 const guint8          *mask,
+                                                 gint                   mask_stride,
+                                                 gint                   x,
+                                                 gint                   y,
+                                                 gint                   width,
+                                                 gint                   height,
+                                                 const ClutterColor    *color,
+                                                 gfloat                 opacity);
+void            _dax_rasterizer_composite_image (DaxRasterizerSurface  *surface,
+                                                 const guint8          *pixels,
+                                                 gint                   width,
+                                                 gint                   height,
+                                                 gint                   rowstride,
+                                                 gint                   n_channels,
+                                                 const double           affine[6],
+                                                 gfloat                 opacity);
+
+G_END_DECLS
+
+#endif /* __DAX_RASTERIZER_H__ */
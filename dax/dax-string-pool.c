@@ -0,0 +1,173 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "dax-string-pool.h"
+
+#define INITIAL_SIZE    64      /* has to be a power of 2 */
+
+/*
+ * Open addressing with linear probing. The hash of every string is kept
+ * next to it so that probing rarely has to look at the characters, and the
+ * strings can be looked up without being NUL terminated.
+ */
+typedef struct
+{
+    guint hash;
+    guint len;
+    const gchar *string;
+} Entry;
+
+struct _DaxStringPool
+{
+    DaxArena *arena;
+    Entry *entries;
+    guint size;
+    guint n_strings;
+
+    guint n_lookups;
+    gsize string_bytes;
+    gsize saved_bytes;
+};
+
+static guint
+hash_string (const gchar *string,
+             gsize        len)
+{
+    guint hash = 5381;
+    gsize i;
+
+    for (i = 0; i < len; i++)
+        hash = (hash << 5) + hash + (guchar) string[i];
+
+    return hash;
+}
+
+static void
+dax_string_pool_grow (DaxStringPool *pool)
+{
+    Entry *old_entries = pool->entries;
+    guint old_size = pool->size, i;
+
+    pool->size *= 2;
+    pool->entries = g_new0 (Entry, pool->size);
+
+    for (i = 0; i < old_size; i++) {
+        guint j;
+
+        if (old_entries[i].string == NULL)
+            continue;
+
+        j = old_entries[i].hash & (pool->size - 1);
+        while (pool->entries[j].string)
+            j = (j + 1) & (pool->size - 1);
+        pool->entries[j] = old_entries[i];
+    }
+
+    g_free (old_entries);
+}
+
+DaxStringPool *
+_dax_string_pool_new (DaxArena *arena)
+{
+    DaxStringPool *pool;
+
+    pool = g_slice_new0 (DaxStringPool);
+    pool->arena = arena;
+    pool->size = INITIAL_SIZE;
+    pool->entries = g_new0 (Entry, pool->size);
+
+    return pool;
+}
+
+/* the strings themselves belong to the arena */
+void
+_dax_string_pool_free (DaxStringPool *pool)
+{
+    if (pool == NULL)
+        return;
+
+    g_free (pool->entries);
+    g_slice_free (DaxStringPool, pool);
+}
+
+const gchar *
+_dax_string_pool_intern_len (DaxStringPool *pool,
+                             const gchar   *string,
+                             gsize          len)
+{
+    guint hash, i;
+    gchar *copy;
+
+    if (string == NULL)
+        return NULL;
+
+    pool->n_lookups++;
+
+    hash = hash_string (string, len);
+    for (i = hash & (pool->size - 1);
+         pool->entries[i].string;
+         i = (i + 1) & (pool->size - 1))
+    {
+        Entry *entry = &pool->entries[i];
+
+        if (entry->hash == hash && entry->len == len &&
+            memcmp (entry->string, string, len) == 0)
+        {
+            pool->saved_bytes += len + 1;
+            return entry->string;
+        }
+    }
+
+    copy = _dax_arena_alloc (pool->arena, len + 1);
+    memcpy (copy, string, len);
+    copy[len] = '\0';
+
+    pool->entries[i].hash = hash;
+    pool->entries[i].len = len;
+    pool->entries[i].string = copy;
+    pool->string_bytes += len + 1;
+
+    /* keep the load factor under 1/2 */
+    if (++pool->n_strings * 2 > pool->size)
+        dax_string_pool_grow (pool);
+
+    return copy;
+}
+
+const gchar *
+_dax_string_pool_intern (DaxStringPool *pool,
+                         const gchar   *string)
+{
+    if (string == NULL)
+        return NULL;
+
+    return _dax_string_pool_intern_len (pool, string, strlen (string));
+}
+
+void
+_dax_string_pool_get_stats (DaxStringPool      *pool,
+                            DaxStringPoolStats *stats)
+{
+    stats->n_strings = pool->n_strings;
+    stats->n_lookups = pool->n_lookups;
+    stats->string_bytes = pool->string_bytes;
+    stats->table_bytes = sizeof (DaxStringPool) + pool->size * sizeof (Entry);
+    stats->saved_bytes = pool->saved_bytes;
+}
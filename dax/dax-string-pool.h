@@ -0,0 +1,59 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __DAX_STRING_POOL_H__
+#define __DAX_STRING_POOL_H__
+
+#include <glib.h>
+
+#include "dax-arena.h"
+
+G_BEGIN_DECLS
+
+/*
+ * A table of interned strings. Interning the same characters twice gives
+ * back the same pointer, so interned strings can be compared with ==. The
+ * strings are stored in an arena and live as long as it does.
+ */
+
+typedef struct _DaxStringPool DaxStringPool;
+
+typedef struct
+{
+    guint n_strings;            /* distinct strings in the pool */
+    guint n_lookups;            /* calls to _dax_string_pool_intern*() */
+    gsize string_bytes;         /* bytes taken by the strings */
+    gsize table_bytes;          /* bytes taken by the hash table */
+    gsize saved_bytes;          /* bytes that would have been duplicated */
+} DaxStringPoolStats;
+
+DaxStringPool * _dax_string_pool_new        (DaxArena      *arena);
+void            _dax_string_pool_free       (DaxStringPool *pool);
+
+const gchar *   _dax_string_pool_intern     (DaxStringPool *pool,
+                                             const gchar   *string);
+const gchar *   _dax_string_pool_intern_len (DaxStringPool *pool,
+                                             const gchar   *string,
+                                             gsize          len);
+
+void            _dax_string_pool_get_stats  (DaxStringPool      *pool,
+                                             DaxStringPoolStats *stats);
+
+G_END_DECLS
+
+#endif /* __DAX_STRING_POOL_H__ */
@@ -0,0 +1,576 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A hierarchical timer wheel, as described by Varghese and Lauck, "Hashed and
+ * Hierarchical Timing Wheels".
+ *
+ * Time is counted in ticks of DAX_TIMER_WHEEL_TICK ms. The first level has one
+ * slot per tick for the next WHEEL_SIZE ticks, each upper level has slots
+ * WHEEL_SIZE times wider than the level below. When the first level wraps
+ * around, the timers of the next slot of the upper level are cascaded down.
+ *
+ * The whole wheel is driven by a single GSource that only wakes up when the
+ * next timer is due. All the timers expiring in the same tick are fired in the
+ * same dispatch.
+ */
+
+#include "dax-internals.h"
+#include "dax-debug.h"
+
+#include "dax-timer-wheel.h"
+
+#define WHEEL_BITS  6
+#define WHEEL_SIZE  (1 << WHEEL_BITS)
+#define WHEEL_MASK  (WHEEL_SIZE - 1)
+#define N_LEVELS    4
+
+/* timers can't be scheduled further than that, they are clamped */
+#define MAX_DELTA   ((G_GUINT64_CONSTANT (1) << (WHEEL_BITS * N_LEVELS)) - 1)
+
+typedef struct
+{
+    GSource source;
+    DaxTimerWheel *wheel;
+} WheelSource;
+
+struct _DaxTimerWheel
+{
+    gint ref_count;
+
+    GSource *source;
+
+    GTimer *clock;
+    gboolean paused;
+
+    guint64 jiffies;            /* next tick to process */
+    guint64 next_expiry;
+    gboolean next_expiry_valid;
+
+    DaxTimerWheelEntry *slots[N_LEVELS][WHEEL_SIZE];
+    guint n_entries[N_LEVELS];
+    guint n_timers;
+
+    guint64 n_fired;
+    guint64 n_wakeups;
+};
+
+static gulong
+wheel_elapsed_ms (DaxTimerWheel *wheel)
+{
+    return (gulong) (g_timer_elapsed (wheel->clock, NULL) * 1e3);
+}
+
+static guint64
+wheel_current_tick (DaxTimerWheel *wheel)
+{
+    return wheel_elapsed_ms (wheel) / DAX_TIMER_WHEEL_TICK;
+}
+
+static void
+wheel_link (DaxTimerWheel      *wheel,
+            DaxTimerWheelEntry *entry)
+{
+    guint64 expires, delta;
+    gint level;
+    guint idx;
+
+    expires = MAX (entry->expires, wheel->jiffies);
+    delta = expires - wheel->jiffies;
+    if (delta > MAX_DELTA) {
+        expires = wheel->jiffies + MAX_DELTA;
+        delta = MAX_DELTA;
+    }
+
+    for (level = 0; level < N_LEVELS - 1; level++)
+        if (delta < (G_GUINT64_CONSTANT (1) << (WHEEL_BITS * (level + 1))))
+            break;
+
+    idx = (expires >> (WHEEL_BITS * level)) & WHEEL_MASK;
+
+    entry->head = &wheel->slots[level][idx];
+    entry->level = level;
+    entry->prev = NULL;
+    entry->next = *entry->head;
+    if (entry->next)
+        entry->next->prev = entry;
+    *entry->head = entry;
+
+    wheel->n_entries[level]++;
+}
+
+static void
+wheel_unlink (DaxTimerWheel      *wheel,
+              DaxTimerWheelEntry *entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        *entry->head = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+
+    if (entry->level >= 0)
+        wheel->n_entries[entry->level]--;
+
+    entry->head = NULL;
+    entry->next = entry->prev = NULL;
+}
+
+/* move the timers of slot idx of level one level down */
+static void
+wheel_cascade (DaxTimerWheel *wheel,
+               gint           level,
+               guint          idx)
+{
+    DaxTimerWheelEntry *entry, *next;
+
+    entry = wheel->slots[level][idx];
+    wheel->slots[level][idx] = NULL;
+
+    for (; entry; entry = next) {
+        next = entry->next;
+        wheel->n_entries[level]--;
+        wheel_link (wheel, entry);
+    }
+}
+
+static void
+wheel_run (DaxTimerWheel *wheel,
+           guint64        target)
+{
+    DaxTimerWheelEntry *pending, *entry;
+    guint idx;
+    gint level;
+
+    while (wheel->jiffies <= target) {
+        idx = wheel->jiffies & WHEEL_MASK;
+
+        for (level = 1; idx == 0 && level < N_LEVELS; level++) {
+            idx = (wheel->jiffies >> (WHEEL_BITS * level)) & WHEEL_MASK;
+            wheel_cascade (wheel, level, idx);
+        }
+
+        /* nothing to do before the first level wraps around */
+        if (wheel->n_entries[0] == 0) {
+            wheel->jiffies = MIN (target + 1,
+                                  (wheel->jiffies | WHEEL_MASK) + 1);
+            continue;
+        }
+
+        idx = wheel->jiffies & WHEEL_MASK;
+        wheel->jiffies++;
+
+        /* detach the slot first, callbacks are free to add and remove
+         * timers, including the ones that are about to fire */
+        pending = wheel->slots[0][idx];
+        wheel->slots[0][idx] = NULL;
+        for (entry = pending; entry; entry = entry->next) {
+            entry->head = &pending;
+            entry->level = -1;
+            wheel->n_entries[0]--;
+        }
+
+        while (pending) {
+            entry = pending;
+            wheel_unlink (wheel, entry);
+            wheel->n_timers--;
+            wheel->n_fired++;
+            entry->func (entry->data);
+        }
+    }
+
+    wheel->next_expiry_valid = FALSE;
+}
+
+static guint64
+wheel_get_next_expiry (DaxTimerWheel *wheel)
+{
+    DaxTimerWheelEntry *entry;
+    guint64 next = G_MAXUINT64, boundary;
+    guint i, idx;
+    gint level;
+
+    if (wheel->next_expiry_valid)
+        return wheel->next_expiry;
+
+    if (wheel->n_entries[0]) {
+        for (i = 0; i < WHEEL_SIZE; i++) {
+            idx = (wheel->jiffies + i) & WHEEL_MASK;
+            if (wheel->slots[0][idx]) {
+                next = wheel->jiffies + i;
+                break;
+            }
+        }
+    }
+
+    /* timers in the upper levels can't expire before the first level wraps
+     * around, only look at them when the first level has nothing sooner */
+    boundary = (wheel->jiffies | WHEEL_MASK) + 1;
+    if (next >= boundary) {
+        for (level = 1; level < N_LEVELS; level++) {
+            if (wheel->n_entries[level] == 0)
+                continue;
+
+            for (i = 0; i < WHEEL_SIZE; i++) {
+                entry = wheel->slots[level][i];
+                for (; entry; entry = entry->next)
+                    next = MIN (next, MAX (entry->expires, boundary));
+            }
+        }
+    }
+
+    wheel->next_expiry = next;
+    wheel->next_expiry_valid = TRUE;
+
+    return next;
+}
+
+/*
+ * GSource implementation
+ */
+
+static gboolean
+wheel_source_prepare (GSource *source,
+                      gint    *timeout)
+{
+    DaxTimerWheel *wheel = ((WheelSource *) source)->wheel;
+    guint64 next;
+    gulong now;
+
+    *timeout = -1;
+
+    if (wheel->paused || wheel->n_timers == 0)
+        return FALSE;
+
+    next = wheel_get_next_expiry (wheel) * DAX_TIMER_WHEEL_TICK;
+    now = wheel_elapsed_ms (wheel);
+    if (next <= now) {
+        *timeout = 0;
+        return TRUE;
+    }
+
+    *timeout = MIN (next - now, G_MAXINT);
+
+    return FALSE;
+}
+
+static gboolean
+wheel_source_check (GSource *source)
+{
+    DaxTimerWheel *wheel = ((WheelSource *) source)->wheel;
+
+    if (wheel->paused || wheel->n_timers == 0)
+        return FALSE;
+
+    return wheel_get_next_expiry (wheel) <= wheel_current_tick (wheel);
+}
+
+static gboolean
+wheel_source_dispatch (GSource     *source,
+                       GSourceFunc  callback,
+                       gpointer     user_data)
+{
+    DaxTimerWheel *wheel = ((WheelSource *) source)->wheel;
+
+    dax_timer_wheel_ref (wheel);
+
+    wheel->n_wakeups++;
+    wheel_run (wheel, wheel_current_tick (wheel));
+
+    DAX_NOTE (SCRIPT, "[TIMER] wake up #%" G_GUINT64_FORMAT ", %"
+              G_GUINT64_FORMAT " timers fired so far",
+              wheel->n_wakeups, wheel->n_fired);
+
+    dax_timer_wheel_unref (wheel);
+
+    return TRUE;
+}
+
+static GSourceFuncs wheel_source_funcs = {
+    wheel_source_prepare,
+    wheel_source_check,
+    wheel_source_dispatch,
+    NULL
+};
+
+/*
+ * Public API
+ */
+
+DaxTimerWheel *
+dax_timer_wheel_new (void)
+{
+    DaxTimerWheel *wheel;
+    WheelSource *source;
+
+    wheel = g_slice_new0 (DaxTimerWheel);
+    wheel->ref_count = 1;
+    wheel->clock = g_timer_new ();
+
+    source = (WheelSource *) g_source_new (&wheel_source_funcs,
+                                           sizeof (WheelSource));
+    source->wheel = wheel;
+    wheel->source = (GSource *) source;
+    g_source_attach (wheel->source, NULL);
+
+    return wheel;
+}
+
+/**
+ * dax_timer_wheel_get_default:
+ *
+ * Returns: the wheel used by the timers not attached to a document, owned by
+ * Dax.
+ */
+DaxTimerWheel *
+dax_timer_wheel_get_default (void)
+{
+    static DaxTimerWheel *default_wheel = NULL;
+
+    if (G_UNLIKELY (default_wheel == NULL))
+        default_wheel = dax_timer_wheel_new ();
+
+    return default_wheel;
+}
+
+DaxTimerWheel *
+dax_timer_wheel_ref (DaxTimerWheel *wheel)
+{
+    g_return_val_if_fail (wheel != NULL, NULL);
+
+    wheel->ref_count++;
+
+    return wheel;
+}
+
+void
+dax_timer_wheel_unref (DaxTimerWheel *wheel)
+{
+    DaxTimerWheelEntry *entry;
+    gint level, i;
+
+    g_return_if_fail (wheel != NULL);
+
+    if (--wheel->ref_count > 0)
+        return;
+
+    /* don't leave the remaining entries pointing to the slots */
+    for (level = 0; level < N_LEVELS; level++)
+        for (i = 0; i < WHEEL_SIZE; i++)
+            while ((entry = wheel->slots[level][i]))
+                wheel_unlink (wheel, entry);
+
+    g_source_destroy (wheel->source);
+    g_source_unref (wheel->source);
+    g_timer_destroy (wheel->clock);
+
+    g_slice_free (DaxTimerWheel, wheel);
+}
+
+/**
+ * dax_timer_wheel_pause:
+ * @wheel: a #DaxTimerWheel
+ *
+ * Stops the clock of @wheel. No timer fires while the wheel is paused and the
+ * time spent paused does not count towards their delay.
+ */
+void
+dax_timer_wheel_pause (DaxTimerWheel *wheel)
+{
+    g_return_if_fail (wheel != NULL);
+
+    if (wheel->paused)
+        return;
+
+    DAX_NOTE (SCRIPT, "[TIMER] pausing wheel %p", wheel);
+
+    g_timer_stop (wheel->clock);
+    wheel->paused = TRUE;
+}
+
+void
+dax_timer_wheel_resume (DaxTimerWheel *wheel)
+{
+    g_return_if_fail (wheel != NULL);
+
+    if (!wheel->paused)
+        return;
+
+    DAX_NOTE (SCRIPT, "[TIMER] resuming wheel %p", wheel);
+
+    g_timer_continue (wheel->clock);
+    wheel->paused = FALSE;
+
+    g_main_context_wakeup (g_source_get_context (wheel->source));
+}
+
+gboolean
+dax_timer_wheel_is_paused (DaxTimerWheel *wheel)
+{
+    g_return_val_if_fail (wheel != NULL, FALSE);
+
+    return wheel->paused;
+}
+
+/**
+ * dax_timer_wheel_get_time:
+ * @wheel: a #DaxTimerWheel
+ *
+ * Returns: the time (in ms) elapsed on the clock of @wheel, not counting the
+ * time spent paused
+ */
+gulong
+dax_timer_wheel_get_time (DaxTimerWheel *wheel)
+{
+    g_return_val_if_fail (wheel != NULL, 0);
+
+    return wheel_elapsed_ms (wheel);
+}
+
+guint
+dax_timer_wheel_get_n_timers (DaxTimerWheel *wheel)
+{
+    g_return_val_if_fail (wheel != NULL, 0);
+
+    return wheel->n_timers;
+}
+
+guint64
+dax_timer_wheel_get_n_wakeups (DaxTimerWheel *wheel)
+{
+    g_return_val_if_fail (wheel != NULL, 0);
+
+    return wheel->n_wakeups;
+}
+
+/**
+ * dax_timer_wheel_get_wakeups_saved:
+ * @wheel: a #DaxTimerWheel
+ *
+ * Returns: the number of main loop wake ups saved by firing timers together,
+ * compared to having one source per timer
+ */
+guint64
+dax_timer_wheel_get_wakeups_saved (DaxTimerWheel *wheel)
+{
+    g_return_val_if_fail (wheel != NULL, 0);
+
+    if (wheel->n_fired < wheel->n_wakeups)
+        return 0;
+
+    return wheel->n_fired - wheel->n_wakeups;
+}
+
+void
+dax_timer_wheel_entry_init (DaxTimerWheelEntry *entry,
+                            DaxTimerWheelFunc   func,
+                            gpointer            data)
+{
+    g_return_if_fail (entry != NULL);
+
+    entry->next = entry->prev = NULL;
+    entry->head = NULL;
+    entry->level = -1;
+    entry->expires = 0;
+    entry->func = func;
+    entry->data = data;
+}
+
+gboolean
+dax_timer_wheel_entry_is_pending (DaxTimerWheelEntry *entry)
+{
+    g_return_val_if_fail (entry != NULL, FALSE);
+
+    return entry->head != NULL;
+}
+
+/**
+ * dax_timer_wheel_add:
+ * @wheel: a #DaxTimerWheel
+ * @entry: an initialized #DaxTimerWheelEntry
+ * @delay: time, in ms, after which @entry should fire
+ *
+ * Schedules @entry. If @entry was already pending, it is rescheduled. The
+ * entry is fired at most one tick after its expiry, never before.
+ */
+void
+dax_timer_wheel_add (DaxTimerWheel      *wheel,
+                     DaxTimerWheelEntry *entry,
+                     gulong              delay)
+{
+    g_return_if_fail (wheel != NULL);
+    g_return_if_fail (entry != NULL && entry->func != NULL);
+
+    if (entry->head)
+        dax_timer_wheel_remove (wheel, entry);
+
+    /* an empty wheel can skip the ticks it has not processed yet */
+    if (wheel->n_timers == 0)
+        wheel->jiffies = MAX (wheel->jiffies, wheel_current_tick (wheel));
+
+    entry->expires = (wheel_elapsed_ms (wheel) + delay +
+                      DAX_TIMER_WHEEL_TICK - 1) / DAX_TIMER_WHEEL_TICK;
+    wheel_link (wheel, entry);
+
+    wheel->n_timers++;
+    wheel->next_expiry_valid = FALSE;
+}
+
+void
+dax_timer_wheel_remove (DaxTimerWheel      *wheel,
+                        DaxTimerWheelEntry *entry)
+{
+    g_return_if_fail (wheel != NULL);
+    g_return_if_fail (entry != NULL);
+
+    if (entry->head == NULL)
+        return;
+
+    wheel_unlink (wheel, entry);
+
+    wheel->n_timers--;
+    wheel->next_expiry_valid = FALSE;
+}
+
+/**
+ * dax_timer_wheel_get_remaining:
+ * @wheel: a #DaxTimerWheel
+ * @entry: a #DaxTimerWheelEntry
+ *
+ * Returns: the time, in ms, before @entry fires, or 0 if @entry is not
+ * pending
+ */
+gulong
+dax_timer_wheel_get_remaining (DaxTimerWheel      *wheel,
+                               DaxTimerWheelEntry *entry)
+{
+    guint64 expires;
+    gulong now;
+
+    g_return_val_if_fail (wheel != NULL, 0);
+    g_return_val_if_fail (entry != NULL, 0);
+
+    if (entry->head == NULL)
+        return 0;
+
+    expires = entry->expires * DAX_TIMER_WHEEL_TICK;
+    now = wheel_elapsed_ms (wheel);
+
+    return expires > now ? expires - now : 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__DAX_H_INSIDE__) && !defined(DAX_COMPILATION)
+#error "Only <dax/dax.h> can be included directly."
+#endif
+
+#ifndef __DAX_TIMER_WHEEL_H__
+#define __DAX_TIMER_WHEEL_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * DAX_TIMER_WHEEL_TICK:
+ *
+ * Resolution of the timer wheel, in ms. Timers expiring within the same tick
+ * are fired together.
+ */
+#define DAX_TIMER_WHEEL_TICK    10
+
+typedef struct _DaxTimerWheel DaxTimerWheel;
+typedef struct _DaxTimerWheelEntry DaxTimerWheelEntry;
+
+typedef void (*DaxTimerWheelFunc) (gpointer data);
+
+/**
+ * DaxTimerWheelEntry:
+ *
+ * A timer scheduled on a #DaxTimerWheel. Entries are meant to be embedded in
+ * the structure of the object they fire for, initialize them with
+ * dax_timer_wheel_entry_init().
+ */
+struct _DaxTimerWheelEntry
+{
+    /*< private >*/
+    DaxTimerWheelEntry *next;
+    DaxTimerWheelEntry *prev;
+    DaxTimerWheelEntry **head;
+    gint level;
+
+    guint64 expires;
+
+    DaxTimerWheelFunc func;
+    gpointer data;
+};
+
+DaxTimerWheel * dax_timer_wheel_new                 (void);
+DaxTimerWheel * dax_timer_wheel_get_default         (void);
+DaxTimerWheel * dax_timer_wheel_ref                 (DaxTimerWheel *wheel);
+void            dax_timer_wheel_unref               (DaxTimerWheel *wheel);
+
+void            dax_timer_wheel_pause               (DaxTimerWheel *wheel);
+void            dax_timer_wheel_resume              (DaxTimerWheel *wheel);
+gboolean        dax_timer_wheel_is_paused           (DaxTimerWheel *wheel);
+gulong          dax_timer_wheel_get_time            (DaxTimerWheel *wheel);
+
+guint           dax_timer_wheel_get_n_timers        (DaxTimerWheel *wheel);
+guint64         dax_timer_wheel_get_n_wakeups       (DaxTimerWheel *wheel);
+guint64         dax_timer_wheel_get_wakeups_saved   (DaxTimerWheel *wheel);
+
+void            dax_timer_wheel_entry_init      (DaxTimerWheelEntry *entry,
+                                                 DaxTimerWheelFunc   func,
+                                                 gpointer            data);
+void            dax_timer_wheel_add             (DaxTimerWheel      *wheel,
+                                                 DaxTimerWheelEntry *entry,
+                                                 gulong              delay);
+void            dax_timer_wheel_remove          (DaxTimerWheel      *wheel,
+                                                 DaxTimerWheelEntry *entry);
+gboolean        dax_timer_wheel_entry_is_pending (DaxTimerWheelEntry *entry);
+gulong          dax_timer_wheel_get_remaining   (DaxTimerWheel      *wheel,
+                                                 DaxTimerWheelEntry *entry);
+
+G_END_DECLS
+
+#endif /* __DAX_TIMER_WHEEL_H__ */
@@ -23,11 +23,15 @@
 #include "dax-dom.h"
 
 #include "clutter-shape.h"
+#include "dax-affine.h"
+#include "dax-binding.h"
 #include "dax-debug.h"
+#include "dax-display-list.h"
 #include "dax-enum-types.h"
 #include "dax-group.h"
 #include "dax-internals.h"
 #include "dax-knot-sequence.h"
+#include "dax-path.h"
 #include "dax-shape.h"
 #include "dax-utils.h"
 
@@ -43,6 +47,16 @@ G_DEFINE_TYPE (DaxTraverserClutter,
                                       DaxTraverserClutterPrivate))
 
 static GQuark quark_object_actor;
+static GQuark quark_actor_element;
+
+/* what changed in an element since its actor was last updated */
+enum
+{
+    CHANGED_TRANSFORM       = 1 << 0,
+    CHANGED_POSITION        = 1 << 1,
+    CHANGED_FILL_OPACITY    = 1 << 2,
+    CHANGED_GEOMETRY        = 1 << 3
+};
 
 enum
 {
@@ -51,12 +65,33 @@ enum
     PROP_CONTAINER
 };
 
+/* flags of the elements that can't be drawn by a display list */
+enum
+{
+    NODE_DYNAMIC        = 1 << 0,   /* can change once displayed */
+    NODE_HAS_DYNAMIC    = 1 << 1    /* has a dynamic descendant */
+};
+
+typedef struct
+{
+    double affine[6];
+} BaseCtm;
+
 struct _DaxTraverserClutterPrivate
 {
     ClutterContainer *container;
+    ClutterContainer *root_container;   /* where the children of <svg> go */
     ClutterColor *fill_color;
     ClutterScore *score;
     GPtrArray *media;               /* Array of ClutterMedia objects */
+    DaxGroupCacheMode group_cache_mode;
+
+    /* display list mode */
+    gboolean use_display_list;
+    GHashTable *dynamic;            /* DaxDomNode -> flags */
+    DaxDisplayList *list;           /* the list static shapes go in */
+    GArray *base_ctm;               /* array of BaseCtm, inverted CTM of
+                                       the actors containing the lists */
 };
 
 static void
@@ -100,18 +135,321 @@ set_container_internal (DaxTraverserClutter *self,
     if (priv->container)
         g_object_unref (priv->container);
     priv->container = g_object_ref (container);
+
+    /* shapes drawn after this point go in a new display list */
+    priv->list = NULL;
+}
+
+/* Every actor is bound to the element it was built for, so that DOM
+ * mutations and event handlers can find it back */
+static void
+add_actor (DaxTraverserClutter *self,
+           gpointer             element,
+           ClutterActor        *actor)
+{
+    DaxTraverserClutterPrivate *priv = self->priv;
+
+    clutter_container_add_actor (priv->container, actor);
+    g_object_set_qdata (G_OBJECT (element), quark_object_actor, actor);
+    g_object_set_qdata (G_OBJECT (actor), quark_actor_element, element);
+
+    /* keep the stacking order: the next static shapes are drawn on top */
+    priv->list = NULL;
+}
+
+/* the elements without a transform are drawn with the identity */
+static void
+get_element_transform (GObject   *element,
+                       DaxMatrix *matrix)
+{
+    DaxMatrix *transform;
+
+    g_object_get (element, "transform", &transform, NULL);
+    if (transform) {
+        *matrix = *transform;
+        dax_matrix_free (transform);
+        return;
+    }
+
+    _dax_affine_identity (matrix->affine);
+    matrix->n_elementary_matrices = 0;
+}
+
+static void
+set_actor_transform (ClutterActor *actor,
+                     GObject      *element)
+{
+    DaxMatrix matrix;
+
+    get_element_transform (element, &matrix);
+    if (DAX_IS_SHAPE (actor))
+        dax_shape_set_matrix (DAX_SHAPE (actor), &matrix);
+    else if (DAX_IS_GROUP (actor))
+        dax_group_set_matrix (DAX_GROUP (actor), &matrix);
+}
+
+static const DaxBindingProperty transform_properties[] =
+{
+    { "transform", CHANGED_TRANSFORM },
+    { NULL, 0 }
+};
+
+static void
+update_transform (GObject *element,
+                  GObject *target,
+                  guint    changes)
+{
+    set_actor_transform (CLUTTER_ACTOR (target), element);
+}
+
+/* Rectangles, texts and textures can't be given an affine transform, the
+ * ones built for a transformed element are put in a group that holds it.
+ * Returns the actor bound to the element */
+static ClutterActor *
+add_transformed_actor (DaxTraverserClutter *self,
+                       gpointer             element,
+                       ClutterActor        *actor,
+                       const DaxMatrix     *transform)
+{
+    ClutterActor *group;
+
+    if (transform == NULL) {
+        add_actor (self, element, actor);
+        return actor;
+    }
+
+    group = dax_group_new ();
+    dax_group_set_matrix (DAX_GROUP (group), transform);
+    clutter_container_add_actor (CLUTTER_CONTAINER (group), actor);
+    add_actor (self, element, group);
+
+    return group;
+}
+
+/*
+ * Display list
+ *
+ * The elements that can't change once displayed don't need an actor each.
+ * Static shapes are drawn by a DaxDisplayList, consecutive ones by the same
+ * list, and static <g> are flattened. Only the dynamic elements (animated,
+ * watched by handlers or scripts, text, images and videos) and their
+ * ancestors keep their actors.
+ */
+
+static guint
+get_node_flags (DaxTraverserClutter *self,
+                gpointer             node)
+{
+    return GPOINTER_TO_UINT (g_hash_table_lookup (self->priv->dynamic, node));
+}
+
+/* TRUE if node is drawn by a display list rather than by an actor */
+static gboolean
+is_static (DaxTraverserClutter *self,
+           gpointer             node)
+{
+    return self->priv->dynamic && get_node_flags (self, node) == 0;
+}
+
+/* Next node of a depth-first walk of the subtree of root */
+static DaxDomNode *
+next_node (DaxDomNode *node,
+           DaxDomNode *root)
+{
+    if (node->first_child)
+        return node->first_child;
+
+    while (node != root && node->next_sibling == NULL)
+        node = node->parent_node;
+
+    return node == root ? NULL : node->next_sibling;
+}
+
+static void
+add_node_flags (DaxTraverserClutter *self,
+                DaxDomNode          *node,
+                guint                flags)
+{
+    flags |= get_node_flags (self, node);
+    g_hash_table_insert (self->priv->dynamic, node, GUINT_TO_POINTER (flags));
+}
+
+/* Every element of the subtree of root is dynamic, its ancestors have a
+ * dynamic descendant */
+static void
+mark_dynamic (DaxTraverserClutter *self,
+              DaxDomNode          *root)
+{
+    DaxDomNode *node;
+
+    if (root == NULL || get_node_flags (self, root) & NODE_DYNAMIC)
+        return;
+
+    for (node = root; node; node = next_node (node, root))
+        add_node_flags (self, node, NODE_DYNAMIC);
+
+    for (node = root->parent_node; node; node = node->parent_node) {
+        if (get_node_flags (self, node) & NODE_HAS_DYNAMIC)
+            break;
+        add_node_flags (self, node, NODE_HAS_DYNAMIC);
+    }
+}
+
+static gboolean
+has_onload_handler (DaxDomNode *node)
+{
+    gchar *onload;
+    gboolean has_onload;
+
+    if (!DAX_IS_ELEMENT (node))
+        return FALSE;
+
+    g_object_get (node, "onload", &onload, NULL);
+    has_onload = onload != NULL;
+    g_free (onload);
+
+    return has_onload;
+}
+
+/* Find out which elements of the tree rooted at svg are dynamic */
+static void
+find_dynamic_elements (DaxTraverserClutter *self,
+                       DaxDomNode          *svg)
+{
+    DaxDomNode *node;
+    gboolean has_scripts = FALSE;
+
+    for (node = svg; node; node = next_node (node, svg)) {
+        if (DAX_IS_ELEMENT_ANIMATION (node)) {
+            DaxElementAnimation *animation = DAX_ELEMENT_ANIMATION (node);
+
+            mark_dynamic (self, DAX_DOM_NODE (
+                dax_element_animation_get_target (animation)));
+        } else if (DAX_IS_ELEMENT_HANDLER (node)) {
+            DaxElementHandler *handler = DAX_ELEMENT_HANDLER (node);
+
+            mark_dynamic (self, DAX_DOM_NODE (
+                dax_element_handler_get_target (handler)));
+        } else if (DAX_IS_ELEMENT_TEXT (node) ||
+                   DAX_IS_ELEMENT_IMAGE (node) ||
+                   DAX_IS_ELEMENT_VIDEO (node))
+        {
+            mark_dynamic (self, node);
+        } else if (DAX_IS_ELEMENT_SCRIPT (node)) {
+            has_scripts = TRUE;
+        }
+
+        if (node != svg && has_onload_handler (node)) {
+            has_scripts = TRUE;
+            mark_dynamic (self, node);
+        }
+    }
+
+    if (!has_scripts)
+        return;
+
+    /* scripts can get any element with an id */
+    for (node = svg->first_child; node; node = next_node (node, svg)) {
+        if (DAX_IS_DOM_ELEMENT (node) &&
+            dax_dom_element_get_id (DAX_DOM_ELEMENT (node)))
+        {
+            mark_dynamic (self, node);
+        }
+    }
 }
 
 static void
-on_g_transform_changed (DaxElementG *element,
-                        GParamSpec  *pspec,
-                        gpointer     user_data)
+push_base_ctm (DaxTraverserClutter *self)
+{
+    DaxTraverserClutterPrivate *priv = self->priv;
+    const DaxMatrix *ctm;
+    BaseCtm base;
+
+    ctm = dax_traverser_get_ctm (DAX_TRAVERSER (self));
+    _dax_affine_invert (base.affine, ctm->affine);
+    g_array_append_val (priv->base_ctm, base);
+}
+
+static void
+pop_base_ctm (DaxTraverserClutter *self)
+{
+    DaxTraverserClutterPrivate *priv = self->priv;
+
+    g_array_set_size (priv->base_ctm, priv->base_ctm->len - 1);
+}
+
+/* Append path to the current display list, opening a new one if needed */
+static void
+record_path (DaxTraverserClutter *self,
+             DaxPath             *path,
+             const ClutterColor  *fill_color,
+             const ClutterColor  *stroke_color)
+{
+    DaxTraverserClutterPrivate *priv = self->priv;
+    const DaxMatrix *ctm;
+    BaseCtm *base;
+    DaxMatrix matrix;
+
+    if (path == NULL)
+        return;
+
+    if (priv->list == NULL) {
+        ClutterActor *list = dax_display_list_new ();
+
+        clutter_container_add_actor (priv->container, list);
+        priv->list = DAX_DISPLAY_LIST (list);
+    }
+
+    /* the path is drawn in the coordinates of the actor containing the
+     * list */
+    ctm = dax_traverser_get_ctm (DAX_TRAVERSER (self));
+    base = &g_array_index (priv->base_ctm, BaseCtm, priv->base_ctm->len - 1);
+    _dax_affine_multiply (matrix.affine, ctm->affine, base->affine);
+    matrix.n_elementary_matrices = 0;
+
+    dax_display_list_add_path (priv->list, path, &matrix,
+                               fill_color, stroke_color);
+}
+
+static void
+dax_traverser_clutter_traverse_svg (DaxTraverser  *traverser,
+                                    DaxElementSvg *node)
+{
+    DaxTraverserClutter *build = DAX_TRAVERSER_CLUTTER (traverser);
+    DaxTraverserClutterPrivate *priv = build->priv;
+    BaseCtm identity;
+
+    if (!priv->use_display_list)
+        return;
+
+    if (priv->dynamic)
+        g_hash_table_destroy (priv->dynamic);
+    priv->dynamic = g_hash_table_new (g_direct_hash, g_direct_equal);
+    find_dynamic_elements (build, DAX_DOM_NODE (node));
+
+    DAX_NOTE (TRAVERSER, "%u elements need an actor",
+              g_hash_table_size (priv->dynamic));
+
+    _dax_affine_identity (identity.affine);
+    g_array_set_size (priv->base_ctm, 0);
+    g_array_append_val (priv->base_ctm, identity);
+}
+
+static const DaxBindingProperty g_properties[] =
+{
+    { "transform", CHANGED_TRANSFORM },
+    { NULL, 0 }
+};
+
+static void
+update_g (GObject *element,
+          GObject *target,
+          guint    changes)
 {
-    DaxGroup *group = DAX_GROUP (user_data);
     const DaxMatrix *matrix;
 
-    matrix = dax_element_g_get_transform (element);
-    dax_group_set_matrix (group, matrix);
+    matrix = dax_element_g_get_transform (DAX_ELEMENT_G (element));
+    dax_group_set_matrix (DAX_GROUP (target), matrix);
 }
 
 static void
@@ -122,41 +460,55 @@ dax_traverser_clutter_traverse_g (DaxTraverser    *traverser,
     DaxTraverserClutter *build = DAX_TRAVERSER_CLUTTER (traverser);
     DaxTraverserClutterPrivate *priv = build->priv;
     ClutterActor *group;
-    DaxMatrix *matrix;
+    const DaxMatrix *matrix;
+
+    /* a static group is flattened, its children are drawn by the display
+     * list of its parent */
+    if (is_static (build, node))
+        return;
 
     if (way == DAX_TRAVERSER_WAY_END) {
         ClutterActor *parent;
 
         parent = clutter_actor_get_parent (CLUTTER_ACTOR (priv->container));
         set_container_internal (build, CLUTTER_CONTAINER (parent));
+        if (priv->dynamic)
+            pop_base_ctm (build);
         return;
     }
 
     group = dax_group_new ();
-    clutter_container_add_actor (priv->container, group);
+    dax_group_set_cache_mode (DAX_GROUP (group), priv->group_cache_mode);
+    add_actor (build, node, group);
     set_container_internal (build, CLUTTER_CONTAINER (group));
+    if (priv->dynamic)
+        push_base_ctm (build);
 
-    g_signal_connect (node, "notify::transform",
-                      G_CALLBACK (on_g_transform_changed), group);
+    _dax_binding_new (G_OBJECT (node), G_OBJECT (group), g_properties,
+                      update_g);
 
-    g_object_get (node, "transform", &matrix, NULL);
+    matrix = dax_element_g_get_transform (node);
     if (matrix == NULL)
         return;
 
     dax_group_set_matrix (DAX_GROUP (group), matrix);
-    dax_matrix_free (matrix);
 }
 
+static const DaxBindingProperty path_properties[] =
+{
+    { "transform", CHANGED_TRANSFORM },
+    { NULL, 0 }
+};
+
 static void
-on_path_transform_changed (DaxElementPath *element,
-                           GParamSpec     *pspec,
-                           gpointer        user_data)
+update_path (GObject *element,
+             GObject *target,
+             guint    changes)
 {
-    DaxShape *shape = DAX_SHAPE (user_data);
     const DaxMatrix *matrix;
 
-    matrix = dax_element_path_get_transform (element);
-    dax_shape_set_matrix (shape, matrix);
+    matrix = dax_element_path_get_transform (DAX_ELEMENT_PATH (element));
+    dax_shape_set_matrix (DAX_SHAPE (target), matrix);
 }
 
 static void
@@ -164,75 +516,98 @@ dax_traverser_clutter_traverse_path (DaxTraverser   *traverser,
                                      DaxElementPath *node)
 {
     DaxTraverserClutter *build = DAX_TRAVERSER_CLUTTER (traverser);
-    DaxTraverserClutterPrivate *priv = build->priv;
     DaxElement *element = DAX_ELEMENT (node);
     const ClutterColor *fill_color, *stroke_color;
     ClutterActor *shape;
-    ClutterPath2D *path;
-    DaxMatrix *matrix;
-
-    shape = dax_shape_new ();
+    DaxPath *path;
+    const DaxMatrix *matrix;
 
     fill_color = dax_element_get_fill_color (element);
     stroke_color = dax_element_get_stroke_color (element);
+    path = dax_element_path_get_path (node);
+
+    if (is_static (build, node)) {
+        record_path (build, path, fill_color, stroke_color);
+        g_object_unref (path);
+        return;
+    }
+
+    shape = dax_shape_new ();
     if (fill_color)
         g_object_set (shape, "color", fill_color, NULL);
     if (stroke_color)
         g_object_set (shape, "border-color", stroke_color, NULL);
 
-    g_object_get (node, "d", &path, NULL);
     g_object_set (shape, "path", path, NULL);
+    g_object_unref (path);
 
-    clutter_container_add_actor (priv->container, shape);
+    add_actor (build, node, shape);
 
-    g_signal_connect (node, "notify::transform",
-                      G_CALLBACK (on_path_transform_changed), shape);
+    _dax_binding_new (G_OBJECT (node), G_OBJECT (shape), path_properties,
+                      update_path);
 
-    g_object_get (node, "transform", &matrix, NULL);
+    matrix = dax_element_path_get_transform (node);
     if (matrix == NULL)
         return;
 
     dax_shape_set_matrix (DAX_SHAPE (shape), matrix);
-    dax_matrix_free (matrix);
 }
 
-static void
-on_rect_x_changed (DaxElementRect *element,
-                   GParamSpec     *pspec,
-                   gpointer        user_data)
+static const DaxBindingProperty rect_properties[] =
 {
-    ClutterActor *rectangle = CLUTTER_ACTOR (user_data);
-    gfloat x;
-
-    x = dax_element_rect_get_x_px (element);
-    clutter_actor_set_x (rectangle, x);
-}
+    { "x", CHANGED_POSITION },
+    { "y", CHANGED_POSITION },
+    { "fill-opacity", CHANGED_FILL_OPACITY },
+    { "transform", CHANGED_TRANSFORM },
+    { NULL, 0 }
+};
 
 static void
-on_rect_y_changed (DaxElementRect *element,
-                   GParamSpec     *pspec,
-                   gpointer        user_data)
+update_rect (GObject *element,
+             GObject *target,
+             guint    changes)
 {
-    ClutterActor *rectangle = CLUTTER_ACTOR (user_data);
-    gfloat y;
+    DaxElementRect *rect = DAX_ELEMENT_RECT (element);
+
+    if (changes & CHANGED_POSITION)
+        clutter_actor_set_position (CLUTTER_ACTOR (target),
+                                    dax_element_rect_get_x_px (rect),
+                                    dax_element_rect_get_y_px (rect));
+
+    if (changes & CHANGED_FILL_OPACITY) {
+        ClutterRectangle *rectangle = CLUTTER_RECTANGLE (target);
+        ClutterColor fill_color;
+        gfloat fill_opacity;
+
+        fill_opacity = dax_element_get_fill_opacity (DAX_ELEMENT (rect));
+        clutter_rectangle_get_color (rectangle, &fill_color);
+        fill_color.alpha = fill_opacity * 255;
+        clutter_rectangle_set_color (rectangle, &fill_color);
+    }
+
+    /* only a rectangle built with a transform has a group to hold it */
+    if (changes & CHANGED_TRANSFORM) {
+        ClutterActor *parent;
 
-    y = dax_element_rect_get_y_px (element);
-    clutter_actor_set_y (rectangle, y);
+        parent = clutter_actor_get_parent (CLUTTER_ACTOR (target));
+        if (g_object_get_qdata (element, quark_object_actor) == parent)
+            set_actor_transform (parent, element);
+    }
 }
 
-static void
-on_rect_fill_opacity_changed (DaxElementRect *element,
-                              GParamSpec     *pspec,
-                              gpointer        user_data)
+static DaxPath *
+dax_path_new_from_geometry (const ClutterGeometry *geom)
 {
-    ClutterRectangle *rectangle = CLUTTER_RECTANGLE (user_data);
-    ClutterColor fill_color;
-    gfloat fill_opacity;
+    DaxPath *path;
 
-    fill_opacity = dax_element_get_fill_opacity (DAX_ELEMENT (element));
-    clutter_rectangle_get_color (rectangle, &fill_color);
-    fill_color.alpha = fill_opacity * 255;
-    clutter_rectangle_set_color (rectangle, &fill_color);
+    path = dax_path_new ();
+    dax_path_move_to (path, geom->x, geom->y);
+    dax_path_line_to (path, geom->x + geom->width, geom->y);
+    dax_path_line_to (path, geom->x + geom->width, geom->y + geom->height);
+    dax_path_line_to (path, geom->x, geom->y + geom->height);
+    dax_path_close (path);
+
+    return path;
 }
 
 static void
@@ -240,22 +615,13 @@ dax_traverser_clutter_traverse_rect (DaxTraverser   *traverser,
                                      DaxElementRect *node)
 {
     DaxTraverserClutter *build = DAX_TRAVERSER_CLUTTER (traverser);
-    DaxTraverserClutterPrivate *priv = build->priv;
     DaxElement *element = DAX_ELEMENT (node);
     const ClutterColor *fill_color, *stroke_color;
     ClutterActor *rectangle;
     ClutterGeometry geom;
 
-    rectangle = clutter_rectangle_new ();
-
     fill_color = dax_element_get_fill_color (element);
     stroke_color = dax_element_get_stroke_color (element);
-    if (fill_color)
-        clutter_rectangle_set_color (CLUTTER_RECTANGLE (rectangle),
-                                     fill_color);
-    if (stroke_color)
-        clutter_rectangle_set_border_color (CLUTTER_RECTANGLE (rectangle),
-                                            stroke_color);
 
     /* FIXME dax_element_rect_get_geometry() sounds like it could be
      * useful here */
@@ -263,22 +629,36 @@ dax_traverser_clutter_traverse_rect (DaxTraverser   *traverser,
     geom.y = dax_element_rect_get_y_px (node);
     geom.width = dax_element_rect_get_width_px (node);
     geom.height = dax_element_rect_get_height_px (node);
+
+    if (is_static (build, node)) {
+        DaxPath *path = dax_path_new_from_geometry (&geom);
+
+        record_path (build, path, fill_color, stroke_color);
+        g_object_unref (path);
+        return;
+    }
+
+    rectangle = clutter_rectangle_new ();
+    if (fill_color)
+        clutter_rectangle_set_color (CLUTTER_RECTANGLE (rectangle),
+                                     fill_color);
+    if (stroke_color)
+        clutter_rectangle_set_border_color (CLUTTER_RECTANGLE (rectangle),
+                                            stroke_color);
+
     clutter_actor_set_geometry (rectangle, &geom);
 
-    g_signal_connect (node, "notify::fill-opacity",
-                      G_CALLBACK (on_rect_fill_opacity_changed), rectangle);
-    g_signal_connect (node, "notify::x",
-                      G_CALLBACK (on_rect_x_changed), rectangle);
-    g_signal_connect (node, "notify::y",
-                      G_CALLBACK (on_rect_y_changed), rectangle);
+    _dax_binding_new (G_OBJECT (node), G_OBJECT (rectangle), rect_properties,
+                      update_rect);
 
-    clutter_container_add_actor (priv->container, rectangle);
+    add_transformed_actor (build, node, rectangle,
+                           dax_element_rect_get_transform (node));
 }
 
-static ClutterPath2D *
-clutter_path_new_from_knot_sequence (const DaxKnotSequence *seq)
+static DaxPath *
+dax_path_new_from_knot_sequence (const DaxKnotSequence *seq)
 {
-    ClutterPath2D *path;
+    DaxPath *path;
     const float *knots;
     guint nb_knots, i;
 
@@ -287,11 +667,11 @@ clutter_path_new_from_knot_sequence (const DaxKnotSequence *seq)
         return NULL;
     knots = dax_knot_sequence_get_array (seq);
 
-    path = clutter_path_2d_new ();
-    clutter_path_2d_add_move_to (path, knots[0], knots[1]);
+    path = dax_path_new ();
+    dax_path_move_to (path, knots[0], knots[1]);
 
     for (i = 1; i < nb_knots; i++)
-        clutter_path_2d_add_line_to (path, knots[i * 2], knots[i * 2 + 1]);
+        dax_path_line_to (path, knots[i * 2], knots[i * 2 + 1]);
 
     return path;
 }
@@ -301,39 +681,51 @@ dax_traverser_clutter_traverse_polyline (DaxTraverser       *traverser,
                                          DaxElementPolyline *node)
 {
     DaxTraverserClutter *build = DAX_TRAVERSER_CLUTTER (traverser);
-    DaxTraverserClutterPrivate *priv = build->priv;
     DaxElement *element = DAX_ELEMENT (node);
     const ClutterColor *fill_color, *stroke_color;
     ClutterActor *polyline;
     const DaxKnotSequence *seq;
-    ClutterPath2D *path;
-
-    polyline = clutter_shape_new ();
+    DaxPath *path;
 
     g_object_get (G_OBJECT (node), "points", &seq, NULL);
-    path = clutter_path_new_from_knot_sequence (seq);
-    g_object_set (G_OBJECT (polyline), "path", path, NULL);
+    path = dax_path_new_from_knot_sequence (seq);
 
     fill_color = dax_element_get_fill_color (element);
     stroke_color = dax_element_get_stroke_color (element);
+
+    if (is_static (build, node)) {
+        record_path (build, path, fill_color, stroke_color);
+        if (path)
+            g_object_unref (path);
+        return;
+    }
+
+    polyline = dax_shape_new ();
+    g_object_set (G_OBJECT (polyline), "path", path, NULL);
+    if (path)
+        g_object_unref (path);
+
     if (fill_color) {
         g_object_set (polyline, "color", fill_color, NULL);
     }
     if (stroke_color)
         g_object_set (polyline, "border-color", stroke_color, NULL);
 
-    clutter_container_add_actor (priv->container, polyline);
+    set_actor_transform (polyline, G_OBJECT (node));
+    _dax_binding_new (G_OBJECT (node), G_OBJECT (polyline),
+                      transform_properties, update_transform);
+    add_actor (build, node, polyline);
 }
 
-static ClutterPath2D *
+static DaxPath *
 build_circle_path (DaxElementCircle *circle)
 {
-    ClutterPath2D *path;
+    DaxPath *path;
     ClutterUnits *cx_u, *cy_u, *r_u;
     gfloat cx, cy, r;
     static gfloat k = 4 * (G_SQRT2 - 1) / 3;
 
-    /* Build the ClutterPath2D */
+    /* Build the DaxPath */
     cx_u = dax_element_circle_get_cx (circle);
     cy_u = dax_element_circle_get_cy (circle);
     r_u  = dax_element_circle_get_r (circle);
@@ -341,39 +733,56 @@ build_circle_path (DaxElementCircle *circle)
     cy = clutter_units_to_pixels (cy_u);
     r = clutter_units_to_pixels (r_u);
 
-    path = clutter_path_2d_new ();
-
-    clutter_path_2d_add_move_to (path, cx + r, cy);
-    clutter_path_2d_add_curve_to (path,
-                                  cx + r, cy + r * k,
-                                  cx + r * k, cy + r,
-                                  cx, cy + r);
-    clutter_path_2d_add_curve_to (path,
-                                  cx - r * k , cy + r,
-                                  cx - r , cy + r * k,
-                                  cx - r, cy);
-    clutter_path_2d_add_curve_to (path,
-                                  cx - r, cy - r * k,
-                                  cx - r * k, cy - r,
-                                  cx, cy - r);
-    clutter_path_2d_add_curve_to (path,
-                                  cx + r * k, cy - r,
-                                  cx + r, cy - r * k,
-                                  cx + r, cy);
-    clutter_path_2d_add_close (path);
+    path = dax_path_new ();
+
+    dax_path_move_to (path, cx + r, cy);
+    dax_path_curve_to (path,
+                       cx + r, cy + r * k,
+                       cx + r * k, cy + r,
+                       cx, cy + r);
+    dax_path_curve_to (path,
+                       cx - r * k , cy + r,
+                       cx - r , cy + r * k,
+                       cx - r, cy);
+    dax_path_curve_to (path,
+                       cx - r, cy - r * k,
+                       cx - r * k, cy - r,
+                       cx, cy - r);
+    dax_path_curve_to (path,
+                       cx + r * k, cy - r,
+                       cx + r, cy - r * k,
+                       cx + r, cy);
+    dax_path_close (path);
 
     return path;
 }
 
+static const DaxBindingProperty circle_properties[] =
+{
+    { "cx", CHANGED_GEOMETRY },
+    { "cy", CHANGED_GEOMETRY },
+    { "r", CHANGED_GEOMETRY },
+    { "transform", CHANGED_TRANSFORM },
+    { NULL, 0 }
+};
+
+/* the path is built once for all the attributes changed in a frame */
 static void
-on_circle_changed (DaxElementCircle *circle,
-                   GParamSpec       *pspec,
-                   ClutterActor     *target)
+update_circle (GObject *element,
+               GObject *target,
+               guint    changes)
 {
-    ClutterPath2D *path;
+    DaxPath *path;
+
+    if (changes & CHANGED_TRANSFORM)
+        set_actor_transform (CLUTTER_ACTOR (target), element);
 
-    path = build_circle_path (circle);
+    if (!(changes & CHANGED_GEOMETRY))
+        return;
+
+    path = build_circle_path (DAX_ELEMENT_CIRCLE (element));
     g_object_set (target, "path", path, NULL);
+    g_object_unref (path);
 }
 
 static void
@@ -381,30 +790,37 @@ dax_traverser_clutter_traverse_circle (DaxTraverser     *traverser,
                                        DaxElementCircle *node)
 {
     DaxTraverserClutter *build = DAX_TRAVERSER_CLUTTER (traverser);
-    DaxTraverserClutterPrivate *priv = build->priv;
     DaxElement *element = DAX_ELEMENT (node);
     const ClutterColor *fill_color, *stroke_color;
     ClutterActor *circle;
-    ClutterPath2D *path;
+    DaxPath *path;
 
     path = build_circle_path (node);
 
-    circle = clutter_shape_new ();
-    g_object_set (circle, "path", path, NULL);
-
     /* handle fill / stroke colors */
     fill_color = dax_element_get_fill_color (element);
     stroke_color = dax_element_get_stroke_color (element);
+
+    if (is_static (build, node)) {
+        record_path (build, path, fill_color, stroke_color);
+        g_object_unref (path);
+        return;
+    }
+
+    circle = dax_shape_new ();
+    g_object_set (circle, "path", path, NULL);
+    g_object_unref (path);
+
     if (fill_color) {
         g_object_set (circle, "color", fill_color, NULL);
     }
     if (stroke_color)
         g_object_set (circle, "border-color", stroke_color, NULL);
 
-    g_object_set_qdata (G_OBJECT (node), quark_object_actor, circle);
-    g_signal_connect (node, "notify::r",
-                      G_CALLBACK (on_circle_changed), circle);
-    clutter_container_add_actor (priv->container, circle);
+    set_actor_transform (circle, G_OBJECT (node));
+    _dax_binding_new (G_OBJECT (node), G_OBJECT (circle), circle_properties,
+                      update_circle);
+    add_actor (build, node, circle);
 }
 
 static void
@@ -516,6 +932,72 @@ dax_traverser_clutter_traverse_animate (DaxTraverser      *traverser,
     clutter_score_append (priv->score, NULL, tl);
 }
 
+/*
+ * <animateTransform> does not go through a ClutterInterval, which would
+ * allocate a new DaxMatrix for every frame, twice. The transform lists are
+ * interpolated in place and given to the element without boxed copies.
+ */
+
+typedef struct
+{
+    ClutterAnimation *animation;
+    DaxDomElement *target;
+    DaxMatrix from;
+    DaxMatrix to;
+    DaxMatrix current;
+} TransformAnimation;
+
+static void
+transform_animation_free (gpointer  data,
+                          GClosure *closure)
+{
+    g_slice_free (TransformAnimation, data);
+}
+
+static void
+on_transform_animation_new_frame (ClutterTimeline    *timeline,
+                                  gint                msecs,
+                                  TransformAnimation *data)
+{
+    ClutterAlpha *alpha;
+    gdouble progress;
+
+    alpha = clutter_animation_get_alpha (data->animation);
+    progress = clutter_alpha_get_alpha (alpha);
+
+    if (!dax_matrix_interpolate (&data->from, &data->to, progress,
+                                 &data->current))
+    {
+        return;
+    }
+
+    if (DAX_IS_ELEMENT_G (data->target))
+        dax_element_g_set_transform (DAX_ELEMENT_G (data->target),
+                                     &data->current);
+    else if (DAX_IS_ELEMENT_PATH (data->target))
+        dax_element_path_set_transform (DAX_ELEMENT_PATH (data->target),
+                                        &data->current);
+    else
+        g_object_set (data->target, "transform", &data->current, NULL);
+}
+
+static gboolean
+_string_to_matrix (DaxMatrix               *matrix,
+                   DaxAnimateTransformType  type,
+                   const gchar             *values)
+{
+    const gchar *keyword;
+    gchar *string;
+    gboolean res;
+
+    keyword = dax_enum_to_string (DAX_TYPE_ANIMATE_TRANSFORM_TYPE, type);
+    string = g_strdup_printf ("%s(%s)", keyword, values);
+    res = dax_matrix_from_string (matrix, string);
+    g_free (string);
+
+    return res;
+}
+
 static void
 dax_traverser_clutter_traverse_animate_transform (
     DaxTraverser               *traverser,
@@ -530,31 +1012,44 @@ dax_traverser_clutter_traverse_animate_transform (
     DaxAnimateTransformType type;
     ClutterAnimation *animation;
     ClutterTimeline *tl;
+    TransformAnimation *data;
 
     target_element = dax_element_animation_get_target (animation_node);
+    attribute_name = dax_element_animation_get_attribute_name (animation_node);
+    if (g_strcmp0 (attribute_name, "transform") != 0) {
+        g_warning ("Cannot animate %s with <animateTransform>",
+                   attribute_name);
+        return;
+    }
+
+    /* parse the transform lists once */
+    data = g_slice_new (TransformAnimation);
+    type = dax_element_animate_transform_get_matrix_type (node);
+    from = dax_element_animation_get_from (animation_node);
+    to = dax_element_animation_get_to (animation_node);
+    if (!_string_to_matrix (&data->from, type, from) ||
+        !_string_to_matrix (&data->to, type, to))
+    {
+        g_warning ("Invalid <animateTransform> values from %s to %s",
+                   from, to);
+        g_slice_free (TransformAnimation, data);
+        return;
+    }
+
+    DAX_NOTE (ANIMATION, "setting up transform animation on %s going from "
+              "%s to %s", G_OBJECT_TYPE_NAME (target_element), from, to);
+
     animation = _clutter_animation_new_from_dax_animation (animation_node,
                                                            target_element);
+    data->animation = animation;
+    data->target = target_element;
 
-    /* setup the interval */
-    type = dax_element_animate_transform_get_matrix_type (node);
-    attribute_name = dax_element_animation_get_attribute_name (animation_node);
-    from =
-        g_strdup_printf("%s(%s)",
-                        dax_enum_to_string (DAX_TYPE_ANIMATE_TRANSFORM_TYPE,
-                                            type),
-                        dax_element_animation_get_from (animation_node));
-    to =
-        g_strdup_printf("%s(%s)",
-                        dax_enum_to_string (DAX_TYPE_ANIMATE_TRANSFORM_TYPE,
-                                            type),
-                        dax_element_animation_get_to (animation_node));
-    _animation_setup_property (animation,
-                               target_element,
-                               attribute_name,
-                               from, to);
+    tl = clutter_animation_get_timeline (animation);
+    g_signal_connect_data (tl, "new-frame",
+                           G_CALLBACK (on_transform_animation_new_frame),
+                           data, transform_animation_free, 0);
 
     /* Add the timeline to the global score */
-    tl = clutter_animation_get_timeline (animation);
     clutter_score_append (priv->score, NULL, tl);
 }
 
@@ -653,12 +1148,12 @@ dax_traverser_clutter_traverse_handler (DaxTraverser      *traverser,
     }
 }
 
-static ClutterPath2D *
-clutter_path_new_from_line (DaxElementLine *line)
+static DaxPath *
+dax_path_new_from_line (DaxElementLine *line)
 {
     ClutterUnits *x1_u, *y1_u, *x2_u, *y2_u;
     gfloat x1, y1, x2, y2;
-    ClutterPath2D *path;
+    DaxPath *path;
 
     x1_u = dax_element_line_get_x1 (line);
     y1_u = dax_element_line_get_y1 (line);
@@ -670,9 +1165,9 @@ clutter_path_new_from_line (DaxElementLine *line)
     x2 = clutter_units_to_pixels (x2_u);
     y2 = clutter_units_to_pixels (y2_u);
 
-    path = clutter_path_2d_new ();
-    clutter_path_2d_add_move_to (path, x1, y1);
-    clutter_path_2d_add_line_to (path, x2, y2);
+    path = dax_path_new ();
+    dax_path_move_to (path, x1, y1);
+    dax_path_line_to (path, x2, y2);
 
     return path;
 }
@@ -682,21 +1177,31 @@ dax_traverser_clutter_traverse_line (DaxTraverser   *traverser,
                                      DaxElementLine *node)
 {
     DaxTraverserClutter *build = DAX_TRAVERSER_CLUTTER (traverser);
-    DaxTraverserClutterPrivate *priv = build->priv;
     DaxElement *element = DAX_ELEMENT (node);
     const ClutterColor *stroke_color;
     ClutterActor *line;
-    ClutterPath2D *path;
+    DaxPath *path;
+
+    path = dax_path_new_from_line (node);
+    stroke_color = dax_element_get_stroke_color (element);
+
+    if (is_static (build, node)) {
+        record_path (build, path, NULL, stroke_color);
+        g_object_unref (path);
+        return;
+    }
 
-    line = clutter_shape_new ();
-    path = clutter_path_new_from_line (node);
+    line = dax_shape_new ();
     g_object_set (G_OBJECT (line), "path", path, NULL);
+    g_object_unref (path);
 
-    stroke_color = dax_element_get_stroke_color (element);
     if (stroke_color)
         g_object_set (line, "border-color", stroke_color, NULL);
 
-    clutter_container_add_actor (priv->container, line);
+    set_actor_transform (line, G_OBJECT (node));
+    _dax_binding_new (G_OBJECT (node), G_OBJECT (line), transform_properties,
+                      update_transform);
+    add_actor (build, node, line);
 }
 
 static ClutterActor *
@@ -755,12 +1260,47 @@ dax_traverser_clutter_traverse_text (DaxTraverser   *traverser,
                                      DaxElementText *node)
 {
     DaxTraverserClutter *build = DAX_TRAVERSER_CLUTTER (traverser);
-    DaxTraverserClutterPrivate *priv = build->priv;
-    ClutterActor *text;
+    ClutterActor *text, *actor;
 
     text = clutter_text_new_from_dax_text (node);
 
-    clutter_container_add_actor (priv->container, text);
+    actor = add_transformed_actor (build, node, text,
+                                   dax_element_text_get_transform (node));
+    if (actor != text)
+        _dax_binding_new (G_OBJECT (node), G_OBJECT (actor),
+                          transform_properties, update_transform);
+}
+
+static void
+set_texture_from_dax_image (ClutterTexture  *texture,
+                            DaxElementImage *image)
+{
+    DaxCacheEntry *entry;
+    GdkPixbuf *pixbuf;
+    GError *error = NULL;
+
+    entry = (DaxCacheEntry *) dax_element_image_get_cache_entry (image);
+    pixbuf = dax_cache_entry_get_pixbuf (entry);
+    if (pixbuf == NULL)
+        return;
+
+    if (!clutter_texture_set_from_rgb_data (texture,
+                                            gdk_pixbuf_get_pixels (pixbuf),
+                                            gdk_pixbuf_get_has_alpha (pixbuf),
+                                            gdk_pixbuf_get_width (pixbuf),
+                                            gdk_pixbuf_get_height (pixbuf),
+                                            gdk_pixbuf_get_rowstride (pixbuf),
+                                            gdk_pixbuf_get_n_channels (pixbuf),
+                                            CLUTTER_TEXTURE_NONE,
+                                            &error))
+    {
+        g_warning (G_STRLOC ": could not upload %s: %s",
+                   dax_cache_entry_get_uri (entry), error->message);
+        g_clear_error (&error);
+        return;
+    }
+
+    clutter_actor_show (CLUTTER_ACTOR (texture));
 }
 
 static ClutterActor *
@@ -769,8 +1309,6 @@ clutter_texture_new_from_dax_image (DaxElementImage *image)
     ClutterActor *actor;
     ClutterUnits *x_u, *y_u, *width_u, *height_u;
     gfloat x, y, width, height;
-    const DaxCacheEntry *entry;
-    gchar *path;
 
     x_u = dax_element_image_get_x (image);
     y_u = dax_element_image_get_y (image);
@@ -782,13 +1320,9 @@ clutter_texture_new_from_dax_image (DaxElementImage *image)
     width = clutter_units_to_pixels (width_u);
     height = clutter_units_to_pixels (height_u);
 
-    entry = dax_element_image_get_cache_entry (image);
-    path = dax_cache_entry_get_local_path (entry);
-
-    /* FIXME: should be async */
-    actor = clutter_texture_new_from_file (path, NULL);
+    actor = clutter_texture_new ();
     clutter_actor_set_x (actor, x);
-    clutter_actor_set_y (actor, x);
+    clutter_actor_set_y (actor, y);
     clutter_actor_set_width (actor, width);
     clutter_actor_set_height (actor, height);
 
@@ -796,18 +1330,14 @@ clutter_texture_new_from_dax_image (DaxElementImage *image)
 }
 
 static void
-on_image_loaded (DaxElementImage     *image,
-                 gboolean             loaded,
-                 DaxTraverserClutter *traverver)
+on_image_loaded (DaxElementImage *image,
+                 gboolean         loaded,
+                 ClutterTexture  *texture)
 {
-    DaxTraverserClutterPrivate *priv = traverver->priv;
-    ClutterActor *actor;
-
     if (loaded == FALSE)
         return;
 
-    actor = clutter_texture_new_from_dax_image (image);
-    clutter_container_add_actor (priv->container, actor);
+    set_texture_from_dax_image (texture, image);
 }
 
 static void
@@ -815,10 +1345,26 @@ dax_traverser_clutter_traverse_image (DaxTraverser    *traverser,
                                       DaxElementImage *node)
 {
     DaxTraverserClutter *build = DAX_TRAVERSER_CLUTTER (traverser);
+    ClutterActor *actor, *bound;
+
+    /* The actor takes the place of the image in the scene right away, the
+     * pixels are decoded in the background and uploaded once the image
+     * element is loaded. This way, images don't delay the first frame */
+    actor = clutter_texture_new_from_dax_image (node);
+    bound = add_transformed_actor (build, node, actor,
+                                   dax_element_image_get_transform (node));
+    if (bound != actor)
+        _dax_binding_new (G_OBJECT (node), G_OBJECT (bound),
+                          transform_properties, update_transform);
+
+    if (dax_dom_element_is_loaded (DAX_DOM_ELEMENT (node))) {
+        set_texture_from_dax_image (CLUTTER_TEXTURE (actor), node);
+        return;
+    }
 
-    if (dax_dom_element_is_loaded (DAX_DOM_ELEMENT (node)))
-        on_image_loaded (node, TRUE, build);
-    g_signal_connect (node, "loaded", G_CALLBACK (on_image_loaded), build);
+    clutter_actor_hide (actor);
+    g_signal_connect_object (node, "loaded",
+                             G_CALLBACK (on_image_loaded), actor, 0);
 }
 
 
@@ -853,7 +1399,173 @@ dax_traverser_clutter_traverse_video (DaxTraverser    *traverser,
     clutter_media_set_uri (CLUTTER_MEDIA (video), uri);
     g_ptr_array_add (priv->media, video);
 
-    clutter_container_add_actor (priv->container, video);
+    add_actor (build, node, video);
+}
+
+/*
+ * DOM mutations
+ *
+ * Once the scene graph is built, the traverser follows the mutations of the
+ * document and only builds or destroys the actors of the nodes that were
+ * inserted or removed.
+ */
+
+static ClutterActor *
+get_actor (DaxDomNode *node)
+{
+    return g_object_get_qdata (G_OBJECT (node), quark_object_actor);
+}
+
+/* The container in which the actors of the children of parent live, NULL
+ * if the children of parent are not displayed */
+static ClutterContainer *
+get_children_container (DaxTraverserClutter *self,
+                        DaxDomNode          *parent)
+{
+    ClutterActor *actor;
+
+    if (DAX_IS_ELEMENT_SVG (parent))
+        return self->priv->root_container;
+
+    actor = get_actor (parent);
+    if (actor == NULL)
+        return NULL;
+    if (CLUTTER_IS_CONTAINER (actor))
+        return CLUTTER_CONTAINER (actor);
+
+    /* eg. an <animate> added to a shape */
+    return CLUTTER_CONTAINER (clutter_actor_get_parent (actor));
+}
+
+/* Keep the stacking order of the actors in the order of the document */
+static void
+restack_actor (ClutterContainer *container,
+               DaxDomNode       *node)
+{
+    ClutterActor *actor, *sibling_actor, *parent;
+    DaxDomNode *sibling;
+
+    actor = get_actor (node);
+    if (actor == NULL)
+        return;
+
+    parent = CLUTTER_ACTOR (container);
+    for (sibling = node->next_sibling; sibling; sibling = sibling->next_sibling)
+    {
+        sibling_actor = get_actor (sibling);
+        if (sibling_actor && clutter_actor_get_parent (sibling_actor) == parent)
+        {
+            clutter_container_lower_child (container, actor, sibling_actor);
+            return;
+        }
+    }
+}
+
+static void
+build_subtree (DaxTraverserClutter *self,
+               DaxDomNode          *node,
+               ClutterContainer    *container)
+{
+    DaxTraverser *traverser = DAX_TRAVERSER (self);
+
+    DAX_NOTE (TRAVERSER, "Building actors for %s", G_OBJECT_TYPE_NAME (node));
+
+    set_container_internal (self, container);
+    dax_traverser_set_root (traverser, node);
+    dax_traverser_apply (traverser);
+    dax_traverser_set_root (traverser, NULL);
+
+    restack_actor (container, node);
+}
+
+/* The actors of a subtree are destroyed with the actor of its root, forget
+ * about all of them */
+static void
+forget_actors (DaxTraverserClutter *self,
+               DaxDomNode          *root)
+{
+    DaxTraverserClutterPrivate *priv = self->priv;
+    DaxDomNode *node = root;
+
+    while (node) {
+        ClutterActor *actor = get_actor (node);
+
+        if (actor) {
+            g_ptr_array_remove (priv->media, actor);
+            g_object_set_qdata (G_OBJECT (node), quark_object_actor, NULL);
+            g_object_set_qdata (G_OBJECT (actor), quark_actor_element, NULL);
+        }
+
+        if (node->first_child) {
+            node = node->first_child;
+            continue;
+        }
+        while (node != root && node->next_sibling == NULL)
+            node = node->parent_node;
+        node = node == root ? NULL : node->next_sibling;
+    }
+}
+
+static void
+destroy_subtree (DaxTraverserClutter *self,
+                 DaxDomNode          *node)
+{
+    ClutterActor *actor = get_actor (node);
+
+    forget_actors (self, node);
+    if (actor)
+        clutter_actor_destroy (actor);
+}
+
+/* The actor of a <text> is built from its text children, a change of the
+ * children means a new actor */
+static void
+rebuild_element (DaxTraverserClutter *self,
+                 DaxDomNode          *element)
+{
+    ClutterActor *actor = get_actor (element);
+    ClutterContainer *container;
+
+    if (actor == NULL)
+        return;
+
+    container = CLUTTER_CONTAINER (clutter_actor_get_parent (actor));
+    destroy_subtree (self, element);
+    build_subtree (self, element, container);
+}
+
+static void
+on_node_inserted (DaxDomDocument      *document,
+                  DaxDomNode          *node,
+                  DaxTraverserClutter *self)
+{
+    DaxDomNode *parent = node->parent_node;
+    ClutterContainer *container;
+
+    if (DAX_IS_ELEMENT_TEXT (parent)) {
+        rebuild_element (self, parent);
+        return;
+    }
+
+    container = get_children_container (self, parent);
+    if (container)
+        build_subtree (self, node, container);
+}
+
+static void
+on_node_removed (DaxDomDocument      *document,
+                 DaxDomNode          *node,
+                 DaxDomNode          *former_parent,
+                 DaxTraverserClutter *self)
+{
+    if (DAX_IS_ELEMENT_TEXT (former_parent)) {
+        rebuild_element (self, former_parent);
+        return;
+    }
+
+    DAX_NOTE (TRAVERSER, "Destroying actors of %s", G_OBJECT_TYPE_NAME (node));
+
+    destroy_subtree (self, node);
 }
 
 /*
@@ -920,6 +1632,9 @@ dax_traverser_clutter_finalize (GObject *object)
     DaxTraverserClutterPrivate *priv = self->priv;
 
     g_object_unref (priv->score);
+    if (priv->dynamic)
+        g_hash_table_destroy (priv->dynamic);
+    g_array_free (priv->base_ctm, TRUE);
 
     G_OBJECT_CLASS (dax_traverser_clutter_parent_class)->finalize (object);
 }
@@ -932,6 +1647,7 @@ dax_traverser_clutter_class_init (DaxTraverserClutterClass *klass)
     GParamSpec *pspec;
 
     quark_object_actor = g_quark_from_static_string ("dax-clutter-actor");
+    quark_actor_element = g_quark_from_static_string ("dax-actor-element");
 
     g_type_class_add_private (klass, sizeof (DaxTraverserClutterPrivate));
 
@@ -940,6 +1656,7 @@ dax_traverser_clutter_class_init (DaxTraverserClutterClass *klass)
     object_class->dispose = dax_traverser_clutter_dispose;
     object_class->finalize = dax_traverser_clutter_finalize;
 
+    traverser_class->traverse_svg = dax_traverser_clutter_traverse_svg;
     traverser_class->traverse_g = dax_traverser_clutter_traverse_g;
     traverser_class->traverse_path = dax_traverser_clutter_traverse_path;
     traverser_class->traverse_rect = dax_traverser_clutter_traverse_rect;
@@ -972,6 +1689,7 @@ dax_traverser_clutter_init (DaxTraverserClutter *self)
 
     priv->score = clutter_score_new ();
     priv->media = g_ptr_array_new ();
+    priv->base_ctm = g_array_new (FALSE, FALSE, sizeof (BaseCtm));
 }
 
 DaxTraverser *
@@ -999,3 +1717,96 @@ dax_traverser_clutter_get_media (DaxTraverserClutter *self)
 
     return self->priv->media;
 }
+
+/**
+ * dax_traverser_clutter_follow_mutations:
+ * @self: a #DaxTraverserClutter that has been applied to @document
+ * @document: the #DaxDomDocument the scene graph has been built from
+ *
+ * Keeps the scene graph built by @self in sync with @document. When a node
+ * is inserted in or removed from the document, only the actors of that node
+ * are built or destroyed instead of the whole scene graph. Changes of the
+ * attributes are already applied to the actors they were built for.
+ */
+void
+dax_traverser_clutter_follow_mutations (DaxTraverserClutter *self,
+                                        DaxDomDocument      *document)
+{
+    DaxTraverserClutterPrivate *priv;
+
+    g_return_if_fail (DAX_IS_TRAVERSER_CLUTTER (self));
+    g_return_if_fail (DAX_IS_DOM_DOCUMENT (document));
+
+    priv = self->priv;
+
+    /* the traverser is back to the container it was given */
+    priv->root_container = priv->container;
+
+    g_signal_connect_object (document, "node-inserted",
+                             G_CALLBACK (on_node_inserted), self, 0);
+    g_signal_connect_object (document, "node-removed",
+                             G_CALLBACK (on_node_removed), self, 0);
+}
+
+/**
+ * dax_traverser_clutter_set_use_display_list:
+ * @self: a #DaxTraverserClutter
+ * @use_list: whether to draw the static parts of the document with display
+ *   lists
+ *
+ * When @use_list is %TRUE, the elements that can't change once
+ * displayed are not given an actor each but are drawn by #DaxDisplayList
+ * actors, far fewer actors to lay out, pick and paint for each frame. The
+ * elements that are animated, watched by event handlers or that can be
+ * reached by scripts keep their actors.
+ *
+ * The elements are sorted out when traversing the &lt;svg&gt; element, the
+ * traverser has to be applied to the whole document. The scene graph built
+ * this way can't follow the mutations of the document.
+ */
+void
+dax_traverser_clutter_set_use_display_list (DaxTraverserClutter *self,
+                                            gboolean             use_list)
+{
+    g_return_if_fail (DAX_IS_TRAVERSER_CLUTTER (self));
+
+    self->priv->use_display_list = use_list;
+}
+
+/**
+ * dax_traverser_clutter_set_group_cache_mode:
+ * @self: a #DaxTraverserClutter
+ * @mode: the #DaxGroupCacheMode of the groups built from now on
+ *
+ * Sets the cache mode of the #DaxGroup built for the &lt;g&gt; elements,
+ * see dax_group_set_cache_mode().
+ */
+void
+dax_traverser_clutter_set_group_cache_mode (DaxTraverserClutter *self,
+                                            DaxGroupCacheMode    mode)
+{
+    g_return_if_fail (DAX_IS_TRAVERSER_CLUTTER (self));
+
+    self->priv->group_cache_mode = mode;
+}
+
+/**
+ * dax_traverser_clutter_get_element:
+ * @actor: a #ClutterActor
+ *
+ * Retrieves the element @actor was built for by a #DaxTraverserClutter.
+ *
+ * Return value: (transfer none): the element displayed by @actor, %NULL if
+ * @actor was not built by a traverser
+ */
+DaxDomElement *
+dax_traverser_clutter_get_element (ClutterActor *actor)
+{
+    g_return_val_if_fail (CLUTTER_IS_ACTOR (actor), NULL);
+
+    /* no traverser has been created yet */
+    if (quark_actor_element == 0)
+        return NULL;
+
+    return g_object_get_qdata (G_OBJECT (actor), quark_actor_element);
+}
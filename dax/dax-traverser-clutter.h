@@ -26,6 +26,7 @@
 #include <glib-object.h>
 #include <clutter/clutter.h>
 
+#include "dax-group.h"
 #include "dax-traverser.h"
 
 G_BEGIN_DECLS
@@ -76,6 +77,15 @@ DaxTraverser *  dax_traverser_clutter_new           (DaxDomNode       *root,
 ClutterScore *  dax_traverser_clutter_get_score     (DaxTraverserClutter *self);
 GPtrArray *     dax_traverser_clutter_get_media     (DaxTraverserClutter *self);
 
+void            dax_traverser_clutter_follow_mutations  (DaxTraverserClutter *self,
+                                                         DaxDomDocument      *document);
+void            dax_traverser_clutter_set_use_display_list  (DaxTraverserClutter *self,
+                                                             gboolean             use_list);
+void            dax_traverser_clutter_set_group_cache_mode  (DaxTraverserClutter *self,
+                                                             DaxGroupCacheMode    mode);
+
+DaxDomElement * dax_traverser_clutter_get_element   (ClutterActor *actor);
+
 G_END_DECLS
 
 #endif /* __DAX_TRAVERSER_CLUTTER_H__ */
@@ -0,0 +1,796 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <pango/pangoft2.h>
+
+#include "dax-dom.h"
+
+#include "dax-affine.h"
+#include "dax-debug.h"
+#include "dax-internals.h"
+#include "dax-knot-sequence.h"
+#include "dax-rasterizer.h"
+
+#include "dax-traverser-raster.h"
+
+G_DEFINE_TYPE (DaxTraverserRaster, dax_traverser_raster, DAX_TYPE_TRAVERSER)
+
+#define TRAVERSER_RASTER_PRIVATE(o)                                 \
+        (G_TYPE_INSTANCE_GET_PRIVATE ((o),                          \
+                                      DAX_TYPE_TRAVERSER_RASTER,    \
+                                      DaxTraverserRasterPrivate))
+
+/* <line> and strokes have no width attribute yet */
+#define DEFAULT_STROKE_WIDTH    1.0f
+#define DEFAULT_FONT            "Sans 12"
+
+enum
+{
+    PROP_0,
+
+    PROP_WIDTH,
+    PROP_HEIGHT
+};
+
+struct _DaxTraverserRasterPrivate
+{
+    guint width, height;
+    DaxRasterizerSurface surface;
+    guint32 background;             /* premultiplied ARGB, see clear() */
+
+    /* user space of the root element to device space (viewBox) */
+    double viewport[6];
+
+    DaxRasterizer *rasterizer;
+
+    PangoFontMap *font_map;
+    PangoContext *pango_context;
+};
+
+static const ClutterColor default_text_color = { 0x00, 0x00, 0x00, 0xff };
+
+static void
+fill_surface (DaxTraverserRaster *raster)
+{
+    DaxTraverserRasterPrivate *priv = raster->priv;
+    guint i, n_pixels;
+
+    n_pixels = priv->surface.stride * priv->surface.height;
+    for (i = 0; i < n_pixels; i++)
+        priv->surface.pixels[i] = priv->background;
+}
+
+/* The surface is allocated once its size is known, that is when the <svg>
+ * element is traversed if no size was given */
+static void
+ensure_surface (DaxTraverserRaster *raster)
+{
+    DaxTraverserRasterPrivate *priv = raster->priv;
+
+    if (priv->surface.pixels)
+        return;
+
+    priv->surface.width = priv->width;
+    priv->surface.height = priv->height;
+    priv->surface.stride = priv->width;
+    priv->surface.pixels = g_new0 (guint32, priv->width * priv->height);
+    if (priv->background)
+        fill_surface (raster);
+}
+
+/* the current transformation from user space to device pixels */
+static void
+get_device_matrix (DaxTraverserRaster *raster,
+                   double              affine[6])
+{
+    DaxTraverserRasterPrivate *priv = raster->priv;
+    const DaxMatrix *ctm;
+
+    ctm = dax_traverser_get_ctm (DAX_TRAVERSER (raster));
+    _dax_affine_multiply (affine, ctm->affine, priv->viewport);
+}
+
+static DaxRasterizer *
+begin_path (DaxTraverserRaster *raster)
+{
+    DaxTraverserRasterPrivate *priv = raster->priv;
+    double affine[6];
+
+    ensure_surface (raster);
+
+    get_device_matrix (raster, affine);
+    _dax_rasterizer_reset (priv->rasterizer);
+    _dax_rasterizer_set_transform (priv->rasterizer, affine);
+
+    return priv->rasterizer;
+}
+
+static void
+paint_path (DaxTraverserRaster *raster,
+            DaxElement         *element,
+            gboolean            fill)
+{
+    DaxTraverserRasterPrivate *priv = raster->priv;
+    const ClutterColor *fill_color, *stroke_color;
+
+    fill_color = dax_element_get_fill_color (element);
+    stroke_color = dax_element_get_stroke_color (element);
+
+    if (fill && fill_color)
+        _dax_rasterizer_fill (priv->rasterizer,
+                              &priv->surface,
+                              fill_color,
+                              dax_element_get_fill_opacity (element),
+                              DAX_RASTERIZER_FILL_NONZERO);
+
+    if (stroke_color)
+        _dax_rasterizer_stroke (priv->rasterizer,
+                                &priv->surface,
+                                stroke_color,
+                                1.0f,
+                                DEFAULT_STROKE_WIDTH);
+}
+
+/*
+ * DaxTraverser implementation
+ */
+
+static void
+dax_traverser_raster_traverse_svg (DaxTraverser  *traverser,
+                                   DaxElementSvg *node)
+{
+    DaxTraverserRaster *raster = DAX_TRAVERSER_RASTER (traverser);
+    DaxTraverserRasterPrivate *priv = raster->priv;
+    ClutterUnits *width_u, *height_u;
+    gfloat width = 0.f, height = 0.f;
+    GArray *viewbox;
+    double scale[6];
+
+    width_u = dax_element_svg_get_width (node);
+    height_u = dax_element_svg_get_height (node);
+    if (width_u)
+        width = clutter_units_to_pixels (width_u);
+    if (height_u)
+        height = clutter_units_to_pixels (height_u);
+
+    /* if no size was given, use the size of the document */
+    if (priv->surface.pixels == NULL) {
+        if (priv->width == 0)
+            priv->width = width > 0 ? (guint) (width + 0.5f) : 0;
+        if (priv->height == 0)
+            priv->height = height > 0 ? (guint) (height + 0.5f) : 0;
+        ensure_surface (raster);
+    }
+
+    _dax_affine_identity (priv->viewport);
+
+    g_object_get (node, "viewBox", &viewbox, NULL);
+    if (viewbox && viewbox->len == 4) {
+        float vb_x, vb_y, vb_width, vb_height;
+        double translate[6];
+
+        vb_x = g_array_index (viewbox, float, 0);
+        vb_y = g_array_index (viewbox, float, 1);
+        vb_width = g_array_index (viewbox, float, 2);
+        vb_height = g_array_index (viewbox, float, 3);
+
+        if (vb_width > 0 && vb_height > 0) {
+            _dax_affine_translate (translate, -vb_x, -vb_y);
+            _dax_affine_scale (scale,
+                               priv->width / vb_width,
+                               priv->height / vb_height);
+            _dax_affine_multiply (priv->viewport, translate, scale);
+        }
+    } else if (width > 0 && height > 0) {
+        _dax_affine_scale (priv->viewport,
+                           priv->width / width,
+                           priv->height / height);
+    }
+
+    DAX_NOTE (TRANSFORM, "rasterizing into a %ux%u buffer, viewport "
+              "scale %.02fx%.02f translate %.02f,%.02f",
+              priv->width, priv->height,
+              priv->viewport[0], priv->viewport[3],
+              priv->viewport[4], priv->viewport[5]);
+}
+
+static void
+dax_traverser_raster_traverse_path (DaxTraverser   *traverser,
+                                    DaxElementPath *node)
+{
+    DaxTraverserRaster *raster = DAX_TRAVERSER_RASTER (traverser);
+    DaxRasterizer *rasterizer;
+    DaxPath *path;
+
+    rasterizer = begin_path (raster);
+
+    path = dax_element_path_get_path (node);
+    _dax_rasterizer_add_path (rasterizer, path);
+    g_object_unref (path);
+
+    paint_path (raster, DAX_ELEMENT (node), TRUE);
+}
+
+static void
+dax_traverser_raster_traverse_rect (DaxTraverser   *traverser,
+                                    DaxElementRect *node)
+{
+    DaxTraverserRaster *raster = DAX_TRAVERSER_RASTER (traverser);
+    DaxRasterizer *rasterizer;
+    gfloat x, y, width, height;
+
+    x = dax_element_rect_get_x_px (node);
+    y = dax_element_rect_get_y_px (node);
+    width = dax_element_rect_get_width_px (node);
+    height = dax_element_rect_get_height_px (node);
+    if (width <= 0 || height <= 0)
+        return;
+
+    rasterizer = begin_path (raster);
+    _dax_rasterizer_move_to (rasterizer, x, y);
+    _dax_rasterizer_line_to (rasterizer, x + width, y);
+    _dax_rasterizer_line_to (rasterizer, x + width, y + height);
+    _dax_rasterizer_line_to (rasterizer, x, y + height);
+    _dax_rasterizer_close (rasterizer);
+
+    paint_path (raster, DAX_ELEMENT (node), TRUE);
+}
+
+static void
+dax_traverser_raster_traverse_polyline (DaxTraverser       *traverser,
+                                        DaxElementPolyline *node)
+{
+    DaxTraverserRaster *raster = DAX_TRAVERSER_RASTER (traverser);
+    DaxRasterizer *rasterizer;
+    DaxKnotSequence *seq;
+    const float *knots;
+    guint nb_knots, i;
+
+    g_object_get (node, "points", &seq, NULL);
+    if (seq == NULL)
+        return;
+
+    nb_knots = dax_knot_sequence_get_size (seq);
+    if (nb_knots == 0) {
+        g_object_unref (seq);
+        return;
+    }
+    knots = dax_knot_sequence_get_array (seq);
+
+    rasterizer = begin_path (raster);
+    _dax_rasterizer_move_to (rasterizer, knots[0], knots[1]);
+    for (i = 1; i < nb_knots; i++)
+        _dax_rasterizer_line_to (rasterizer, knots[i * 2], knots[i * 2 + 1]);
+
+    paint_path (raster, DAX_ELEMENT (node), TRUE);
+
+    g_object_unref (seq);
+}
+
+static void
+dax_traverser_raster_traverse_circle (DaxTraverser     *traverser,
+                                      DaxElementCircle *node)
+{
+    DaxTraverserRaster *raster = DAX_TRAVERSER_RASTER (traverser);
+    DaxRasterizer *rasterizer;
+    gfloat cx, cy, r;
+    static gfloat k = 4 * (G_SQRT2 - 1) / 3;
+
+    cx = clutter_units_to_pixels (dax_element_circle_get_cx (node));
+    cy = clutter_units_to_pixels (dax_element_circle_get_cy (node));
+    r = clutter_units_to_pixels (dax_element_circle_get_r (node));
+    if (r <= 0)
+        return;
+
+    rasterizer = begin_path (raster);
+    _dax_rasterizer_move_to (rasterizer, cx + r, cy);
+    _dax_rasterizer_curve_to (rasterizer,
+                              cx + r, cy + r * k,
+                              cx + r * k, cy + r,
+                              cx, cy + r);
+    _dax_rasterizer_curve_to (rasterizer,
+                              cx - r * k, cy + r,
+                              cx - r, cy + r * k,
+                              cx - r, cy);
+    _dax_rasterizer_curve_to (rasterizer,
+                              cx - r, cy - r * k,
+                              cx - r * k, cy - r,
+                              cx, cy - r);
+    _dax_rasterizer_curve_to (rasterizer,
+                              cx + r * k, cy - r,
+                              cx + r, cy - r * k,
+                              cx + r, cy);
+    _dax_rasterizer_close (rasterizer);
+
+    paint_path (raster, DAX_ELEMENT (node), TRUE);
+}
+
+static void
+dax_traverser_raster_traverse_line (DaxTraverser   *traverser,
+                                    DaxElementLine *node)
+{
+    DaxTraverserRaster *raster = DAX_TRAVERSER_RASTER (traverser);
+    DaxRasterizer *rasterizer;
+    gfloat x1, y1, x2, y2;
+
+    x1 = clutter_units_to_pixels (dax_element_line_get_x1 (node));
+    y1 = clutter_units_to_pixels (dax_element_line_get_y1 (node));
+    x2 = clutter_units_to_pixels (dax_element_line_get_x2 (node));
+    y2 = clutter_units_to_pixels (dax_element_line_get_y2 (node));
+
+    rasterizer = begin_path (raster);
+    _dax_rasterizer_move_to (rasterizer, x1, y1);
+    _dax_rasterizer_line_to (rasterizer, x2, y2);
+
+    /* lines are never filled */
+    paint_path (raster, DAX_ELEMENT (node), FALSE);
+}
+
+static PangoLayout *
+pango_layout_new_from_dax_text (DaxTraverserRaster *raster,
+                                DaxElementText     *text,
+                                double              scale)
+{
+    DaxTraverserRasterPrivate *priv = raster->priv;
+    PangoFontDescription *desc;
+    PangoLayout *layout;
+    gchar *flatten_text, *font_family, *font_size;
+    GString *font_name;
+
+    if (priv->font_map == NULL) {
+        priv->font_map = pango_ft2_font_map_new ();
+        pango_ft2_font_map_set_resolution (PANGO_FT2_FONT_MAP (priv->font_map),
+                                           96, 96);
+        priv->pango_context = pango_font_map_create_context (priv->font_map);
+    }
+
+    /* font name. FIXME: inherit the properties */
+    g_object_get (text,
+                  "font-family", &font_family,
+                  "font-size", &font_size,
+                  NULL);
+    font_name = g_string_new (DEFAULT_FONT);
+    if (font_family || font_size)
+        g_string_truncate (font_name, 0);
+    if (font_family)
+        g_string_append (font_name, font_family);
+    if (font_size) {
+        g_string_append_c (font_name, ' ');
+        g_string_append (font_name, font_size);
+    }
+    g_free (font_family);
+    g_free (font_size);
+
+    desc = pango_font_description_from_string (font_name->str);
+    if (pango_font_description_get_size (desc) == 0)
+        pango_font_description_set_size (desc, 12 * PANGO_SCALE);
+    pango_font_description_set_size (desc,
+                                     pango_font_description_get_size (desc) *
+                                     scale);
+    g_string_free (font_name, TRUE);
+
+    flatten_text = dax_element_text_get_text (text);
+
+    layout = pango_layout_new (priv->pango_context);
+    pango_layout_set_font_description (layout, desc);
+    pango_layout_set_text (layout, flatten_text, -1);
+
+    pango_font_description_free (desc);
+    g_free (flatten_text);
+
+    return layout;
+}
+
+static void
+dax_traverser_raster_traverse_text (DaxTraverser   *traverser,
+                                    DaxElementText *node)
+{
+    DaxTraverserRaster *raster = DAX_TRAVERSER_RASTER (traverser);
+    DaxTraverserRasterPrivate *priv = raster->priv;
+    const ClutterColor *color;
+    PangoRectangle logical;
+    PangoLayout *layout;
+    FT_Bitmap bitmap;
+    GArray *xs, *ys;
+    double affine[6];
+    gfloat x = 0.f, y = 0.f, dx, dy;
+    gint baseline;
+
+    ensure_surface (raster);
+
+    xs = dax_element_text_get_x (node);
+    ys = dax_element_text_get_y (node);
+    if (xs && xs->len)
+        x = clutter_units_to_pixels (&g_array_index (xs, ClutterUnits, 0));
+    if (ys && ys->len)
+        y = clutter_units_to_pixels (&g_array_index (ys, ClutterUnits, 0));
+
+    /* Glyphs are rendered axis aligned, only the origin and the scale of the
+     * CTM are taken into account */
+    get_device_matrix (raster, affine);
+    dx = affine[0] * x + affine[2] * y + affine[4];
+    dy = affine[1] * x + affine[3] * y + affine[5];
+
+    layout = pango_layout_new_from_dax_text (raster, node,
+                                             _dax_affine_expansion (affine));
+    pango_layout_get_pixel_extents (layout, NULL, &logical);
+    baseline = pango_layout_get_baseline (layout) / PANGO_SCALE;
+
+    if (logical.width <= 0 || logical.height <= 0) {
+        g_object_unref (layout);
+        return;
+    }
+
+    bitmap.rows = logical.height;
+    bitmap.width = logical.width;
+    bitmap.pitch = (logical.width + 3) & ~3;
+    bitmap.buffer = g_malloc0 (bitmap.pitch * bitmap.rows);
+    bitmap.num_grays = 256;
+    bitmap.pixel_mode = FT_PIXEL_MODE_GRAY;
+
+    pango_ft2_render_layout (&bitmap, layout, -logical.x, -logical.y);
+
+    color = dax_element_get_fill_color (DAX_ELEMENT (node));
+    if (color == NULL)
+        color = &default_text_color;
+
+    /* SVG text is position relatively to its baseline */
+    _dax_rasterizer_composite_a8 (&priv->surface,
+                                  bitmap.buffer,
+                                  bitmap.pitch,
+                                  (gint) (dx + 0.5f) + logical.x,
+                                  (gint) (dy + 0.5f) - baseline + logical.y,
+                                  bitmap.width,
+                                  bitmap.rows,
+                                  color,
+                                  dax_element_get_fill_opacity (DAX_ELEMENT (node)));
+
+    g_free (bitmap.buffer);
+    g_object_unref (layout);
+}
+
+static void
+dax_traverser_raster_traverse_image (DaxTraverser    *traverser,
+                                     DaxElementImage *node)
+{
+    DaxTraverserRaster *raster = DAX_TRAVERSER_RASTER (traverser);
+    DaxTraverserRasterPrivate *priv = raster->priv;
+    const DaxCacheEntry *entry;
+    GdkPixbuf *pixbuf;
+    gfloat x, y, width, height;
+    double image_to_user[6], affine[6];
+    gint image_width, image_height;
+    GError *error = NULL;
+
+    entry = dax_element_image_get_cache_entry (node);
+    if (entry == NULL || !dax_cache_entry_is_ready ((DaxCacheEntry *) entry))
+        return;
+
+    x = clutter_units_to_pixels (dax_element_image_get_x (node));
+    y = clutter_units_to_pixels (dax_element_image_get_y (node));
+    width = clutter_units_to_pixels (dax_element_image_get_width (node));
+    height = clutter_units_to_pixels (dax_element_image_get_height (node));
+    if (width <= 0 || height <= 0)
+        return;
+
+    /* use the decoded image if the loading pipeline already produced it */
+    pixbuf = dax_cache_entry_decode_image_sync ((DaxCacheEntry *) entry,
+                                                &error);
+    if (pixbuf == NULL) {
+        if (error) {
+            g_warning (G_STRLOC ": could not load %s: %s",
+                       dax_cache_entry_get_uri ((DaxCacheEntry *) entry),
+                       error->message);
+            g_clear_error (&error);
+        }
+        return;
+    }
+
+    ensure_surface (raster);
+
+    image_width = gdk_pixbuf_get_width (pixbuf);
+    image_height = gdk_pixbuf_get_height (pixbuf);
+
+    /* image pixels -> user space -> device space */
+    _dax_affine_scale (image_to_user,
+                       width / image_width,
+                       height / image_height);
+    image_to_user[4] = x;
+    image_to_user[5] = y;
+    get_device_matrix (raster, affine);
+    _dax_affine_multiply (affine, image_to_user, affine);
+
+    _dax_rasterizer_composite_image (&priv->surface,
+                                     gdk_pixbuf_get_pixels (pixbuf),
+                                     image_width,
+                                     image_height,
+                                     gdk_pixbuf_get_rowstride (pixbuf),
+                                     gdk_pixbuf_get_n_channels (pixbuf),
+                                     affine,
+                                     1.0f);
+}
+
+/*
+ * GObject implementation
+ */
+
+static void
+dax_traverser_raster_get_property (GObject    *object,
+                                   guint       property_id,
+                                   GValue     *value,
+                                   GParamSpec *pspec)
+{
+    DaxTraverserRaster *raster = DAX_TRAVERSER_RASTER (object);
+    DaxTraverserRasterPrivate *priv = raster->priv;
+
+    switch (property_id)
+    {
+    case PROP_WIDTH:
+        g_value_set_uint (value, priv->width);
+        break;
+    case PROP_HEIGHT:
+        g_value_set_uint (value, priv->height);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    }
+}
+
+static void
+dax_traverser_raster_set_property (GObject      *object,
+                                   guint         property_id,
+                                   const GValue *value,
+                                   GParamSpec   *pspec)
+{
+    DaxTraverserRaster *raster = DAX_TRAVERSER_RASTER (object);
+    DaxTraverserRasterPrivate *priv = raster->priv;
+
+    switch (property_id)
+    {
+    case PROP_WIDTH:
+        priv->width = g_value_get_uint (value);
+        break;
+    case PROP_HEIGHT:
+        priv->height = g_value_get_uint (value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    }
+}
+
+static void
+dax_traverser_raster_dispose (GObject *object)
+{
+    DaxTraverserRaster *raster = DAX_TRAVERSER_RASTER (object);
+    DaxTraverserRasterPrivate *priv = raster->priv;
+
+    if (priv->pango_context) {
+        g_object_unref (priv->pango_context);
+        priv->pango_context = NULL;
+    }
+
+    if (priv->font_map) {
+        g_object_unref (priv->font_map);
+        priv->font_map = NULL;
+    }
+
+    G_OBJECT_CLASS (dax_traverser_raster_parent_class)->dispose (object);
+}
+
+static void
+dax_traverser_raster_finalize (GObject *object)
+{
+    DaxTraverserRaster *raster = DAX_TRAVERSER_RASTER (object);
+    DaxTraverserRasterPrivate *priv = raster->priv;
+
+    _dax_rasterizer_free (priv->rasterizer);
+    g_free (priv->surface.pixels);
+
+    G_OBJECT_CLASS (dax_traverser_raster_parent_class)->finalize (object);
+}
+
+static void
+dax_traverser_raster_class_init (DaxTraverserRasterClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+    DaxTraverserClass *traverser_class = DAX_TRAVERSER_CLASS (klass);
+    GParamSpec *pspec;
+
+    g_type_class_add_private (klass, sizeof (DaxTraverserRasterPrivate));
+
+    object_class->get_property = dax_traverser_raster_get_property;
+    object_class->set_property = dax_traverser_raster_set_property;
+    object_class->dispose = dax_traverser_raster_dispose;
+    object_class->finalize = dax_traverser_raster_finalize;
+
+    traverser_class->traverse_svg = dax_traverser_raster_traverse_svg;
+    traverser_class->traverse_path = dax_traverser_raster_traverse_path;
+    traverser_class->traverse_rect = dax_traverser_raster_traverse_rect;
+    traverser_class->traverse_polyline =
+        dax_traverser_raster_traverse_polyline;
+    traverser_class->traverse_circle = dax_traverser_raster_traverse_circle;
+    traverser_class->traverse_line = dax_traverser_raster_traverse_line;
+    traverser_class->traverse_text = dax_traverser_raster_traverse_text;
+    traverser_class->traverse_image = dax_traverser_raster_traverse_image;
+
+    pspec = g_param_spec_uint ("width",
+                               "Width",
+                               "Width of the buffer, 0 to use the width of "
+                               "the document",
+                               0, G_MAXUINT16, 0,
+                               DAX_GPARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_WIDTH, pspec);
+
+    pspec = g_param_spec_uint ("height",
+                               "Height",
+                               "Height of the buffer, 0 to use the height of "
+                               "the document",
+                               0, G_MAXUINT16, 0,
+                               DAX_GPARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_HEIGHT, pspec);
+}
+
+static void
+dax_traverser_raster_init (DaxTraverserRaster *self)
+{
+    DaxTraverserRasterPrivate *priv;
+
+    self->priv = priv = TRAVERSER_RASTER_PRIVATE (self);
+
+    _dax_affine_identity (priv->viewport);
+    priv->rasterizer = _dax_rasterizer_new ();
+}
+
+DaxTraverser *
+dax_traverser_raster_new (DaxDomNode *root,
+                          guint       width,
+                          guint       height)
+{
+    return g_object_new (DAX_TYPE_TRAVERSER_RASTER,
+                         "root", root,
+                         "width", width,
+                         "height", height,
+                         NULL);
+}
+
+void
+dax_traverser_raster_clear (DaxTraverserRaster *self,
+                            const ClutterColor *color)
+{
+    DaxTraverserRasterPrivate *priv;
+    guint32 pixel = 0;
+
+    g_return_if_fail (DAX_IS_TRAVERSER_RASTER (self));
+
+    priv = self->priv;
+
+    if (color) {
+        guint a = color->alpha;
+
+        pixel = a << 24 |
+                (color->red * a / 255) << 16 |
+                (color->green * a / 255) << 8 |
+                (color->blue * a / 255);
+    }
+
+    /* a surface that doesn't have its size yet is filled when allocated */
+    priv->background = pixel;
+    if (priv->surface.pixels)
+        fill_surface (self);
+}
+
+/**
+ * dax_traverser_raster_get_data:
+ * @self: a #DaxTraverserRaster
+ *
+ * Returns the rendered pixels, premultiplied ARGB32 in native endianness
+ * (the same layout as CAIRO_FORMAT_ARGB32) with a stride of
+ * dax_traverser_raster_get_stride() pixels.
+ */
+const guint32 *
+dax_traverser_raster_get_data (DaxTraverserRaster *self)
+{
+    g_return_val_if_fail (DAX_IS_TRAVERSER_RASTER (self), NULL);
+
+    ensure_surface (self);
+
+    return self->priv->surface.pixels;
+}
+
+guint
+dax_traverser_raster_get_width (DaxTraverserRaster *self)
+{
+    g_return_val_if_fail (DAX_IS_TRAVERSER_RASTER (self), 0);
+
+    return self->priv->width;
+}
+
+guint
+dax_traverser_raster_get_height (DaxTraverserRaster *self)
+{
+    g_return_val_if_fail (DAX_IS_TRAVERSER_RASTER (self), 0);
+
+    return self->priv->height;
+}
+
+guint
+dax_traverser_raster_get_stride (DaxTraverserRaster *self)
+{
+    g_return_val_if_fail (DAX_IS_TRAVERSER_RASTER (self), 0);
+
+    return self->priv->surface.stride;
+}
+
+gboolean
+dax_traverser_raster_save_png (DaxTraverserRaster  *self,
+                               const gchar         *filename,
+                               GError             **error)
+{
+    DaxTraverserRasterPrivate *priv;
+    GdkPixbuf *pixbuf;
+    guint8 *pixels;
+    gint rowstride;
+    guint x, y;
+    gboolean ret;
+
+    g_return_val_if_fail (DAX_IS_TRAVERSER_RASTER (self), FALSE);
+    g_return_val_if_fail (filename, FALSE);
+
+    priv = self->priv;
+    ensure_surface (self);
+
+    if (priv->width == 0 || priv->height == 0) {
+        g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                     "Cannot save an empty image");
+        return FALSE;
+    }
+
+    pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8,
+                             priv->width, priv->height);
+    pixels = gdk_pixbuf_get_pixels (pixbuf);
+    rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+
+    /* premultiplied ARGB32 -> RGBA */
+    for (y = 0; y < priv->height; y++) {
+        const guint32 *src = priv->surface.pixels + y * priv->surface.stride;
+        guint8 *dst = pixels + y * rowstride;
+
+        for (x = 0; x < priv->width; x++) {
+            guint32 p = src[x];
+            guint a = p >> 24;
+
+            if (a == 0) {
+                dst[0] = dst[1] = dst[2] = dst[3] = 0;
+            } else {
+                dst[0] = ((p >> 16) & 0xff) * 255 / a;
+                dst[1] = ((p >> 8) & 0xff) * 255 / a;
+                dst[2] = (p & 0xff) * 255 / a;
+                dst[3] = a;
+            }
+            dst += 4;
+        }
+    }
+
+    ret = gdk_pixbuf_save (pixbuf, filename, "png", error, NULL);
+    g_object_unref (pixbuf);
+
+    return ret;
+}
@@ -0,0 +1,91 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__DAX_H_INSIDE__) && !defined(DAX_COMPILATION)
+#error "Only <dax/dax.h> can be included directly."
+#endif
+
+#ifndef __DAX_TRAVERSER_RASTER_H__
+#define __DAX_TRAVERSER_RASTER_H__
+
+#include <glib-object.h>
+#include <clutter/clutter.h>
+
+#include "dax-traverser.h"
+
+G_BEGIN_DECLS
+
+#define DAX_TYPE_TRAVERSER_RASTER dax_traverser_raster_get_type()
+
+#define DAX_TRAVERSER_RASTER(obj)                               \
+    (G_TYPE_CHECK_INSTANCE_CAST ((obj),                         \
+                                 DAX_TYPE_TRAVERSER_RASTER,     \
+                                 DaxTraverserRaster))
+
+#define DAX_TRAVERSER_RASTER_CLASS(klass)                   \
+    (G_TYPE_CHECK_CLASS_CAST ((klass),                      \
+                              DAX_TYPE_TRAVERSER_RASTER,    \
+                              DaxTraverserRasterClass))
+
+#define DAX_IS_TRAVERSER_RASTER(obj) \
+    (G_TYPE_CHECK_INSTANCE_TYPE ((obj), DAX_TYPE_TRAVERSER_RASTER))
+
+#define DAX_IS_TRAVERSER_RASTER_CLASS(klass) \
+    (G_TYPE_CHECK_CLASS_TYPE ((klass), DAX_TYPE_TRAVERSER_RASTER))
+
+#define DAX_TRAVERSER_RASTER_GET_CLASS(obj)                 \
+    (G_TYPE_INSTANCE_GET_CLASS ((obj),                      \
+                                DAX_TYPE_TRAVERSER_RASTER,  \
+                                DaxTraverserRasterClass))
+
+typedef struct _DaxTraverserRaster DaxTraverserRaster;
+typedef struct _DaxTraverserRasterClass DaxTraverserRasterClass;
+typedef struct _DaxTraverserRasterPrivate DaxTraverserRasterPrivate;
+
+struct _DaxTraverserRaster
+{
+    DaxTraverser parent;
+
+    DaxTraverserRasterPrivate *priv;
+};
+
+struct _DaxTraverserRasterClass
+{
+    DaxTraverserClass parent_class;
+};
+
+GType           dax_traverser_raster_get_type   (void) G_GNUC_CONST;
+
+DaxTraverser *  dax_traverser_raster_new        (DaxDomNode *root,
+                                                 guint       width,
+                                                 guint       height);
+
+void            dax_traverser_raster_clear      (DaxTraverserRaster *self,
+                                                 const ClutterColor *color);
+const guint32 * dax_traverser_raster_get_data   (DaxTraverserRaster *self);
+guint           dax_traverser_raster_get_width  (DaxTraverserRaster *self);
+guint           dax_traverser_raster_get_height (DaxTraverserRaster *self);
+guint           dax_traverser_raster_get_stride (DaxTraverserRaster *self);
+
+gboolean        dax_traverser_raster_save_png   (DaxTraverserRaster  *self,
+                                                 const gchar         *filename,
+                                                 GError             **error);
+
+G_END_DECLS
+
+#endif /* __DAX_TRAVERSER_RASTER_H__ */
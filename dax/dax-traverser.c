@@ -16,8 +16,13 @@
  * along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include "dax-affine.h"
 #include "dax-debug.h"
+#include "dax-dom-text.h"
+#include "dax-element-desc.h"
+#include "dax-element-title.h"
 #include "dax-internals.h"
 
 #include "dax-traverser.h"
@@ -36,26 +41,57 @@ enum
     PROP_ROOT
 };
 
+typedef struct
+{
+    double affine[6];
+} SavedCtm;
+
 struct _DaxTraverserPrivate
 {
     DaxMatrix ctm;
+    GArray *ctm_stack;              /* array of SavedCtm */
     DaxDomNode *root;
 };
 
-/* Update the ctm with the transform matrix set on element */
 static void
-apply_transform (DaxTraverser *traverser,
-                 DaxElement   *element)
+save_ctm (DaxTraverser *traverser)
+{
+    DaxTraverserPrivate *priv = traverser->priv;
+    SavedCtm saved;
+
+    memcpy (saved.affine, priv->ctm.affine, sizeof (saved.affine));
+    g_array_append_val (priv->ctm_stack, saved);
+}
+
+static void
+restore_ctm (DaxTraverser *traverser)
+{
+    DaxTraverserPrivate *priv = traverser->priv;
+    SavedCtm *saved;
+
+    if (G_UNLIKELY (priv->ctm_stack->len == 0)) {
+        g_warning (G_STRLOC ": unbalanced CTM stack");
+        return;
+    }
+
+    saved = &g_array_index (priv->ctm_stack, SavedCtm,
+                            priv->ctm_stack->len - 1);
+    memcpy (priv->ctm.affine, saved->affine, sizeof (saved->affine));
+    g_array_set_size (priv->ctm_stack, priv->ctm_stack->len - 1);
+}
+
+/* Update the ctm with the transform matrix set on element. The element
+ * transform is applied first, then the transforms of its ancestors */
+static void
+apply_transform (DaxTraverser    *traverser,
+                 const DaxMatrix *matrix)
 {
     DaxTraverserPrivate *priv = traverser->priv;
-    DaxMatrix *matrix;
 
-    g_object_get (element, "transform", &matrix, NULL);
     if (matrix == NULL)
         return;
 
-    _dax_affine_multiply (priv->ctm.affine, priv->ctm.affine, matrix->affine);
-    dax_matrix_free (matrix);
+    _dax_affine_multiply (priv->ctm.affine, matrix->affine, priv->ctm.affine);
 }
 
 /*
@@ -148,6 +184,263 @@ dax_traverser_traverse_video_real (DaxTraverser    *self,
 {
 }
 
+/*
+ * Dispatching
+ *
+ * Each node is dispatched to its traverse_*() function with a single lookup
+ * of its GType in a table built when the class is initialized.
+ */
+
+typedef void (*DispatchFunc) (DaxTraverser *traverser,
+                              DaxDomNode   *node);
+
+typedef struct
+{
+    DispatchFunc start;
+    DispatchFunc end;
+} Dispatch;
+
+static GHashTable *dispatch_table;  /* GType -> const Dispatch */
+
+static void
+dispatch_svg (DaxTraverser *traverser,
+              DaxDomNode   *node)
+{
+    dax_traverser_traverse_svg (traverser, (DaxElementSvg *) node);
+}
+
+static void
+dispatch_g_start (DaxTraverser *traverser,
+                  DaxDomNode   *node)
+{
+    dax_traverser_traverse_g (traverser, (DaxElementG *) node,
+                              DAX_TRAVERSER_WAY_START);
+}
+
+static void
+dispatch_g_end (DaxTraverser *traverser,
+                DaxDomNode   *node)
+{
+    dax_traverser_traverse_g (traverser, (DaxElementG *) node,
+                              DAX_TRAVERSER_WAY_END);
+}
+
+static void
+dispatch_path (DaxTraverser *traverser,
+               DaxDomNode   *node)
+{
+    dax_traverser_traverse_path (traverser, (DaxElementPath *) node);
+}
+
+static void
+dispatch_rect (DaxTraverser *traverser,
+               DaxDomNode   *node)
+{
+    dax_traverser_traverse_rect (traverser, (DaxElementRect *) node);
+}
+
+static void
+dispatch_text (DaxTraverser *traverser,
+               DaxDomNode   *node)
+{
+    dax_traverser_traverse_text (traverser, (DaxElementText *) node);
+}
+
+static void
+dispatch_polyline (DaxTraverser *traverser,
+                   DaxDomNode   *node)
+{
+    dax_traverser_traverse_polyline (traverser, (DaxElementPolyline *) node);
+}
+
+static void
+dispatch_animate (DaxTraverser *traverser,
+                  DaxDomNode   *node)
+{
+    dax_traverser_traverse_animate (traverser, (DaxElementAnimate *) node);
+}
+
+static void
+dispatch_animate_transform (DaxTraverser *traverser,
+                            DaxDomNode   *node)
+{
+    dax_traverser_traverse_animate_transform (traverser,
+                                              (DaxElementAnimateTransform *)
+                                              node);
+}
+
+static void
+dispatch_image (DaxTraverser *traverser,
+                DaxDomNode   *node)
+{
+    dax_traverser_traverse_image (traverser, (DaxElementImage *) node);
+}
+
+static void
+dispatch_video (DaxTraverser *traverser,
+                DaxDomNode   *node)
+{
+    dax_traverser_traverse_video (traverser, (DaxElementVideo *) node);
+}
+
+static void
+dispatch_circle (DaxTraverser *traverser,
+                 DaxDomNode   *node)
+{
+    dax_traverser_traverse_circle (traverser, (DaxElementCircle *) node);
+}
+
+static void
+dispatch_script (DaxTraverser *traverser,
+                 DaxDomNode   *node)
+{
+    dax_traverser_traverse_script (traverser, (DaxElementScript *) node);
+}
+
+static void
+dispatch_handler (DaxTraverser *traverser,
+                  DaxDomNode   *node)
+{
+    dax_traverser_traverse_handler (traverser, (DaxElementHandler *) node);
+}
+
+static void
+dispatch_line (DaxTraverser *traverser,
+               DaxDomNode   *node)
+{
+    dax_traverser_traverse_line (traverser, (DaxElementLine *) node);
+}
+
+static const Dispatch no_dispatch = { NULL, NULL };
+
+static const struct
+{
+    GType (*get_type) (void);
+    Dispatch dispatch;
+} builtin_dispatchers[] =
+{
+    { dax_element_svg_get_type,         { dispatch_svg, NULL }              },
+    { dax_element_g_get_type,           { dispatch_g_start, dispatch_g_end }},
+    { dax_element_path_get_type,        { dispatch_path, NULL }             },
+    { dax_element_rect_get_type,        { dispatch_rect, NULL }             },
+    { dax_element_text_get_type,        { dispatch_text, NULL }             },
+    { dax_element_polyline_get_type,    { dispatch_polyline, NULL }         },
+    { dax_element_animate_get_type,     { dispatch_animate, NULL }          },
+    { dax_element_animate_transform_get_type,
+                                        { dispatch_animate_transform, NULL }},
+    { dax_element_image_get_type,       { dispatch_image, NULL }            },
+    { dax_element_video_get_type,       { dispatch_video, NULL }            },
+    { dax_element_circle_get_type,      { dispatch_circle, NULL }           },
+    { dax_element_script_get_type,      { dispatch_script, NULL }           },
+    { dax_element_handler_get_type,     { dispatch_handler, NULL }          },
+    { dax_element_line_get_type,        { dispatch_line, NULL }             },
+};
+
+static void
+build_dispatch_table (void)
+{
+    guint i;
+
+    dispatch_table = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    for (i = 0; i < G_N_ELEMENTS (builtin_dispatchers); i++) {
+        GType type = builtin_dispatchers[i].get_type ();
+
+        g_hash_table_insert (dispatch_table,
+                             GSIZE_TO_POINTER (type),
+                             (gpointer) &builtin_dispatchers[i].dispatch);
+    }
+
+    /* frequent nodes with nothing to dispatch, found right away rather than
+     * after walking up their ancestors. DaxDomNode stops the walk */
+    g_hash_table_insert (dispatch_table,
+                         GSIZE_TO_POINTER (DAX_TYPE_DOM_TEXT),
+                         (gpointer) &no_dispatch);
+    g_hash_table_insert (dispatch_table,
+                         GSIZE_TO_POINTER (DAX_TYPE_ELEMENT_DESC),
+                         (gpointer) &no_dispatch);
+    g_hash_table_insert (dispatch_table,
+                         GSIZE_TO_POINTER (DAX_TYPE_ELEMENT_TITLE),
+                         (gpointer) &no_dispatch);
+    g_hash_table_insert (dispatch_table,
+                         GSIZE_TO_POINTER (DAX_TYPE_DOM_NODE),
+                         (gpointer) &no_dispatch);
+}
+
+static const Dispatch *
+lookup_dispatch (GType type)
+{
+    const Dispatch *dispatch;
+
+    /* subclasses of the known elements (eg. registered by applications) are
+     * dispatched as their closest known ancestor */
+    while (type != G_TYPE_INVALID) {
+        dispatch = g_hash_table_lookup (dispatch_table,
+                                        GSIZE_TO_POINTER (type));
+        if (G_LIKELY (dispatch))
+            return dispatch;
+
+        type = g_type_parent (type);
+    }
+
+    return &no_dispatch;
+}
+
+static void
+dax_traverse_node (DaxTraverser    *traverser,
+                   DaxDomNode      *node,
+                   DaxTraverserWay  way)
+{
+    const Dispatch *dispatch;
+
+    DAX_NOTE (TRAVERSER, "traversing %s %p", G_OBJECT_TYPE_NAME (node), node);
+
+    dispatch = lookup_dispatch (G_OBJECT_TYPE (node));
+
+    if (way == DAX_TRAVERSER_WAY_START) {
+        if (dispatch->start)
+            dispatch->start (traverser, node);
+    } else {
+        if (dispatch->end)
+            dispatch->end (traverser, node);
+    }
+}
+
+/* Depth-first walk of the tree, iterative so deep documents can't exhaust
+ * the stack */
+static void
+dax_traverser_walk_tree (DaxTraverser *traverser,
+                         DaxDomNode   *root)
+{
+    DaxDomNode *node = root;
+
+    dax_traverse_node (traverser, node, DAX_TRAVERSER_WAY_START);
+
+    for (;;) {
+        if (node->first_child) {
+            node = node->first_child;
+            dax_traverse_node (traverser, node, DAX_TRAVERSER_WAY_START);
+            continue;
+        }
+
+        /* close the nodes until one of them has a next sibling */
+        for (;;) {
+            dax_traverse_node (traverser, node, DAX_TRAVERSER_WAY_END);
+
+            if (node == root)
+                return;
+
+            if (node->next_sibling) {
+                node = node->next_sibling;
+                dax_traverse_node (traverser, node, DAX_TRAVERSER_WAY_START);
+                break;
+            }
+
+            node = node->parent_node;
+        }
+    }
+}
+
 /*
  * GObject overloading
  */
@@ -209,6 +502,11 @@ dax_traverser_dispose (GObject *object)
 static void
 dax_traverser_finalize (GObject *object)
 {
+    DaxTraverser *traverser = DAX_TRAVERSER (object);
+    DaxTraverserPrivate *priv = traverser->priv;
+
+    g_array_free (priv->ctm_stack, TRUE);
+
     G_OBJECT_CLASS (dax_traverser_parent_class)->finalize (object);
 }
 
@@ -220,6 +518,8 @@ dax_traverser_class_init (DaxTraverserClass *klass)
 
     g_type_class_add_private (klass, sizeof (DaxTraverserPrivate));
 
+    build_dispatch_table ();
+
     object_class->get_property = dax_traverser_get_property;
     object_class->set_property = dax_traverser_set_property;
     object_class->dispose = dax_traverser_dispose;
@@ -258,6 +558,7 @@ dax_traverser_init (DaxTraverser *self)
     self->priv = priv = TRAVERSER_PRIVATE (self);
 
     _dax_affine_identity (priv->ctm.affine);
+    priv->ctm_stack = g_array_new (FALSE, FALSE, sizeof (SavedCtm));
 }
 
 const DaxMatrix *
@@ -268,66 +569,24 @@ dax_traverser_get_ctm (DaxTraverser *self)
     return &self->priv->ctm;
 }
 
-static void
-dax_traverse_node (DaxTraverser    *traverser,
-                   DaxDomNode      *node,
-                   DaxTraverserWay  way)
+/* Used to traverse a document piece by piece, keeping the traverser state
+ * (eg. the current container of DaxTraverserClutter) from one piece to the
+ * next */
+void
+dax_traverser_set_root (DaxTraverser *self,
+                        DaxDomNode   *root)
 {
-    DAX_NOTE (TRAVERSER, "traversing %s %p", G_OBJECT_TYPE_NAME (node), node);
-
-    if (way == DAX_TRAVERSER_WAY_END) {
-        if (DAX_IS_ELEMENT_G (node)) {
-            dax_traverser_traverse_g (traverser, (DaxElementG *)node, way);
-        }
-        return;
-    }
-
-    if (DAX_IS_ELEMENT_SVG (node))
-        dax_traverser_traverse_svg (traverser, (DaxElementSvg *)node);
-    else if (DAX_IS_ELEMENT_G (node))
-        dax_traverser_traverse_g (traverser, (DaxElementG *)node, way);
-    else if (DAX_IS_ELEMENT_PATH (node))
-        dax_traverser_traverse_path (traverser, (DaxElementPath *)node);
-    else if (DAX_IS_ELEMENT_RECT (node))
-        dax_traverser_traverse_rect (traverser, (DaxElementRect *)node);
-    else if (DAX_IS_ELEMENT_TEXT (node))
-        dax_traverser_traverse_text (traverser, (DaxElementText *)node);
-    else if (DAX_IS_ELEMENT_POLYLINE (node))
-        dax_traverser_traverse_polyline (traverser, (DaxElementPolyline *)node);
-    else if (DAX_IS_ELEMENT_ANIMATE (node))
-        dax_traverser_traverse_animate (traverser, (DaxElementAnimate *)node);
-    else if (DAX_IS_ELEMENT_ANIMATE_TRANSFORM (node)) {
-        DaxElementAnimateTransform *element;
-
-        element = DAX_ELEMENT_ANIMATE_TRANSFORM (node);
-        dax_traverser_traverse_animate_transform (traverser, element);
-    } else if (DAX_IS_ELEMENT_IMAGE (node))
-        dax_traverser_traverse_image (traverser, (DaxElementImage *)node);
-    else if (DAX_IS_ELEMENT_VIDEO (node))
-        dax_traverser_traverse_video (traverser, (DaxElementVideo *)node);
-    else if (DAX_IS_ELEMENT_CIRCLE (node))
-        dax_traverser_traverse_circle (traverser, (DaxElementCircle *)node);
-    else if (DAX_IS_ELEMENT_SCRIPT (node))
-        dax_traverser_traverse_script (traverser, (DaxElementScript *)node);
-    else if (DAX_IS_ELEMENT_HANDLER (node))
-        dax_traverser_traverse_handler (traverser, (DaxElementHandler *)node);
-    else if (DAX_IS_ELEMENT_LINE (node))
-        dax_traverser_traverse_line (traverser, (DaxElementLine *)node);
-}
+    DaxTraverserPrivate *priv;
 
-static void
-dax_traverser_walk_tree (DaxTraverser *traverser,
-                         DaxDomNode   *node)
-{
-    DaxDomNode *cur;
+    g_return_if_fail (DAX_IS_TRAVERSER (self));
+    g_return_if_fail (root == NULL || DAX_IS_DOM_NODE (root));
 
-    dax_traverse_node (traverser, node, DAX_TRAVERSER_WAY_START);
-    cur = node->first_child;
-    while (cur) {
-        dax_traverser_walk_tree (traverser, cur);
-        cur = cur->next_sibling;
-    }
-    dax_traverse_node (traverser, node, DAX_TRAVERSER_WAY_END);
+    priv = self->priv;
+    if (root)
+        g_object_ref (root);
+    if (priv->root)
+        g_object_unref (priv->root);
+    priv->root = root;
 }
 
 void
@@ -358,8 +617,14 @@ dax_traverser_traverse_g (DaxTraverser    *self,
 {
     DaxTraverserClass *klass = DAX_TRAVERSER_GET_CLASS (self);
 
-    apply_transform (self, DAX_ELEMENT (node));
-    klass->traverse_g (self, node, way);
+    if (way == DAX_TRAVERSER_WAY_START) {
+        save_ctm (self);
+        apply_transform (self, dax_element_g_get_transform (node));
+        klass->traverse_g (self, node, way);
+    } else {
+        klass->traverse_g (self, node, way);
+        restore_ctm (self);
+    }
 }
 
 void
@@ -368,8 +633,10 @@ dax_traverser_traverse_path (DaxTraverser   *self,
 {
     DaxTraverserClass *klass = DAX_TRAVERSER_GET_CLASS (self);
 
-    apply_transform (self, DAX_ELEMENT (node));
+    save_ctm (self);
+    apply_transform (self, dax_element_path_get_transform (node));
     klass->traverse_path (self, node);
+    restore_ctm (self);
 }
 
 void
@@ -378,7 +645,10 @@ dax_traverser_traverse_rect (DaxTraverser   *self,
 {
     DaxTraverserClass *klass = DAX_TRAVERSER_GET_CLASS (self);
 
+    save_ctm (self);
+    apply_transform (self, dax_element_rect_get_transform (node));
     klass->traverse_rect (self, node);
+    restore_ctm (self);
 }
 
 void
@@ -387,7 +657,10 @@ dax_traverser_traverse_polyline (DaxTraverser       *self,
 {
     DaxTraverserClass *klass = DAX_TRAVERSER_GET_CLASS (self);
 
+    save_ctm (self);
+    apply_transform (self, dax_element_polyline_get_transform (node));
     klass->traverse_polyline (self, node);
+    restore_ctm (self);
 }
 
 void
@@ -414,7 +687,10 @@ dax_traverser_traverse_circle (DaxTraverser     *self,
 {
     DaxTraverserClass *klass = DAX_TRAVERSER_GET_CLASS (self);
 
+    save_ctm (self);
+    apply_transform (self, dax_element_circle_get_transform (node));
     klass->traverse_circle (self, node);
+    restore_ctm (self);
 }
 
 void
@@ -441,7 +717,10 @@ dax_traverser_traverse_line (DaxTraverser   *self,
 {
     DaxTraverserClass *klass = DAX_TRAVERSER_GET_CLASS (self);
 
+    save_ctm (self);
+    apply_transform (self, dax_element_line_get_transform (node));
     klass->traverse_line (self, node);
+    restore_ctm (self);
 }
 
 void
@@ -450,7 +729,10 @@ dax_traverser_traverse_text (DaxTraverser   *self,
 {
     DaxTraverserClass *klass = DAX_TRAVERSER_GET_CLASS (self);
 
+    save_ctm (self);
+    apply_transform (self, dax_element_text_get_transform (node));
     klass->traverse_text (self, node);
+    restore_ctm (self);
 }
 
 void
@@ -459,7 +741,10 @@ dax_traverser_traverse_image (DaxTraverser    *self,
 {
     DaxTraverserClass *klass = DAX_TRAVERSER_GET_CLASS (self);
 
+    save_ctm (self);
+    apply_transform (self, dax_element_image_get_transform (node));
     klass->traverse_image (self, node);
+    restore_ctm (self);
 }
 
 void
@@ -31,98 +31,97 @@
  * DaxMatrix
  */
 
-static DaxElementaryMatrix *
-dax_elementary_matrix_new (DaxMatrixType type,
-                           float         param0,
-                           float         param1,
-                           float         param2)
+static void
+dax_matrix_append_elementary (DaxMatrix     *matrix,
+                              DaxMatrixType  type,
+                              float          param0,
+                              float          param1,
+                              float          param2)
 {
     DaxElementaryMatrix *em;
 
-    em = g_slice_new (DaxElementaryMatrix);
+    /* too many transforms, remember it and collapse the list at the end of
+     * the parsing */
+    if (matrix->n_elementary_matrices >= DAX_MATRIX_MAX_ELEMENTARY) {
+        matrix->n_elementary_matrices = DAX_MATRIX_MAX_ELEMENTARY + 1;
+        return;
+    }
+
+    em = &matrix->elementary_matrices[matrix->n_elementary_matrices++];
     em->type = type;
     em->params[0] = param0;
     em->params[1] = param1;
     em->params[2] = param2;
-
-    return em;
 }
 
 static void
-dax_elementary_matrix_free (DaxElementaryMatrix *em)
+dax_elementary_matrix_to_affine (const DaxElementaryMatrix *em,
+                                 double                     affine[6])
 {
-    g_slice_free (DaxElementaryMatrix, em);
-}
+    double tmp_affine[6];
 
-static DaxElementaryMatrix *
-dax_elementary_matrix_copy (DaxElementaryMatrix *em)
-{
-    return g_slice_dup (DaxElementaryMatrix, em);
+    switch (em->type) {
+    case DAX_MATRIX_TYPE_TRANSLATE:
+        _dax_affine_translate (affine, em->params[0], em->params[1]);
+        break;
+    case DAX_MATRIX_TYPE_SCALE:
+        _dax_affine_scale (affine, em->params[0], em->params[1]);
+        break;
+    case DAX_MATRIX_TYPE_ROTATE:
+        _dax_affine_rotate (affine, em->params[0]);
+        break;
+    case DAX_MATRIX_TYPE_ROTATE_AROUND:
+        _dax_affine_translate (affine, -em->params[1], -em->params[2]);
+        _dax_affine_rotate (tmp_affine, em->params[0]);
+        _dax_affine_multiply (affine, affine, tmp_affine);
+        _dax_affine_translate (tmp_affine, em->params[1], em->params[2]);
+        _dax_affine_multiply (affine, affine, tmp_affine);
+        break;
+    case DAX_MATRIX_TYPE_SKEW_X:
+        _dax_affine_shear (affine, em->params[0]);
+        break;
+    case DAX_MATRIX_TYPE_SKEW_Y:
+        _dax_affine_shear (affine, em->params[0]);
+        /* transpose the affine, given that we know [1] is zero */
+        affine[1] = affine[2];
+        affine[2] = 0;
+        break;
+    case DAX_MATRIX_TYPE_GENERIC:
+    default:
+        g_assert_not_reached ();
+    }
 }
 
+/* Rebuild the affine from the list of elementary matrices */
 static void
-dax_matrix_prepend_elementary (DaxMatrix           *matrix,
-                               DaxElementaryMatrix *em)
-{
-    matrix->elementary_matrices = g_list_prepend (matrix->elementary_matrices,
-                                                  em);
-}
-
-DaxMatrix *
-dax_matrix_deep_copy (const DaxMatrix *matrix)
+dax_matrix_compose (DaxMatrix *matrix)
 {
-    DaxMatrix *new_matrix;
-    GList *cur;
-
-    if (matrix == NULL)
-        return NULL;
+    double tmp_affine[6];
+    guint i;
 
-    new_matrix = g_slice_dup (DaxMatrix, matrix);
-    new_matrix->elementary_matrices = NULL;
-    new_matrix->refcount = 1;
-    for (cur = matrix->elementary_matrices; cur; cur = g_list_next (cur)) {
-        DaxElementaryMatrix *em;
+    _dax_affine_identity (matrix->affine);
 
-        em = dax_elementary_matrix_copy (cur->data);
-        dax_matrix_prepend_elementary (new_matrix, em);
+    for (i = 0; i < matrix->n_elementary_matrices; i++) {
+        dax_elementary_matrix_to_affine (&matrix->elementary_matrices[i],
+                                         tmp_affine);
+        _dax_affine_multiply (matrix->affine, tmp_affine, matrix->affine);
     }
-
-    new_matrix->elementary_matrices =
-        g_list_reverse (new_matrix->elementary_matrices);
-
-    return new_matrix;
 }
 
 DaxMatrix *
-dax_matrix_copy (DaxMatrix *matrix)
+dax_matrix_copy (const DaxMatrix *matrix)
 {
     if (matrix == NULL)
         return NULL;
 
-    g_atomic_int_inc (&matrix->refcount);
-
-    return matrix;
-}
-
-static void
-dax_matrix_free_elementary_matrices (DaxMatrix *matrix)
-{
-    GList *cur;
-
-    if (matrix->elementary_matrices == NULL)
-        return;
-
-    for (cur = matrix->elementary_matrices; cur; cur = g_list_next (cur))
-        dax_elementary_matrix_free (cur->data);
-    g_list_free (matrix->elementary_matrices);
-    matrix->elementary_matrices = NULL;
+    return g_slice_dup (DaxMatrix, matrix);
 }
 
-static void
-dax_matrix_destroy (DaxMatrix *matrix)
+/* DaxMatrix is a plain structure, kept for API compatibility */
+DaxMatrix *
+dax_matrix_deep_copy (const DaxMatrix *matrix)
 {
-    dax_matrix_free_elementary_matrices (matrix);
-    g_slice_free (DaxMatrix, matrix);
+    return dax_matrix_copy (matrix);
 }
 
 void
@@ -131,8 +130,7 @@ dax_matrix_free (DaxMatrix *matrix)
     if (matrix == NULL)
         return;
 
-    if (g_atomic_int_dec_and_test (&matrix->refcount))
-        dax_matrix_destroy (matrix);
+    g_slice_free (DaxMatrix, matrix);
 }
 
 void
@@ -141,8 +139,7 @@ dax_matrix_from_array (DaxMatrix *matrix,
 {
     g_return_if_fail (matrix != NULL);
 
-    matrix->refcount = 1;
-    matrix->elementary_matrices = NULL;
+    matrix->n_elementary_matrices = 0;
     memcpy (matrix->affine, src, 6 * sizeof (double));
 }
 
@@ -163,7 +160,7 @@ dax_matrix_get_affine (DaxMatrix *matrix)
  * Copyright (C) 2000 Eazel, Inc.
  * Copyright (C) 2002 Dom Lachowicz <cinamod@hotmail.com>
  *
- * I made some changes to the original function. We now populate a GList of
+ * I made some changes to the original function. We now populate a list of
  * elementary transformation that the resulting matrix can be decomposed into.
  * This is useful when, say, we want to interpolate between "rotate(0)
  * scale(1)" and "rotate(90) scale(10)"
@@ -179,7 +176,6 @@ dax_parse_transform (DaxMatrix  *matrix,
     guint key_len;
     double tmp_affine[6];
     double *dst = matrix->affine;
-    DaxElementaryMatrix *em;
 
     _dax_affine_identity (dst);
 
@@ -245,19 +241,16 @@ dax_parse_transform (DaxMatrix  *matrix,
         if (!strcmp (keyword, "matrix")) {
             if (n_args != 6)
                 return FALSE;
-            em = dax_elementary_matrix_new (DAX_MATRIX_TYPE_GENERIC, 0, 0, 0);
-            dax_matrix_prepend_elementary (matrix, em);
+            dax_matrix_append_elementary (matrix, DAX_MATRIX_TYPE_GENERIC,
+                                          0, 0, 0);
             _dax_affine_multiply (dst, args, dst);
         } else if (!strcmp (keyword, "translate")) {
             if (n_args == 1)
                 args[1] = 0;
             else if (n_args != 2)
                 return FALSE;
-            em = dax_elementary_matrix_new (DAX_MATRIX_TYPE_TRANSLATE,
-                                            args[0],
-                                            args[1],
-                                            0);
-            dax_matrix_prepend_elementary (matrix, em);
+            dax_matrix_append_elementary (matrix, DAX_MATRIX_TYPE_TRANSLATE,
+                                          args[0], args[1], 0);
             _dax_affine_translate (tmp_affine, args[0], args[1]);
             _dax_affine_multiply (dst, tmp_affine, dst);
         } else if (!strcmp (keyword, "scale")) {
@@ -265,28 +258,20 @@ dax_parse_transform (DaxMatrix  *matrix,
                 args[1] = args[0];
             else if (n_args != 2)
                 return FALSE;
-            em = dax_elementary_matrix_new (DAX_MATRIX_TYPE_SCALE,
-                                            args[0],
-                                            args[1],
-                                            0);
-            dax_matrix_prepend_elementary (matrix, em);
+            dax_matrix_append_elementary (matrix, DAX_MATRIX_TYPE_SCALE,
+                                          args[0], args[1], 0);
             _dax_affine_scale (tmp_affine, args[0], args[1]);
             _dax_affine_multiply (dst, tmp_affine, dst);
         } else if (!strcmp (keyword, "rotate")) {
             if (n_args == 1) {
-                em = dax_elementary_matrix_new (DAX_MATRIX_TYPE_ROTATE,
-                                                args[0],
-                                                0,
-                                                0);
-                dax_matrix_prepend_elementary (matrix, em);
+                dax_matrix_append_elementary (matrix, DAX_MATRIX_TYPE_ROTATE,
+                                              args[0], 0, 0);
                 _dax_affine_rotate (tmp_affine, args[0]);
                 _dax_affine_multiply (dst, tmp_affine, dst);
             } else if (n_args == 3) {
-                em = dax_elementary_matrix_new (DAX_MATRIX_TYPE_ROTATE_AROUND,
-                                                args[0],
-                                                args[1],
-                                                args[2]);
-                dax_matrix_prepend_elementary (matrix, em);
+                dax_matrix_append_elementary (matrix,
+                                              DAX_MATRIX_TYPE_ROTATE_AROUND,
+                                              args[0], args[1], args[2]);
                 _dax_affine_translate (tmp_affine, args[1], args[2]);
                 _dax_affine_multiply (dst, tmp_affine, dst);
 
@@ -300,21 +285,15 @@ dax_parse_transform (DaxMatrix  *matrix,
         } else if (!strcmp (keyword, "skewX")) {
             if (n_args != 1)
                 return FALSE;
-            em = dax_elementary_matrix_new (DAX_MATRIX_TYPE_SKEW_X,
-                                            args[0],
-                                            0,
-                                            0);
-            dax_matrix_prepend_elementary (matrix, em);
+            dax_matrix_append_elementary (matrix, DAX_MATRIX_TYPE_SKEW_X,
+                                          args[0], 0, 0);
             _dax_affine_shear (tmp_affine, args[0]);
             _dax_affine_multiply (dst, tmp_affine, dst);
         } else if (!strcmp (keyword, "skewY")) {
             if (n_args != 1)
                 return FALSE;
-            em = dax_elementary_matrix_new (DAX_MATRIX_TYPE_SKEW_X,
-                                            args[0],
-                                            0,
-                                            0);
-            dax_matrix_prepend_elementary (matrix, em);
+            dax_matrix_append_elementary (matrix, DAX_MATRIX_TYPE_SKEW_Y,
+                                          args[0], 0, 0);
             _dax_affine_shear (tmp_affine, args[0]);
             /* transpose the affine, given that we know [1] is zero */
             tmp_affine[1] = tmp_affine[2];
@@ -323,7 +302,6 @@ dax_parse_transform (DaxMatrix  *matrix,
         } else
             return FALSE;       /* unknown keyword */
     }
-    matrix->elementary_matrices = g_list_reverse (matrix->elementary_matrices);
     return TRUE;
 }
 
@@ -334,13 +312,18 @@ dax_matrix_from_string (DaxMatrix   *matrix,
     gboolean res;
 
     g_return_val_if_fail (matrix != NULL, FALSE);
-    g_return_val_if_fail (matrix != NULL, FALSE);
+    g_return_val_if_fail (string != NULL, FALSE);
 
-    matrix->refcount = 1;
-    matrix->elementary_matrices = NULL;
+    matrix->n_elementary_matrices = 0;
     res = dax_parse_transform (matrix, string);
     if (res == FALSE)
-        dax_matrix_free_elementary_matrices (matrix);
+        matrix->n_elementary_matrices = 0;
+
+    /* the affine is right but the transform list can't be kept */
+    if (matrix->n_elementary_matrices > DAX_MATRIX_MAX_ELEMENTARY) {
+        matrix->n_elementary_matrices = 1;
+        matrix->elementary_matrices[0].type = DAX_MATRIX_TYPE_GENERIC;
+    }
 
     return res;
 }
@@ -382,33 +365,154 @@ _transform_string_matrix (const GValue *src,
 
     dax_matrix_from_string (&matrix, g_value_get_string (src));
 
-    dest->data[0].v_pointer = dax_matrix_deep_copy (&matrix);
+    dest->data[0].v_pointer = dax_matrix_copy (&matrix);
 }
 
 static gboolean
-dax_matrices_can_be_interpolated (DaxMatrix *a,
-                                  DaxMatrix *b)
+dax_elementary_matrices_compatible (const DaxElementaryMatrix *a,
+                                    const DaxElementaryMatrix *b)
 {
-    GList *cur_a, *cur_b;
+    if (a->type == DAX_MATRIX_TYPE_GENERIC)
+        return FALSE;
 
-    if (g_list_length (a->elementary_matrices) !=
-        g_list_length (b->elementary_matrices) &&
-        g_list_length (a->elementary_matrices) != 0)
-    {
+    if (a->type == b->type)
+        return TRUE;
+
+    /* rotate(a) is rotate(a 0 0) */
+    return (a->type == DAX_MATRIX_TYPE_ROTATE ||
+            a->type == DAX_MATRIX_TYPE_ROTATE_AROUND) &&
+           (b->type == DAX_MATRIX_TYPE_ROTATE ||
+            b->type == DAX_MATRIX_TYPE_ROTATE_AROUND);
+}
+
+/* Elementary matrix of the same type as @em that does nothing, used to
+ * interpolate from/to an empty transform list */
+static void
+dax_elementary_matrix_neutral (const DaxElementaryMatrix *em,
+                               DaxElementaryMatrix       *neutral)
+{
+    *neutral = *em;
+
+    switch (em->type) {
+    case DAX_MATRIX_TYPE_SCALE:
+        neutral->params[0] = neutral->params[1] = 1.0f;
+        break;
+    case DAX_MATRIX_TYPE_ROTATE_AROUND:
+        /* keep the center of the rotation */
+        neutral->params[0] = 0.0f;
+        break;
+    default:
+        neutral->params[0] = neutral->params[1] = neutral->params[2] = 0.0f;
+        break;
+    }
+}
+
+/* A matrix without transform list is either an empty list or an affine
+ * given as is, dax_matrix_from_array() */
+static gboolean
+dax_matrix_is_plain_affine (const DaxMatrix *matrix)
+{
+    static const double identity[6] = { 1, 0, 0, 1, 0, 0 };
+    guint i;
+
+    if (matrix->n_elementary_matrices)
         return FALSE;
+
+    for (i = 0; i < 6; i++)
+        if (matrix->affine[i] != identity[i])
+            return TRUE;
+
+    return FALSE;
+}
+
+/**
+ * dax_matrix_interpolate:
+ * @a: the initial #DaxMatrix
+ * @b: the final #DaxMatrix
+ * @progress: the interpolation progress, between 0.0 and 1.0
+ * @result: return location for the interpolated matrix
+ *
+ * Interpolates the transform lists of @a and @b. Both lists have to be made
+ * of the same sequence of translate, scale, rotate, skewX and skewY
+ * transforms, one of them can also be empty. When one of them has no
+ * transform list but is not the identity, such as the matrices created with
+ * dax_matrix_from_array(), the affine coefficients of @a and @b are
+ * interpolated instead.
+ *
+ * This does not allocate any memory and @result may be @a or @b.
+ *
+ * Return value: %TRUE if @a and @b can be interpolated
+ */
+gboolean
+dax_matrix_interpolate (const DaxMatrix *a,
+                        const DaxMatrix *b,
+                        gdouble          progress,
+                        DaxMatrix       *result)
+{
+    DaxElementaryMatrix from, to;
+    const DaxMatrix *longest;
+    guint n, i, j;
+
+    g_return_val_if_fail (a != NULL && b != NULL && result != NULL, FALSE);
+
+    if ((a->n_elementary_matrices == 0 && b->n_elementary_matrices == 0) ||
+        dax_matrix_is_plain_affine (a) || dax_matrix_is_plain_affine (b))
+    {
+        for (i = 0; i < 6; i++)
+            result->affine[i] =
+                a->affine[i] + progress * (b->affine[i] - a->affine[i]);
+        result->n_elementary_matrices = 0;
+        return TRUE;
     }
 
-    for (cur_a = a->elementary_matrices, cur_b = b->elementary_matrices;
-         cur_a;
-         cur_a = g_list_next (cur_a), cur_b = g_list_next (cur_b))
+    longest = a->n_elementary_matrices ? a : b;
+    n = longest->n_elementary_matrices;
+
+    if (a->n_elementary_matrices && b->n_elementary_matrices &&
+        a->n_elementary_matrices != b->n_elementary_matrices)
     {
-        DaxElementaryMatrix *em_a = cur_a->data;
-        DaxElementaryMatrix *em_b = cur_b->data;
+        return FALSE;
+    }
+
+    /* check everything before writing, result can be a or b */
+    for (i = 0; i < n; i++) {
+        const DaxElementaryMatrix *em = &longest->elementary_matrices[i];
 
-        if (em_a->type != em_b->type)
+        if (em->type == DAX_MATRIX_TYPE_GENERIC)
             return FALSE;
+        if (a->n_elementary_matrices && b->n_elementary_matrices &&
+            !dax_elementary_matrices_compatible (&a->elementary_matrices[i],
+                                                 &b->elementary_matrices[i]))
+        {
+            return FALSE;
+        }
     }
 
+    for (i = 0; i < n; i++) {
+        if (a->n_elementary_matrices)
+            from = a->elementary_matrices[i];
+        else
+            dax_elementary_matrix_neutral (&b->elementary_matrices[i], &from);
+
+        if (b->n_elementary_matrices)
+            to = b->elementary_matrices[i];
+        else
+            dax_elementary_matrix_neutral (&a->elementary_matrices[i], &to);
+
+        /* rotate(a) and rotate(a cx cy), the center of the first one is
+         * 0,0 */
+        if (from.type != to.type)
+            from.type = to.type = DAX_MATRIX_TYPE_ROTATE_AROUND;
+
+        result->elementary_matrices[i].type = to.type;
+        for (j = 0; j < 3; j++)
+            result->elementary_matrices[i].params[j] =
+                from.params[j] + progress * (to.params[j] - from.params[j]);
+    }
+    result->n_elementary_matrices = n;
+
+    dax_matrix_compose (result);
+
     return TRUE;
 }
 
@@ -418,52 +522,17 @@ dax_matrix_progress (const GValue *a,
                      gdouble       progress,
                      GValue       *retval)
 {
-    DaxMatrix *matrix_a = g_value_get_boxed (a);
-    DaxMatrix *matrix_b = g_value_get_boxed (b);
-    DaxElementaryMatrix *em_a;
-    DaxElementaryMatrix *em_b;
-    DaxMatrix matrix, *result;
-    double tmp_affine[6], result_affine[6];
+    const DaxMatrix *matrix_a = g_value_get_boxed (a);
+    const DaxMatrix *matrix_b = g_value_get_boxed (b);
+    DaxMatrix result;
 
-    if (dax_matrices_can_be_interpolated (matrix_a, matrix_b) == FALSE) {
+    if (!dax_matrix_interpolate (matrix_a, matrix_b, progress, &result)) {
         /* FIXME: more useful message... */
         g_warning ("Can not interpolate between those two matrices");
         return FALSE;
     }
 
-    _dax_affine_identity (result_affine);
-
-    /* FIXME: should really support interpolating between two lists of
-     * similar elementary matrices */
-    em_a = matrix_a->elementary_matrices->data;
-    em_b = matrix_b->elementary_matrices->data;
-
-    switch (em_b->type) {
-    case DAX_MATRIX_TYPE_ROTATE:
-        {
-            float angle, angle_a, angle_b;
-
-            angle_a = em_a->params[0];
-            angle_b = em_b->params[0];
-            angle = progress * (angle_b - angle_a) + angle_a;
-
-            _dax_affine_rotate (tmp_affine, angle);
-            _dax_affine_multiply (result_affine, tmp_affine, result_affine);
-        }
-        break;
-    case DAX_MATRIX_TYPE_GENERIC:
-    case DAX_MATRIX_TYPE_ROTATE_AROUND:
-    case DAX_MATRIX_TYPE_TRANSLATE:
-    case DAX_MATRIX_TYPE_SCALE:
-    case DAX_MATRIX_TYPE_SKEW_X:
-    case DAX_MATRIX_TYPE_SKEW_Y:
-    default:
-        g_assert_not_reached ();
-    }
-
-    dax_matrix_from_array (&matrix, result_affine);
-    result = dax_matrix_deep_copy (&matrix);
-    g_value_set_boxed (retval, result);
+    g_value_set_boxed (retval, &result);
 
     return TRUE;
 }
@@ -57,16 +57,20 @@ struct _DaxElementaryMatrix
     float params[3];                            /* up to 3 paramaters */
 };
 
+/* transform lists longer than that are collapsed into a single
+ * DAX_MATRIX_TYPE_GENERIC elementary matrix */
+#define DAX_MATRIX_MAX_ELEMENTARY   8
+
 struct _DaxMatrix
 {
-    volatile gint refcount;
-    GList *elementary_matrices;
     double affine[6];
+    guint n_elementary_matrices;
+    DaxElementaryMatrix elementary_matrices[DAX_MATRIX_MAX_ELEMENTARY];
 };
 
 GType           dax_matrix_get_type         (void) G_GNUC_CONST;
 
-DaxMatrix *     dax_matrix_copy             (DaxMatrix *matrix);
+DaxMatrix *     dax_matrix_copy             (const DaxMatrix *matrix);
 DaxMatrix *     dax_matrix_deep_copy        (const DaxMatrix *matrix);
 void            dax_matrix_free             (DaxMatrix *matrix);
 
@@ -81,6 +85,10 @@ gchar *         dax_matrix_to_string        (const DaxMatrix *matrix);
 void            dax_matrix_transform_point  (const DaxMatrix    *matrix,
                                              const ClutterPoint *point,
                                              ClutterPoint       *out);
+gboolean        dax_matrix_interpolate      (const DaxMatrix *a,
+                                             const DaxMatrix *b,
+                                             gdouble          progress,
+                                             DaxMatrix       *result);
 
 /*
  * Animation types
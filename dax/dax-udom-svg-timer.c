@@ -42,7 +42,8 @@ enum
 
     PROP_DELAY,
     PROP_REPEAT_INTERVAL,
-    PROP_RUNNING
+    PROP_RUNNING,
+    PROP_WHEEL
 };
 
 struct _DaxSvgTimerPrivate
@@ -50,36 +51,35 @@ struct _DaxSvgTimerPrivate
     glong repeat_interval;
     gboolean running;
 
-    glong delay;                /* delay used when the timeout was added */
-    GTimer *elapsed;            /* time elapsed since the timeout was added */
-    guint timeout_id;
+    glong delay;                /* initial delay, used by start() */
+    DaxTimerWheel *wheel;
+    DaxTimerWheelEntry entry;
 };
 
-static gulong
-elapsed_ms (GTimer *timer)
+static DaxTimerWheel *
+dax_svg_timer_get_wheel (DaxSvgTimer *timer)
 {
-    gdouble seconds;
+    DaxSvgTimerPrivate *priv = timer->priv;
 
-    seconds = g_timer_elapsed (timer, NULL);
+    if (priv->wheel == NULL)
+        priv->wheel = dax_timer_wheel_ref (dax_timer_wheel_get_default ());
 
-    return (gulong)(seconds * 1e3);
+    return priv->wheel;
 }
 
-/* priv->delay is the delay till the next wake up */
-static gboolean dax_svg_timer_fire (gpointer data);
 static void
-schedule_next_wake_up (DaxSvgTimer *timer)
+schedule_next_wake_up (DaxSvgTimer *timer,
+                       glong        delay)
 {
     DaxSvgTimerPrivate *priv = timer->priv;
 
-    DAX_NOTE (SCRIPT, "[TIMER] next wake up in %ld ms", priv->delay);
-    g_timer_start (priv->elapsed);
-    priv->timeout_id = g_timeout_add (priv->delay,
-                                      dax_svg_timer_fire,
-                                      timer);
+    DAX_NOTE (SCRIPT, "[TIMER] next wake up in %ld ms", delay);
+    dax_timer_wheel_add (dax_svg_timer_get_wheel (timer),
+                         &priv->entry,
+                         MAX (delay, 0));
 }
 
-static gboolean
+static void
 dax_svg_timer_fire (gpointer data)
 {
     DaxSvgTimer *timer = (DaxSvgTimer *) data;
@@ -87,18 +87,21 @@ dax_svg_timer_fire (gpointer data)
     DaxXmlEventTarget *target = DAX_XML_EVENT_TARGET (timer);
     DaxXmlEvent timer_event;
 
+    g_object_ref (timer);
+
+    /* reschedule before running the handlers so they can stop the timer */
+    if (priv->repeat_interval > 0)
+        schedule_next_wake_up (timer, priv->repeat_interval);
+    else
+        priv->running = FALSE;
+
     dax_xml_event_from_type (&timer_event,
                              DAX_XML_EVENT_TYPE_SVG_TIMER,
                              target);
     dax_xml_event_target_handle_event (target,
                                        dax_xml_event_copy (&timer_event));
 
-    if (priv->repeat_interval > 0) {
-        priv->delay = priv->repeat_interval;
-        schedule_next_wake_up (timer);
-    }
-
-    return FALSE;
+    g_object_unref (timer);
 }
 
 static void
@@ -118,17 +121,12 @@ dax_svg_timer_set_delay (DaxSvgTimer *timer,
         dax_svg_timer_stop (timer);
     } else if (delay == 0) {
         /* 0 means that the event will be triggered as soon as possible */
+        dax_timer_wheel_remove (dax_svg_timer_get_wheel (timer),
+                                &priv->entry);
         dax_svg_timer_fire (timer);
     } else {
-        /* we need to delete the next timer event (if needed)... */
-        if (priv->timeout_id) {
-            g_source_remove (priv->timeout_id);
-            priv->timeout_id = 0;
-        }
-
-        /* ...and schedule the next one */
-        priv->delay = delay;
-        schedule_next_wake_up (timer);
+        /* reschedule the next timer event */
+        schedule_next_wake_up (timer, delay);
     }
 }
 
@@ -138,10 +136,10 @@ dax_svg_timer_get_delay (DaxSvgTimer *timer)
     DaxSvgTimerPrivate *priv = timer->priv;
     glong remaining;
 
-    remaining = priv->delay - elapsed_ms (priv->elapsed);
+    if (!dax_timer_wheel_entry_is_pending (&priv->entry))
+        return priv->delay;
 
-    if (remaining < 0)
-        remaining = 0;
+    remaining = dax_timer_wheel_get_remaining (priv->wheel, &priv->entry);
 
     DAX_NOTE (SCRIPT, "[TIMER] delay is %ld ms", remaining);
 
@@ -202,6 +200,9 @@ dax_svg_timer_get_property (GObject    *object,
     case PROP_RUNNING:
         g_value_set_boolean (value, timer->priv->running);
         break;
+    case PROP_WHEEL:
+        g_value_set_pointer (value, dax_svg_timer_get_wheel (timer));
+        break;
 
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -224,12 +225,33 @@ dax_svg_timer_set_property (GObject      *object,
     case PROP_REPEAT_INTERVAL:
         dax_svg_timer_set_repeat_interval (timer, g_value_get_long (value));
         break;
+    case PROP_WHEEL:
+        if (g_value_get_pointer (value))
+            timer->priv->wheel =
+                dax_timer_wheel_ref (g_value_get_pointer (value));
+        break;
 
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     }
 }
 
+static void
+dax_svg_timer_dispose (GObject *object)
+{
+    DaxSvgTimer *timer = (DaxSvgTimer *) object;
+    DaxSvgTimerPrivate *priv = timer->priv;
+
+    if (priv->wheel) {
+        dax_timer_wheel_remove (priv->wheel, &priv->entry);
+        dax_timer_wheel_unref (priv->wheel);
+        priv->wheel = NULL;
+    }
+    priv->running = FALSE;
+
+    G_OBJECT_CLASS (dax_svg_timer_parent_class)->dispose (object);
+}
+
 static void
 dax_svg_timer_finalize (GObject *object)
 {
@@ -246,6 +268,7 @@ dax_svg_timer_class_init (DaxSvgTimerClass *klass)
 
     object_class->get_property = dax_svg_timer_get_property;
     object_class->set_property = dax_svg_timer_set_property;
+    object_class->dispose = dax_svg_timer_dispose;
     object_class->finalize = dax_svg_timer_finalize;
 
     pspec = g_param_spec_long ("delay",
@@ -270,6 +293,13 @@ dax_svg_timer_class_init (DaxSvgTimerClass *klass)
                                   FALSE,
                                   DAX_GPARAM_READABLE);
     g_object_class_install_property (object_class, PROP_RUNNING, pspec);
+
+    pspec = g_param_spec_pointer ("wheel",
+                                  "wheel",
+                                  "The timer wheel the timer is scheduled on",
+                                  DAX_GPARAM_READWRITE |
+                                  G_PARAM_CONSTRUCT_ONLY);
+    g_object_class_install_property (object_class, PROP_WHEEL, pspec);
 }
 
 static void
@@ -279,7 +309,7 @@ dax_svg_timer_init (DaxSvgTimer *timer)
 
     timer->priv = priv = SVG_TIMER_PRIVATE (timer);
 
-    priv->elapsed = g_timer_new ();
+    dax_timer_wheel_entry_init (&priv->entry, dax_svg_timer_fire, timer);
 }
 
 DaxSvgTimer *
@@ -292,6 +322,27 @@ dax_svg_timer_new (glong initial_interval,
                          NULL);
 }
 
+/**
+ * dax_svg_timer_new_full:
+ * @wheel: the #DaxTimerWheel to schedule the timer on, usually the one of a
+ *   document, see dax_dom_document_get_timer_wheel()
+ * @initial_interval: delay, in ms, before the first event
+ * @repeat_interval: interval, in ms, between two events
+ *
+ * Returns: a new #DaxSvgTimer driven by @wheel
+ */
+DaxSvgTimer *
+dax_svg_timer_new_full (DaxTimerWheel *wheel,
+                        glong          initial_interval,
+                        glong          repeat_interval)
+{
+    return g_object_new (DAX_TYPE_SVG_TIMER,
+                         "wheel", wheel,
+                         "delay", initial_interval,
+                         "repeatInterval", repeat_interval,
+                         NULL);
+}
+
 void
 dax_svg_timer_start (DaxSvgTimer *timer)
 {
@@ -310,7 +361,7 @@ dax_svg_timer_start (DaxSvgTimer *timer)
         priv->delay = priv->repeat_interval;
 
     priv->running = TRUE;
-    schedule_next_wake_up (timer);
+    schedule_next_wake_up (timer, priv->delay);
 }
 
 void
@@ -324,11 +375,9 @@ dax_svg_timer_stop (DaxSvgTimer *timer)
 
     priv = timer->priv;
 
-    if (priv->running)
+    if (!priv->running)
         return;
 
     priv->running = FALSE;
-    g_timer_stop (priv->elapsed);
-    g_source_remove (priv->timeout_id);
-    priv->timeout_id = 0;
+    dax_timer_wheel_remove (dax_svg_timer_get_wheel (timer), &priv->entry);
 }
@@ -25,6 +25,8 @@
 
 #include <glib-object.h>
 
+#include "dax-timer-wheel.h"
+
 G_BEGIN_DECLS
 
 #define DAX_TYPE_SVG_TIMER dax_svg_timer_get_type()
@@ -64,6 +66,9 @@ GType           dax_svg_timer_get_type  (void) G_GNUC_CONST;
 
 DaxSvgTimer *   dax_svg_timer_new       (glong initial_interval,
                                          glong repeat_interval);
+DaxSvgTimer *   dax_svg_timer_new_full  (DaxTimerWheel *wheel,
+                                         glong          initial_interval,
+                                         glong          repeat_interval);
 void            dax_svg_timer_start     (DaxSvgTimer *timer);
 void            dax_svg_timer_stop      (DaxSvgTimer *timer);
 
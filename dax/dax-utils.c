@@ -115,162 +115,244 @@ _dax_utils_parse_simple_float (gchar  **string,
     return TRUE;
 }
 
+/*
+ * Number parsing.
+ *
+ * The significant digits are accumulated in an integer, 8 digits at a time
+ * when the end of the string is known. When that integer fits in a double
+ * and the power of ten is exact (up to 1e22), a single multiplication or
+ * division gives the correctly rounded double. The remaining cases, rare in
+ * SVG documents, go through g_ascii_strtod(). Either way, the result is the
+ * one of (gfloat) g_ascii_strtod().
+ */
+
+static const double powers_of_ten[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define MAX_EXACT_DIGITS    19
+#define MAX_EXACT_MANTISSA  (G_GUINT64_CONSTANT (1) << 53)
+
+/* the 8 bytes of chunk, loaded in little endian order, are digits */
+static inline gboolean
+is_eight_digits (guint64 chunk)
+{
+    return ((chunk & G_GUINT64_CONSTANT (0xF0F0F0F0F0F0F0F0)) |
+            (((chunk + G_GUINT64_CONSTANT (0x0606060606060606)) &
+              G_GUINT64_CONSTANT (0xF0F0F0F0F0F0F0F0)) >> 4)) ==
+           G_GUINT64_CONSTANT (0x3333333333333333);
+}
+
+/* converts 8 digits with 3 multiplications instead of 8 */
+static inline guint32
+parse_eight_digits (guint64 chunk)
+{
+    const guint64 mask = G_GUINT64_CONSTANT (0x000000FF000000FF);
+    const guint64 mul1 = G_GUINT64_CONSTANT (0x000F424000000064);
+    const guint64 mul2 = G_GUINT64_CONSTANT (0x0000271000000001);
+
+    chunk -= G_GUINT64_CONSTANT (0x3030303030303030);
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+
+    return (guint32) chunk;
+}
+
+static inline const gchar *
+scan_digits (const gchar *p,
+             const gchar *end,
+             guint64     *mantissa,
+             gint        *n_digits)
+{
+    guint64 m = *mantissa;
+    const gchar *start = p;
+
+    if (end) {
+        while (end - p >= 8) {
+            guint64 chunk;
+
+            memcpy (&chunk, p, sizeof (chunk));
+            chunk = GUINT64_FROM_LE (chunk);
+            if (!is_eight_digits (chunk))
+                break;
+            m = m * 100000000 + parse_eight_digits (chunk);
+            p += 8;
+        }
+    }
+
+    for (; g_ascii_isdigit (*p); p++)
+        m = m * 10 + (*p - '0');
+
+    *mantissa = m;
+    *n_digits += p - start;
+
+    return p;
+}
+
+/*
+ * _dax_utils_parse_number:
+ * @string: the string to parse, updated to point after the number
+ * @end: the end of the string if known, %NULL otherwise
+ * @number: return location for the number
+ *
+ * Parses a <number>: an optional sign, digits with an optional fractional
+ * part, and an optional exponent. Knowing @end allows to read the digits
+ * 8 by 8.
+ */
 gboolean
-_dax_utils_parse_float (char   **string,
-                        gfloat  *x)
+_dax_utils_parse_number (const gchar **string,
+                         const gchar  *end,
+                         gfloat       *number)
 {
-	char *end, *c;
-	gboolean integer_part = FALSE;
-	gboolean fractional_part = FALSE;
-	gboolean exponent_part = FALSE;
-	gfloat mantissa = 0.0;
-	gfloat exponent = 0.0;
-	gfloat divisor;
-	gboolean mantissa_sign = 1.0;
-	gboolean exponent_sign = 1.0;
-
-	c = *string;
-
-	if (*c == '-') {
-		mantissa_sign = -1.0;
-		c++;
-	} else if (*c == '+')
-		c++;
-
-	if (*c >= '0' && *c <= '9') {
-		integer_part = TRUE;
-		mantissa = *c - '0';
-		c++;
-
-		while (*c >= '0' && *c <= '9') {
-			mantissa = mantissa * 10.0 + *c - '0';
-			c++;
-		}
-	}
-
-
-	if (*c == '.')
-		c++;
-	else if (!integer_part)
-		return FALSE;
-
-	if (*c >= '0' && *c <= '9') {
-		fractional_part = TRUE;
-		mantissa += (*c - '0') * 0.1;
-		divisor = 0.01;
-		c++;
-
-		while (*c >= '0' && *c <= '9') {
-			mantissa += (*c - '0') * divisor;
-			divisor *= 0.1;
-			c++;
-		}
-	}
-
-	if (!fractional_part && !integer_part)
-		return FALSE;
-
-	end = c;
-
-	if (*c == 'E' || *c == 'e') {
-		c++;
-
-		if (*c == '-') {
-			exponent_sign = -1.0;
-			c++;
-		} else if (*c == '+')
-			c++;
-
-		if (*c >= '0' && *c <= '9') {
-			exponent_part = TRUE;
-			exponent = *c - '0';
-			c++;
-
-			while (*c >= '0' && *c <= '9') {
-				exponent = exponent * 10.0 + *c - '0';
-				c++;
-			}
-		}
-	}
-
-	if (exponent_part) {
-		end = c;
-		*x = mantissa_sign * mantissa * pow (10.0, exponent_sign * exponent);
-	} else
-		*x = mantissa_sign * mantissa;
-
-	*string = end;
-
-	return TRUE;
+    const gchar *p = *string, *digits;
+    guint64 mantissa = 0;
+    gint exponent = 0, n_digits = 0;
+    gboolean negative = FALSE, has_digits = FALSE;
+    double value;
+
+    if (*p == '-') {
+        negative = TRUE;
+        p++;
+    } else if (*p == '+') {
+        p++;
+    }
+
+    /* leading zeros are not significant digits */
+    for (; *p == '0'; p++)
+        has_digits = TRUE;
+
+    digits = p;
+    p = scan_digits (p, end, &mantissa, &n_digits);
+    has_digits |= p > digits;
+
+    if (*p == '.') {
+        p++;
+        if (mantissa == 0) {
+            for (; *p == '0'; p++) {
+                exponent--;
+                has_digits = TRUE;
+            }
+        }
+
+        digits = p;
+        p = scan_digits (p, end, &mantissa, &n_digits);
+        exponent -= p - digits;
+        has_digits |= p > digits;
+    }
+
+    if (!has_digits)
+        return FALSE;
+
+    /* only take the 'e' if an exponent follows, "1em" is a length */
+    if (*p == 'e' || *p == 'E') {
+        const gchar *e = p + 1;
+        gint sign = 1, value_e = 0;
+
+        if (*e == '-') {
+            sign = -1;
+            e++;
+        } else if (*e == '+') {
+            e++;
+        }
+
+        if (g_ascii_isdigit (*e)) {
+            for (; g_ascii_isdigit (*e); e++)
+                if (value_e < 10000)
+                    value_e = value_e * 10 + (*e - '0');
+            exponent += sign * value_e;
+            p = e;
+        }
+    }
+
+    if (n_digits <= MAX_EXACT_DIGITS &&
+        mantissa <= MAX_EXACT_MANTISSA &&
+        exponent >= -22 && exponent <= 22)
+    {
+        value = (double) mantissa;
+        if (exponent < 0)
+            value /= powers_of_ten[-exponent];
+        else
+            value *= powers_of_ten[exponent];
+        if (negative)
+            value = -value;
+    } else {
+        value = g_ascii_strtod (*string, NULL);
+    }
+
+    *number = value;
+    *string = p;
+
+    return TRUE;
 }
 
-/* That's a bit restrictive as a definition of an URI but that's the two
- * schemes we want to support anyway */
 gboolean
-_dax_utils_is_iri (const gchar *str)
+_dax_utils_parse_float (char   **string,
+                        gfloat  *x)
 {
-    return g_str_has_prefix (str, "http://") ||
-           g_str_has_prefix (str, "file://");
+    return _dax_utils_parse_number ((const gchar **) string, NULL, x);
 }
 
-static void
-dump_path2d_node (ClutterPath2DNode *node)
+/*
+ * _dax_utils_parse_float_list:
+ * @string: the string to parse, updated to point after the last number
+ *   parsed and the separators following it
+ * @values: the array to fill
+ * @max_values: the size of @values
+ *
+ * Parses a list of numbers separated by white space and/or commas, up to
+ * @max_values of them. The whole string has been parsed if @string points
+ * to '\0' afterwards.
+ *
+ * Return value: the number of values parsed
+ */
+guint
+_dax_utils_parse_float_list (gchar  **string,
+                             gfloat  *values,
+                             guint    max_values)
 {
-  switch (node->type)
+    const gchar *p = *string, *end;
+    guint n_values = 0;
+
+    end = p + strlen (p);
+
+    while (g_ascii_isspace (*p) || *p == ',')
+        p++;
+
+    while (n_values < max_values &&
+           _dax_utils_parse_number (&p, end, &values[n_values]))
     {
-    case CLUTTER_PATH_MOVE_TO:
-      g_print ("M %.2f,%.2f %.2f,%.2f\n", node->points[0].x, node->points[0].y,
-                                          node->points[1].x, node->points[1].y);
-      break;
-    case CLUTTER_PATH_REL_MOVE_TO:
-      g_print ("m %.2f,%.2f %.2f,%.2f\n", node->points[0].x, node->points[0].y,
-                                          node->points[1].x, node->points[1].y);
-      break;
-    case CLUTTER_PATH_LINE_TO:
-      g_print ("L %.2f,%.2f %.2f,%.2f\n", node->points[0].x, node->points[0].y,
-                                          node->points[1].x, node->points[1].y);
-      break;
-    case CLUTTER_PATH_REL_LINE_TO:
-      g_print ("l %.2f,%.2f %.2f,%.2f\n", node->points[0].x, node->points[0].y,
-                                          node->points[1].x, node->points[1].y);
-      break;
-    case CLUTTER_PATH_CURVE_TO:
-      g_print ("C %.2f,%.2f %.2f,%.2f %.2f,%.2f\n",
-               node->points[0].x, node->points[0].y,
-               node->points[1].x, node->points[1].y,
-               node->points[2].x, node->points[2].y);
-      break;
-    case CLUTTER_PATH_REL_CURVE_TO:
-      g_print ("c %.2f,%.2f %.2f,%.2f %.2f,%.2f\n",
-               node->points[0].x, node->points[0].y,
-               node->points[1].x, node->points[1].y,
-               node->points[2].x, node->points[2].y);
-      break;
-    case CLUTTER_PATH_CLOSE:
-      g_print ("z\n");
-      break;
-    default:
-      g_assert_not_reached ();
+        n_values++;
+        while (g_ascii_isspace (*p) || *p == ',')
+            p++;
     }
 
+    *string = (gchar *) p;
+
+    return n_values;
+}
+
+/* That's a bit restrictive as a definition of an URI but that's the two
+ * schemes we want to support anyway */
+gboolean
+_dax_utils_is_iri (const gchar *str)
+{
+    return g_str_has_prefix (str, "http://") ||
+           g_str_has_prefix (str, "https://") ||
+           g_str_has_prefix (str, "file://") ||
+           g_str_has_prefix (str, "data:");
 }
 
 void
-_dax_utils_dump_path_2d (ClutterPath2D *path)
+_dax_utils_dump_path (DaxPath *path)
 {
-  GSList *nodes, *e;
+  gchar *string;
 
   g_message ("path %p", path);
 
-  nodes = clutter_path_2d_get_nodes (path);
-  for (e = nodes; e; e = g_slist_next (e))
-    {
-      ClutterPath2DNode *node = e->data;
-
-      dump_path2d_node (node);
-    }
-
-  g_slist_free (nodes);
+  string = dax_path_to_string (path);
+  g_print ("%s\n", string);
+  g_free (string);
 }
 
 void
@@ -288,6 +370,82 @@ _dax_utils_dump_cogl_matrix (CoglMatrix *m)
              m->wx, m->wy, m->wz, m->ww);
 }
 
+/*
+ * Projects box, in the coordinates given by modelview, to window
+ * coordinates. Returns FALSE if a corner of box is behind the eye, the
+ * window rectangle can't be computed then.
+ */
+gboolean
+_dax_utils_project_box (const CoglMatrix      *modelview,
+                        const CoglMatrix      *projection,
+                        const float           *viewport,
+                        const ClutterActorBox *box,
+                        ClutterActorBox       *window)
+{
+    CoglMatrix matrix;
+    gfloat corners[4][2];
+    guint i;
+
+    cogl_matrix_multiply (&matrix, projection, modelview);
+
+    corners[0][0] = box->x1; corners[0][1] = box->y1;
+    corners[1][0] = box->x2; corners[1][1] = box->y1;
+    corners[2][0] = box->x2; corners[2][1] = box->y2;
+    corners[3][0] = box->x1; corners[3][1] = box->y2;
+
+    for (i = 0; i < 4; i++) {
+        gfloat x = corners[i][0], y = corners[i][1], z = 0, w = 1;
+
+        cogl_matrix_transform_point (&matrix, &x, &y, &z, &w);
+        if (w <= 0)
+            return FALSE;
+
+        /* normalized device coordinates to window coordinates */
+        x = viewport[0] + (x / w + 1) / 2 * viewport[2];
+        y = viewport[1] + (1 - y / w) / 2 * viewport[3];
+
+        if (i == 0) {
+            window->x1 = window->x2 = x;
+            window->y1 = window->y2 = y;
+        } else {
+            window->x1 = MIN (window->x1, x);
+            window->y1 = MIN (window->y1, y);
+            window->x2 = MAX (window->x2, x);
+            window->y2 = MAX (window->y2, y);
+        }
+    }
+
+    return TRUE;
+}
+
+/*
+ * Whether box, in the current cogl coordinates, can touch a pixel of the
+ * viewport. Cogl doesn't tell the clip stack so the viewport is the clip.
+ * Strokes are one pixel wide, a pixel is kept around box for them.
+ */
+gboolean
+_dax_utils_box_is_visible (const ClutterActorBox *box)
+{
+    CoglMatrix modelview, projection;
+    ClutterActorBox window;
+    float viewport[4];
+
+    cogl_get_modelview_matrix (&modelview);
+    cogl_get_projection_matrix (&projection);
+    cogl_get_viewport (viewport);
+
+    if (!_dax_utils_project_box (&modelview, &projection, viewport, box,
+                                 &window))
+    {
+        return TRUE;
+    }
+
+    return window.x2 + 1 >= viewport[0] &&
+           window.y2 + 1 >= viewport[1] &&
+           window.x1 - 1 <= viewport[0] + viewport[2] &&
+           window.y1 - 1 <= viewport[1] + viewport[3];
+}
+
 static void
 install_properties_valist (GObjectClass *klass,
                            _DaxProp      first_property,
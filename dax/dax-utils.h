@@ -24,6 +24,8 @@
 #include <glib.h>
 #include <clutter/clutter.h>
 
+#include "dax-path.h"
+
 G_BEGIN_DECLS
 
 void        _dax_utils_skip_space               (char **str);
@@ -34,11 +36,23 @@ guint       _dax_utils_count_commas             (const gchar *str);
 guint       _dax_utils_count_words              (const gchar *str);
 gboolean    _dax_utils_parse_simple_float       (gchar **string,
                                                  gfloat *number);
+gboolean    _dax_utils_parse_number             (const gchar **string,
+                                                 const gchar  *end,
+                                                 gfloat       *number);
 gboolean    _dax_utils_parse_float              (char   **string,
                                                  gfloat  *x);
+guint       _dax_utils_parse_float_list         (gchar  **string,
+                                                 gfloat  *values,
+                                                 guint    max_values);
 gboolean    _dax_utils_is_iri                   (const gchar *str);
-void        _dax_utils_dump_path_2d             (ClutterPath2D *path);
+void        _dax_utils_dump_path                (DaxPath *path);
 void        _dax_utils_dump_cogl_matrix         (CoglMatrix *m);
+gboolean    _dax_utils_project_box              (const CoglMatrix *modelview,
+                                                 const CoglMatrix *projection,
+                                                 const float      *viewport,
+                                                 const ClutterActorBox *box,
+                                                 ClutterActorBox  *window);
+gboolean    _dax_utils_box_is_visible           (const ClutterActorBox *box);
 
 typedef enum {
     _DAX_PROP_TRANSFORM = 1,
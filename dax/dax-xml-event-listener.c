@@ -24,14 +24,16 @@
 GType
 dax_xml_event_listener_get_type (void)
 {
-    static GType a_type = 0;
-
-    if (G_UNLIKELY (a_type == 0)) {
-        a_type =
-            g_type_register_static_simple (G_TYPE_INTERFACE,
-                                           I_("DaxXmlEventListener"),
-                                           sizeof (DaxXmlEventListenerIface),
-                                           NULL, 0, NULL, 0);
+    static volatile gsize a_type = 0;
+
+    if (g_once_init_enter (&a_type)) {
+        GType type;
+
+        type = g_type_register_static_simple (G_TYPE_INTERFACE,
+                                              I_("DaxXmlEventListener"),
+                                              sizeof (DaxXmlEventListenerIface),
+                                              NULL, 0, NULL, 0);
+        g_once_init_leave (&a_type, type);
     }
 
     return a_type;
@@ -174,18 +174,20 @@ dax_xml_event_target_base_init (gpointer g_iface)
 GType
 dax_xml_event_target_get_type (void)
 {
-    static GType a_type = 0;
+    static volatile gsize a_type = 0;
 
-    if (G_UNLIKELY (a_type == 0)) {
+    if (g_once_init_enter (&a_type)) {
         const GTypeInfo event_target_info = {
             sizeof (DaxXmlEventTargetIface),
             dax_xml_event_target_base_init,
             NULL, /* base_finalize */
         };
+        GType type;
 
-        a_type = g_type_register_static (G_TYPE_INTERFACE,
-                                         I_("DaxXmlEventTarget"),
-                                         &event_target_info, 0);
+        type = g_type_register_static (G_TYPE_INTERFACE,
+                                       I_("DaxXmlEventTarget"),
+                                       &event_target_info, 0);
+        g_once_init_leave (&a_type, type);
     }
 
     return a_type;
@@ -22,7 +22,9 @@
 #define __DAX_H_INSIDE__
 
 #include "dax-actor.h"
+#include "dax-binary.h"
 #include "dax-core.h"
+#include "dax-display-list.h"
 #include "dax-dom-forward.h"
 #include "dax-dom-character-data.h"
 #include "dax-dom-document.h"
@@ -52,10 +54,15 @@
 #include "dax-enum-types.h"
 #include "dax-knot-sequence.h"
 #include "dax-parser.h"
+#include "dax-path.h"
+#include "dax-path-cache.h"
+#include "dax-timer-wheel.h"
 #include "dax-traverser.h"
 #include "dax-traverser-clutter.h"
 #include "dax-traverser-load.h"
+#include "dax-traverser-raster.h"
 #include "dax-types.h"
+#include "dax-udom-svg-timer.h"
 #include "dax-xml-forward.h"
 #include "dax-xml-event.h"
 #include "dax-xml-event-target.h"
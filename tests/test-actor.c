@@ -0,0 +1,501 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include <dax.h>
+#include <dax-shape.h>
+
+/* all the actors of the scene graph, in painting order */
+static GList *
+list_actors (ClutterContainer *container,
+             GList            *list)
+{
+    GList *children, *l;
+
+    children = clutter_container_get_children (container);
+    for (l = children; l; l = l->next) {
+        list = g_list_append (list, l->data);
+        if (CLUTTER_IS_CONTAINER (l->data))
+            list = list_actors (l->data, list);
+    }
+    g_list_free (children);
+
+    return list;
+}
+
+static guint
+count_items (GList *actors)
+{
+    GList *l;
+    guint n_items = 0;
+
+    for (l = actors; l; l = l->next)
+        if (DAX_IS_DISPLAY_LIST (l->data))
+            n_items += dax_display_list_get_n_items (l->data);
+
+    return n_items;
+}
+
+static ClutterActor *
+new_actor (const gchar *file,
+           gboolean     use_display_list)
+{
+    DaxDomDocument *document;
+    ClutterActor *actor;
+
+    document = dax_dom_document_new_from_file (file, NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+
+    actor = dax_actor_new ();
+    g_object_ref_sink (actor);
+    dax_actor_set_use_display_list (DAX_ACTOR (actor), use_display_list);
+    dax_actor_set_document (DAX_ACTOR (actor), document);
+    g_object_unref (document);
+
+    return actor;
+}
+
+/* a static document is drawn by a single actor */
+static void
+test_actor_display_list (void)
+{
+    ClutterActor *actor;
+    GList *actors;
+
+    actor = new_actor ("wild/tiger.svg", FALSE);
+    actors = list_actors (CLUTTER_CONTAINER (actor), NULL);
+    g_assert_cmpuint (g_list_length (actors), >, 400);
+    g_assert_cmpuint (count_items (actors), ==, 0);
+    g_list_free (actors);
+
+    dax_actor_set_use_display_list (DAX_ACTOR (actor), TRUE);
+    actors = list_actors (CLUTTER_CONTAINER (actor), NULL);
+    g_assert_cmpuint (g_list_length (actors), ==, 1);
+    g_assert (DAX_IS_DISPLAY_LIST (actors->data));
+    g_assert_cmpuint (count_items (actors), >, 0);
+    g_assert_cmpuint (count_items (actors), <=, 240);
+    g_list_free (actors);
+
+    clutter_actor_destroy (actor);
+    g_object_unref (actor);
+}
+
+static const char animated[] =
+"<?xml version=\"1.0\"?>\n"
+"<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.2\" "
+     "baseProfile=\"tiny\">\n"
+  "<g transform=\"translate(10, 10)\">\n"
+    "<path d=\"M 0 0 L 10 10 L 0 10 z\" fill=\"red\"/>\n"
+    "<path d=\"M 0 0 L 10 10 L 10 0 z\" fill=\"blue\"/>\n"
+  "</g>\n"
+  "<rect width=\"10\" height=\"10\" fill=\"green\">\n"
+    "<animate attributeName=\"x\" from=\"0\" to=\"100\" dur=\"1s\"/>\n"
+  "</rect>\n"
+  "<circle cx=\"5\" cy=\"5\" r=\"5\" fill=\"black\"/>\n"
+"</svg>";
+
+/* animated elements keep their actors, in the order of the document */
+static void
+test_actor_display_list_dynamic (void)
+{
+    DaxDomDocument *document;
+    ClutterActor *actor;
+    GList *actors;
+
+    document = dax_dom_document_new_from_memory (animated,
+                                                 sizeof (animated) - 1,
+                                                 "file:///", NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+
+    actor = dax_actor_new ();
+    g_object_ref_sink (actor);
+    dax_actor_set_use_display_list (DAX_ACTOR (actor), TRUE);
+    dax_actor_set_document (DAX_ACTOR (actor), document);
+
+    actors = list_actors (CLUTTER_CONTAINER (actor), NULL);
+    g_assert_cmpuint (g_list_length (actors), ==, 3);
+    g_assert (DAX_IS_DISPLAY_LIST (g_list_nth_data (actors, 0)));
+    g_assert_cmpuint (dax_display_list_get_n_items (g_list_nth_data (actors,
+                                                                     0)),
+                      ==, 2);
+    g_assert (CLUTTER_IS_RECTANGLE (g_list_nth_data (actors, 1)));
+    g_assert (DAX_IS_DISPLAY_LIST (g_list_nth_data (actors, 2)));
+    g_assert_cmpuint (dax_display_list_get_n_items (g_list_nth_data (actors,
+                                                                     2)),
+                      ==, 1);
+    g_list_free (actors);
+
+    clutter_actor_destroy (actor);
+    g_object_unref (actor);
+    g_object_unref (document);
+}
+
+#define N_GLYPHS 200
+
+static const char glyph[] =
+    "M 0 0 C 5 -5 15 -5 20 0 C 25 5 25 15 20 20 L 0 20 z";
+
+/* an icon sheet repeating the same glyph tessellates it once */
+static void
+test_actor_path_cache (void)
+{
+    ClutterColor black = { 0x00, 0x00, 0x00, 0xff };
+    ClutterActor *stage, *sheet;
+    DaxPathCacheStats stats;
+    gsize max_size;
+    guint i;
+
+    /* start from an empty cache */
+    max_size = dax_path_cache_get_max_size ();
+    dax_path_cache_set_max_size (0);
+    dax_path_cache_set_max_size (max_size);
+    dax_path_cache_reset_stats ();
+
+    stage = clutter_stage_get_default ();
+    sheet = clutter_group_new ();
+    clutter_container_add_actor (CLUTTER_CONTAINER (stage), sheet);
+
+    for (i = 0; i < N_GLYPHS; i++) {
+        ClutterActor *shape = dax_shape_new ();
+        DaxPath *path = dax_path_new_from_string (glyph);
+
+        g_object_set (shape, "path", path, "color", &black, NULL);
+        g_object_unref (path);
+        clutter_actor_set_position (shape, (i % 20) * 25, (i / 20) * 25);
+        clutter_container_add_actor (CLUTTER_CONTAINER (sheet), shape);
+    }
+
+    clutter_actor_show (stage);
+    clutter_redraw (CLUTTER_STAGE (stage));
+
+    dax_path_cache_get_stats (&stats);
+    g_assert_cmpuint (stats.misses, ==, 1);
+    g_assert_cmpuint (stats.hits, ==, N_GLYPHS - 1);
+    g_assert_cmpuint (stats.n_entries, ==, 1);
+
+    /* the geometry no shape uses is dropped when over the cap */
+    clutter_actor_destroy (sheet);
+    dax_path_cache_get_stats (&stats);
+    g_assert_cmpuint (stats.n_entries, ==, 1);
+
+    dax_path_cache_set_max_size (0);
+    dax_path_cache_get_stats (&stats);
+    g_assert_cmpuint (stats.n_entries, ==, 0);
+    g_assert_cmpuint (stats.evictions, ==, 1);
+    g_assert_cmpuint (stats.size, ==, 0);
+
+    dax_path_cache_set_max_size (max_size);
+}
+
+/* a static group is painted from its texture while a sibling changes */
+static void
+test_actor_group_cache (void)
+{
+    ClutterColor red = { 0xff, 0x00, 0x00, 0xff };
+    ClutterColor blue = { 0x00, 0x00, 0xff, 0xff };
+    ClutterActor *stage, *group, *rectangle, *sibling;
+    DaxGroupCacheStats stats;
+    gsize max_size;
+
+    if (!cogl_features_available (COGL_FEATURE_OFFSCREEN))
+        return;
+
+    stage = clutter_stage_get_default ();
+    group = dax_group_new ();
+    dax_group_set_cache_mode (DAX_GROUP (group), DAX_GROUP_CACHE_ALWAYS);
+    rectangle = clutter_rectangle_new_with_color (&red);
+    clutter_actor_set_size (rectangle, 50, 50);
+    clutter_container_add_actor (CLUTTER_CONTAINER (group), rectangle);
+    sibling = clutter_rectangle_new_with_color (&red);
+    clutter_actor_set_position (sibling, 100, 0);
+    clutter_actor_set_size (sibling, 50, 50);
+    clutter_container_add (CLUTTER_CONTAINER (stage), group, sibling, NULL);
+    clutter_actor_show (stage);
+
+    dax_group_reset_cache_stats ();
+    clutter_redraw (CLUTTER_STAGE (stage));
+    clutter_redraw (CLUTTER_STAGE (stage));
+    dax_group_get_cache_stats (&stats);
+    g_assert_cmpuint (stats.renders, ==, 1);
+    g_assert_cmpuint (stats.hits, ==, 1);
+    g_assert_cmpuint (stats.n_textures, ==, 1);
+
+    /* changing a sibling doesn't touch the texture */
+    clutter_rectangle_set_color (CLUTTER_RECTANGLE (sibling), &blue);
+    clutter_redraw (CLUTTER_STAGE (stage));
+    dax_group_get_cache_stats (&stats);
+    g_assert_cmpuint (stats.renders, ==, 1);
+    g_assert_cmpuint (stats.hits, ==, 2);
+
+    /* changing a child renders it again */
+    clutter_rectangle_set_color (CLUTTER_RECTANGLE (rectangle), &blue);
+    clutter_redraw (CLUTTER_STAGE (stage));
+    dax_group_get_cache_stats (&stats);
+    g_assert_cmpuint (stats.invalidations, ==, 1);
+    g_assert_cmpuint (stats.renders, ==, 2);
+
+    /* shrinking the budget drops the texture */
+    max_size = dax_group_get_cache_max_size ();
+    dax_group_set_cache_max_size (0);
+    dax_group_get_cache_stats (&stats);
+    g_assert_cmpuint (stats.n_textures, ==, 0);
+    g_assert_cmpuint (stats.size, ==, 0);
+    clutter_redraw (CLUTTER_STAGE (stage));
+    dax_group_get_cache_stats (&stats);
+    g_assert_cmpuint (stats.n_textures, ==, 0);
+    dax_group_set_cache_max_size (max_size);
+
+    clutter_actor_destroy (group);
+    clutter_actor_destroy (sibling);
+    dax_group_get_cache_stats (&stats);
+    g_assert_cmpuint (stats.n_textures, ==, 0);
+    g_assert_cmpuint (stats.size, ==, 0);
+}
+
+static void
+on_paint (ClutterActor *actor,
+          guint        *n_paints)
+{
+    (*n_paints)++;
+}
+
+static ClutterActor *
+new_glyph_shape (void)
+{
+    ClutterColor black = { 0x00, 0x00, 0x00, 0xff };
+    ClutterActor *shape;
+    DaxPath *path;
+
+    shape = dax_shape_new ();
+    path = dax_path_new_from_string (glyph);
+    g_object_set (shape, "path", path, "color", &black, NULL);
+    g_object_unref (path);
+
+    return shape;
+}
+
+/* a shape looks its geometry up the first time it is drawn */
+static guint
+count_lookups (void)
+{
+    DaxPathCacheStats stats;
+
+    dax_path_cache_get_stats (&stats);
+
+    return stats.hits + stats.misses;
+}
+
+/* shapes and groups scrolled out of the stage aren't drawn */
+static void
+test_actor_culling (void)
+{
+    ClutterActor *stage, *group, *shape, *hidden;
+    guint n_paints = 0, n_hidden_paints = 0;
+
+    dax_path_cache_reset_stats ();
+
+    stage = clutter_stage_get_default ();
+    clutter_actor_set_size (stage, 640, 480);
+    group = dax_group_new ();
+    shape = new_glyph_shape ();
+    g_signal_connect (shape, "paint", G_CALLBACK (on_paint), &n_paints);
+    hidden = new_glyph_shape ();
+    clutter_actor_set_position (hidden, 1000, 0);
+    g_signal_connect (hidden, "paint", G_CALLBACK (on_paint),
+                      &n_hidden_paints);
+    clutter_container_add (CLUTTER_CONTAINER (group), shape, hidden, NULL);
+    clutter_container_add_actor (CLUTTER_CONTAINER (stage), group);
+    clutter_actor_show (stage);
+
+    /* the group is in view, the shape outside of the stage isn't drawn */
+    clutter_redraw (CLUTTER_STAGE (stage));
+    g_assert_cmpuint (n_paints, ==, 1);
+    g_assert_cmpuint (n_hidden_paints, ==, 1);
+    g_assert_cmpuint (count_lookups (), ==, 1);
+
+    clutter_actor_set_position (hidden, 100, 100);
+    clutter_redraw (CLUTTER_STAGE (stage));
+    g_assert_cmpuint (count_lookups (), ==, 2);
+
+    /* the group moves away, its children aren't even painted */
+    clutter_actor_set_position (group, -1000, 0);
+    clutter_redraw (CLUTTER_STAGE (stage));
+    g_assert_cmpuint (n_paints, ==, 2);
+    g_assert_cmpuint (n_hidden_paints, ==, 2);
+
+    /* a child moves back in view, the bounds of the group follow */
+    clutter_actor_set_position (shape, 1100, 100);
+    clutter_redraw (CLUTTER_STAGE (stage));
+    g_assert_cmpuint (n_paints, ==, 3);
+
+    /* a pixel is kept around the bounds for the strokes */
+    clutter_actor_set_position (group, 0, 0);
+    clutter_actor_set_position (shape, 640.5, 0);
+    clutter_redraw (CLUTTER_STAGE (stage));
+    g_assert_cmpuint (n_paints, ==, 4);
+
+    clutter_actor_destroy (group);
+}
+
+static const char hit_test[] =
+"<?xml version=\"1.0\"?>\n"
+"<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.2\" "
+     "baseProfile=\"tiny\">\n"
+  "<path id=\"triangle\" d=\"M 0 0 L 150 0 L 0 150 z\" fill=\"red\"/>\n"
+  "<rect id=\"square\" x=\"50\" y=\"50\" width=\"50\" height=\"50\" "
+        "fill=\"blue\"/>\n"
+  "<g transform=\"translate(200, 0)\">\n"
+    "<path id=\"ring\" d=\"M 0 0 H 100 V 100 H 0 Z "
+                          "M 25 25 H 75 V 75 H 25 Z\" fill=\"green\"/>\n"
+  "</g>\n"
+"</svg>";
+
+static void
+assert_element_at (ClutterActor *actor,
+                   gfloat        x,
+                   gfloat        y,
+                   const gchar  *id)
+{
+    DaxDomElement *element;
+
+    element = dax_actor_get_element_at_position (DAX_ACTOR (actor), x, y);
+    if (id == NULL) {
+        g_assert (element == NULL);
+        return;
+    }
+
+    g_assert (DAX_IS_DOM_ELEMENT (element));
+    g_assert_cmpstr (dax_dom_element_get_id (element), ==, id);
+}
+
+/* the element under a point is found without painting */
+static void
+test_actor_hit_test (void)
+{
+    DaxDomDocument *document;
+    DaxDomElement *square;
+    ClutterActor *stage, *actor;
+
+    document = dax_dom_document_new_from_memory (hit_test,
+                                                 sizeof (hit_test) - 1,
+                                                 "file:///", NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+
+    stage = clutter_stage_get_default ();
+    actor = dax_actor_new ();
+    dax_actor_set_document (DAX_ACTOR (actor), document);
+    clutter_container_add_actor (CLUTTER_CONTAINER (stage), actor);
+    clutter_actor_show (stage);
+    clutter_redraw (CLUTTER_STAGE (stage));
+
+    assert_element_at (actor, 10, 10, "triangle");
+    assert_element_at (actor, 140, 40, NULL);
+    /* the rectangle is on top of the triangle */
+    assert_element_at (actor, 60, 60, "square");
+    assert_element_at (actor, 60, 40, "triangle");
+    /* through the transform of the group, the hole is empty */
+    assert_element_at (actor, 210, 10, "ring");
+    assert_element_at (actor, 250, 50, NULL);
+
+    dax_actor_set_geometric_picking (DAX_ACTOR (actor), TRUE);
+    g_assert (clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                              CLUTTER_PICK_REACTIVE,
+                                              250, 50) == actor);
+    /* the document has no size, only what is drawn is picked */
+    g_assert (clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                              CLUTTER_PICK_REACTIVE,
+                                              350, 50) != actor);
+
+    /* the actors follow the attributes set from script */
+    square = dax_dom_document_get_element_by_id (document, "square");
+    dax_dom_element_set_attribute (square, "x", "320", NULL);
+    clutter_redraw (CLUTTER_STAGE (stage));
+    assert_element_at (actor, 60, 60, "triangle");
+    assert_element_at (actor, 330, 60, "square");
+
+    clutter_actor_destroy (actor);
+    g_object_unref (document);
+}
+
+static void
+time_frames (const gchar *file,
+             gboolean     use_display_list)
+{
+    ClutterActor *stage, *actor;
+    GList *actors;
+    gdouble elapsed;
+    guint i, n_actors, n_frames = 100;
+
+    stage = clutter_stage_get_default ();
+    actor = new_actor (file, use_display_list);
+    clutter_container_add_actor (CLUTTER_CONTAINER (stage), actor);
+    clutter_actor_show (stage);
+
+    actors = list_actors (CLUTTER_CONTAINER (actor), NULL);
+    n_actors = g_list_length (actors);
+    g_list_free (actors);
+
+    /* the first frame builds the cogl paths */
+    clutter_redraw (CLUTTER_STAGE (stage));
+
+    g_test_timer_start ();
+    for (i = 0; i < n_frames; i++)
+        clutter_redraw (CLUTTER_STAGE (stage));
+    elapsed = g_test_timer_elapsed ();
+
+    g_test_minimized_result (elapsed / n_frames * 1000,
+                             "%s, %s: %u actors, %.2f ms per frame", file,
+                             use_display_list ? "display list" : "actors",
+                             n_actors, elapsed / n_frames * 1000);
+
+    clutter_actor_destroy (actor);
+    g_object_unref (actor);
+}
+
+static void
+test_actor_perf_display_list (void)
+{
+    time_frames ("wild/tiger.svg", FALSE);
+    time_frames ("wild/tiger.svg", TRUE);
+    time_frames ("wild/lion.svg", FALSE);
+    time_frames ("wild/lion.svg", TRUE);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+    dax_init (&argc, &argv);
+
+    g_test_add_func ("/actor/display-list", test_actor_display_list);
+    g_test_add_func ("/actor/display-list/dynamic",
+                     test_actor_display_list_dynamic);
+    g_test_add_func ("/actor/path-cache", test_actor_path_cache);
+    g_test_add_func ("/actor/group-cache", test_actor_group_cache);
+    g_test_add_func ("/actor/culling", test_actor_culling);
+    g_test_add_func ("/actor/hit-test", test_actor_hit_test);
+
+    if (g_test_perf ())
+        g_test_add_func ("/actor/perf/display-list",
+                         test_actor_perf_display_list);
+
+    return g_test_run ();
+}
@@ -0,0 +1,555 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <dax.h>
+
+#define N_PERF_IMAGES       24
+#define PERF_IMAGE_SIZE     512
+
+static void
+test_cache_dedup (void)
+{
+    DaxCache *cache;
+    DaxCacheEntry *a, *b, *c;
+    DaxCacheStats stats;
+
+    cache = dax_cache_new ();
+
+    a = dax_cache_get_entry_for_uri (cache, "file:///tmp/dax/image.png");
+    b = dax_cache_get_entry_for_uri (cache, "file:///tmp/dax/./image.png");
+    c = dax_cache_get_entry_for_uri (cache, "FILE:///tmp/dax/../dax/image.png");
+    g_assert (DAX_IS_CACHE_ENTRY (a));
+    g_assert (a == b);
+    g_assert (a == c);
+
+    dax_cache_get_stats (cache, &stats);
+    g_assert_cmpuint (stats.misses, ==, 1);
+    g_assert_cmpuint (stats.hits, ==, 2);
+    g_assert_cmpuint (stats.n_entries, ==, 1);
+    g_assert_cmpuint (stats.size, ==, dax_cache_entry_get_size (a));
+
+    g_object_unref (a);
+    g_object_unref (b);
+    g_object_unref (c);
+    g_object_unref (cache);
+}
+
+static void
+test_cache_href (void)
+{
+    DaxDomDocument *document;
+    DaxDomElement *image;
+    DaxCache *cache;
+    DaxCacheEntry *a, *b;
+
+    document = dax_dom_document_new_from_file ("09_05.svg", NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+    image = dax_dom_document_get_document_element (document);
+
+    cache = dax_cache_new ();
+
+    a = dax_cache_get_entry_for_href (cache, image, "externalImage.png");
+    b = dax_cache_get_entry_for_href (cache, image, "./externalImage.png");
+    g_assert (a == b);
+    g_assert (g_str_has_suffix (dax_cache_entry_get_uri (a),
+                                "/externalImage.png"));
+
+    g_object_unref (a);
+    g_object_unref (b);
+    g_object_unref (cache);
+    g_object_unref (document);
+}
+
+static void
+test_cache_eviction (void)
+{
+    DaxCache *cache;
+    DaxCacheEntry *used, *unused;
+    DaxCacheStats stats;
+
+    cache = dax_cache_new ();
+
+    used = dax_cache_get_entry_for_uri (cache, "file:///tmp/dax/used.png");
+    unused = dax_cache_get_entry_for_uri (cache, "file:///tmp/dax/unused.png");
+    g_object_unref (unused);
+
+    /* only the entry nobody references anymore can go away */
+    dax_cache_set_max_size (cache, 1);
+
+    dax_cache_get_stats (cache, &stats);
+    g_assert_cmpuint (stats.evictions, ==, 1);
+    g_assert_cmpuint (stats.n_entries, ==, 1);
+    g_assert_cmpuint (stats.size, ==, dax_cache_entry_get_size (used));
+
+    /* asking for it again is a miss */
+    unused = dax_cache_get_entry_for_uri (cache, "file:///tmp/dax/unused.png");
+    dax_cache_get_stats (cache, &stats);
+    g_assert_cmpuint (stats.misses, ==, 3);
+
+    g_object_unref (unused);
+    g_object_unref (used);
+    g_object_unref (cache);
+}
+
+static void
+test_cache_outlive (void)
+{
+    DaxCache *cache;
+    DaxCacheEntry *entry;
+
+    cache = dax_cache_new ();
+    entry = dax_cache_get_entry_for_uri (cache, "file:///tmp/dax/image.png");
+    g_assert (dax_cache_entry_get_cache (entry) == cache);
+
+    /* the entry forgets the cache it belonged to */
+    g_object_unref (cache);
+    g_assert (dax_cache_entry_get_cache (entry) == NULL);
+    dax_cache_entry_set_uri (entry, "file:///tmp/dax/other.png");
+
+    g_object_unref (entry);
+}
+
+static void
+on_pixbuf_notify (DaxCacheEntry *entry,
+                  GParamSpec    *pspec,
+                  GMainLoop     *loop)
+{
+    g_main_loop_quit (loop);
+}
+
+static void
+test_cache_decode (void)
+{
+    DaxDomDocument *document;
+    DaxDomElement *svg;
+    DaxCache *cache;
+    DaxCacheEntry *entry;
+    GdkPixbuf *pixbuf;
+    GMainLoop *loop;
+    gsize size;
+
+    document = dax_dom_document_new_from_file ("09_05.svg", NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+    svg = dax_dom_document_get_document_element (document);
+
+    cache = dax_cache_new ();
+    entry = dax_cache_get_entry_for_href (cache, svg, "externalImage.png");
+    g_assert (dax_cache_entry_is_ready (entry));
+    g_assert (!dax_cache_entry_is_decoded (entry));
+    size = dax_cache_entry_get_size (entry);
+
+    /* decoded in the background, delivered in the main loop */
+    loop = g_main_loop_new (NULL, FALSE);
+    g_signal_connect (entry, "notify::pixbuf",
+                      G_CALLBACK (on_pixbuf_notify), loop);
+    dax_cache_entry_decode_image (entry);
+    if (!dax_cache_entry_is_decoded (entry))
+        g_main_loop_run (loop);
+
+    pixbuf = dax_cache_entry_get_pixbuf (entry);
+    g_assert (GDK_IS_PIXBUF (pixbuf));
+    g_assert_cmpint (gdk_pixbuf_get_width (pixbuf), ==, 100);
+    g_assert_cmpint (gdk_pixbuf_get_height (pixbuf), ==, 100);
+
+    /* the decoded pixels are accounted for in the cache */
+    g_assert_cmpuint (dax_cache_entry_get_size (entry), >=,
+                      size + 100 * 100 * 3);
+    g_assert_cmpuint (dax_cache_get_size (cache), ==,
+                      dax_cache_entry_get_size (entry));
+
+    /* and shared with synchronous users */
+    g_assert (dax_cache_entry_decode_image_sync (entry, NULL) == pixbuf);
+
+    g_main_loop_unref (loop);
+    g_object_unref (entry);
+    g_object_unref (cache);
+    g_object_unref (document);
+}
+
+static void
+test_cache_decode_sync (void)
+{
+    DaxDomDocument *document;
+    DaxDomElement *svg;
+    DaxCache *cache;
+    DaxCacheEntry *entry;
+
+    document = dax_dom_document_new_from_file ("09_05.svg", NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+    svg = dax_dom_document_get_document_element (document);
+
+    cache = dax_cache_new ();
+    dax_cache_set_decoding_threads (cache, 0);
+
+    entry = dax_cache_get_entry_for_href (cache, svg, "externalImage.png");
+    dax_cache_entry_decode_image (entry);
+    g_assert (dax_cache_entry_is_decoded (entry));
+    g_assert (GDK_IS_PIXBUF (dax_cache_entry_get_pixbuf (entry)));
+
+    g_object_unref (entry);
+    g_object_unref (cache);
+    g_object_unref (document);
+}
+
+static void
+test_cache_data_uri (void)
+{
+    DaxCache *cache;
+    DaxCacheEntry *text, *image;
+    GByteArray *data;
+    GdkPixbuf *pixbuf;
+    gchar *png, *base64, *uri;
+    gsize png_len;
+
+    cache = dax_cache_new ();
+
+    /* percent-encoded */
+    text = dax_cache_get_entry_for_uri (cache, "data:,Hello%2C%20World!");
+    g_assert (dax_cache_entry_is_ready (text));
+    data = dax_cache_entry_get_data (text);
+    g_assert_cmpuint (data->len, ==, 13);
+    g_assert (memcmp (data->data, "Hello, World!", 13) == 0);
+
+    /* escaped NUL bytes are part of the data */
+    g_object_unref (text);
+    text = dax_cache_get_entry_for_uri (cache, "data:,a%00b%00");
+    g_assert (dax_cache_entry_is_ready (text));
+    data = dax_cache_entry_get_data (text);
+    g_assert_cmpuint (data->len, ==, 4);
+    g_assert (memcmp (data->data, "a\0b\0", 4) == 0);
+
+    /* base64, decoded in memory, no temporary file */
+    g_assert (g_file_get_contents ("externalImage.png", &png, &png_len, NULL));
+    base64 = g_base64_encode ((const guchar *) png, png_len);
+    uri = g_strconcat ("data:image/png;base64,", base64, NULL);
+
+    image = dax_cache_get_entry_for_uri (cache, uri);
+    g_assert (dax_cache_entry_is_ready (image));
+    g_assert (dax_cache_entry_get_local_uri (image) == NULL);
+    data = dax_cache_entry_get_data (image);
+    g_assert_cmpuint (data->len, ==, png_len);
+    g_assert (memcmp (data->data, png, png_len) == 0);
+
+    pixbuf = dax_cache_entry_decode_image_sync (image, NULL);
+    g_assert (GDK_IS_PIXBUF (pixbuf));
+    g_assert_cmpint (gdk_pixbuf_get_width (pixbuf), ==, 100);
+
+    /* malformed */
+    g_object_unref (text);
+    text = dax_cache_get_entry_for_uri (cache, "data:image/png;base64");
+    g_assert (!dax_cache_entry_is_ready (text));
+    g_assert (dax_cache_entry_has_failed (text));
+
+    g_free (uri);
+    g_free (base64);
+    g_free (png);
+    g_object_unref (text);
+    g_object_unref (image);
+    g_object_unref (cache);
+}
+
+/* A stand-in for a remote server: test-server://host/name is fetched from
+ * the served directory with the GIO fetcher */
+static gchar *served_dir;
+
+static gboolean
+test_server_can_fetch (const DaxCacheFetcher *fetcher,
+                       const gchar           *uri)
+{
+    return g_str_has_prefix (uri, "test-server://");
+}
+
+static void
+test_server_fetch (const DaxCacheFetcher *fetcher,
+                   DaxCacheEntry         *entry,
+                   const gchar           *uri)
+{
+    gchar *path, *file_uri;
+
+    path = g_build_filename (served_dir, strrchr (uri, '/') + 1, NULL);
+    file_uri = g_filename_to_uri (path, NULL, NULL);
+
+    dax_cache_fetcher_gio.fetch (&dax_cache_fetcher_gio, entry, file_uri);
+
+    g_free (file_uri);
+    g_free (path);
+}
+
+static const DaxCacheFetcher test_server_fetcher =
+{
+    "test-server",
+    test_server_can_fetch,
+    test_server_fetch
+};
+
+static void
+on_ready_notify (DaxCacheEntry *entry,
+                 GParamSpec    *pspec,
+                 GMainLoop     *loop)
+{
+    g_main_loop_quit (loop);
+}
+
+static void
+remove_directory (const gchar *path)
+{
+    const gchar *name;
+    GDir *dir;
+
+    dir = g_dir_open (path, 0, NULL);
+    if (dir == NULL)
+        return;
+
+    while ((name = g_dir_read_name (dir))) {
+        gchar *child = g_build_filename (path, name, NULL);
+
+        if (g_file_test (child, G_FILE_TEST_IS_DIR))
+            remove_directory (child);
+        else
+            g_unlink (child);
+        g_free (child);
+    }
+    g_dir_close (dir);
+    g_rmdir (path);
+}
+
+static void
+test_cache_fetcher (void)
+{
+    DaxCache *cache;
+    DaxCacheEntry *entry;
+    GMainLoop *loop;
+    gchar *png, *served, *cache_dir, *local_path, *content;
+    gsize png_len, len;
+
+    served_dir = g_strdup_printf ("%s/dax-served-%d", g_get_tmp_dir (),
+                                  (gint) getpid ());
+    cache_dir = g_strdup_printf ("%s/dax-cache-%d", g_get_tmp_dir (),
+                                 (gint) getpid ());
+    g_assert (g_mkdir_with_parents (served_dir, 0700) == 0);
+
+    g_assert (g_file_get_contents ("externalImage.png", &png, &png_len, NULL));
+    served = g_build_filename (served_dir, "image.png", NULL);
+    g_assert (g_file_set_contents (served, png, png_len, NULL));
+
+    /* first time, the content is fetched asynchronously and stored in the
+     * on-disk cache */
+    cache = dax_cache_new ();
+    dax_cache_set_directory (cache, cache_dir);
+    dax_cache_add_fetcher (cache, &test_server_fetcher);
+
+    loop = g_main_loop_new (NULL, FALSE);
+    entry = dax_cache_get_entry_for_uri (cache, "test-server://host/image.png");
+    g_signal_connect (entry, "notify::ready",
+                      G_CALLBACK (on_ready_notify), loop);
+    if (!dax_cache_entry_is_ready (entry))
+        g_main_loop_run (loop);
+    g_assert (dax_cache_entry_is_ready (entry));
+
+    local_path = dax_cache_entry_get_local_path (entry);
+    g_assert (g_str_has_prefix (local_path, cache_dir));
+    g_assert (g_file_get_contents (local_path, &content, &len, NULL));
+    g_assert_cmpuint (len, ==, png_len);
+    g_assert (memcmp (content, png, len) == 0);
+    g_free (content);
+    g_free (local_path);
+
+    g_object_unref (entry);
+    g_object_unref (cache);
+
+    /* second time, with the server gone, it's found on disk right away */
+    g_unlink (served);
+
+    cache = dax_cache_new ();
+    dax_cache_set_directory (cache, cache_dir);
+    dax_cache_add_fetcher (cache, &test_server_fetcher);
+
+    entry = dax_cache_get_entry_for_uri (cache, "test-server://host/image.png");
+    g_assert (dax_cache_entry_is_ready (entry));
+    g_assert (GDK_IS_PIXBUF (dax_cache_entry_decode_image_sync (entry, NULL)));
+
+    g_object_unref (entry);
+    g_object_unref (cache);
+
+    remove_directory (cache_dir);
+    remove_directory (served_dir);
+    g_main_loop_unref (loop);
+    g_free (served);
+    g_free (png);
+    g_free (cache_dir);
+    g_free (served_dir);
+}
+
+/* Writes n noisy PNG files in dir and returns a document drawing them */
+static GString *
+create_image_document (const gchar *dir,
+                       const gchar *prefix,
+                       guint        n,
+                       GPtrArray   *files)
+{
+    GdkPixbuf *pixbuf;
+    GString *svg;
+    guchar *pixels;
+    gint x, y, rowstride;
+    guint i;
+
+    svg = g_string_new ("<?xml version=\"1.0\"?>\n"
+                        "<svg xmlns=\"http://www.w3.org/2000/svg\" "
+                        "xmlns:xlink=\"http://www.w3.org/1999/xlink\" "
+                        "version=\"1.2\" baseProfile=\"tiny\" "
+                        "width=\"800\" height=\"600\">\n"
+                        "<rect x=\"0\" y=\"0\" width=\"800\" "
+                        "height=\"600\" fill=\"gray\"/>\n");
+
+    pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, FALSE, 8,
+                             PERF_IMAGE_SIZE, PERF_IMAGE_SIZE);
+    pixels = gdk_pixbuf_get_pixels (pixbuf);
+    rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+
+    for (i = 0; i < n; i++) {
+        gchar *name, *path, *uri;
+
+        for (y = 0; y < PERF_IMAGE_SIZE; y++)
+            for (x = 0; x < PERF_IMAGE_SIZE * 3; x++)
+                pixels[y * rowstride + x] = g_random_int_range (0, 256);
+
+        name = g_strdup_printf ("dax-perf-%d-%s-%02u.png",
+                                (gint) getpid (), prefix, i);
+        path = g_build_filename (dir, name, NULL);
+        g_assert (gdk_pixbuf_save (pixbuf, path, "png", NULL, NULL));
+
+        uri = g_filename_to_uri (path, NULL, NULL);
+        g_string_append_printf (svg,
+                                "<image x=\"%u\" y=\"%u\" width=\"100\" "
+                                "height=\"100\" xlink:href=\"%s\"/>\n",
+                                (i % 8) * 100, (i / 8) * 100, uri);
+
+        g_ptr_array_add (files, path);
+        g_free (uri);
+        g_free (name);
+    }
+    g_string_append (svg, "</svg>");
+
+    g_object_unref (pixbuf);
+
+    return svg;
+}
+
+/* Time to first frame is the time before the scene can be built from the
+ * document, images showing up when decoded */
+static void
+load_image_document (const GString *svg,
+                     guint          n_threads,
+                     gdouble       *first_frame,
+                     gdouble       *fully_loaded)
+{
+    DaxDomDocument *document;
+    DaxDomElement *root;
+
+    dax_cache_set_decoding_threads (dax_cache_get_default (), n_threads);
+
+    g_test_timer_start ();
+
+    document = dax_dom_document_new_from_memory (svg->str, svg->len,
+                                                 "file:///", NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+    root = dax_dom_document_get_document_element (document);
+    *first_frame = g_test_timer_elapsed ();
+
+    while (!dax_dom_element_is_loaded (root))
+        g_main_context_iteration (NULL, TRUE);
+    *fully_loaded = g_test_timer_elapsed ();
+
+    g_object_unref (document);
+}
+
+static void
+test_cache_perf_first_frame (void)
+{
+    GString *sync_svg, *threaded_svg;
+    GPtrArray *files;
+    gdouble first_frame, fully_loaded;
+    guint threads, i;
+
+    /* two sets of files, so the second run doesn't find decoded images in
+     * the cache */
+    files = g_ptr_array_new ();
+    sync_svg = create_image_document (g_get_tmp_dir (), "sync",
+                                      N_PERF_IMAGES, files);
+    threaded_svg = create_image_document (g_get_tmp_dir (), "threaded",
+                                          N_PERF_IMAGES, files);
+
+    load_image_document (sync_svg, 0, &first_frame, &fully_loaded);
+    g_test_minimized_result (first_frame,
+                             "synchronous decoding, first frame: %.1f ms",
+                             first_frame * 1000);
+    g_test_minimized_result (fully_loaded,
+                             "synchronous decoding, fully loaded: %.1f ms",
+                             fully_loaded * 1000);
+
+    threads = dax_cache_get_decoding_threads (dax_cache_get_default ());
+    load_image_document (threaded_svg, MAX (threads, 1),
+                         &first_frame, &fully_loaded);
+    g_test_minimized_result (first_frame,
+                             "%u decoding threads, first frame: %.1f ms",
+                             MAX (threads, 1), first_frame * 1000);
+    g_test_minimized_result (fully_loaded,
+                             "%u decoding threads, fully loaded: %.1f ms",
+                             MAX (threads, 1), fully_loaded * 1000);
+
+    dax_cache_set_decoding_threads (dax_cache_get_default (), threads);
+
+    for (i = 0; i < files->len; i++) {
+        g_unlink (g_ptr_array_index (files, i));
+        g_free (g_ptr_array_index (files, i));
+    }
+    g_ptr_array_free (files, TRUE);
+    g_string_free (sync_svg, TRUE);
+    g_string_free (threaded_svg, TRUE);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+    g_thread_init (NULL);
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+    dax_init_headless (&argc, &argv);
+
+    g_test_add_func ("/cache/dedup", test_cache_dedup);
+    g_test_add_func ("/cache/href", test_cache_href);
+    g_test_add_func ("/cache/eviction", test_cache_eviction);
+    g_test_add_func ("/cache/outlive", test_cache_outlive);
+    g_test_add_func ("/cache/decode", test_cache_decode);
+    g_test_add_func ("/cache/decode-sync", test_cache_decode_sync);
+    g_test_add_func ("/cache/data-uri", test_cache_data_uri);
+    g_test_add_func ("/cache/fetcher", test_cache_fetcher);
+
+    if (g_test_perf ())
+        g_test_add_func ("/cache/perf/first-frame",
+                         test_cache_perf_first_frame);
+
+    return g_test_run ();
+}
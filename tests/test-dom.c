@@ -117,6 +117,343 @@ test_document_get_element_by_id (void)
                      "bar");
 }
 
+static const char text_font[] =
+"<?xml version=\"1.0\"?>\n"
+"<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.2\" "
+     "baseProfile=\"tiny\">\n"
+  "<text font-family=\"Sans\" font-size=\"12\">foo</text>\n"
+"</svg>";
+
+/* string properties set by the parser are interned in the document, the
+ * ones set later are copies, both have to outlive the document */
+static void
+test_element_strings (void)
+{
+    DaxDomDocument *document;
+    DaxDomElement *svg;
+    DaxDomNode *text;
+    gchar *font_family, *font_size;
+
+    document = dax_dom_document_new_from_memory (text_font,
+                                                 sizeof (text_font) - 1,
+                                                 NULL,
+                                                 NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+    svg = dax_dom_document_get_document_element (document);
+    text = dax_dom_node_get_first_child (DAX_DOM_NODE (svg));
+    while (text && !DAX_IS_ELEMENT_TEXT (text))
+        text = dax_dom_node_get_next_sibling (text);
+    g_assert (DAX_IS_ELEMENT_TEXT (text));
+
+    g_object_set (text, "font-family", "Serif", NULL);
+    g_object_set (text, "font-family", "Monospace", NULL);
+
+    g_object_ref (text);
+    g_object_unref (document);
+
+    g_object_get (text,
+                  "font-family", &font_family,
+                  "font-size", &font_size,
+                  NULL);
+    g_assert_cmpstr (font_family, ==, "Monospace");
+    g_assert_cmpstr (font_size, ==, "12");
+    g_free (font_family);
+    g_free (font_size);
+
+    g_object_unref (text);
+}
+
+/* an element defined by the application */
+typedef DaxElement TestElementFoo;
+typedef DaxElementClass TestElementFooClass;
+
+G_DEFINE_TYPE (TestElementFoo, test_element_foo, DAX_TYPE_ELEMENT)
+
+static void
+test_element_foo_class_init (TestElementFooClass *klass)
+{
+}
+
+static void
+test_element_foo_init (TestElementFoo *self)
+{
+}
+
+static const char custom_element[] =
+"<?xml version=\"1.0\"?>\n"
+"<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.2\" "
+     "baseProfile=\"tiny\">\n"
+  "<foo xml:id=\"foo\"/>\n"
+  "<rect xml:id=\"rect\" width=\"10\" height=\"10\"/>\n"
+"</svg>";
+
+static void
+test_document_register_element (void)
+{
+    DaxDomDocument *document;
+    DaxDomElement *element;
+
+    g_assert (dax_document_lookup_element ("rect") == DAX_TYPE_ELEMENT_RECT);
+    g_assert (dax_document_lookup_element ("foo") == G_TYPE_INVALID);
+
+    dax_document_register_element ("foo", test_element_foo_get_type ());
+    g_assert (dax_document_lookup_element ("foo") ==
+              test_element_foo_get_type ());
+
+    document = dax_dom_document_new_from_memory (custom_element,
+                                                 sizeof (custom_element) - 1,
+                                                 "file:///",
+                                                 NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+
+    element = dax_dom_document_get_element_by_id (document, "foo");
+    g_assert (G_TYPE_CHECK_INSTANCE_TYPE (element,
+                                          test_element_foo_get_type ()));
+    element = dax_dom_document_get_element_by_id (document, "rect");
+    g_assert (DAX_IS_ELEMENT_RECT (element));
+
+    g_object_unref (document);
+}
+
+static const char siblings[] =
+"<?xml version=\"1.0\"?>\n"
+"<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.2\" "
+     "baseProfile=\"tiny\">\n"
+  "<g xml:id=\"g\"><rect xml:id=\"a\" width=\"10\" height=\"10\"/></g>\n"
+  "<rect xml:id=\"b\" width=\"10\" height=\"10\"/>\n"
+"</svg>";
+
+typedef struct
+{
+    guint n_inserted;
+    guint n_removed;
+    DaxDomNode *former_parent;
+} MutationCount;
+
+static void
+on_node_inserted (DaxDomDocument *document,
+                  DaxDomNode     *node,
+                  MutationCount  *count)
+{
+    count->n_inserted++;
+}
+
+static void
+on_node_removed (DaxDomDocument *document,
+                 DaxDomNode     *node,
+                 DaxDomNode     *former_parent,
+                 MutationCount  *count)
+{
+    count->n_removed++;
+    count->former_parent = former_parent;
+}
+
+static void
+test_dom_node_mutation (void)
+{
+    DaxDomDocument *document;
+    DaxDomNode *svg, *g, *a, *b, *node;
+    MutationCount count = { 0, };
+    GError *error = NULL;
+
+    document = dax_dom_document_new_from_memory (siblings,
+                                                 sizeof (siblings) - 1,
+                                                 "file:///", NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+    svg = DAX_DOM_NODE (dax_dom_document_get_document_element (document));
+    g = DAX_DOM_NODE (dax_dom_document_get_element_by_id (document, "g"));
+    a = DAX_DOM_NODE (dax_dom_document_get_element_by_id (document, "a"));
+    b = DAX_DOM_NODE (dax_dom_document_get_element_by_id (document, "b"));
+
+    g_signal_connect (document, "node-inserted",
+                      G_CALLBACK (on_node_inserted), &count);
+    g_signal_connect (document, "node-removed",
+                      G_CALLBACK (on_node_removed), &count);
+
+    /* removing gives the reference of the tree to the caller */
+    node = dax_dom_node_remove_child (svg, b, &error);
+    g_assert_no_error (error);
+    g_assert (node == b);
+    g_assert (b->parent_node == NULL);
+    g_assert (b->previous_sibling == NULL);
+    g_assert (svg->last_child == g);
+    g_assert (g->next_sibling == NULL);
+    g_assert_cmpuint (count.n_removed, ==, 1);
+    g_assert (count.former_parent == svg);
+
+    /* and inserting takes it back */
+    node = dax_dom_node_insert_before (svg, b, g, &error);
+    g_assert_no_error (error);
+    g_assert (node == b);
+    g_assert (svg->first_child == b);
+    g_assert (b->next_sibling == g);
+    g_assert (g->previous_sibling == b);
+    g_assert_cmpuint (count.n_inserted, ==, 1);
+
+    /* a node already in the tree is moved, the tree still takes over the
+     * reference of the caller */
+    g_object_ref (b);
+    dax_dom_node_insert_before (g, b, a, &error);
+    g_assert_no_error (error);
+    g_assert (b->parent_node == g);
+    g_assert (svg->first_child == g);
+    g_assert (g->first_child == b);
+    g_assert (b->next_sibling == a);
+    g_assert (a->previous_sibling == b);
+    g_assert_cmpuint (count.n_removed, ==, 2);
+    g_assert_cmpuint (count.n_inserted, ==, 2);
+
+    /* errors */
+    node = dax_dom_node_remove_child (svg, a, &error);
+    g_assert (node == NULL);
+    g_assert_error (error,
+                    DAX_DOM_EXCEPTION_ERROR,
+                    DAX_DOM_EXCEPTION_ERROR_NOT_FOUND);
+    g_clear_error (&error);
+
+    node = dax_dom_node_insert_before (svg, a, b, &error);
+    g_assert (node == NULL);
+    g_assert_error (error,
+                    DAX_DOM_EXCEPTION_ERROR,
+                    DAX_DOM_EXCEPTION_ERROR_NOT_FOUND);
+    g_clear_error (&error);
+
+    node = dax_dom_node_append_child (g, svg, &error);
+    g_assert (node == NULL);
+    g_assert_error (error,
+                    DAX_DOM_EXCEPTION_ERROR,
+                    DAX_DOM_EXCEPTION_ERROR_HIERARCHY_REQUEST);
+    g_clear_error (&error);
+
+    g_assert_cmpuint (count.n_removed, ==, 2);
+    g_assert_cmpuint (count.n_inserted, ==, 2);
+
+    g_object_unref (document);
+}
+
+/*
+ * Mutations of a displayed document only touch the actors of the nodes
+ * inserted or removed
+ */
+
+typedef struct
+{
+    guint n_added;
+    guint n_removed;
+    ClutterActor *added;
+} ActorCount;
+
+static void
+on_actor_added (ClutterContainer *container,
+                ClutterActor     *actor,
+                ActorCount       *count)
+{
+    count->n_added++;
+    count->added = actor;
+}
+
+static void
+on_actor_removed (ClutterContainer *container,
+                  ClutterActor     *actor,
+                  ActorCount       *count)
+{
+    count->n_removed++;
+}
+
+/* all the actors of the scene graph, in painting order */
+static GList *
+list_actors (ClutterContainer *container,
+             GList            *list,
+             ActorCount       *count)
+{
+    GList *children, *l;
+
+    if (count) {
+        g_signal_connect (container, "actor-added",
+                          G_CALLBACK (on_actor_added), count);
+        g_signal_connect (container, "actor-removed",
+                          G_CALLBACK (on_actor_removed), count);
+    }
+
+    children = clutter_container_get_children (container);
+    for (l = children; l; l = l->next) {
+        list = g_list_append (list, l->data);
+        if (CLUTTER_IS_CONTAINER (l->data))
+            list = list_actors (l->data, list, count);
+    }
+    g_list_free (children);
+
+    return list;
+}
+
+static DaxDomNode *
+find_nested_path (DaxDomNode *node)
+{
+    DaxDomNode *child, *path;
+
+    for (child = node->first_child; child; child = child->next_sibling) {
+        if (DAX_IS_ELEMENT_PATH (child) && DAX_IS_ELEMENT_G (node))
+            return child;
+        path = find_nested_path (child);
+        if (path)
+            return path;
+    }
+
+    return NULL;
+}
+
+static void
+test_dom_mutation_actor (void)
+{
+    ClutterActor *actor;
+    DaxDomDocument *document;
+    DaxDomNode *svg, *path, *parent, *next;
+    ActorCount count = { 0, };
+    GList *before, *after, *l, *m;
+    guint n_different = 0;
+
+    document = dax_dom_document_new_from_file ("wild/tiger.svg", NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+    actor = dax_actor_new ();
+    g_object_ref_sink (actor);
+    dax_actor_set_document (DAX_ACTOR (actor), document);
+    svg = DAX_DOM_NODE (dax_dom_document_get_document_element (document));
+
+    path = find_nested_path (svg);
+    g_assert (path);
+    parent = path->parent_node;
+    next = path->next_sibling;
+
+    before = list_actors (CLUTTER_CONTAINER (actor), NULL, &count);
+    g_assert_cmpuint (g_list_length (before), >, 100);
+
+    /* removing the path only destroys its actor */
+    dax_dom_node_remove_child (parent, path, NULL);
+    g_assert_cmpuint (count.n_removed, ==, 1);
+    g_assert_cmpuint (count.n_added, ==, 0);
+
+    /* putting it back only builds one actor, at the same place */
+    dax_dom_node_insert_before (parent, path, next, NULL);
+    g_assert_cmpuint (count.n_removed, ==, 1);
+    g_assert_cmpuint (count.n_added, ==, 1);
+
+    after = list_actors (CLUTTER_CONTAINER (actor), NULL, NULL);
+    g_assert_cmpuint (g_list_length (after), ==, g_list_length (before));
+    for (l = before, m = after; l && m; l = l->next, m = m->next) {
+        if (l->data == m->data)
+            continue;
+        g_assert (m->data == count.added);
+        n_different++;
+    }
+    g_assert_cmpuint (n_different, ==, 1);
+
+    g_list_free (before);
+    g_list_free (after);
+    clutter_actor_destroy (actor);
+    g_object_unref (actor);
+    g_object_unref (document);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -127,8 +464,13 @@ main (int   argc,
 
     g_test_add_func ("/dom/node", test_dom_node);
     g_test_add_func ("/dom/text", test_dom_text);
+    g_test_add_func ("/dom/node/mutation", test_dom_node_mutation);
+    g_test_add_func ("/dom/node/mutation/actor", test_dom_mutation_actor);
     g_test_add_func ("/dom/document/getElementById",
                      test_document_get_element_by_id);
+    g_test_add_func ("/dom/element/strings", test_element_strings);
+    g_test_add_func ("/dom/document/register-element",
+                     test_document_register_element);
 
     return g_test_run ();
 }
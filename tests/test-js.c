@@ -79,6 +79,133 @@ test(DaxTestJSFixture *fix,
     g_assert_cmpint (retval, ==, TRUE);
 }
 
+static const gchar *const handler_args[] = { "event", NULL };
+
+static void
+test_compiled_function (void)
+{
+    DaxJsContext *context;
+    DaxJsFunction *function;
+    DaxJsFunctionListener *listener;
+    DaxDomElement *target;
+    DaxXmlEvent event;
+    GError *error = NULL;
+    gpointer alive;
+    gint retval;
+
+    context = dax_js_context_new ();
+    dax_js_context_eval (context, "var total = 0;", -1, "test-js", NULL, NULL);
+
+    listener = dax_js_function_listener_new_from_code (context,
+                                                       "total += 1;");
+    g_assert (DAX_IS_JS_FUNCTION_LISTENER (listener));
+
+    /* compiling does not run anything */
+    dax_js_context_eval (context, "total", -1, "test-js", &retval, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (retval, ==, 0);
+
+    target = dax_element_rect_new ();
+    dax_xml_event_from_type (&event, DAX_XML_EVENT_TYPE_LOAD,
+                             DAX_XML_EVENT_TARGET (target));
+    dax_xml_event_listener_handle_event (DAX_XML_EVENT_LISTENER (listener),
+                                         &event);
+    dax_xml_event_listener_handle_event (DAX_XML_EVENT_LISTENER (listener),
+                                         &event);
+    dax_js_context_eval (context, "total", -1, "test-js", &retval, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (retval, ==, 2);
+
+    /* a syntax error gives no function */
+    function = dax_js_context_compile_function (context,
+                                                "broken",
+                                                handler_args,
+                                                "total += ;",
+                                                "test-js");
+    g_assert (function == NULL);
+    g_assert (dax_js_function_listener_new_from_code (context,
+                                                      "total += ;") == NULL);
+
+    /* the listener keeps its context alive */
+    alive = context;
+    g_object_add_weak_pointer (G_OBJECT (context), &alive);
+    g_object_unref (context);
+    g_assert (alive != NULL);
+    dax_xml_event_listener_handle_event (DAX_XML_EVENT_LISTENER (listener),
+                                         &event);
+    g_object_unref (listener);
+    g_assert (alive == NULL);
+
+    g_object_unref (event.any.target);
+    g_object_unref (target);
+}
+
+#define N_HANDLER_RUNS  10000
+
+static const gchar handler_body[] =
+    "var angle = (total * 2 * Math.PI) / 360;"
+    "total += Math.round (100 * Math.cos (angle));";
+
+static void
+test_perf_handler (void)
+{
+    DaxJsContext *context;
+    DaxJsFunctionListener *listener;
+    DaxDomElement *target;
+    DaxXmlEvent event;
+    gchar *script;
+    gdouble eval_time, compile_time, call_time;
+    gint i;
+
+    context = dax_js_context_new ();
+    dax_js_context_eval (context, "var total = 0;", -1, "test-js", NULL, NULL);
+
+    /* what the handlers used to do: evaluate the source before each call */
+    script = g_strdup_printf ("function __dax_handler(event) {%s}",
+                              handler_body);
+    g_test_timer_start ();
+    for (i = 0; i < N_HANDLER_RUNS; i++) {
+        dax_js_context_eval (context, script, -1, "test-js", NULL, NULL);
+        dax_js_context_call_function (context, "__dax_handler", "i", i);
+    }
+    eval_time = g_test_timer_elapsed ();
+    g_free (script);
+
+    g_test_timer_start ();
+    for (i = 0; i < N_HANDLER_RUNS; i++) {
+        listener = dax_js_function_listener_new_from_code (context,
+                                                           handler_body);
+        g_object_unref (listener);
+    }
+    compile_time = g_test_timer_elapsed ();
+
+    /* what they do now: call the listener compiled once */
+    target = dax_element_rect_new ();
+    dax_xml_event_from_type (&event, DAX_XML_EVENT_TYPE_LOAD,
+                             DAX_XML_EVENT_TARGET (target));
+    listener = dax_js_function_listener_new_from_code (context, handler_body);
+    g_test_timer_start ();
+    for (i = 0; i < N_HANDLER_RUNS; i++)
+        dax_xml_event_listener_handle_event (DAX_XML_EVENT_LISTENER (listener),
+                                             &event);
+    call_time = g_test_timer_elapsed ();
+    g_object_unref (listener);
+    g_object_unref (event.any.target);
+    g_object_unref (target);
+
+    g_test_minimized_result (eval_time * 1e6 / N_HANDLER_RUNS,
+                             "eval + call: %.2f us/event",
+                             eval_time * 1e6 / N_HANDLER_RUNS);
+    g_test_minimized_result (compile_time * 1e6 / N_HANDLER_RUNS,
+                             "compile: %.2f us/handler",
+                             compile_time * 1e6 / N_HANDLER_RUNS);
+    g_test_minimized_result (call_time * 1e6 / N_HANDLER_RUNS,
+                             "compiled call: %.2f us/event",
+                             call_time * 1e6 / N_HANDLER_RUNS);
+
+    g_object_unref (context);
+}
+
 gint
 main(gint    argc,
      gchar **argv)
@@ -116,5 +243,9 @@ main(gint    argc,
     }
     g_dir_close(dir);
 
+    g_test_add_func ("/js/compiled-function", test_compiled_function);
+    if (g_test_perf ())
+        g_test_add_func ("/js/perf/handler", test_perf_handler);
+
     return g_test_run ();
 }
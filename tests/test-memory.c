@@ -0,0 +1,198 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <glib.h>
+
+#include <dax.h>
+
+static gsize n_allocs;
+static gsize live_bytes;
+
+#ifdef __GLIBC__
+
+/*
+ * GLib ignores g_mem_set_vtable() since 2.46 and GSlice ends up in malloc()
+ * too, so the C library allocator is wrapped instead. The functions below
+ * take precedence over the ones of the C library for the whole process and
+ * forward to the glibc implementation.
+ */
+
+#define CAN_COUNT_ALLOCATIONS
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t n_members, size_t size);
+extern void *__libc_realloc (void *mem, size_t size);
+extern void *__libc_memalign (size_t alignment, size_t size);
+extern void __libc_free (void *mem);
+
+static void *
+count_alloc (void *mem)
+{
+    if (mem) {
+        n_allocs++;
+        live_bytes += malloc_usable_size (mem);
+    }
+
+    return mem;
+}
+
+void *
+malloc (size_t size)
+{
+    return count_alloc (__libc_malloc (size));
+}
+
+void *
+calloc (size_t n_members,
+        size_t size)
+{
+    return count_alloc (__libc_calloc (n_members, size));
+}
+
+void *
+realloc (void   *mem,
+         size_t  size)
+{
+    gsize old_size = mem ? malloc_usable_size (mem) : 0;
+    void *new_mem;
+
+    new_mem = __libc_realloc (mem, size);
+    if (new_mem) {
+        live_bytes -= old_size;
+        live_bytes += malloc_usable_size (new_mem);
+        if (mem == NULL)
+            n_allocs++;
+    } else if (size == 0) {
+        live_bytes -= old_size;
+    }
+
+    return new_mem;
+}
+
+void *
+memalign (size_t alignment,
+          size_t size)
+{
+    return count_alloc (__libc_memalign (alignment, size));
+}
+
+int
+posix_memalign (void   **mem,
+                size_t   alignment,
+                size_t   size)
+{
+    *mem = count_alloc (__libc_memalign (alignment, size));
+
+    return *mem ? 0 : ENOMEM;
+}
+
+void
+free (void *mem)
+{
+    if (mem == NULL)
+        return;
+
+    live_bytes -= malloc_usable_size (mem);
+    __libc_free (mem);
+}
+
+#endif /* __GLIBC__ */
+
+static guint
+count_nodes (DaxDomNode *root)
+{
+    DaxDomNode *node = root;
+    guint n_nodes = 0;
+
+    while (node) {
+        n_nodes++;
+
+        if (node->first_child) {
+            node = node->first_child;
+            continue;
+        }
+
+        while (node != root && node->next_sibling == NULL)
+            node = node->parent_node;
+        if (node == root)
+            break;
+        node = node->next_sibling;
+    }
+
+    return n_nodes;
+}
+
+static void
+test_perf_bytes_per_node (void)
+{
+    DaxDomDocument *document;
+    gsize allocs_before, bytes_before, load_allocs, load_bytes;
+    guint n_nodes;
+
+    /* a first load initializes the classes and interned strings */
+    document = dax_dom_document_new_from_file ("wild/tiger.svg", NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+    g_object_unref (document);
+
+    allocs_before = n_allocs;
+    bytes_before = live_bytes;
+
+    document = dax_dom_document_new_from_file ("wild/tiger.svg", NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+
+    load_allocs = n_allocs - allocs_before;
+    load_bytes = live_bytes - bytes_before;
+    n_nodes = count_nodes (DAX_DOM_NODE (document));
+
+    g_object_unref (document);
+
+    g_test_minimized_result ((gdouble) load_bytes / n_nodes,
+                             "tiger: %u nodes, %.1f bytes and %.1f "
+                             "allocations per node, %" G_GSIZE_FORMAT
+                             " bytes left after unref",
+                             n_nodes,
+                             (gdouble) load_bytes / n_nodes,
+                             (gdouble) load_allocs / n_nodes,
+                             live_bytes - bytes_before);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+    /* GSlice would hide the allocations in its magazines */
+    g_setenv ("G_SLICE", "always-malloc", TRUE);
+
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+    dax_init (&argc, &argv);
+
+#ifdef CAN_COUNT_ALLOCATIONS
+    if (g_test_perf ())
+        g_test_add_func ("/memory/perf/bytes-per-node",
+                         test_perf_bytes_per_node);
+#endif
+
+    return g_test_run ();
+}
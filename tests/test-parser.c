@@ -18,10 +18,13 @@
  * along with this library. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <fcntl.h>
 #include <math.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #include <dax.h>
 
@@ -137,8 +140,9 @@ test_path (void)
 {
     DaxDomDocument *document;
     DaxDomNode *svg, *path;
-    ClutterPath2D *clutter_path;
-    ClutterPath2DNode node;
+    DaxPath *dax_path;
+    const guint8 *verbs;
+    const gfloat *coords;
 
     document = dax_dom_document_new_from_file ("08_01.svg", NULL);
     g_assert (DAX_IS_DOM_DOCUMENT (document));
@@ -147,22 +151,22 @@ test_path (void)
 
     path = dax_dom_node_get_last_child (svg);
     g_assert (DAX_IS_ELEMENT_PATH (path));
-    clutter_path = dax_element_path_get_path (DAX_ELEMENT_PATH (path));
-    g_assert (clutter_path_2d_get_n_nodes (clutter_path) == 4);
-    clutter_path_2d_get_node (clutter_path, 0, &node);
-    g_assert (node.type == CLUTTER_PATH_MOVE_TO);
-    g_assert_cmpint (node.points[0].x, ==, 100);
-    g_assert_cmpint (node.points[0].y, ==, 100);
-    clutter_path_2d_get_node (clutter_path, 1, &node);
-    g_assert (node.type == CLUTTER_PATH_LINE_TO);
-    g_assert_cmpint (node.points[0].x, ==, 300);
-    g_assert_cmpint (node.points[0].y, ==, 100);
-    clutter_path_2d_get_node (clutter_path, 2, &node);
-    g_assert (node.type == CLUTTER_PATH_LINE_TO);
-    g_assert_cmpint (node.points[0].x, ==, 200);
-    g_assert_cmpint (node.points[0].y, ==, 300);
-    clutter_path_2d_get_node (clutter_path, 3, &node);
-    g_assert (node.type == CLUTTER_PATH_CLOSE);
+    dax_path = dax_element_path_get_path (DAX_ELEMENT_PATH (path));
+    g_assert_cmpuint (dax_path_get_n_verbs (dax_path), ==, 4);
+    g_assert_cmpuint (dax_path_get_n_coords (dax_path), ==, 6);
+    verbs = dax_path_get_verbs (dax_path);
+    coords = dax_path_get_coords (dax_path);
+    g_assert (verbs[0] == DAX_PATH_MOVE_TO);
+    g_assert_cmpint (coords[0], ==, 100);
+    g_assert_cmpint (coords[1], ==, 100);
+    g_assert (verbs[1] == DAX_PATH_LINE_TO);
+    g_assert_cmpint (coords[2], ==, 300);
+    g_assert_cmpint (coords[3], ==, 100);
+    g_assert (verbs[2] == DAX_PATH_LINE_TO);
+    g_assert_cmpint (coords[4], ==, 200);
+    g_assert_cmpint (coords[5], ==, 300);
+    g_assert (verbs[3] == DAX_PATH_CLOSE);
+    g_object_unref (dax_path);
 }
 
 static void
@@ -711,6 +715,633 @@ test_transform (void)
     dax_matrix_free (matrix);
 }
 
+static void
+on_notify (GObject    *object,
+           GParamSpec *pspec,
+           gint       *count)
+{
+    (*count)++;
+}
+
+static void
+test_attribute_notify (void)
+{
+    DaxDomDocument *document;
+    DaxDomElement *rect;
+    ClutterUnits *units;
+    gint x_count = 0, y_count = 0, opacity_count = 0, any_count = 0;
+
+    document = dax_document_new ();
+    rect = dax_dom_document_create_element (document, "rect", NULL);
+    g_assert (DAX_IS_ELEMENT_RECT (rect));
+
+    /* nobody listens yet */
+    dax_dom_element_set_attribute (rect, "x", "  5", NULL);
+    g_object_get (rect, "x", &units, NULL);
+    g_assert_cmpfloat (clutter_units_get_unit_value (units), ==, 5.0f);
+    clutter_units_free (units);
+
+    g_signal_connect (rect, "notify::x", G_CALLBACK (on_notify), &x_count);
+    g_signal_connect (rect, "notify::y", G_CALLBACK (on_notify), &y_count);
+
+    dax_dom_element_set_attribute (rect, "x", "10", NULL);
+    g_object_get (rect, "x", &units, NULL);
+    g_assert_cmpfloat (clutter_units_get_unit_value (units), ==, 10.0f);
+    clutter_units_free (units);
+    g_assert_cmpint (x_count, ==, 1);
+    g_assert_cmpint (y_count, ==, 0);
+
+    /* inherited properties go through the same table */
+    dax_dom_element_set_attribute (rect, "fill-opacity", "0.5", NULL);
+    dax_dom_element_set_attribute (rect, "y", "3", NULL);
+    g_assert_cmpint (x_count, ==, 1);
+    g_assert_cmpint (y_count, ==, 1);
+
+    /* unknown attributes are ignored */
+    dax_dom_element_set_attribute (rect, "unknown", "3", NULL);
+
+    /* detailed handlers are called for properties set directly too */
+    g_signal_connect (rect, "notify::fill-opacity", G_CALLBACK (on_notify),
+                      &opacity_count);
+    g_object_set (rect, "fill-opacity", 0.25f, NULL);
+    g_assert_cmpint (opacity_count, ==, 1);
+    g_assert_cmpint (x_count, ==, 1);
+
+    /* and so are the handlers without detail */
+    g_signal_connect (rect, "notify", G_CALLBACK (on_notify), &any_count);
+    g_object_set (rect, "fill-opacity", 0.5f, NULL);
+    g_assert_cmpint (any_count, ==, 1);
+    dax_dom_element_set_attribute (rect, "x", "1", NULL);
+    g_assert_cmpint (any_count, ==, 2);
+    g_assert_cmpint (x_count, ==, 2);
+
+    g_object_unref (document);
+}
+
+static const gchar progressive[] =
+"<?xml version=\"1.0\"?>\n"
+"<!DOCTYPE svg [\n"
+  "<!ENTITY size \"20\">\n"
+"]>\n"
+"<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.2\" "
+     "baseProfile=\"tiny\" width=\"100\" height=\"100\">\n"
+  "<title>Progressive</title>\n"
+  "<rect x=\"10\" y=\"10\" width=\"&size;\" height=\"20\"/>\n"
+  "<g>\n"
+    "<circle cx=\"50\" cy=\"50\" r=\"10\"/>\n"
+    "<rect x=\"60\" y=\"60\" width=\"5\" height=\"5\"/>\n"
+  "</g>\n"
+"</svg>";
+
+typedef struct
+{
+    GPtrArray *elements;
+    gsize fed;                  /* number of bytes fed when emitted */
+    gsize at[3];
+} ProgressiveData;
+
+static void
+on_element_parsed (DaxParser       *parser,
+                   DaxDomElement   *element,
+                   ProgressiveData *data)
+{
+    if (data->elements->len < G_N_ELEMENTS (data->at))
+        data->at[data->elements->len] = data->fed;
+    g_ptr_array_add (data->elements, element);
+}
+
+static void
+test_progressive (void)
+{
+    DaxParser *parser;
+    DaxDomDocument *document;
+    DaxDomNode *svg, *node;
+    ClutterUnits *units;
+    ProgressiveData data;
+    GError *error = NULL;
+    gsize len = sizeof (progressive) - 1, chunk;
+    guint i;
+
+    data.elements = g_ptr_array_new ();
+    data.fed = 0;
+
+    parser = dax_parser_new ("file:///");
+    g_signal_connect (parser, "element-parsed",
+                      G_CALLBACK (on_element_parsed), &data);
+
+    /* feed small chunks to cut tags and text in the middle */
+    while (data.fed < len) {
+        chunk = MIN (7, len - data.fed);
+        g_assert (dax_parser_feed (parser, progressive + data.fed, chunk,
+                                   NULL));
+        data.fed += chunk;
+    }
+
+    /* <title>, <rect> and <g> are emitted, not the children of <g> */
+    g_assert_cmpuint (data.elements->len, ==, 3);
+
+    /* and they are emitted before the end of the document */
+    for (i = 0; i < data.elements->len; i++)
+        g_assert_cmpuint (data.at[i], <, len);
+    g_assert_cmpuint (data.at[0], <, data.at[1]);
+    g_assert_cmpuint (data.at[1], <, data.at[2]);
+
+    g_assert (dax_parser_end (parser, NULL));
+    g_assert_cmpuint (data.elements->len, ==, 3);
+
+    /* the resulting tree is the same as the non progressive one */
+    document = dax_parser_get_document (parser);
+    svg = DAX_DOM_NODE (dax_dom_document_get_document_element (document));
+    g_assert (DAX_IS_ELEMENT_SVG (svg));
+
+    node = dax_dom_node_get_first_child (svg);
+    g_assert (DAX_IS_ELEMENT_TITLE (node));
+    g_assert (node == g_ptr_array_index (data.elements, 0));
+    g_assert (DAX_IS_DOM_TEXT (dax_dom_node_get_first_child (node)));
+
+    node = dax_dom_node_get_next_sibling (node);
+    g_assert (DAX_IS_ELEMENT_RECT (node));
+    g_assert (node == g_ptr_array_index (data.elements, 1));
+    g_object_get (node, "x", &units, NULL);
+    g_assert_cmpfloat (clutter_units_get_unit_value (units), ==, 10.0f);
+    clutter_units_free (units);
+    /* the entities of the internal subset are substituted */
+    g_object_get (node, "width", &units, NULL);
+    g_assert_cmpfloat (clutter_units_get_unit_value (units), ==, 20.0f);
+    clutter_units_free (units);
+
+    node = dax_dom_node_get_next_sibling (node);
+    g_assert (DAX_IS_ELEMENT_G (node));
+    g_assert (node == g_ptr_array_index (data.elements, 2));
+    g_assert (DAX_IS_ELEMENT_CIRCLE (dax_dom_node_get_first_child (node)));
+    g_assert (dax_dom_node_get_next_sibling (node) == NULL);
+
+    /* ill-formed documents are reported */
+    g_object_unref (parser);
+    parser = dax_parser_new ("file:///");
+    g_assert (!dax_parser_feed (parser, "<svg><rect></svg>", -1, &error));
+    g_assert (g_error_matches (error, DAX_PARSER_ERROR,
+                               DAX_PARSER_ERROR_INVALID_XML));
+    g_clear_error (&error);
+    g_object_unref (parser);
+
+    g_ptr_array_free (data.elements, TRUE);
+}
+
+static const gchar transformed[] =
+"<?xml version=\"1.0\"?>\n"
+"<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.2\" "
+     "baseProfile=\"tiny\">\n"
+  "<rect transform=\"translate(12.5 -3.25)\" width=\"5\" height=\"5\"/>\n"
+"</svg>";
+
+/* finds the bytes of the matrix described by @transform in the precompiled
+ * document @daxb and gives it more elementary matrices than it can hold */
+static void
+corrupt_matrix (const gchar *daxb,
+                const gchar *transform)
+{
+    DaxMatrix matrix;
+    gchar *contents;
+    gsize length, i;
+    guint *n_elementary_matrices = NULL;
+
+    g_assert (dax_matrix_from_string (&matrix, transform));
+    g_assert (g_file_get_contents (daxb, &contents, &length, NULL));
+
+    for (i = 0; i + sizeof (DaxMatrix) <= length; i += 8) {
+        if (memcmp (contents + i, matrix.affine, sizeof (matrix.affine)))
+            continue;
+        n_elementary_matrices = (guint *)
+            (contents + i + G_STRUCT_OFFSET (DaxMatrix, n_elementary_matrices));
+        break;
+    }
+    g_assert (n_elementary_matrices);
+
+    *n_elementary_matrices = DAX_MATRIX_MAX_ELEMENTARY + 1;
+    g_assert (g_file_set_contents (daxb, contents, length, NULL));
+    g_free (contents);
+}
+
+/* parse @filename, save it precompiled and load it back */
+static DaxDomDocument *
+load_precompiled (const gchar *filename)
+{
+    DaxDomDocument *document;
+    GError *error = NULL;
+    gchar *daxb;
+
+    document = dax_dom_document_new_from_file (filename, NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+
+    daxb = g_build_filename (g_get_tmp_dir (), "dax-test-parser.daxb", NULL);
+    g_assert (dax_dom_document_save_binary (document, daxb, &error));
+    g_assert_no_error (error);
+    g_object_unref (document);
+
+    document = dax_dom_document_new_from_file (daxb, &error);
+    g_assert_no_error (error);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+
+    g_unlink (daxb);
+    g_free (daxb);
+
+    return document;
+}
+
+static void
+test_binary (void)
+{
+    DaxDomDocument *document;
+    DaxDomNode *svg, *node;
+    DaxKnotSequence *seq;
+    DaxPath *path;
+    DaxSvgVersion version;
+    ClutterUnits *units;
+    GArray *view_box;
+    GError *error = NULL;
+    gchar *daxb;
+
+    /* enums, arrays and units */
+    document = load_precompiled ("01_01.svg");
+    svg = DAX_DOM_NODE (dax_dom_document_get_document_element (document));
+    g_assert (DAX_IS_ELEMENT_SVG (svg));
+    g_object_get (svg, "version", &version, "viewBox", &view_box, NULL);
+    g_assert_cmpint (version, ==, DAX_SVG_VERSION_1_2);
+    g_assert_cmpuint (view_box->len, ==, 4);
+    g_assert_cmpfloat (g_array_index (view_box, float, 2), ==, 30.0f);
+    node = dax_dom_node_get_last_child (svg);
+    g_assert (DAX_IS_ELEMENT_RECT (node));
+    g_object_get (node, "width", &units, NULL);
+    g_assert_cmpfloat (clutter_units_get_unit_value (units), ==, 10.0f);
+    clutter_units_free (units);
+    g_array_unref (view_box);
+    g_object_unref (document);
+
+    /* knot sequences */
+    document = load_precompiled ("09_06.svg");
+    svg = DAX_DOM_NODE (dax_dom_document_get_document_element (document));
+    g_object_get (svg, "width", &units, NULL);
+    g_assert_cmpint (clutter_units_get_unit_type (units), ==, CLUTTER_UNIT_CM);
+    g_assert_cmpfloat (clutter_units_get_unit_value (units), ==, 12.0f);
+    clutter_units_free (units);
+    node = dax_dom_node_get_last_child (svg);
+    g_assert (DAX_IS_ELEMENT_POLYLINE (node));
+    g_object_get (node, "points", &seq, NULL);
+    g_object_unref (document);
+    /* the knots are in the mapping, kept alive by the sequence */
+    g_assert_cmpuint (dax_knot_sequence_get_size (seq), ==, 22);
+    g_assert_cmpfloat (dax_knot_sequence_get_array (seq)[43], ==, 375.0f);
+    g_object_unref (seq);
+
+    /* paths */
+    document = load_precompiled ("08_01.svg");
+    svg = DAX_DOM_NODE (dax_dom_document_get_document_element (document));
+    node = dax_dom_node_get_last_child (svg);
+    g_assert (DAX_IS_ELEMENT_PATH (node));
+    path = dax_element_path_get_path (DAX_ELEMENT_PATH (node));
+    g_object_unref (document);
+    g_assert_cmpuint (dax_path_get_n_verbs (path), ==, 4);
+    g_assert_cmpuint (dax_path_get_n_coords (path), ==, 6);
+    g_assert (dax_path_get_verbs (path)[3] == DAX_PATH_CLOSE);
+    g_assert_cmpfloat (dax_path_get_coords (path)[4], ==, 200.0f);
+    g_object_unref (path);
+
+    /* text nodes */
+    document = load_precompiled ("18_01.svg");
+    svg = DAX_DOM_NODE (dax_dom_document_get_document_element (document));
+    node = dax_dom_node_get_next_sibling (dax_dom_node_get_first_child (svg));
+    g_assert (DAX_IS_ELEMENT_SCRIPT (node));
+    node = dax_dom_node_get_first_child (node);
+    g_assert (DAX_IS_DOM_TEXT (node));
+    g_assert_cmpstr (
+        dax_dom_character_data_get_data (DAX_DOM_CHARACTER_DATA (node)),
+        ==,
+        _18_01_script);
+    g_object_unref (document);
+
+    /* an SVG file is not a precompiled document */
+    document = dax_dom_document_new_from_binary ("01_01.svg", &error);
+    g_assert (document == NULL);
+    g_assert (g_error_matches (error, DAX_BINARY_ERROR,
+                               DAX_BINARY_ERROR_INVALID));
+    g_clear_error (&error);
+
+    /* neither is a truncated one */
+    daxb = g_build_filename (g_get_tmp_dir (), "dax-test-parser.daxb", NULL);
+    g_assert (g_file_set_contents (daxb, "DAXB\1\0\0\0", 8, NULL));
+    document = dax_dom_document_new_from_binary (daxb, &error);
+    g_assert (document == NULL);
+    g_assert (error != NULL);
+    g_clear_error (&error);
+
+    /* nor one with a transform of too many elementary matrices */
+    document = dax_dom_document_new_from_memory (transformed,
+                                                 sizeof (transformed) - 1,
+                                                 "file:///", NULL);
+    g_assert (dax_dom_document_save_binary (document, daxb, NULL));
+    g_object_unref (document);
+    corrupt_matrix (daxb, "translate(12.5 -3.25)");
+    document = dax_dom_document_new_from_binary (daxb, &error);
+    g_assert (document == NULL);
+    g_assert (g_error_matches (error, DAX_BINARY_ERROR,
+                               DAX_BINARY_ERROR_INVALID));
+    g_clear_error (&error);
+
+    g_unlink (daxb);
+    g_free (daxb);
+}
+
+typedef struct
+{
+    GMainLoop *loop;
+    guint n_pending;
+    GPtrArray *documents;
+    GError *error;
+} AsyncData;
+
+static void
+on_document_loaded (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+    AsyncData *data = user_data;
+    DaxDomDocument *document;
+    GError *error = NULL;
+
+    document = dax_dom_document_new_from_file_finish (result, &error);
+    if (document)
+        g_ptr_array_add (data->documents, document);
+    else if (data->error == NULL)
+        data->error = error;
+    else
+        g_error_free (error);
+
+    if (--data->n_pending == 0)
+        g_main_loop_quit (data->loop);
+}
+
+static void
+load_async (AsyncData    *data,
+            const gchar **files,
+            guint         n_files,
+            GCancellable *cancellable)
+{
+    guint i;
+
+    data->loop = g_main_loop_new (NULL, FALSE);
+    data->documents = g_ptr_array_new_with_free_func (g_object_unref);
+    data->error = NULL;
+    data->n_pending = n_files;
+
+    for (i = 0; i < n_files; i++)
+        dax_dom_document_new_from_file_async (files[i], cancellable,
+                                              on_document_loaded, data);
+    /* late enough for the loads to be done or under way */
+    if (cancellable)
+        g_cancellable_cancel (cancellable);
+    g_main_loop_run (data->loop);
+    g_main_loop_unref (data->loop);
+}
+
+static void
+test_async (void)
+{
+    static const gchar *files[] = { "18_01.svg", "18_01.svg", "09_06.svg" };
+    static const gchar *missing[] = { "does-not-exist.svg" };
+    GCancellable *cancellable;
+    AsyncData data;
+    guint i;
+
+    dax_dom_document_set_loading_threads (2);
+    load_async (&data, files, G_N_ELEMENTS (files), NULL);
+    g_assert_no_error (data.error);
+    g_assert_cmpuint (data.documents->len, ==, G_N_ELEMENTS (files));
+
+    for (i = 0; i < data.documents->len; i++) {
+        DaxDomDocument *document = g_ptr_array_index (data.documents, i);
+        DaxDomElement *svg;
+
+        g_assert (DAX_IS_DOM_DOCUMENT (document));
+        svg = dax_dom_document_get_document_element (document);
+        g_assert (DAX_IS_ELEMENT_SVG (svg));
+        /* "parsed" has been signaled in the main thread */
+        g_assert (dax_dom_element_is_loaded (svg));
+    }
+    g_ptr_array_free (data.documents, TRUE);
+
+    load_async (&data, missing, G_N_ELEMENTS (missing), NULL);
+    g_assert (data.error != NULL);
+    g_assert_cmpuint (data.documents->len, ==, 0);
+    g_clear_error (&data.error);
+    g_ptr_array_free (data.documents, TRUE);
+
+    /* cancelled after the loads started, no document comes back */
+    cancellable = g_cancellable_new ();
+    load_async (&data, files, G_N_ELEMENTS (files), cancellable);
+    g_assert (g_error_matches (data.error, G_IO_ERROR, G_IO_ERROR_CANCELLED));
+    g_assert_cmpuint (data.documents->len, ==, 0);
+    g_clear_error (&data.error);
+    g_ptr_array_free (data.documents, TRUE);
+    g_object_unref (cancellable);
+}
+
+#define N_PARSE_RUNS    20
+
+static void
+test_perf_attributes (void)
+{
+    static const gchar *files[] = { "wild/tiger.svg", "wild/lion.svg" };
+    gdouble elapsed;
+    guint i, j;
+
+    g_test_timer_start ();
+    for (i = 0; i < N_PARSE_RUNS; i++) {
+        for (j = 0; j < G_N_ELEMENTS (files); j++) {
+            DaxDomDocument *document;
+
+            document = dax_dom_document_new_from_file (files[j], NULL);
+            g_assert (DAX_IS_DOM_DOCUMENT (document));
+            g_object_unref (document);
+        }
+    }
+    elapsed = g_test_timer_elapsed ();
+
+    g_test_minimized_result (elapsed * 1e3 / N_PARSE_RUNS,
+                             "parsed tiger and lion in %.02f ms",
+                             elapsed * 1e3 / N_PARSE_RUNS);
+}
+
+/* evicts @filename from the page cache so that the next load reads it from
+ * the disk */
+static void
+drop_from_page_cache (const gchar *filename)
+{
+#ifdef POSIX_FADV_DONTNEED
+    int fd;
+
+    fd = g_open (filename, O_RDONLY, 0);
+    if (fd < 0)
+        return;
+
+    /* dirty pages are not dropped */
+    fdatasync (fd);
+    posix_fadvise (fd, 0, 0, POSIX_FADV_DONTNEED);
+    close (fd);
+#endif
+}
+
+/* time spent loading @files, in ms per run */
+static gdouble
+time_loads (const gchar **files,
+            guint         n_files,
+            gboolean      binary,
+            gboolean      cold)
+{
+    gdouble elapsed = 0;
+    guint i, j;
+
+    for (i = 0; i < N_PARSE_RUNS; i++) {
+        for (j = 0; j < n_files; j++) {
+            DaxDomDocument *document;
+
+            if (cold)
+                drop_from_page_cache (files[j]);
+
+            g_test_timer_start ();
+            if (binary)
+                document = dax_dom_document_new_from_binary (files[j], NULL);
+            else
+                document = dax_dom_document_new_from_file (files[j], NULL);
+            elapsed += g_test_timer_elapsed ();
+
+            g_assert (DAX_IS_DOM_DOCUMENT (document));
+            g_object_unref (document);
+        }
+    }
+
+    return elapsed * 1e3 / N_PARSE_RUNS;
+}
+
+static void
+test_perf_binary (void)
+{
+    static const gchar *files[] = { "wild/tiger.svg", "wild/lion.svg" };
+    gchar *daxb[G_N_ELEMENTS (files)];
+    gdouble xml_cold, binary_cold, xml_warm, binary_warm;
+    guint j;
+
+    for (j = 0; j < G_N_ELEMENTS (files); j++) {
+        DaxDomDocument *document;
+        gchar *name;
+
+        document = dax_dom_document_new_from_file (files[j], NULL);
+        name = g_strdup_printf ("dax-test-perf-%u.daxb", j);
+        daxb[j] = g_build_filename (g_get_tmp_dir (), name, NULL);
+        g_assert (dax_dom_document_save_binary (document, daxb[j], NULL));
+        g_object_unref (document);
+        g_free (name);
+    }
+
+    /* precompiled documents are about saving the parsing of files that are
+     * not in the page cache yet, eg. at start up */
+    xml_cold = time_loads (files, G_N_ELEMENTS (files), FALSE, TRUE);
+    binary_cold = time_loads ((const gchar **) daxb, G_N_ELEMENTS (daxb),
+                              TRUE, TRUE);
+    xml_warm = time_loads (files, G_N_ELEMENTS (files), FALSE, FALSE);
+    binary_warm = time_loads ((const gchar **) daxb, G_N_ELEMENTS (daxb),
+                              TRUE, FALSE);
+
+    for (j = 0; j < G_N_ELEMENTS (files); j++) {
+        g_unlink (daxb[j]);
+        g_free (daxb[j]);
+    }
+
+    g_test_minimized_result (binary_cold,
+                             "loaded tiger and lion cold in %.02f ms from "
+                             "XML, %.02f ms precompiled; warm in %.02f ms "
+                             "from XML, %.02f ms precompiled",
+                             xml_cold, binary_cold, xml_warm, binary_warm);
+}
+
+#define N_ASYNC_DOCUMENTS   8
+
+static void
+test_perf_async (void)
+{
+    const gchar *files[N_ASYNC_DOCUMENTS];
+    gdouble one_thread = 0;
+    guint n_threads, i;
+
+    for (i = 0; i < N_ASYNC_DOCUMENTS; i++)
+        files[i] = i % 2 ? "wild/lion.svg" : "wild/tiger.svg";
+
+    for (n_threads = 1; n_threads <= N_ASYNC_DOCUMENTS; n_threads *= 2) {
+        AsyncData data;
+        gdouble elapsed;
+
+        dax_dom_document_set_loading_threads (n_threads);
+
+        g_test_timer_start ();
+        load_async (&data, files, N_ASYNC_DOCUMENTS, NULL);
+        elapsed = g_test_timer_elapsed ();
+
+        g_assert_no_error (data.error);
+        g_ptr_array_free (data.documents, TRUE);
+
+        if (n_threads == 1)
+            one_thread = elapsed;
+
+        g_test_minimized_result (elapsed * 1e3,
+                                 "%u documents with %u threads in %.02f ms, "
+                                 "speedup %.02f",
+                                 N_ASYNC_DOCUMENTS, n_threads,
+                                 elapsed * 1e3, one_thread / elapsed);
+    }
+}
+
+#define CHUNK_SIZE      4096
+
+static void
+on_first_element_parsed (DaxParser     *parser,
+                         DaxDomElement *element,
+                         gdouble       *first)
+{
+    if (*first < 0)
+        *first = g_test_timer_elapsed ();
+}
+
+static void
+test_perf_progressive (void)
+{
+    DaxParser *parser;
+    gchar *contents;
+    gsize len, fed;
+    gdouble first = -1, elapsed;
+
+    g_assert (g_file_get_contents ("wild/tiger.svg", &contents, &len, NULL));
+
+    parser = dax_parser_new ("file:///");
+    g_signal_connect (parser, "element-parsed",
+                      G_CALLBACK (on_first_element_parsed), &first);
+
+    g_test_timer_start ();
+    for (fed = 0; fed < len; fed += CHUNK_SIZE)
+        dax_parser_feed (parser, contents + fed, MIN (CHUNK_SIZE, len - fed),
+                         NULL);
+    dax_parser_end (parser, NULL);
+    elapsed = g_test_timer_elapsed ();
+
+    g_assert_cmpfloat (first, >=, 0);
+    g_test_minimized_result (first * 1e3,
+                             "first element of tiger after %.02f ms, "
+                             "whole document after %.02f ms",
+                             first * 1e3, elapsed * 1e3);
+
+    g_object_unref (parser);
+    g_free (contents);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -735,6 +1366,16 @@ main (int   argc,
     g_test_add_func ("/parser/xml-base", test_base);
     g_test_add_func ("/parser/preserve-aspect-ratio", test_preserve_ar);
     g_test_add_func ("/parser/transform", test_transform);
+    g_test_add_func ("/parser/attribute-notify", test_attribute_notify);
+    g_test_add_func ("/parser/progressive", test_progressive);
+    g_test_add_func ("/parser/binary", test_binary);
+    g_test_add_func ("/parser/async", test_async);
+    if (g_test_perf ()) {
+        g_test_add_func ("/parser/perf/attributes", test_perf_attributes);
+        g_test_add_func ("/parser/perf/progressive", test_perf_progressive);
+        g_test_add_func ("/parser/perf/binary", test_perf_binary);
+        g_test_add_func ("/parser/perf/async", test_perf_async);
+    }
 
     return g_test_run ();
 }
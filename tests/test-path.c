@@ -0,0 +1,429 @@
+#include <math.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <dax.h>
+
+#define assert_coord(a, b)  g_assert_cmpfloat (fabsf ((a) - (b)), <, 1e-3)
+
+static void
+assert_verbs (DaxPath     *path,
+              const gchar *expected)
+{
+    static const gchar commands[] = { 'M', 'L', 'C', 'Z' };
+    const guint8 *verbs;
+    guint i, n_verbs;
+
+    n_verbs = dax_path_get_n_verbs (path);
+    g_assert_cmpuint (n_verbs, ==, strlen (expected));
+
+    verbs = dax_path_get_verbs (path);
+    for (i = 0; i < n_verbs; i++)
+        g_assert_cmpint (commands[verbs[i]], ==, expected[i]);
+}
+
+static void
+test_lines (void)
+{
+    DaxPath *path;
+    const gfloat *coords;
+
+    path = dax_path_new_from_string ("M 10 20 L 30,40 H 50 V 60 Z");
+    assert_verbs (path, "MLLLZ");
+    g_assert_cmpuint (dax_path_get_n_coords (path), ==, 8);
+    coords = dax_path_get_coords (path);
+    g_assert_cmpfloat (coords[0], ==, 10.f);
+    g_assert_cmpfloat (coords[1], ==, 20.f);
+    g_assert_cmpfloat (coords[2], ==, 30.f);
+    g_assert_cmpfloat (coords[3], ==, 40.f);
+    g_assert_cmpfloat (coords[4], ==, 50.f);
+    g_assert_cmpfloat (coords[5], ==, 40.f);
+    g_assert_cmpfloat (coords[6], ==, 50.f);
+    g_assert_cmpfloat (coords[7], ==, 60.f);
+    g_object_unref (path);
+
+    /* extra pairs after a moveto are linetos */
+    path = dax_path_new_from_string ("m 1 1 2 2 M 0 0 10 0 10 10");
+    assert_verbs (path, "MLMLL");
+    coords = dax_path_get_coords (path);
+    g_assert_cmpfloat (coords[2], ==, 3.f);
+    g_assert_cmpfloat (coords[3], ==, 3.f);
+    g_assert_cmpfloat (coords[8], ==, 10.f);
+    g_assert_cmpfloat (coords[9], ==, 10.f);
+    g_object_unref (path);
+}
+
+static void
+test_relative (void)
+{
+    DaxPath *path;
+    const gfloat *coords;
+
+    path = dax_path_new_from_string ("m 10 20 l 10 10 h 10 v 10 z m 5 5 l 1 1");
+    assert_verbs (path, "MLLLZML");
+    coords = dax_path_get_coords (path);
+    g_assert_cmpfloat (coords[2], ==, 20.f);
+    g_assert_cmpfloat (coords[3], ==, 30.f);
+    g_assert_cmpfloat (coords[4], ==, 30.f);
+    g_assert_cmpfloat (coords[5], ==, 30.f);
+    g_assert_cmpfloat (coords[6], ==, 30.f);
+    g_assert_cmpfloat (coords[7], ==, 40.f);
+    /* relative to the start of the closed sub-path */
+    g_assert_cmpfloat (coords[8], ==, 15.f);
+    g_assert_cmpfloat (coords[9], ==, 25.f);
+    g_assert_cmpfloat (coords[10], ==, 16.f);
+    g_assert_cmpfloat (coords[11], ==, 26.f);
+    g_object_unref (path);
+
+    /* drawing after a closepath starts a new sub-path at the same point */
+    path = dax_path_new_from_string ("M 10 10 L 20 10 Z L 20 20");
+    assert_verbs (path, "MLZML");
+    coords = dax_path_get_coords (path);
+    g_assert_cmpfloat (coords[4], ==, 10.f);
+    g_assert_cmpfloat (coords[5], ==, 10.f);
+    g_object_unref (path);
+}
+
+static void
+test_curves (void)
+{
+    DaxPath *path;
+    const gfloat *coords;
+
+    path = dax_path_new_from_string ("M 0 0 C 10 0 20 10 20 20 s 10 20 20 20");
+    assert_verbs (path, "MCC");
+    coords = dax_path_get_coords (path);
+    /* reflection of the previous second control point */
+    g_assert_cmpfloat (coords[8], ==, 20.f);
+    g_assert_cmpfloat (coords[9], ==, 30.f);
+    g_assert_cmpfloat (coords[10], ==, 30.f);
+    g_assert_cmpfloat (coords[11], ==, 40.f);
+    g_assert_cmpfloat (coords[12], ==, 40.f);
+    g_assert_cmpfloat (coords[13], ==, 40.f);
+    g_object_unref (path);
+
+    /* without a previous curve, the first control point is the current
+     * point */
+    path = dax_path_new_from_string ("M 5 5 S 10 10 20 20");
+    assert_verbs (path, "MC");
+    coords = dax_path_get_coords (path);
+    g_assert_cmpfloat (coords[2], ==, 5.f);
+    g_assert_cmpfloat (coords[3], ==, 5.f);
+    g_object_unref (path);
+
+    /* quadratic curves become cubic ones */
+    path = dax_path_new_from_string ("M 0 0 Q 30 30 60 0 T 120 0");
+    assert_verbs (path, "MCC");
+    coords = dax_path_get_coords (path);
+    assert_coord (coords[2], 20.f);
+    assert_coord (coords[3], 20.f);
+    assert_coord (coords[4], 40.f);
+    assert_coord (coords[5], 20.f);
+    g_assert_cmpfloat (coords[6], ==, 60.f);
+    g_assert_cmpfloat (coords[7], ==, 0.f);
+    assert_coord (coords[8], 80.f);
+    assert_coord (coords[9], -20.f);
+    assert_coord (coords[10], 100.f);
+    assert_coord (coords[11], -20.f);
+    g_assert_cmpfloat (coords[12], ==, 120.f);
+    g_assert_cmpfloat (coords[13], ==, 0.f);
+    g_object_unref (path);
+}
+
+static void
+test_arcs (void)
+{
+    DaxPath *path;
+    const gfloat *coords;
+    gfloat k = 4.0 / 3.0 * tan (G_PI / 8);
+
+    /* half circle above the x axis, split in two quarters */
+    path = dax_path_new_from_string ("M 0 0 A 10 10 0 0 1 20 0");
+    assert_verbs (path, "MCC");
+    coords = dax_path_get_coords (path);
+    assert_coord (coords[2], 0.f);
+    assert_coord (coords[3], -10.f * k);
+    assert_coord (coords[6], 10.f);
+    assert_coord (coords[7], -10.f);
+    g_assert_cmpfloat (coords[12], ==, 20.f);
+    g_assert_cmpfloat (coords[13], ==, 0.f);
+    g_object_unref (path);
+
+    /* same arc with the other sweep flag, compact flags and relative */
+    path = dax_path_new_from_string ("M0 0a10 10 0 0020 0");
+    assert_verbs (path, "MCC");
+    coords = dax_path_get_coords (path);
+    assert_coord (coords[6], 10.f);
+    assert_coord (coords[7], 10.f);
+    g_assert_cmpfloat (coords[12], ==, 20.f);
+    g_object_unref (path);
+
+    /* radii too small are scaled up */
+    path = dax_path_new_from_string ("M 0 0 A 1 1 0 0 1 20 0");
+    assert_verbs (path, "MCC");
+    coords = dax_path_get_coords (path);
+    assert_coord (coords[7], -10.f);
+    g_object_unref (path);
+
+    /* large arc of a full 270 degrees */
+    path = dax_path_new_from_string ("M 10 0 A 10 10 0 1 1 0 -10");
+    assert_verbs (path, "MCCC");
+    g_object_unref (path);
+
+    /* null radius: straight line, same end point: omitted */
+    path = dax_path_new_from_string ("M 0 0 A 0 10 0 0 1 20 0 "
+                                     "A 5 5 0 0 1 20 0");
+    assert_verbs (path, "ML");
+    g_object_unref (path);
+}
+
+static void
+test_numbers (void)
+{
+    DaxPath *path;
+    const gfloat *coords;
+
+    path = dax_path_new_from_string ("M1.5.5L-1-2l+1e2 1E-1L.5e+1,0.1");
+    assert_verbs (path, "MLLL");
+    coords = dax_path_get_coords (path);
+    g_assert_cmpfloat (coords[0], ==, 1.5f);
+    g_assert_cmpfloat (coords[1], ==, 0.5f);
+    g_assert_cmpfloat (coords[2], ==, -1.f);
+    g_assert_cmpfloat (coords[3], ==, -2.f);
+    g_assert_cmpfloat (coords[4], ==, 99.f);
+    assert_coord (coords[5], -1.9f);
+    g_assert_cmpfloat (coords[6], ==, 5.f);
+    g_assert_cmpfloat (coords[7], ==, 0.1f);
+    g_object_unref (path);
+
+    path = dax_path_new_from_string ("M 123.456 0.000789 L 1e-7 -98765.4321");
+    coords = dax_path_get_coords (path);
+    g_assert_cmpfloat (coords[0], ==, 123.456f);
+    g_assert_cmpfloat (coords[1], ==, 0.000789f);
+    g_assert_cmpfloat (coords[2], ==, 1e-7f);
+    g_assert_cmpfloat (coords[3], ==, -98765.4321f);
+    g_object_unref (path);
+}
+
+static void
+test_errors (void)
+{
+    DaxPath *path;
+
+    /* what comes before an error is kept */
+    path = dax_path_new_from_string ("M 10 10 L 20 20 L 30");
+    assert_verbs (path, "ML");
+    g_object_unref (path);
+
+    path = dax_path_new_from_string ("M 10 10 Z 5 5");
+    assert_verbs (path, "MZ");
+    g_object_unref (path);
+
+    path = dax_path_new_from_string ("M 10 10 X 20 20");
+    assert_verbs (path, "M");
+    g_object_unref (path);
+
+    path = dax_path_new_from_string ("M 0 0 A 10 10 0 2 1 20 0");
+    assert_verbs (path, "M");
+    g_object_unref (path);
+
+    /* a path data has to start with a moveto */
+    path = dax_path_new_from_string ("L 10 10");
+    assert_verbs (path, "");
+    g_object_unref (path);
+
+    path = dax_path_new_from_string ("   ");
+    assert_verbs (path, "");
+    g_object_unref (path);
+}
+
+static void
+test_string (void)
+{
+    GValue string_value = { 0, }, path_value = { 0, };
+    DaxPath *path;
+    gchar *string;
+
+    g_value_init (&string_value, G_TYPE_STRING);
+    g_value_init (&path_value, DAX_TYPE_PATH);
+
+    g_value_set_static_string (&string_value, "m10 20 30 40 z");
+    g_assert (g_value_transform (&string_value, &path_value));
+    path = g_value_get_object (&path_value);
+    assert_verbs (path, "MLZ");
+
+    string = dax_path_to_string (path);
+    g_assert_cmpstr (string, ==, "M 10,20 L 40,60 Z");
+    g_free (string);
+
+    g_value_unset (&path_value);
+    g_value_unset (&string_value);
+}
+
+static void
+test_bounds (void)
+{
+    DaxPath *path;
+    gfloat x1, y1, x2, y2;
+
+    path = dax_path_new_from_string ("M 10 20 L 30,5 H 0 Z");
+    g_assert (dax_path_get_bounds (path, &x1, &y1, &x2, &y2));
+    g_assert_cmpfloat (x1, ==, 0.f);
+    g_assert_cmpfloat (y1, ==, 5.f);
+    g_assert_cmpfloat (x2, ==, 30.f);
+    g_assert_cmpfloat (y2, ==, 20.f);
+    g_object_unref (path);
+
+    /* the curve doesn't reach its control points */
+    path = dax_path_new_from_string ("M 0 0 C 0 -10 10 -10 10 0");
+    g_assert (dax_path_get_bounds (path, &x1, &y1, &x2, &y2));
+    g_assert_cmpfloat (x1, ==, 0.f);
+    g_assert_cmpfloat (y1, ==, -7.5f);
+    g_assert_cmpfloat (x2, ==, 10.f);
+    g_assert_cmpfloat (y2, ==, 0.f);
+    g_object_unref (path);
+
+    path = dax_path_new ();
+    g_assert (!dax_path_get_bounds (path, &x1, &y1, &x2, &y2));
+    g_object_unref (path);
+}
+
+static void
+test_hit_test (void)
+{
+    DaxPath *path;
+
+    /* a square with a hole turning the same way */
+    path = dax_path_new_from_string ("M 0 0 H 10 V 10 H 0 Z "
+                                     "M 2 2 H 8 V 8 H 2 Z");
+    g_assert (dax_path_fill_contains_point (path, DAX_FILL_RULE_NONZERO,
+                                            5, 5));
+    g_assert (!dax_path_fill_contains_point (path, DAX_FILL_RULE_EVEN_ODD,
+                                             5, 5));
+    g_assert (dax_path_fill_contains_point (path, DAX_FILL_RULE_EVEN_ODD,
+                                            1, 5));
+    g_assert (!dax_path_fill_contains_point (path, DAX_FILL_RULE_NONZERO,
+                                             11, 5));
+
+    g_assert (dax_path_stroke_contains_point (path, 2, 10.9, 5));
+    g_assert (!dax_path_stroke_contains_point (path, 2, 5, 5));
+    g_object_unref (path);
+
+    /* open sub-paths are closed when filled, not when stroked */
+    path = dax_path_new_from_string ("M 0 0 C 0 -10 10 -10 10 0");
+    g_assert (dax_path_fill_contains_point (path, DAX_FILL_RULE_NONZERO,
+                                            5, -5));
+    g_assert (!dax_path_fill_contains_point (path, DAX_FILL_RULE_NONZERO,
+                                             5, -9));
+    g_assert (!dax_path_stroke_contains_point (path, 1, 5, 0));
+    g_object_unref (path);
+}
+
+/* collects the d="" attributes of the path elements of a file */
+static void
+collect_path_data (const gchar *filename,
+                   GPtrArray   *strings)
+{
+    gchar *contents, *p, *end;
+
+    if (!g_file_get_contents (filename, &contents, NULL, NULL))
+        return;
+
+    for (p = strstr (contents, "<path"); p; p = strstr (end, "<path")) {
+        end = strchr (p, '>');
+        if (end == NULL)
+            break;
+
+        p = g_strstr_len (p, end - p, " d=\"");
+        if (p == NULL)
+            continue;
+        p += 4;
+        end = strchr (p, '"');
+        if (end == NULL)
+            break;
+
+        g_ptr_array_add (strings, g_strndup (p, end - p));
+    }
+
+    g_free (contents);
+}
+
+#define N_PARSE_RUNS    50
+
+static void
+test_perf_parse (void)
+{
+    GPtrArray *strings;
+    const gchar *name;
+    gdouble elapsed;
+    gsize n_bytes = 0, n_coords = 0;
+    GDir *dir;
+    guint i, j;
+
+    strings = g_ptr_array_new ();
+
+    dir = g_dir_open ("wild", 0, NULL);
+    g_assert (dir);
+    while ((name = g_dir_read_name (dir))) {
+        gchar *filename;
+
+        if (!g_str_has_suffix (name, ".svg"))
+            continue;
+
+        filename = g_build_filename ("wild", name, NULL);
+        collect_path_data (filename, strings);
+        g_free (filename);
+    }
+    g_dir_close (dir);
+
+    g_assert_cmpuint (strings->len, >, 0);
+
+    g_test_timer_start ();
+    for (i = 0; i < N_PARSE_RUNS; i++) {
+        for (j = 0; j < strings->len; j++) {
+            DaxPath *path;
+
+            path = dax_path_new_from_string (g_ptr_array_index (strings, j));
+            if (i == 0) {
+                n_bytes += strlen (g_ptr_array_index (strings, j));
+                n_coords += dax_path_get_n_coords (path);
+            }
+            g_object_unref (path);
+        }
+    }
+    elapsed = g_test_timer_elapsed ();
+
+    g_test_maximized_result (n_bytes * N_PARSE_RUNS / elapsed / 1e6,
+                             "parsed %u path data at %.02f MB/s, "
+                             "%.02f Mcoords/s",
+                             strings->len,
+                             n_bytes * N_PARSE_RUNS / elapsed / 1e6,
+                             n_coords * N_PARSE_RUNS / elapsed / 1e6);
+
+    for (i = 0; i < strings->len; i++)
+        g_free (g_ptr_array_index (strings, i));
+    g_ptr_array_free (strings, TRUE);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/path/lines", test_lines);
+    g_test_add_func ("/path/relative", test_relative);
+    g_test_add_func ("/path/curves", test_curves);
+    g_test_add_func ("/path/arcs", test_arcs);
+    g_test_add_func ("/path/numbers", test_numbers);
+    g_test_add_func ("/path/errors", test_errors);
+    g_test_add_func ("/path/string", test_string);
+    g_test_add_func ("/path/bounds", test_bounds);
+    g_test_add_func ("/path/hit-test", test_hit_test);
+    if (g_test_perf ())
+        g_test_add_func ("/path/perf/parse", test_perf_parse);
+
+    return g_test_run ();
+}
@@ -0,0 +1,129 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include <dax.h>
+
+static const char transforms[] =
+"<?xml version=\"1.0\"?>\n"
+"<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.2\" "
+     "baseProfile=\"tiny\" width=\"40\" height=\"40\">\n"
+  "<g transform=\"translate(20,0)\">\n"
+    "<g transform=\"scale(2)\">\n"
+      "<rect x=\"0\" y=\"0\" width=\"5\" height=\"5\" fill=\"blue\"/>\n"
+    "</g>\n"
+  "</g>\n"
+  "<rect x=\"0\" y=\"20\" width=\"10\" height=\"10\" fill=\"lime\"/>\n"
+"</svg>";
+
+static guint32
+get_pixel (DaxTraverserRaster *raster,
+           guint               x,
+           guint               y)
+{
+    const guint32 *data;
+    guint stride;
+
+    data = dax_traverser_raster_get_data (raster);
+    stride = dax_traverser_raster_get_stride (raster);
+
+    return data[y * stride + x];
+}
+
+static void
+test_raster_rect (void)
+{
+    DaxDomDocument *document;
+    DaxTraverser *traverser;
+    DaxTraverserRaster *raster;
+    DaxDomNode *svg;
+
+    document = dax_dom_document_new_from_file ("01_01.svg", NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+    svg = DAX_DOM_NODE (dax_dom_document_get_document_element (document));
+
+    /* viewBox is 0 0 30 30, the rect goes from 10,10 to 20,20 */
+    traverser = dax_traverser_raster_new (svg, 60, 60);
+    raster = DAX_TRAVERSER_RASTER (traverser);
+    dax_traverser_apply (traverser);
+
+    g_assert_cmpuint (dax_traverser_raster_get_width (raster), ==, 60);
+    g_assert_cmpuint (dax_traverser_raster_get_height (raster), ==, 60);
+
+    g_assert_cmphex (get_pixel (raster, 30, 30), ==, 0xffff0000);
+    g_assert_cmphex (get_pixel (raster, 20, 20), ==, 0xffff0000);
+    g_assert_cmphex (get_pixel (raster, 39, 39), ==, 0xffff0000);
+    g_assert_cmphex (get_pixel (raster, 19, 30), ==, 0);
+    g_assert_cmphex (get_pixel (raster, 40, 30), ==, 0);
+    g_assert_cmphex (get_pixel (raster, 5, 5), ==, 0);
+
+    g_object_unref (traverser);
+    g_object_unref (document);
+}
+
+static void
+test_raster_transforms (void)
+{
+    DaxDomDocument *document;
+    DaxTraverser *traverser;
+    DaxTraverserRaster *raster;
+    DaxDomNode *svg;
+
+    document = dax_dom_document_new_from_memory (transforms,
+                                                 sizeof (transforms) - 1,
+                                                 "file:///",
+                                                 NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+    svg = DAX_DOM_NODE (dax_dom_document_get_document_element (document));
+
+    /* no size given, use the one of the document */
+    traverser = dax_traverser_raster_new (svg, 0, 0);
+    raster = DAX_TRAVERSER_RASTER (traverser);
+    dax_traverser_apply (traverser);
+
+    g_assert_cmpuint (dax_traverser_raster_get_width (raster), ==, 40);
+    g_assert_cmpuint (dax_traverser_raster_get_height (raster), ==, 40);
+
+    /* nested transforms: scale first, then translate */
+    g_assert_cmphex (get_pixel (raster, 20, 0), ==, 0xff0000ff);
+    g_assert_cmphex (get_pixel (raster, 29, 9), ==, 0xff0000ff);
+    g_assert_cmphex (get_pixel (raster, 30, 5), ==, 0);
+    g_assert_cmphex (get_pixel (raster, 5, 5), ==, 0);
+
+    /* the CTM is restored after the <g> elements */
+    g_assert_cmphex (get_pixel (raster, 5, 25), ==, 0xff00ff00);
+    g_assert_cmphex (get_pixel (raster, 25, 25), ==, 0);
+
+    g_object_unref (traverser);
+    g_object_unref (document);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+    dax_init_headless (&argc, &argv);
+
+    g_test_add_func ("/raster/rect", test_raster_rect);
+    g_test_add_func ("/raster/transforms", test_raster_transforms);
+
+    return g_test_run ();
+}
@@ -0,0 +1,246 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include <dax.h>
+
+typedef struct
+{
+    DaxTimerWheelEntry entry;
+    gint id;
+    GArray *log;
+} TestTimer;
+
+static void
+on_timer_fired (gpointer data)
+{
+    TestTimer *timer = data;
+
+    g_array_append_val (timer->log, timer->id);
+}
+
+static gboolean
+quit_loop (gpointer data)
+{
+    g_main_loop_quit (data);
+
+    return FALSE;
+}
+
+/* spins the main loop for ms milliseconds */
+static void
+run_loop (guint ms)
+{
+    GMainLoop *loop;
+
+    loop = g_main_loop_new (NULL, FALSE);
+    g_timeout_add (ms, quit_loop, loop);
+    g_main_loop_run (loop);
+    g_main_loop_unref (loop);
+}
+
+static void
+test_wheel_coalesce (void)
+{
+    DaxTimerWheel *wheel;
+    TestTimer timers[150];
+    GArray *log;
+    guint i;
+
+    wheel = dax_timer_wheel_new ();
+    log = g_array_new (FALSE, FALSE, sizeof (gint));
+
+    /* two batches of timers, each due in the same tick */
+    for (i = 0; i < G_N_ELEMENTS (timers); i++) {
+        timers[i].id = i;
+        timers[i].log = log;
+        dax_timer_wheel_entry_init (&timers[i].entry, on_timer_fired,
+                                    &timers[i]);
+        dax_timer_wheel_add (wheel, &timers[i].entry, i < 100 ? 20 : 60);
+    }
+    g_assert_cmpuint (dax_timer_wheel_get_n_timers (wheel), ==, 150);
+
+    run_loop (150);
+
+    g_assert_cmpuint (log->len, ==, 150);
+    g_assert_cmpuint (dax_timer_wheel_get_n_timers (wheel), ==, 0);
+    g_assert_cmpuint (dax_timer_wheel_get_n_wakeups (wheel), <=, 4);
+    g_assert_cmpuint (dax_timer_wheel_get_wakeups_saved (wheel), >=, 146);
+
+    g_array_free (log, TRUE);
+    dax_timer_wheel_unref (wheel);
+}
+
+static void
+test_wheel_order (void)
+{
+    /* the last one lands in the second level of the wheel */
+    static const gulong delays[] = { 50, 10, 30, 700, 0 };
+    static const gint expected[] = { 4, 1, 2, 0, 3 };
+    DaxTimerWheel *wheel;
+    TestTimer timers[G_N_ELEMENTS (delays)];
+    GArray *log;
+    guint i;
+
+    wheel = dax_timer_wheel_new ();
+    log = g_array_new (FALSE, FALSE, sizeof (gint));
+
+    for (i = 0; i < G_N_ELEMENTS (delays); i++) {
+        timers[i].id = i;
+        timers[i].log = log;
+        dax_timer_wheel_entry_init (&timers[i].entry, on_timer_fired,
+                                    &timers[i]);
+        dax_timer_wheel_add (wheel, &timers[i].entry, delays[i]);
+    }
+
+    /* the remaining time is never more than the delay */
+    g_assert_cmpuint (dax_timer_wheel_get_remaining (wheel, &timers[3].entry),
+                      <=, 700);
+    g_assert_cmpuint (dax_timer_wheel_get_remaining (wheel, &timers[3].entry),
+                      >, 600);
+
+    run_loop (100);
+    g_assert_cmpuint (log->len, ==, 4);
+    g_assert (dax_timer_wheel_entry_is_pending (&timers[3].entry));
+
+    run_loop (700);
+    g_assert_cmpuint (log->len, ==, G_N_ELEMENTS (expected));
+    for (i = 0; i < G_N_ELEMENTS (expected); i++)
+        g_assert_cmpint (g_array_index (log, gint, i), ==, expected[i]);
+
+    g_array_free (log, TRUE);
+    dax_timer_wheel_unref (wheel);
+}
+
+static void
+test_wheel_remove (void)
+{
+    DaxTimerWheel *wheel;
+    TestTimer timers[2];
+    GArray *log;
+    guint i;
+
+    wheel = dax_timer_wheel_new ();
+    log = g_array_new (FALSE, FALSE, sizeof (gint));
+
+    for (i = 0; i < G_N_ELEMENTS (timers); i++) {
+        timers[i].id = i;
+        timers[i].log = log;
+        dax_timer_wheel_entry_init (&timers[i].entry, on_timer_fired,
+                                    &timers[i]);
+        dax_timer_wheel_add (wheel, &timers[i].entry, 20);
+    }
+
+    dax_timer_wheel_remove (wheel, &timers[0].entry);
+    g_assert (!dax_timer_wheel_entry_is_pending (&timers[0].entry));
+    g_assert_cmpuint (dax_timer_wheel_get_n_timers (wheel), ==, 1);
+
+    run_loop (60);
+    g_assert_cmpuint (log->len, ==, 1);
+    g_assert_cmpint (g_array_index (log, gint, 0), ==, 1);
+
+    g_array_free (log, TRUE);
+    dax_timer_wheel_unref (wheel);
+}
+
+static void
+test_wheel_pause (void)
+{
+    DaxTimerWheel *wheel;
+    TestTimer timer;
+    GArray *log;
+    gulong time;
+
+    wheel = dax_timer_wheel_new ();
+    log = g_array_new (FALSE, FALSE, sizeof (gint));
+
+    timer.id = 0;
+    timer.log = log;
+    dax_timer_wheel_entry_init (&timer.entry, on_timer_fired, &timer);
+    dax_timer_wheel_add (wheel, &timer.entry, 40);
+
+    dax_timer_wheel_pause (wheel);
+    g_assert (dax_timer_wheel_is_paused (wheel));
+    time = dax_timer_wheel_get_time (wheel);
+
+    /* the clock of the wheel does not move while paused */
+    run_loop (80);
+    g_assert_cmpuint (log->len, ==, 0);
+    g_assert_cmpuint (dax_timer_wheel_get_time (wheel), ==, time);
+
+    dax_timer_wheel_resume (wheel);
+    g_assert (!dax_timer_wheel_is_paused (wheel));
+    run_loop (80);
+    g_assert_cmpuint (log->len, ==, 1);
+
+    g_array_free (log, TRUE);
+    dax_timer_wheel_unref (wheel);
+}
+
+static void
+test_svg_timer (void)
+{
+    DaxTimerWheel *wheel;
+    DaxSvgTimer *timer;
+    gboolean running;
+    glong delay;
+
+    wheel = dax_timer_wheel_new ();
+    timer = dax_svg_timer_new_full (wheel, 500, 100);
+
+    dax_svg_timer_start (timer);
+    g_object_get (timer, "running", &running, "delay", &delay, NULL);
+    g_assert (running);
+    g_assert_cmpint (delay, <=, 500);
+    g_assert_cmpint (delay, >, 400);
+    g_assert_cmpuint (dax_timer_wheel_get_n_timers (wheel), ==, 1);
+
+    dax_svg_timer_stop (timer);
+    g_object_get (timer, "running", &running, NULL);
+    g_assert (!running);
+    g_assert_cmpuint (dax_timer_wheel_get_n_timers (wheel), ==, 0);
+
+    /* a repeating timer stays on the wheel */
+    g_object_set (timer, "delay", 10L, NULL);
+    dax_svg_timer_start (timer);
+    run_loop (100);
+    g_assert_cmpuint (dax_timer_wheel_get_n_timers (wheel), ==, 1);
+    g_assert_cmpuint (dax_timer_wheel_get_n_wakeups (wheel), >=, 1);
+
+    g_object_unref (timer);
+    g_assert_cmpuint (dax_timer_wheel_get_n_timers (wheel), ==, 0);
+    dax_timer_wheel_unref (wheel);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+    dax_init_headless (&argc, &argv);
+
+    g_test_add_func ("/timer/wheel/coalesce", test_wheel_coalesce);
+    g_test_add_func ("/timer/wheel/order", test_wheel_order);
+    g_test_add_func ("/timer/wheel/remove", test_wheel_remove);
+    g_test_add_func ("/timer/wheel/pause", test_wheel_pause);
+    g_test_add_func ("/timer/svg-timer", test_svg_timer);
+
+    return g_test_run ();
+}
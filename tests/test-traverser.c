@@ -0,0 +1,254 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+
+#include <dax.h>
+
+/*
+ * A traverser logging what it sees
+ */
+
+typedef struct
+{
+    DaxTraverser parent;
+
+    GString *log;
+    guint n_g;
+    guint depth;
+    guint max_depth;
+} TestTraverser;
+
+typedef DaxTraverserClass TestTraverserClass;
+
+G_DEFINE_TYPE (TestTraverser, test_traverser, DAX_TYPE_TRAVERSER)
+
+static void
+test_traverser_traverse_svg (DaxTraverser  *traverser,
+                             DaxElementSvg *node)
+{
+    TestTraverser *test = (TestTraverser *) traverser;
+
+    g_string_append (test->log, "svg ");
+}
+
+static void
+test_traverser_traverse_g (DaxTraverser    *traverser,
+                           DaxElementG     *node,
+                           DaxTraverserWay  way)
+{
+    TestTraverser *test = (TestTraverser *) traverser;
+
+    if (way == DAX_TRAVERSER_WAY_START) {
+        test->n_g++;
+        test->max_depth = MAX (test->max_depth, ++test->depth);
+        if (test->log->len < 256)
+            g_string_append (test->log, "g( ");
+    } else {
+        test->depth--;
+        if (test->log->len < 256)
+            g_string_append (test->log, ")g ");
+    }
+}
+
+static void
+test_traverser_traverse_path (DaxTraverser   *traverser,
+                              DaxElementPath *node)
+{
+    TestTraverser *test = (TestTraverser *) traverser;
+
+    g_string_append (test->log, "path ");
+}
+
+static void
+test_traverser_traverse_rect (DaxTraverser   *traverser,
+                              DaxElementRect *node)
+{
+    TestTraverser *test = (TestTraverser *) traverser;
+
+    g_string_append (test->log, "rect ");
+}
+
+static void
+test_traverser_finalize (GObject *object)
+{
+    TestTraverser *test = (TestTraverser *) object;
+
+    g_string_free (test->log, TRUE);
+
+    G_OBJECT_CLASS (test_traverser_parent_class)->finalize (object);
+}
+
+static void
+test_traverser_class_init (TestTraverserClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    object_class->finalize = test_traverser_finalize;
+
+    klass->traverse_svg = test_traverser_traverse_svg;
+    klass->traverse_g = test_traverser_traverse_g;
+    klass->traverse_path = test_traverser_traverse_path;
+    klass->traverse_rect = test_traverser_traverse_rect;
+}
+
+static void
+test_traverser_init (TestTraverser *self)
+{
+    self->log = g_string_new (NULL);
+}
+
+/*
+ * A traverser doing nothing, to measure the cost of the walk itself
+ */
+
+typedef DaxTraverser NoopTraverser;
+typedef DaxTraverserClass NoopTraverserClass;
+
+G_DEFINE_TYPE (NoopTraverser, noop_traverser, DAX_TYPE_TRAVERSER)
+
+static void
+noop_traverser_class_init (NoopTraverserClass *klass)
+{
+}
+
+static void
+noop_traverser_init (NoopTraverser *self)
+{
+}
+
+static const char nested[] =
+"<?xml version=\"1.0\"?>\n"
+"<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.2\" "
+     "baseProfile=\"tiny\">\n"
+  "<desc>Nested groups</desc>\n"
+  "<g>\n"
+    "<path d=\"M 0 0 L 10 10\"/>\n"
+    "<g><rect width=\"10\" height=\"10\"/></g>\n"
+    "<g/>\n"
+  "</g>\n"
+  "<path d=\"M 0 0 L 10 10\"/>\n"
+"</svg>";
+
+static void
+test_traverser_order (void)
+{
+    DaxDomDocument *document;
+    DaxDomNode *svg;
+    TestTraverser *traverser;
+
+    document = dax_dom_document_new_from_memory (nested, sizeof (nested) - 1,
+                                                 "file:///", NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+    svg = DAX_DOM_NODE (dax_dom_document_get_document_element (document));
+
+    traverser = g_object_new (test_traverser_get_type (), "root", svg, NULL);
+    dax_traverser_apply (DAX_TRAVERSER (traverser));
+
+    g_assert_cmpstr (traverser->log->str, ==,
+                     "svg g( path g( rect )g g( )g )g path ");
+
+    g_object_unref (traverser);
+    g_object_unref (document);
+}
+
+/* Far deeper than what a recursive walk could handle with the default stack
+ * size */
+#define DEEP_LEVELS 200000
+
+static void
+test_traverser_deep (void)
+{
+    DaxDomNode *svg, *parent, *g;
+    TestTraverser *traverser;
+    guint i;
+
+    svg = DAX_DOM_NODE (dax_element_svg_new ());
+    parent = svg;
+    for (i = 0; i < DEEP_LEVELS; i++) {
+        g = DAX_DOM_NODE (dax_element_g_new ());
+        dax_dom_node_append_child (parent, g, NULL);
+        parent = g;
+    }
+    dax_dom_node_append_child (parent,
+                               DAX_DOM_NODE (dax_element_rect_new ()),
+                               NULL);
+
+    traverser = g_object_new (test_traverser_get_type (), "root", svg, NULL);
+    dax_traverser_apply (DAX_TRAVERSER (traverser));
+
+    g_assert_cmpuint (traverser->n_g, ==, DEEP_LEVELS);
+    g_assert_cmpuint (traverser->max_depth, ==, DEEP_LEVELS);
+    g_assert_cmpuint (traverser->depth, ==, 0);
+    g_assert (g_str_has_suffix (traverser->log->str, "rect "));
+
+    g_object_unref (traverser);
+    g_object_unref (svg);
+}
+
+static void
+traverse_file (const gchar *file)
+{
+    DaxDomDocument *document;
+    DaxTraverser *traverser;
+    DaxDomNode *svg;
+    gdouble elapsed;
+    guint i, n_runs = 1000;
+
+    document = dax_dom_document_new_from_file (file, NULL);
+    g_assert (DAX_IS_DOM_DOCUMENT (document));
+    svg = DAX_DOM_NODE (dax_dom_document_get_document_element (document));
+
+    traverser = g_object_new (noop_traverser_get_type (), "root", svg, NULL);
+
+    g_test_timer_start ();
+    for (i = 0; i < n_runs; i++)
+        dax_traverser_apply (traverser);
+    elapsed = g_test_timer_elapsed ();
+
+    g_test_minimized_result (elapsed / n_runs * 1e6,
+                             "%s: %.1f us per traversal", file,
+                             elapsed / n_runs * 1e6);
+
+    g_object_unref (traverser);
+    g_object_unref (document);
+}
+
+static void
+test_traverser_perf_wild (void)
+{
+    traverse_file ("wild/tiger.svg");
+    traverse_file ("wild/lion.svg");
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+    dax_init_headless (&argc, &argv);
+
+    g_test_add_func ("/traverser/order", test_traverser_order);
+    g_test_add_func ("/traverser/deep", test_traverser_deep);
+
+    if (g_test_perf ())
+        g_test_add_func ("/traverser/perf/wild", test_traverser_perf_wild);
+
+    return g_test_run ();
+}
@@ -1,4 +1,6 @@
 
+#include <math.h>
+
 #include <glib.h>
 
 #include <dax.h>
@@ -31,6 +33,16 @@ test_knot_sequence_string (void)
     g_assert_cmpfloat (array[2], ==, 100.0f);
     g_assert_cmpfloat (array[3], ==, 200.0f);
     g_object_unref (seq);
+
+    /* white space only separators, an odd number of coordinates */
+    seq = dax_knot_sequence_new_from_string ("1.5 2.5\n3e1 -4 5");
+    g_assert (dax_knot_sequence_get_size (seq) == 2);
+    array = dax_knot_sequence_get_array (seq);
+    g_assert_cmpfloat (array[0], ==, 1.5f);
+    g_assert_cmpfloat (array[1], ==, 2.5f);
+    g_assert_cmpfloat (array[2], ==, 30.0f);
+    g_assert_cmpfloat (array[3], ==, -4.0f);
+    g_object_unref (seq);
 }
 
 static void
@@ -103,6 +115,139 @@ test_repeat_count_string (void)
     g_assert_cmpfloat (dax_repeat_count_get_value (&count), ==, 0.f);
 }
 
+static void
+assert_matrix_equal (const DaxMatrix *m1,
+                     const DaxMatrix *m2)
+{
+    guint i;
+
+    for (i = 0; i < 6; i++)
+        g_assert_cmpfloat (fabs (m1->affine[i] - m2->affine[i]), <, 1e-5);
+}
+
+static void
+assert_interpolates_to (const gchar *from,
+                        const gchar *to,
+                        gdouble      progress,
+                        const gchar *expected)
+{
+    DaxMatrix a, b, result, reference;
+
+    g_assert (dax_matrix_from_string (&a, from));
+    g_assert (dax_matrix_from_string (&b, to));
+    g_assert (dax_matrix_from_string (&reference, expected));
+
+    g_assert (dax_matrix_interpolate (&a, &b, progress, &result));
+    assert_matrix_equal (&result, &reference);
+    g_assert_cmpuint (result.n_elementary_matrices, ==,
+                      reference.n_elementary_matrices);
+}
+
+static void
+test_matrix_string (void)
+{
+    DaxMatrix matrix, reference, *copy;
+    double affine[6] = { 1, 0, 0.5, 1, 0, 0 };
+
+    g_assert (dax_matrix_from_string (&matrix, "skewY(10) translate(10)"));
+    g_assert_cmpuint (matrix.n_elementary_matrices, ==, 2);
+    g_assert (matrix.elementary_matrices[0].type == DAX_MATRIX_TYPE_SKEW_Y);
+    g_assert (matrix.elementary_matrices[1].type ==
+              DAX_MATRIX_TYPE_TRANSLATE);
+    g_assert_cmpfloat (matrix.elementary_matrices[1].params[1], ==, 0.f);
+
+    /* copies are plain structure copies */
+    copy = dax_matrix_copy (&matrix);
+    g_assert_cmpuint (copy->n_elementary_matrices, ==, 2);
+    assert_matrix_equal (copy, &matrix);
+    dax_matrix_free (copy);
+
+    /* longer transform lists keep the right affine */
+    g_assert (dax_matrix_from_string (&matrix,
+                                      "translate(1) translate(1) "
+                                      "translate(1) translate(1) "
+                                      "translate(1) translate(1) "
+                                      "translate(1) translate(1) "
+                                      "translate(1) translate(1)"));
+    g_assert_cmpuint (matrix.n_elementary_matrices, ==, 1);
+    g_assert (matrix.elementary_matrices[0].type == DAX_MATRIX_TYPE_GENERIC);
+    g_assert (dax_matrix_from_string (&reference, "translate(10)"));
+    assert_matrix_equal (&matrix, &reference);
+
+    dax_matrix_from_array (&matrix, affine);
+    g_assert (dax_matrix_from_string (&reference, "skewX(26.5650512)"));
+    assert_matrix_equal (&matrix, &reference);
+}
+
+static void
+test_matrix_interpolate (void)
+{
+    DaxMatrix a, b, result, reference;
+    double translate[6] = { 1, 0, 0, 1, 10, 0 };
+
+    assert_interpolates_to ("rotate(0)", "rotate(90)", 0.5, "rotate(45)");
+    assert_interpolates_to ("translate(0,0) rotate(0 10 10) scale(1)",
+                            "translate(10,20) rotate(90 20 30) scale(3,5)",
+                            0.5,
+                            "translate(5,10) rotate(45 15 20) scale(2,3)");
+    assert_interpolates_to ("skewX(0) skewY(10)", "skewX(40) skewY(30)",
+                            0.25,
+                            "skewX(10) skewY(15)");
+    assert_interpolates_to ("rotate(10)", "rotate(30 10 20)", 0.5,
+                            "rotate(20 5 10)");
+
+    /* from and to the neutral transforms */
+    assert_interpolates_to ("", "translate(10,10) scale(3)", 0.5,
+                            "translate(5,5) scale(2)");
+    assert_interpolates_to ("rotate(90 10 10)", "", 0.5,
+                            "rotate(45 10 10)");
+
+    /* a plain affine against a transform list */
+    dax_matrix_from_array (&a, translate);
+    g_assert (dax_matrix_from_string (&b, "scale(3)"));
+    g_assert (dax_matrix_interpolate (&a, &b, 0.5, &result));
+    g_assert (dax_matrix_from_string (&reference, "matrix(2 0 0 2 5 0)"));
+    assert_matrix_equal (&result, &reference);
+    g_assert (dax_matrix_interpolate (&b, &a, 0.5, &result));
+    assert_matrix_equal (&result, &reference);
+
+    /* the result can be one of the operands */
+    g_assert (dax_matrix_from_string (&a, "scale(1)"));
+    g_assert (dax_matrix_from_string (&b, "scale(5)"));
+    g_assert (dax_matrix_interpolate (&a, &b, 1.0, &a));
+    assert_matrix_equal (&a, &b);
+
+    /* lists that don't match */
+    g_assert (dax_matrix_from_string (&a, "translate(10) rotate(20)"));
+    g_assert (dax_matrix_from_string (&b, "rotate(20) translate(10)"));
+    g_assert (dax_matrix_interpolate (&a, &b, 0.5, &result) == FALSE);
+    g_assert (dax_matrix_from_string (&b, "translate(10)"));
+    g_assert (dax_matrix_interpolate (&a, &b, 0.5, &result) == FALSE);
+    g_assert (dax_matrix_from_string (&a, "matrix(1 0 0 1 0 0)"));
+    g_assert (dax_matrix_interpolate (&a, &b, 0.5, &result) == FALSE);
+}
+
+static void
+test_matrix_interval (void)
+{
+    ClutterInterval *interval;
+    DaxMatrix a, b, reference;
+    GValue value = { 0, };
+
+    g_assert (dax_matrix_from_string (&a, "translate(0) rotate(0)"));
+    g_assert (dax_matrix_from_string (&b, "translate(20) rotate(180)"));
+    g_assert (dax_matrix_from_string (&reference,
+                                      "translate(5) rotate(45)"));
+
+    interval = clutter_interval_new (DAX_TYPE_MATRIX, &a, &b);
+    g_value_init (&value, DAX_TYPE_MATRIX);
+    g_assert (clutter_interval_compute_value (interval, 0.25, &value));
+    assert_matrix_equal (g_value_get_boxed (&value), &reference);
+
+    g_value_unset (&value);
+    g_object_unref (interval);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -117,6 +262,9 @@ main (int   argc,
     g_test_add_func ("/types/duration-string", test_duration_string);
     g_test_add_func ("/types/repeat-count", test_repeat_count);
     g_test_add_func ("/types/repeat-count-string", test_repeat_count_string);
+    g_test_add_func ("/types/matrix-string", test_matrix_string);
+    g_test_add_func ("/types/matrix-interpolate", test_matrix_interpolate);
+    g_test_add_func ("/types/matrix-interval", test_matrix_interval);
 
     return g_test_run ();
 }
@@ -1,8 +1,13 @@
 
+#include <math.h>
+#include <string.h>
+
 #include <glib.h>
 #include <glib-object.h>
 
+#include <dax-binding.h>
 #include <dax-utils.h>
+#include <dax-string-pool.h>
 
 typedef struct _CountTest {
     const char *str;
@@ -34,6 +39,386 @@ test_utils_count (void)
     }
 }
 
+static void
+test_utils_is_iri (void)
+{
+    g_assert (_dax_utils_is_iri ("http://example.com/image.png"));
+    g_assert (_dax_utils_is_iri ("https://example.com/image.png"));
+    g_assert (_dax_utils_is_iri ("file:///tmp/image.png"));
+    g_assert (_dax_utils_is_iri ("data:image/png;base64,iVBORw0KGgo="));
+    g_assert (!_dax_utils_is_iri ("image.png"));
+    g_assert (!_dax_utils_is_iri ("../images/data.png"));
+}
+
+static void
+assert_parse_float (const gchar *string,
+                    const gchar *expected_end)
+{
+    gchar *cur = (gchar *) string;
+    gfloat value, expected;
+
+    expected = g_ascii_strtod (string, NULL);
+    g_assert (_dax_utils_parse_float (&cur, &value));
+    g_assert_cmpstr (cur, ==, expected_end);
+    /* bit exact, not just close */
+    g_assert (memcmp (&value, &expected, sizeof (gfloat)) == 0);
+}
+
+static void
+test_utils_parse_float (void)
+{
+    static gchar sign[] = "-", no_digits[] = ".e1";
+    gchar *cur;
+    gfloat value;
+
+    assert_parse_float ("0", "");
+    assert_parse_float ("-0", "");
+    assert_parse_float ("+.5", "");
+    assert_parse_float ("00012.5000", "");
+    assert_parse_float ("0.000789", "");
+    assert_parse_float ("-98765.4321", "");
+    assert_parse_float ("1.5.5", ".5");
+    assert_parse_float ("1e", "e");
+    assert_parse_float ("2em", "em");
+    assert_parse_float ("1e+", "e+");
+    assert_parse_float (".5E+1,", ",");
+    assert_parse_float ("1e-7", "");
+    assert_parse_float ("3.4028235e38", "");
+    assert_parse_float ("7.038531e-26", "");
+    assert_parse_float ("0.30000000000000004", "");
+    /* more significant digits than a double can hold */
+    assert_parse_float ("12345678901234567890123", "");
+    assert_parse_float ("9007199254740993", "");
+    assert_parse_float ("1.00000005960464477539062500001", "");
+    /* runs of digits read 8 at a time */
+    assert_parse_float ("12345678.87654321", "");
+
+    cur = sign;
+    g_assert (!_dax_utils_parse_float (&cur, &value));
+    cur = no_digits;
+    g_assert (!_dax_utils_parse_float (&cur, &value));
+}
+
+/* compares the parser with g_ascii_strtod() on random numbers */
+#define N_RANDOM_FLOATS 100000
+
+static void
+test_utils_parse_float_random (void)
+{
+    GRand *rand;
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar format[8];
+    guint i;
+
+    rand = g_rand_new_with_seed (42);
+
+    for (i = 0; i < N_RANDOM_FLOATS; i++) {
+        gdouble value;
+
+        if (i % 2) {
+            value = g_rand_double_range (rand, -1e6, 1e6);
+            g_snprintf (format, sizeof (format), "%%.%df",
+                        g_rand_int_range (rand, 0, 12));
+        } else {
+            value = g_rand_double (rand) *
+                    pow (10, g_rand_int_range (rand, -40, 39));
+            g_snprintf (format, sizeof (format), "%%.%dg",
+                        g_rand_int_range (rand, 1, 21));
+        }
+        g_ascii_formatd (buffer, sizeof (buffer), format, value);
+
+        assert_parse_float (buffer, "");
+    }
+
+    g_rand_free (rand);
+}
+
+static void
+test_utils_parse_float_list (void)
+{
+    static gchar list[] = " 10,20 , 1e1-5.5.5\t+3,,4 garbage";
+    static gchar short_list[] = "1 2 3";
+    gchar *string = list;
+    gfloat values[8];
+    guint n_values;
+
+    n_values = _dax_utils_parse_float_list (&string, values, 8);
+    g_assert_cmpuint (n_values, ==, 7);
+    g_assert_cmpfloat (values[0], ==, 10.f);
+    g_assert_cmpfloat (values[1], ==, 20.f);
+    g_assert_cmpfloat (values[2], ==, 10.f);
+    g_assert_cmpfloat (values[3], ==, -5.5f);
+    g_assert_cmpfloat (values[4], ==, .5f);
+    g_assert_cmpfloat (values[5], ==, 3.f);
+    g_assert_cmpfloat (values[6], ==, 4.f);
+    g_assert_cmpstr (string, ==, "garbage");
+
+    /* never writes more than asked */
+    string = short_list;
+    n_values = _dax_utils_parse_float_list (&string, values, 2);
+    g_assert_cmpuint (n_values, ==, 2);
+    g_assert_cmpstr (string, ==, "3");
+}
+
+#define N_KNOTS         100000
+#define N_PARSE_RUNS    10
+
+static void
+test_utils_perf_parse_float_list (void)
+{
+    GString *string;
+    gfloat *values;
+    gdouble elapsed;
+    guint i;
+
+    /* what a CAD export looks like */
+    string = g_string_new (NULL);
+    for (i = 0; i < N_KNOTS; i++)
+        g_string_append_printf (string, "%d.%06d,%d.%06d ",
+                                g_test_rand_int_range (0, 10000),
+                                g_test_rand_int_range (0, 1000000),
+                                g_test_rand_int_range (0, 10000),
+                                g_test_rand_int_range (0, 1000000));
+    values = g_new (gfloat, N_KNOTS * 2);
+
+    g_test_timer_start ();
+    for (i = 0; i < N_PARSE_RUNS; i++) {
+        gchar *cur = string->str;
+
+        g_assert_cmpuint (_dax_utils_parse_float_list (&cur, values,
+                                                       N_KNOTS * 2),
+                          ==, N_KNOTS * 2);
+    }
+    elapsed = g_test_timer_elapsed ();
+
+    g_test_maximized_result (string->len * N_PARSE_RUNS / elapsed / 1e6,
+                             "parsed %d coordinates at %.02f MB/s, "
+                             "%.02f Mfloats/s",
+                             N_KNOTS * 2,
+                             string->len * N_PARSE_RUNS / elapsed / 1e6,
+                             N_KNOTS * 2 * N_PARSE_RUNS / elapsed / 1e6);
+
+    g_free (values);
+    g_string_free (string, TRUE);
+}
+
+static void
+test_utils_string_pool (void)
+{
+    DaxArena *arena;
+    DaxStringPool *pool;
+    DaxStringPoolStats stats;
+    const gchar *none, *str;
+    gchar buffer[16];
+    guint i;
+
+    arena = _dax_arena_new ();
+    pool = _dax_string_pool_new (arena);
+
+    none = _dax_string_pool_intern (pool, "none");
+    g_assert_cmpstr (none, ==, "none");
+    g_assert (_dax_string_pool_intern (pool, "none") == none);
+    g_assert (_dax_string_pool_intern_len (pool, "none;", 4) == none);
+    g_assert (_dax_string_pool_intern_len (pool, "non", 3) != none);
+    g_assert (_dax_string_pool_intern (pool, "") != NULL);
+    g_assert (_dax_string_pool_intern (pool, NULL) == NULL);
+
+    /* make the table grow a few times */
+    for (i = 0; i < 1000; i++) {
+        g_snprintf (buffer, sizeof (buffer), "#%06x", i);
+        str = _dax_string_pool_intern (pool, buffer);
+        g_assert_cmpstr (str, ==, buffer);
+    }
+    for (i = 0; i < 1000; i++) {
+        g_snprintf (buffer, sizeof (buffer), "#%06x", i);
+        str = _dax_string_pool_intern (pool, buffer);
+        g_assert (_dax_string_pool_intern (pool, str) == str);
+    }
+    g_assert (_dax_string_pool_intern (pool, "none") == none);
+
+    _dax_string_pool_get_stats (pool, &stats);
+    g_assert_cmpuint (stats.n_strings, ==, 1003);
+    g_assert_cmpuint (stats.n_lookups, ==, 3006);
+    g_assert_cmpuint (stats.string_bytes, ==, 5 + 4 + 1 + 1000 * 8);
+    g_assert_cmpuint (stats.saved_bytes, ==, 5 + 5 + 5 + 1000 * 8 * 2);
+
+    _dax_string_pool_free (pool);
+    _dax_arena_unref (arena);
+}
+
+/*
+ * An object bound to an other one, like elements are bound to actors
+ */
+
+typedef struct
+{
+    GObject parent;
+
+    gint a, b, c;
+    guint n_notify;
+} BoundObject;
+
+typedef GObjectClass BoundObjectClass;
+
+G_DEFINE_TYPE (BoundObject, bound_object, G_TYPE_OBJECT)
+
+enum
+{
+    PROP_0,
+
+    PROP_A,
+    PROP_B,
+    PROP_C
+};
+
+enum
+{
+    CHANGED_A = 1 << 0,
+    CHANGED_B = 1 << 1
+};
+
+static const DaxBindingProperty bound_properties[] =
+{
+    { "a", CHANGED_A },
+    { "b", CHANGED_B },
+    { NULL, 0 }
+};
+
+static void
+bound_object_get_property (GObject    *object,
+                           guint       property_id,
+                           GValue     *value,
+                           GParamSpec *pspec)
+{
+}
+
+static void
+bound_object_set_property (GObject      *object,
+                           guint         property_id,
+                           const GValue *value,
+                           GParamSpec   *pspec)
+{
+    BoundObject *bound = (BoundObject *) object;
+
+    switch (property_id)
+    {
+    case PROP_A:
+        bound->a = g_value_get_int (value);
+        break;
+    case PROP_B:
+        bound->b = g_value_get_int (value);
+        break;
+    case PROP_C:
+        bound->c = g_value_get_int (value);
+        break;
+    }
+}
+
+static void
+bound_object_dispatch_properties_changed (GObject     *object,
+                                          guint        n_pspecs,
+                                          GParamSpec **pspecs)
+{
+    _dax_binding_properties_changed (object, n_pspecs, pspecs);
+}
+
+static void
+bound_object_class_init (BoundObjectClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+    object_class->get_property = bound_object_get_property;
+    object_class->set_property = bound_object_set_property;
+    object_class->dispatch_properties_changed =
+        bound_object_dispatch_properties_changed;
+
+    g_object_class_install_property (object_class, PROP_A,
+        g_param_spec_int ("a", "a", "a", 0, 100, 0, G_PARAM_READWRITE));
+    g_object_class_install_property (object_class, PROP_B,
+        g_param_spec_int ("b", "b", "b", 0, 100, 0, G_PARAM_READWRITE));
+    g_object_class_install_property (object_class, PROP_C,
+        g_param_spec_int ("c", "c", "c", 0, 100, 0, G_PARAM_READWRITE));
+}
+
+static void
+bound_object_init (BoundObject *self)
+{
+}
+
+typedef struct
+{
+    guint n_updates;
+    guint changes;
+    gint a, b;
+} Update;
+
+static Update update;
+
+static void
+update_target (GObject *element,
+               GObject *target,
+               guint    changes)
+{
+    BoundObject *bound = (BoundObject *) element;
+
+    update.n_updates++;
+    update.changes = changes;
+    update.a = bound->a;
+    update.b = bound->b;
+}
+
+static void
+test_utils_binding (void)
+{
+    GObject *element, *target;
+
+    element = g_object_new (bound_object_get_type (), NULL);
+    target = g_object_new (G_TYPE_OBJECT, NULL);
+    _dax_binding_new (element, target, bound_properties, update_target);
+
+    /* several changes, a single update with all of them */
+    g_object_set (element, "a", 1, NULL);
+    g_object_set (element, "b", 2, NULL);
+    g_object_set (element, "a", 3, NULL);
+    g_assert_cmpuint (update.n_updates, ==, 0);
+    _dax_binding_flush ();
+    g_assert_cmpuint (update.n_updates, ==, 1);
+    g_assert_cmpuint (update.changes, ==, CHANGED_A | CHANGED_B);
+    g_assert_cmpint (update.a, ==, 3);
+    g_assert_cmpint (update.b, ==, 2);
+
+    /* nothing to do */
+    _dax_binding_flush ();
+    g_assert_cmpuint (update.n_updates, ==, 1);
+
+    /* c is not bound */
+    g_object_set (element, "c", 4, NULL);
+    _dax_binding_flush ();
+    g_assert_cmpuint (update.n_updates, ==, 1);
+
+    g_object_set (element, "b", 5, NULL);
+    _dax_binding_flush ();
+    g_assert_cmpuint (update.n_updates, ==, 2);
+    g_assert_cmpuint (update.changes, ==, CHANGED_B);
+
+    /* the binding stops with its target */
+    g_object_set (element, "a", 6, NULL);
+    g_object_unref (target);
+    _dax_binding_flush ();
+    g_object_set (element, "a", 7, NULL);
+    _dax_binding_flush ();
+    g_assert_cmpuint (update.n_updates, ==, 2);
+
+    /* and goes away with the element */
+    target = g_object_new (G_TYPE_OBJECT, NULL);
+    _dax_binding_new (element, target, bound_properties, update_target);
+    g_object_set (element, "a", 8, NULL);
+    g_object_unref (element);
+    _dax_binding_flush ();
+    g_assert_cmpuint (update.n_updates, ==, 2);
+    g_object_unref (target);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -42,6 +427,16 @@ main (int   argc,
     g_test_init (&argc, &argv, NULL);
 
     g_test_add_func ("/utils/count", test_utils_count);
+    g_test_add_func ("/utils/is-iri", test_utils_is_iri);
+    g_test_add_func ("/utils/parse-float", test_utils_parse_float);
+    g_test_add_func ("/utils/parse-float-random",
+                     test_utils_parse_float_random);
+    g_test_add_func ("/utils/parse-float-list", test_utils_parse_float_list);
+    g_test_add_func ("/utils/string-pool", test_utils_string_pool);
+    g_test_add_func ("/utils/binding", test_utils_binding);
+    if (g_test_perf ())
+        g_test_add_func ("/utils/perf/parse-float-list",
+                         test_utils_perf_parse_float_list);
 
     return g_test_run ();
 }
@@ -0,0 +1,55 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include <glib.h>
+#include <glib/gprintf.h>
+#include <dax.h>
+
+int
+main (int   argc,
+      char *argv[])
+{
+    DaxDomDocument *document;
+    GError *error = NULL;
+
+    dax_init_headless (&argc, &argv);
+
+    if (argc < 3) {
+        g_printf ("Usage: dax-compile input.svg output.daxb\n");
+        return EXIT_FAILURE;
+    }
+
+    document = dax_dom_document_new_from_file (argv[1], &error);
+    if (document == NULL) {
+        g_printf ("Could not load %s: %s\n", argv[1],
+                  error ? error->message : "unknown error");
+        return EXIT_FAILURE;
+    }
+
+    /* relative IRIs are resolved against the directory of the output */
+    if (!dax_dom_document_save_binary (document, argv[2], &error)) {
+        g_printf ("Could not save %s: %s\n", argv[2], error->message);
+        return EXIT_FAILURE;
+    }
+
+    g_object_unref (document);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+/*
+ * Dax - Load and draw SVG
+ *
+ * Copyright © 2010 Intel Corporation.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU Lesser General Public License,
+ * version 2.1, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include <glib.h>
+#include <glib/gprintf.h>
+#include <dax.h>
+
+static gint width = 0;
+static gint height = 0;
+static gchar *background = NULL;
+static gint repeat = 1;
+
+static GOptionEntry entries[] =
+{
+    { "width", 'w', 0, G_OPTION_ARG_INT, &width,
+      "Width of the output image (default: width of the document)", "W" },
+    { "height", 'h', 0, G_OPTION_ARG_INT, &height,
+      "Height of the output image (default: height of the document)", "H" },
+    { "background", 'b', 0, G_OPTION_ARG_STRING, &background,
+      "Background color (default: transparent)", "COLOR" },
+    { "repeat", 'r', 0, G_OPTION_ARG_INT, &repeat,
+      "Render the document N times and report the throughput", "N" },
+    { NULL }
+};
+
+int
+main (int   argc,
+      char *argv[])
+{
+    GOptionContext *context;
+    DaxDomDocument *document;
+    DaxDomNode *svg;
+    DaxTraverser *traverser = NULL;
+    ClutterColor bg_color;
+    GError *error = NULL;
+    GTimer *timer;
+    gint i;
+
+    context = g_option_context_new ("input.svg output.png - Render SVG "
+                                    "documents without a display");
+    g_option_context_add_main_entries (context, entries, NULL);
+    if (!g_option_context_parse (context, &argc, &argv, &error)) {
+        g_print ("option parsing failed: %s\n", error->message);
+        return EXIT_FAILURE;
+    }
+
+    dax_init_headless (&argc, &argv);
+
+    if (argc < 3) {
+        g_printf ("Usage: dax-render [OPTION...] input.svg output.png\n");
+        return EXIT_FAILURE;
+    }
+
+    if (background && !clutter_color_from_string (&bg_color, background)) {
+        g_printf ("Invalid background color: %s\n", background);
+        return EXIT_FAILURE;
+    }
+
+    document = dax_dom_document_new_from_file (argv[1], &error);
+    if (document == NULL) {
+        g_printf ("Could not load %s: %s\n", argv[1],
+                  error ? error->message : "unknown error");
+        return EXIT_FAILURE;
+    }
+    svg = DAX_DOM_NODE (dax_dom_document_get_document_element (document));
+
+    timer = g_timer_new ();
+    for (i = 0; i < MAX (repeat, 1); i++) {
+        if (traverser)
+            g_object_unref (traverser);
+
+        traverser = dax_traverser_raster_new (svg, width, height);
+        if (background)
+            dax_traverser_raster_clear (DAX_TRAVERSER_RASTER (traverser),
+                                        &bg_color);
+        dax_traverser_apply (traverser);
+    }
+    g_timer_stop (timer);
+
+    if (repeat > 1) {
+        gdouble elapsed = g_timer_elapsed (timer, NULL);
+
+        g_printf ("%d renderings in %.03fs, %.02f ms/frame, %.02f frames/s\n",
+                  repeat, elapsed, elapsed * 1000 / repeat, repeat / elapsed);
+    }
+
+    if (!dax_traverser_raster_save_png (DAX_TRAVERSER_RASTER (traverser),
+                                        argv[2],
+                                        &error))
+    {
+        g_printf ("Could not save %s: %s\n", argv[2], error->message);
+        return EXIT_FAILURE;
+    }
+
+    g_timer_destroy (timer);
+    g_object_unref (traverser);
+    g_object_unref (document);
+
+    return EXIT_SUCCESS;
+}